@@ -0,0 +1,243 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Host memory replacements for Buffer, AutoBuffer and ImageLoader,
+// so the CPU-side classes can be benchmarked without a Vulkan device.
+// Device-local memory is never touched on CPU, so it's allocated only if mapped.
+
+#include "Buffer.h"
+#include "AutoBuffer.h"
+#include "ImageLoader.h"
+
+#include <mutex>
+#include <unordered_map>
+
+using namespace RTGL1;
+
+
+namespace
+{
+
+std::mutex hostMemoryMutex;
+std::unordered_map<const Buffer *, std::unique_ptr<uint8_t[]>> hostMemory;
+
+}
+
+
+Buffer::Buffer()
+    :
+    device(VK_NULL_HANDLE),
+    buffer(VK_NULL_HANDLE),
+    memory(VK_NULL_HANDLE),
+    address(0),
+    size(0),
+    isMapped(false)
+{}
+
+Buffer::~Buffer()
+{
+    Destroy();
+}
+
+void Buffer::Init(
+    const std::shared_ptr<MemoryAllocator> &allocator,
+    VkDeviceSize bsize, VkBufferUsageFlags usage,
+    VkMemoryPropertyFlags properties, const char *debugName)
+{
+    assert(bsize > 0);
+    assert(size == 0);
+
+    size = bsize;
+}
+
+void Buffer::Destroy()
+{
+    std::lock_guard<std::mutex> lock(hostMemoryMutex);
+    hostMemory.erase(this);
+
+    size = 0;
+    isMapped = false;
+}
+
+void *Buffer::Map()
+{
+    assert(size > 0);
+    assert(!isMapped);
+
+    std::lock_guard<std::mutex> lock(hostMemoryMutex);
+
+    auto &mem = hostMemory[this];
+
+    if (!mem)
+    {
+        // value-initialized, as real mapped memory usually is
+        mem = std::make_unique<uint8_t[]>(size);
+    }
+
+    isMapped = true;
+    return mem.get();
+}
+
+void Buffer::Unmap()
+{
+    assert(isMapped);
+    isMapped = false;
+}
+
+bool Buffer::TryUnmap()
+{
+    if (isMapped)
+    {
+        Unmap();
+        return true;
+    }
+
+    return false;
+}
+
+VkBuffer Buffer::GetBuffer() const
+{
+    return buffer;
+}
+
+VkDeviceMemory Buffer::GetMemory() const
+{
+    return memory;
+}
+
+VkDeviceAddress Buffer::GetAddress() const
+{
+    return address;
+}
+
+VkDeviceSize Buffer::GetSize() const
+{
+    return size;
+}
+
+bool Buffer::IsMapped() const
+{
+    return isMapped;
+}
+
+bool Buffer::IsInitted() const
+{
+    return size > 0;
+}
+
+
+
+AutoBuffer::AutoBuffer(std::shared_ptr<MemoryAllocator> _allocator)
+:
+    allocator(std::move(_allocator)),
+    mapped{}
+{}
+
+AutoBuffer::AutoBuffer(VkDevice _device, std::shared_ptr<MemoryAllocator> _allocator) : AutoBuffer(std::move(_allocator))
+{}
+
+AutoBuffer::~AutoBuffer()
+{
+    Destroy();
+}
+
+void AutoBuffer::Create(VkDeviceSize size, VkBufferUsageFlags usage, const std::string &debugName, uint32_t frameCount)
+{
+    assert(frameCount > 0 && frameCount <= MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        staging[i].Init(allocator, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        mapped[i] = staging[i].Map();
+    }
+
+    deviceLocal.Init(allocator, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void AutoBuffer::Destroy()
+{
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        staging[i].Destroy();
+        mapped[i] = nullptr;
+    }
+
+    deviceLocal.Destroy();
+}
+
+void AutoBuffer::CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, VkDeviceSize size, VkDeviceSize offset)
+{
+    // transfer is not measured
+}
+
+void AutoBuffer::CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, const VkBufferCopy *copyInfos, uint32_t copyInfosCount)
+{}
+
+VkBuffer AutoBuffer::GetStaging(uint32_t frameIndex)
+{
+    return staging[frameIndex].GetBuffer();
+}
+
+void *AutoBuffer::GetMapped(uint32_t frameIndex)
+{
+    assert(mapped[frameIndex] != nullptr);
+    return mapped[frameIndex];
+}
+
+VkBuffer AutoBuffer::GetDeviceLocal()
+{
+    return deviceLocal.GetBuffer();
+}
+
+VkDeviceAddress AutoBuffer::GetDeviceAddress()
+{
+    return deviceLocal.GetAddress();
+}
+
+VkDeviceSize AutoBuffer::GetSize() const
+{
+    return deviceLocal.GetSize();
+}
+
+
+
+ImageLoader::ImageLoader(std::shared_ptr<UserFileLoad> _userFileLoad) : userFileLoad(std::move(_userFileLoad))
+{}
+
+ImageLoader::~ImageLoader()
+{}
+
+bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
+{
+    // pretend that no override files exist, so only path building is measured
+    *pResultInfo = {};
+    return false;
+}
+
+bool ImageLoader::LoadLayered(const char *pFilePath, LayeredResultInfo *pResultInfo)
+{
+    *pResultInfo = {};
+    return false;
+}
+
+void ImageLoader::FreeLoaded()
+{
+    loadedImages.clear();
+}
@@ -0,0 +1,575 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// CPU-only micro-benchmarks of the per-frame paths.
+// GPU buffers are replaced with host memory (see FakeGpuMemory.cpp),
+// so the results show only the cost of CPU work: copying to staging,
+// building light lists, translating sector IDs, matching previous frame etc.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "GeomInfoManager.h"
+#include "LightLists.h"
+#include "Matrix.h"
+#include "RgException.h"
+#include "SectorVisibility.h"
+#include "TextureOverrides.h"
+#include "TriangleInfoManager.h"
+#include "VertexCollector.h"
+#include "VertexCollectorFilterType.h"
+#include "Generated/ShaderCommonC.h"
+
+using namespace RTGL1;
+
+
+namespace
+{
+
+// to prevent the compiler from removing the measured code
+volatile uint64_t sink = 0;
+
+template<typename Func>
+void Measure(const char *pName, uint32_t iterationCount, uint64_t itemsPerIteration, uint64_t bytesPerIteration, Func &&func)
+{
+    // warm up caches and allocations
+    func(0);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        func(i);
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double msPerIteration = seconds * 1000.0 / iterationCount;
+    const double itemsPerSecond = (double)itemsPerIteration * iterationCount / seconds;
+    const double mbPerSecond = (double)bytesPerIteration * iterationCount / seconds / (1024.0 * 1024.0);
+
+    if (bytesPerIteration > 0)
+    {
+        printf("%-40s %10.4f ms/iter %12.2f Mitems/s %10.1f MB/s\n", pName, msPerIteration, itemsPerSecond / 1e6, mbPerSecond);
+    }
+    else
+    {
+        printf("%-40s %10.4f ms/iter %12.2f Mitems/s\n", pName, msPerIteration, itemsPerSecond / 1e6);
+    }
+}
+
+RgTransform RandomTransform(std::mt19937 &rnd)
+{
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+
+    RgTransform t = {};
+
+    for (auto &row : t.matrix)
+    {
+        for (float &v : row)
+        {
+            v = d(rnd);
+        }
+    }
+
+    // keep it invertible
+    t.matrix[0][0] += 4.0f;
+    t.matrix[1][1] += 4.0f;
+    t.matrix[2][2] += 4.0f;
+
+    return t;
+}
+
+
+
+void BenchmarkMatrix(std::mt19937 &rnd)
+{
+    constexpr uint32_t count = 4096;
+
+    std::vector<RgTransform> transforms(count);
+    std::vector<float> mats(count * 16);
+    std::vector<float> results(count * 16);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        transforms[i] = RandomTransform(rnd);
+        Matrix::ToMat4(&mats[i * 16], transforms[i]);
+    }
+
+    Measure("Matrix::ToMat4Transposed", 200, count, count * sizeof(RgTransform), [&] (uint32_t)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Matrix::ToMat4Transposed(&results[i * 16], transforms[i]);
+        }
+        sink += (uint64_t)results[17];
+    });
+
+    Measure("Matrix::Multiply", 200, count, 0, [&] (uint32_t)
+    {
+        for (uint32_t i = 0; i + 1 < count; i++)
+        {
+            Matrix::Multiply(&results[i * 16], &mats[i * 16], &mats[(i + 1) * 16]);
+        }
+        sink += (uint64_t)results[17];
+    });
+
+    Measure("Matrix::Inverse", 200, count, 0, [&] (uint32_t)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Matrix::Inverse(&results[i * 16], &mats[i * 16]);
+        }
+        sink += (uint64_t)results[17];
+    });
+}
+
+
+
+// Sector IDs are sparse, like the ones that are passed by a user.
+SectorID GetSectorID(uint32_t i)
+{
+    return SectorID{ i * 7 + 1 };
+}
+
+void FillPotentialVisibility(SectorVisibility &sv, uint32_t sectorCount, uint32_t neighbourCount, std::mt19937 &rnd)
+{
+    std::uniform_int_distribution<uint32_t> d(0, sectorCount - 1);
+
+    for (uint32_t a = 0; a < sectorCount; a++)
+    {
+        for (uint32_t n = 0; n < neighbourCount; n++)
+        {
+            sv.SetPotentialVisibility(GetSectorID(a), GetSectorID(d(rnd)));
+        }
+    }
+}
+
+void BenchmarkSectorVisibility(std::mt19937 &rnd)
+{
+    constexpr uint32_t sectorCount = 1024;
+    constexpr uint32_t neighbourCount = 16;
+
+    SectorVisibility sv;
+
+    Measure("SectorVisibility::SetPotentialVisibility", 20, sectorCount * neighbourCount, 0, [&] (uint32_t)
+    {
+        sv.Reset();
+        FillPotentialVisibility(sv, sectorCount, neighbourCount, rnd);
+    });
+
+    {
+        const uint32_t wordsPerRow = (sectorCount + 31) / 32;
+
+        std::vector<SectorID> ids(sectorCount);
+        std::vector<uint32_t> bits(sectorCount * wordsPerRow, 0);
+        std::uniform_int_distribution<uint32_t> d(0, sectorCount - 1);
+
+        for (uint32_t a = 0; a < sectorCount; a++)
+        {
+            ids[a] = GetSectorID(a);
+
+            for (uint32_t n = 0; n < neighbourCount; n++)
+            {
+                const uint32_t b = d(rnd);
+                bits[a * wordsPerRow + b / 32] |= 1u << (b % 32);
+            }
+        }
+
+        Measure("SectorVisibility::SetPotentialVisibility, matrix", 20, sectorCount * neighbourCount, 0, [&] (uint32_t)
+        {
+            sv.Reset();
+            sv.SetPotentialVisibility(ids.data(), sectorCount, bits.data());
+        });
+    }
+
+    Measure("SectorVisibility queries", 200, sectorCount, 0, [&] (uint32_t)
+    {
+        uint64_t visibleCount = 0;
+
+        for (uint32_t i = 0; i < sectorCount; i++)
+        {
+            const SectorArrayIndex index = sv.SectorIDToArrayIndex(GetSectorID(i));
+
+            if (sv.ArePotentiallyVisibleSectorsExist(index))
+            {
+                for (SectorArrayIndex visible : sv.GetPotentiallyVisibleSectors(index))
+                {
+                    visibleCount += sv.SectorArrayIndexToID(visible).GetID();
+                }
+            }
+        }
+
+        sink += visibleCount;
+    });
+}
+
+
+
+void BenchmarkLightLists(std::mt19937 &rnd)
+{
+    constexpr uint32_t sectorCount = 512;
+    constexpr uint32_t neighbourCount = 8;
+    constexpr uint32_t lightCount = 1024;
+
+    auto sv = std::make_shared<SectorVisibility>();
+    FillPotentialVisibility(*sv, sectorCount, neighbourCount, rnd);
+
+    LightLists lightLists(VK_NULL_HANDLE, nullptr, sv, "Benchmark");
+
+    std::uniform_int_distribution<uint32_t> d(0, sectorCount - 1);
+    std::vector<SectorArrayIndex> lightSectors(lightCount);
+
+    for (auto &s : lightSectors)
+    {
+        s = sv->SectorIDToArrayIndex(GetSectorID(d(rnd)));
+    }
+
+    std::uniform_real_distribution<float> dpos(-100.0f, 100.0f);
+    std::vector<LightBounds> lightBounds(lightCount);
+
+    for (auto &b : lightBounds)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            b.boundsMin[k] = dpos(rnd);
+            b.boundsMax[k] = b.boundsMin[k] + 1.0f;
+        }
+        b.power = 1.0f;
+    }
+
+    // sectors and light lists are cached, if lights are not moved
+    Measure("LightLists, static lights", 200, lightCount, 0, [&] (uint32_t i)
+    {
+        lightLists.PrepareForFrame();
+
+        for (uint32_t l = 0; l < lightCount; l++)
+        {
+            lightLists.InsertLight(LightArrayIndex{ l }, l, lightBounds[l], lightSectors[l], nullptr, nullptr);
+        }
+
+        lightLists.BuildAndCopyFromStaging(VK_NULL_HANDLE, i % MAX_FRAMES_IN_FLIGHT);
+    });
+
+    // including light trees
+    Measure("LightLists, moving lights", 200, lightCount, 0, [&] (uint32_t i)
+    {
+        lightLists.PrepareForFrame();
+
+        for (uint32_t l = 0; l < lightCount; l++)
+        {
+            LightBounds b = lightBounds[l];
+            b.boundsMin[0] += (float)i;
+            b.boundsMax[0] += (float)i;
+
+            lightLists.InsertLight(LightArrayIndex{ l }, l, b, lightSectors[l], nullptr, nullptr);
+        }
+
+        lightLists.BuildAndCopyFromStaging(VK_NULL_HANDLE, i % MAX_FRAMES_IN_FLIGHT);
+    });
+}
+
+
+
+void BenchmarkTriangleInfo(std::mt19937 &rnd)
+{
+    constexpr uint32_t sectorCount = 256;
+    constexpr uint32_t geomCount = 256;
+    constexpr uint32_t triangleCount = 512;
+
+    std::shared_ptr<MemoryAllocator> allocator;
+
+    auto sv = std::make_shared<SectorVisibility>();
+    FillPotentialVisibility(*sv, sectorCount, 4, rnd);
+
+    TriangleInfoManager triangleInfoMgr(VK_NULL_HANDLE, allocator, sv);
+
+    std::uniform_int_distribution<uint32_t> d(0, sectorCount - 1);
+    std::vector<uint32_t> sectorIDs(triangleCount);
+
+    for (uint32_t &id : sectorIDs)
+    {
+        id = GetSectorID(d(rnd)).GetID();
+    }
+
+    Measure("TriangleInfoManager sector IDs", 200, geomCount * triangleCount, geomCount * triangleCount * sizeof(uint32_t), [&] (uint32_t i)
+    {
+        const uint32_t frameIndex = i % MAX_FRAMES_IN_FLIGHT;
+
+        triangleInfoMgr.PrepareForFrame(frameIndex);
+
+        for (uint32_t g = 0; g < geomCount; g++)
+        {
+            sink += triangleInfoMgr.UploadAndGetArrayIndex(frameIndex, sectorIDs.data(), triangleCount, RG_GEOMETRY_TYPE_DYNAMIC);
+        }
+    });
+}
+
+
+
+void BenchmarkGeomInfo()
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    constexpr uint32_t geomCount = 1024;
+    constexpr VertexCollectorFilterTypeFlags flags = FT::CF_DYNAMIC | FT::PT_OPAQUE | FT::PV_WORLD_0;
+
+    std::shared_ptr<MemoryAllocator> allocator;
+    GeomInfoManager geomInfoMgr(VK_NULL_HANDLE, allocator);
+
+    Measure("GeomInfoManager previous frame matching", 200, geomCount, geomCount * sizeof(ShGeometryInstance), [&] (uint32_t i)
+    {
+        const uint32_t frameIndex = i % MAX_FRAMES_IN_FLIGHT;
+
+        geomInfoMgr.PrepareForFrame(frameIndex);
+
+        for (uint32_t g = 0; g < geomCount; g++)
+        {
+            ShGeometryInstance src = {};
+            src.baseVertexIndex = g * 96;
+            src.vertexCount = 96;
+            src.baseIndexIndex = UINT32_MAX;
+            src.indexCount = UINT32_MAX;
+
+            // same unique IDs every frame, so each one is matched with the previous
+            geomInfoMgr.WriteGeomInfo(frameIndex, g, g, flags, src);
+        }
+
+        sink += geomInfoMgr.IsDynamicGeometryUnchanged(frameIndex, flags);
+    });
+}
+
+
+
+struct TestMesh
+{
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<uint32_t> indices;
+};
+
+TestMesh MakeMesh(uint32_t vertexCount, uint32_t indexCount, std::mt19937 &rnd)
+{
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> di(0, vertexCount - 1);
+
+    TestMesh m;
+    m.positions.resize(vertexCount * 3);
+    m.normals.resize(vertexCount * 3);
+    m.texCoords.resize(vertexCount * 2);
+    m.indices.resize(indexCount);
+
+    for (float &f : m.positions) { f = d(rnd); }
+    for (float &f : m.normals) { f = d(rnd); }
+    for (float &f : m.texCoords) { f = d(rnd); }
+    for (uint32_t &i : m.indices) { i = di(rnd); }
+
+    return m;
+}
+
+void BenchmarkVertexCollector(std::mt19937 &rnd)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    constexpr uint32_t geomCount = 512;
+    constexpr uint32_t vertexCount = 1536;
+    constexpr uint32_t indexCount = 3072;
+
+    const VertexBufferProperties properties =
+    {
+        .vertexArrayOfStructs = false,
+        .positionStride = 3 * sizeof(float),
+        .normalStride = 3 * sizeof(float),
+        .texCoordStride = 2 * sizeof(float),
+        .colorStride = sizeof(uint32_t),
+    };
+
+    std::shared_ptr<MemoryAllocator> allocator;
+
+    auto sv = std::make_shared<SectorVisibility>();
+    auto geomInfoMgr = std::make_shared<GeomInfoManager>(VK_NULL_HANDLE, allocator);
+    auto triangleInfoMgr = std::make_shared<TriangleInfoManager>(VK_NULL_HANDLE, allocator, sv);
+
+    auto collector = std::make_shared<VertexCollector>(
+        VK_NULL_HANDLE, allocator, geomInfoMgr, triangleInfoMgr, sv,
+        sizeof(ShVertexBufferDynamic), properties,
+        FT::CF_DYNAMIC | FT::MASK_PASS_THROUGH_GROUP | FT::MASK_PRIMARY_VISIBILITY_GROUP);
+
+    const TestMesh mesh = MakeMesh(vertexCount, indexCount, rnd);
+
+    RgGeometryUploadInfo info = {};
+    info.geomType = RG_GEOMETRY_TYPE_DYNAMIC;
+    info.passThroughType = RG_GEOMETRY_PASS_THROUGH_TYPE_OPAQUE;
+    info.visibilityType = RG_GEOMETRY_VISIBILITY_TYPE_WORLD_0;
+    info.vertexCount = vertexCount;
+    info.pVertexData = mesh.positions.data();
+    info.pNormalData = mesh.normals.data();
+    info.pTexCoordLayerData[0] = mesh.texCoords.data();
+    info.layerColors[0] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    info.transform = RandomTransform(rnd);
+
+    const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT] = {};
+
+    const uint64_t bytesPerGeom =
+        vertexCount * (properties.positionStride + properties.normalStride + properties.texCoordStride);
+
+    const auto beginFrame = [&] (uint32_t frameIndex)
+    {
+        geomInfoMgr->PrepareForFrame(frameIndex);
+        triangleInfoMgr->PrepareForFrame(frameIndex);
+        collector->Reset();
+        collector->BeginCollecting(false);
+    };
+
+    Measure("VertexCollector::AddGeometry", 100, geomCount, geomCount * bytesPerGeom, [&] (uint32_t i)
+    {
+        const uint32_t frameIndex = i % MAX_FRAMES_IN_FLIGHT;
+        beginFrame(frameIndex);
+
+        for (uint32_t g = 0; g < geomCount; g++)
+        {
+            info.uniqueID = g;
+            sink += collector->AddGeometry(frameIndex, info, materials);
+        }
+
+        collector->EndCollecting();
+    });
+
+    info.indexCount = indexCount;
+    info.pIndexData = mesh.indices.data();
+
+    Measure("VertexCollector::AddGeometry indexed", 100, geomCount, geomCount * (bytesPerGeom + indexCount * sizeof(uint32_t)), [&] (uint32_t i)
+    {
+        const uint32_t frameIndex = i % MAX_FRAMES_IN_FLIGHT;
+        beginFrame(frameIndex);
+
+        for (uint32_t g = 0; g < geomCount; g++)
+        {
+            info.uniqueID = g;
+            sink += collector->AddGeometry(frameIndex, info, materials);
+        }
+
+        collector->EndCollecting();
+    });
+
+    // vertices are written directly to the reserved staging memory,
+    // so only the geometry info is processed by AddGeometry
+    Measure("VertexCollector reserved, in-place", 100, geomCount, geomCount * (bytesPerGeom + indexCount * sizeof(uint32_t)), [&] (uint32_t i)
+    {
+        const uint32_t frameIndex = i % MAX_FRAMES_IN_FLIGHT;
+        beginFrame(frameIndex);
+
+        for (uint32_t g = 0; g < geomCount; g++)
+        {
+            RgDynamicGeometryMapping mapping = {};
+
+            if (!collector->ReserveDynamicGeometry(vertexCount, indexCount, mapping))
+            {
+                break;
+            }
+
+            memcpy(mapping.pVertexData, mesh.positions.data(), vertexCount * properties.positionStride);
+            memcpy(mapping.pNormalData, mesh.normals.data(), vertexCount * properties.normalStride);
+            memcpy(mapping.pTexCoordLayerData[0], mesh.texCoords.data(), vertexCount * properties.texCoordStride);
+            memcpy(mapping.pIndexData, mesh.indices.data(), indexCount * sizeof(uint32_t));
+
+            RgGeometryUploadInfo reserved = info;
+            reserved.uniqueID = g;
+            reserved.pVertexData = mapping.pVertexData;
+            reserved.pNormalData = mapping.pNormalData;
+            reserved.pTexCoordLayerData[0] = mapping.pTexCoordLayerData[0];
+            reserved.pIndexData = mapping.pIndexData;
+
+            sink += collector->AddGeometry(frameIndex, reserved, materials);
+        }
+
+        collector->EndCollecting();
+    });
+}
+
+
+
+void BenchmarkTextureOverrides()
+{
+    constexpr uint32_t textureCount = 1024;
+
+    auto imageLoader = std::make_shared<ImageLoader>(nullptr);
+
+    const uint32_t defaultData[4] = {};
+    const RgTextureSet defaultTextures = { { defaultData, true }, {}, {} };
+
+    TextureOverrides::OverrideInfo overrideInfo = {};
+    overrideInfo.texturesPath = "ovrd/mat/";
+    overrideInfo.postfixes[0] = "";
+    overrideInfo.postfixes[1] = "_rme";
+    overrideInfo.postfixes[2] = "_n";
+    overrideInfo.overridenIsSRGB[0] = true;
+
+    std::vector<std::string> relativePaths(textureCount);
+
+    for (uint32_t i = 0; i < textureCount; i++)
+    {
+        relativePaths[i] = "textures/level" + std::to_string(i % 16) + "/wall_" + std::to_string(i) + ".tga";
+    }
+
+    Measure("TextureOverrides path building", 200, textureCount, 0, [&] (uint32_t)
+    {
+        for (const auto &p : relativePaths)
+        {
+            TextureOverrides ovrd(p.c_str(), defaultTextures, { 1, 1 }, overrideInfo, imageLoader);
+            sink += ovrd.GetResult(0).dataSize;
+        }
+    });
+}
+
+}
+
+
+
+int main()
+{
+    VertexCollectorFilterTypeFlags_Init();
+
+    std::mt19937 rnd(42);
+
+    try
+    {
+        BenchmarkMatrix(rnd);
+        BenchmarkSectorVisibility(rnd);
+        BenchmarkLightLists(rnd);
+        BenchmarkTriangleInfo(rnd);
+        BenchmarkGeomInfo();
+        BenchmarkVertexCollector(rnd);
+        BenchmarkTextureOverrides();
+    }
+    catch (RgException &e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -73,11 +73,15 @@ typedef uint32_t RgBool32;
 RG_DEFINE_NON_DISPATCHABLE_HANDLE(RgInstance)
 typedef uint32_t RgMaterial;
 typedef uint32_t RgCubemap;
+typedef uint32_t RgSkinnedMesh;
+typedef uint32_t RgRetainedGeometry;
 typedef uint32_t RgFlags;
 
 #define RG_NULL_HANDLE      0
 #define RG_NO_MATERIAL      0
 #define RG_EMPTY_CUBEMAP    0
+#define RG_NO_SKINNED_MESH  0
+#define RG_NO_RETAINED_GEOMETRY 0
 #define RG_FALSE            0
 #define RG_TRUE             1
 
@@ -102,6 +106,13 @@ typedef enum RgResult
     RG_ERROR_INCORRECT_SECTOR,
     RG_ERROR_CANT_FIND_BLUE_NOISE,
     RG_ERROR_CANT_FIND_WATER_TEXTURES,
+    RG_CANT_RESERVE_DYNAMIC_GEOMETRY,
+    RG_CANT_CREATE_SKINNED_MESH,
+    RG_CANT_CREATE_RETAINED_GEOMETRY,
+    RG_CANT_ADD_STATIC_GEOMETRY,
+    RG_CANT_REMOVE_STATIC_GEOMETRY,
+    RG_CANT_UPLOAD_MESH_INSTANCE,
+    RG_TOO_MANY_TEXTURES,
 } RgResult;
 
 typedef void (*PFN_rgPrint)(const char *pMessage, void *pUserData);
@@ -114,6 +125,7 @@ typedef struct RgMetalSurfaceCreateInfo RgMetalSurfaceCreateInfo;
 typedef struct RgWaylandSurfaceCreateInfo RgWaylandSurfaceCreateInfo;
 typedef struct RgXcbSurfaceCreateInfo RgXcbSurfaceCreateInfo;
 typedef struct RgXlibSurfaceCreateInfo RgXlibSurfaceCreateInfo;
+typedef struct RgHeadlessSurfaceCreateInfo RgHeadlessSurfaceCreateInfo;
 
 #ifdef RG_USE_SURFACE_WIN32
 typedef struct RgWin32SurfaceCreateInfo
@@ -154,6 +166,27 @@ typedef struct RgXlibSurfaceCreateInfo
 } RgXlibSurfaceCreateInfo;
 #endif // RG_USE_SURFACE_XLIB
 
+// No window surface is used, the library renders into internal offscreen images.
+// The size of these images is defined by RgStartFrameInfo::surfaceSize.
+// Vsync requests are ignored.
+typedef struct RgHeadlessSurfaceCreateInfo
+{
+    // Amount of offscreen images, that are used instead of swapchain images.
+    // If 0, then 3 is used.
+    uint32_t            imageCount;
+} RgHeadlessSurfaceCreateInfo;
+
+typedef enum RgStaticGeometryChunking
+{
+    // All static non-movable geometry with the same visibility and pass through types is in one BLAS.
+    RG_STATIC_GEOMETRY_CHUNKING_NONE,
+    // A chunk is closed, when it has at least RgInstanceCreateInfo::staticGeometryChunkTriangleCount triangles.
+    RG_STATIC_GEOMETRY_CHUNKING_BY_TRIANGLE_COUNT,
+    // A new chunk is started, when the sector ID is changed.
+    // Geometries with per triangle sector IDs don't belong to any specific sector.
+    RG_STATIC_GEOMETRY_CHUNKING_BY_SECTOR
+} RgStaticGeometryChunking;
+
 typedef struct RgInstanceCreateInfo
 {
     // Application name.
@@ -167,6 +200,7 @@ typedef struct RgInstanceCreateInfo
     RgWaylandSurfaceCreateInfo  *pWaylandSurfaceCreateInfo;
     RgXcbSurfaceCreateInfo      *pXcbSurfaceCreateInfo;
     RgXlibSurfaceCreateInfo     *pXlibSurfaceCreateInfo;
+    RgHeadlessSurfaceCreateInfo *pHeadlessSurfaceCreateInfo;
 
     RgBool32                    enableValidationLayer;
     // Optional function to print messages from the library.
@@ -177,6 +211,10 @@ typedef struct RgInstanceCreateInfo
     const char                  *pShaderFolderPath;
     // Path to the file with 128 layers of uncompressed 128x128 blue noise images.
     const char                  *pBlueNoiseFilePath;
+    // Optional. Path to the file to load compiled pipelines from. The file is ignored,
+    // if it was created for another device or driver version. On rgDestroyInstance,
+    // pipelines are written to this path (with standard methods, not pfnOpenFile).
+    const char                  *pPipelineCacheFilePath;
     // Optional function to load files: shaders, blue noise and overriden textures.
     // If null, files will be opened with standard methods. pfnLoadFile is very simple,
     // as it requires file data (ppOutData, pOutDataSize) to be fully loaded to the memory.
@@ -212,6 +250,10 @@ typedef struct RgInstanceCreateInfo
     // Max amount of textures to be used during the execution.
     // The value is clamped to [1024..4096]
     uint32_t                    maxTextureCount;
+    // Size of a persistently mapped buffer, from which texture uploads take their staging memory.
+    // Textures that don't fit use separate staging buffers. If 0, the default size (32 MB) is used.
+    // The value is clamped to 64 MB.
+    uint32_t                    textureStagingRingSizeInMegabytes;
     // If true, 'filter' in RgStaticMaterialCreateInfo, RgDynamicMaterialCreateInfo, RgCubemapCreateInfo
     // will set only magnification filter.
     RgBool32                    textureSamplerForceMinificationFilterLinear;
@@ -254,6 +296,29 @@ typedef struct RgInstanceCreateInfo
     // screen space coords and NDC depth.
     RgBool32                    lensFlarePointToCheckIsInScreenSpace;
 
+    // If true, BLAS of static non-movable geometry and of instanced meshes are compacted
+    // after building. This reduces memory usage, but the static scene is applied
+    // a bit later after rgSubmitStaticGeometries. See RgStatistics.
+    RgBool32                    compactStaticAccelerationStructures;
+
+    // If not RG_STATIC_GEOMETRY_CHUNKING_NONE, static non-movable geometry is split into chunks,
+    // each of them has its own BLAS and TLAS instance. A chunk consists of consecutive geometries
+    // in the upload order, so static geometry should be uploaded grouped by sector or by area.
+    RgStaticGeometryChunking    staticGeometryChunking;
+    // If 0, then 65536 is used.
+    uint32_t                    staticGeometryChunkTriangleCount;
+
+    // If true, overriding texture files of static materials are loaded on background threads.
+    // rgCreateStaticMaterial returns immediately, and until the files are loaded, the material
+    // uses its default data from RgTextureSet or an empty texture. Note that pfnOpenFile
+    // and pfnCloseFile will be called from the background threads, so they must be thread-safe.
+    RgBool32                    loadTexturesInBackground;
+
+    // If true, pOverridenTexturesFolderPath is scanned once on rgCreateInstance (with standard
+    // methods, not pfnOpenFile), and override files that weren't found there are not attempted
+    // to be opened. Call rgRescanOverridenTexturesFolder, if the folder's content was changed.
+    RgBool32                    indexOverridenTexturesFolder;
+
 } RgInstanceCreateInfo;
 
 RGAPI RgResult RGCONV rgCreateInstance(
@@ -347,6 +412,12 @@ typedef enum RgGeometryUploadFlagBits
     RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_ADD_BIT = 8,
     // Ignore refl/refr geometry after one refl/refr hit.
     RG_GEOMETRY_UPLOAD_IGNORE_REFL_REFR_AFTER_ONE_REFL_REFR_BIT = 16,
+    // Only for static geometry. The geometry is registered as a mesh
+    // with its own bottom level acceleration structure, and it's not visible
+    // by itself: it must be placed with rgUploadMeshInstance.
+    // Vertices are in the mesh's local space, "transform" is ignored.
+    // Normals must be provided, as they're not generated for such meshes.
+    RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT = 32,
 } RgGeometryUploadFlagBits;
 typedef RgFlags RgGeometryUploadFlags;
 
@@ -406,6 +477,16 @@ typedef struct RgUpdateTransformInfo
     RgTransform     transform;
 } RgUpdateTransformInfo;
 
+typedef struct RgMeshInstanceUploadInfo
+{
+    // Unique ID of this placement, used for matching with the previous frame.
+    uint64_t        uniqueID;
+    // Unique ID of the static geometry that was uploaded
+    // with RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT.
+    uint64_t        meshUniqueID;
+    RgTransform     transform;
+} RgMeshInstanceUploadInfo;
+
 typedef struct RgUpdateTexCoordsInfo
 {
     // movable or non-movable static unique geom ID
@@ -424,13 +505,42 @@ typedef struct RgUpdateTexCoordsInfo
 // Dynamic geometry can be uploaded only between rgStartFrame - rgDrawFrame.
 // Static geometry can be uploaded only between rgStartNewScene - rgSubmitStaticGeometries.
 // Uploading dynamic geometries and then calling rgStartNewScene will erase them.
+// Dynamic geometry can be uploaded from several threads at once, but other functions
+// (including static geometry uploading) must not be called in parallel with it.
+// All uploading threads must finish before rgDrawFrame.
 RGAPI RgResult RGCONV rgUploadGeometry(
     RgInstance                              rgInstance,
     const RgGeometryUploadInfo              *pUploadInfo);
 
+typedef struct RgDynamicGeometryMapping
+{
+    // Arrays in the library's staging memory. Strides are set in RgInstanceCreateInfo.
+    void                            *pVertexData;
+    void                            *pNormalData;
+    // Dynamic geometry uses only 1 layer, others are null.
+    void                            *pTexCoordLayerData[3];
+    // Null, if indexCount was 0.
+    uint32_t                        *pIndexData;
+} RgDynamicGeometryMapping;
+
+// Reserve memory for dynamic geometry's vertices and indices, so they can be written
+// in-place, without an additional copy in rgUploadGeometry.
+// To commit, call rgUploadGeometry with the returned pointers in RgGeometryUploadInfo
+// and with the same vertexCount / indexCount. pNormalData and pTexCoordLayerData
+// can be null there, if they weren't written.
+// The memory is valid only until rgDrawFrame. Uncommitted reservation is just unused.
+// Can be called from several threads, like rgUploadGeometry for dynamic geometry.
+RGAPI RgResult RGCONV rgReserveDynamicGeometry(
+    RgInstance                          rgInstance,
+    uint32_t                            vertexCount,
+    uint32_t                            indexCount,
+    RgDynamicGeometryMapping            *pResult);
+
 // Updating transform is available only for movable static geometry.
 // Other geometry types don't need it because they are either fully static
 // or uploaded every frame, so transforms are always as they are intended.
+// Movable static geometry has its own BLAS, and the transform is applied
+// through its top-level instance, so the update doesn't rebuild any BLAS.
 RGAPI RgResult RGCONV rgUpdateGeometryTransform(
     RgInstance                              rgInstance,
     const RgUpdateTransformInfo             *pUpdateInfo);
@@ -439,6 +549,116 @@ RGAPI RgResult RGCONV rgUpdateGeometryTexCoords(
     RgInstance                              rgInstance,
     const RgUpdateTexCoordsInfo             *pUpdateInfo);
 
+// Place a mesh that was uploaded with RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT.
+// Each placement is a separate top level instance that references the mesh's
+// bottom level acceleration structure, so the mesh's vertices are not copied.
+// Like dynamic geometry, placements must be uploaded each frame,
+// between rgStartFrame - rgDrawFrame. If the limit of placements
+// in a frame is reached, RG_CANT_UPLOAD_MESH_INSTANCE is returned.
+// Movable static geometry and geometry added with rgAddStaticGeometry
+// are placed the same way, and their placements are reserved first.
+RGAPI RgResult RGCONV rgUploadMeshInstance(
+    RgInstance                              rgInstance,
+    const RgMeshInstanceUploadInfo          *pUploadInfo);
+
+typedef struct RgSkinnedMeshCreateInfo
+{
+    uint32_t                        vertexCount;
+    // Bind pose. Strides are set in RgInstanceCreateInfo.
+    // 3 first floats will be used
+    const void                      *pVertexData;
+    // 3 first floats will be used.
+    // If null, then the normals will be generated after skinning.
+    const void                      *pNormalData;
+    // 2 first floats will be used. Can be null.
+    const void                      *pTexCoordData;
+    // 4 bone indices per vertex, each must be less than 65536.
+    // Indices are in the bone palette of RgSkinnedGeometryUploadInfo.
+    const uint32_t                  *pBoneIndices;
+    // 4 weights per vertex, their sum should be 1.0
+    const float                     *pBoneWeights;
+
+    // Can be null, if indices are not used.
+    uint32_t                        indexCount;
+    const uint32_t                  *pIndexData;
+} RgSkinnedMeshCreateInfo;
+
+// Upload bind pose vertices, bone indices and weights to device memory once.
+// Then the mesh can be drawn each frame by uploading only its bone matrices
+// with rgUploadSkinnedGeometry. Vertices are skinned on GPU.
+RGAPI RgResult RGCONV rgCreateSkinnedMesh(
+    RgInstance                              rgInstance,
+    const RgSkinnedMeshCreateInfo           *pCreateInfo,
+    RgSkinnedMesh                           *pResult);
+
+// Destroying RG_NO_SKINNED_MESH has no effect.
+RGAPI RgResult RGCONV rgDestroySkinnedMesh(
+    RgInstance                              rgInstance,
+    RgSkinnedMesh                           skinnedMesh);
+
+typedef struct RgSkinnedGeometryUploadInfo
+{
+    // geomType must be RG_GEOMETRY_TYPE_DYNAMIC.
+    // Vertex and index data, their counts and RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT
+    // are ignored, they are taken from the skinned mesh.
+    RgGeometryUploadInfo            geometry;
+    RgSkinnedMesh                   skinnedMesh;
+    // Bone palette: bind pose to model space matrices
+    uint32_t                        boneCount;
+    const RgTransform               *pBoneTransforms;
+} RgSkinnedGeometryUploadInfo;
+
+// Upload skinned mesh as dynamic geometry of the current frame.
+// Only bone matrices are copied to device memory, skinned positions
+// and normals are written to dynamic vertex buffer by a compute shader.
+// Like rgUploadGeometry, can be called from several threads.
+RGAPI RgResult RGCONV rgUploadSkinnedGeometry(
+    RgInstance                              rgInstance,
+    const RgSkinnedGeometryUploadInfo       *pUploadInfo);
+
+// Create dynamic geometry that is kept between frames until it's destroyed.
+// Its vertices and indices are copied to device memory only once,
+// and then it's drawn each frame without uploading, so only its transform
+// can be changed with rgUpdateRetainedGeometryTransform.
+// Previous frame data for motion vectors is handled as for usual dynamic geometry.
+// pCreateInfo->geomType must be RG_GEOMETRY_TYPE_DYNAMIC,
+// RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT is ignored.
+// Like dynamic geometry, it has only 1 texture coordinates layer,
+// so pCreateInfo->pTexCoordLayerData[1] and [2] must be null.
+// pCreateInfo->uniqueID must not be used by other geometry while the retained one exists.
+RGAPI RgResult RGCONV rgCreateRetainedGeometry(
+    RgInstance                              rgInstance,
+    const RgGeometryUploadInfo              *pCreateInfo,
+    RgRetainedGeometry                      *pResult);
+
+// Destroying RG_NO_RETAINED_GEOMETRY has no effect.
+RGAPI RgResult RGCONV rgDestroyRetainedGeometry(
+    RgInstance                              rgInstance,
+    RgRetainedGeometry                      retainedGeometry);
+
+// New transform is used starting from the current frame.
+RGAPI RgResult RGCONV rgUpdateRetainedGeometryTransform(
+    RgInstance                              rgInstance,
+    RgRetainedGeometry                      retainedGeometry,
+    const RgTransform                       *pTransform);
+
+typedef struct RgUpdateRetainedVerticesInfo
+{
+    RgRetainedGeometry              retainedGeometry;
+    // Vertex count is the same as on creation.
+    // If a pointer is null, the corresponding data is not changed.
+    const void                      *pVertexData;
+    const void                      *pNormalData;
+    // Texture coordinates of the only layer.
+    const void                      *pTexCoordData;
+} RgUpdateRetainedVerticesInfo;
+
+// Invalidate vertices of the retained geometry, they're copied
+// to device memory on the current frame's end.
+RGAPI RgResult RGCONV rgUpdateRetainedGeometryVertices(
+    RgInstance                              rgInstance,
+    const RgUpdateRetainedVerticesInfo      *pUpdateInfo);
+
 
 
 // Clear current scene from all static geometries and make it available for recording new geometries.
@@ -453,9 +673,30 @@ RGAPI RgResult RGCONV rgStartNewScene(
 // To clear static scene, call rgStartNewScene and then rgSubmitStaticGeometries
 // without uploading any geometry.
 // rgStartNewScene and rgSubmitStaticGeometries can be called outside of rgStartFrame-rgDrawFrame.
+// Submission doesn't wait for the acceleration structures to be built: the previous scene
+// is drawn until the new one is ready, and then the scenes are swapped on a frame start.
+// Mesh instances of the new scene are ignored until that swap.
 RGAPI RgResult RGCONV rgSubmitStaticGeometries(
     RgInstance                          rgInstance);
 
+// Add static geometry to the current static scene without rebuilding it, e.g. to stream
+// parts of a big level in and out. The geometry gets its own acceleration structure,
+// that is built in the next rgDrawFrame, and its vertices are placed with its transform.
+// Only RG_GEOMETRY_TYPE_STATIC is allowed, pTriangleSectorIDs are ignored.
+// Can't be called between rgStartNewScene and the moment, when the submitted scene is
+// applied; the added geometry is removed, when a new scene is applied.
+// Each added geometry takes one of MAX_MESH_INSTANCE_COUNT mesh instance slots,
+// RG_CANT_ADD_STATIC_GEOMETRY is returned, if there are no free slots.
+RGAPI RgResult RGCONV rgAddStaticGeometry(
+    RgInstance                          rgInstance,
+    const RgGeometryUploadInfo          *pUploadInfo);
+
+// Remove static geometry, that was added with rgAddStaticGeometry.
+// Its memory is reused, when the frames in flight don't use it anymore.
+RGAPI RgResult RGCONV rgRemoveStaticGeometry(
+    RgInstance                          rgInstance,
+    uint64_t                            staticUniqueID);
+
 
 
 // Set mutual potential visibility between sectors A and B.
@@ -468,6 +709,23 @@ RGAPI RgResult RGCONV rgSetPotentialVisibility(
     uint32_t                            sectorID_A,
     uint32_t                            sectorID_B);
 
+typedef struct RgPotentialVisibilityMatrixInfo
+{
+    // i-th row and i-th column of the matrix correspond to pSectorIDs[i].
+    const uint32_t                      *pSectorIDs;
+    uint32_t                            sectorCount;
+    // Bit matrix of sectorCount rows, each row consists of (sectorCount + 31) / 32 words.
+    // If j-th bit of i-th row is set, then sectors pSectorIDs[i] and pSectorIDs[j]
+    // are potentially visible from each other. Only one of the symmetric bits is required.
+    const uint32_t                      *pVisibilityBits;
+} RgPotentialVisibilityMatrixInfo;
+
+// Same as calling rgSetPotentialVisibility for each set bit of the matrix,
+// but much faster for the whole level at once.
+RGAPI RgResult RGCONV rgSetPotentialVisibilityMatrix(
+    RgInstance                              rgInstance,
+    const RgPotentialVisibilityMatrixInfo   *pInfo);
+
 
 
 typedef enum RgBlendFactor
@@ -668,6 +926,8 @@ typedef struct RgPolygonalLightUploadInfo
     // If not null, points to a function to additionally check if light
     // is visible from the sector. E.g. it can return false if
     // sector's bounding box is completely behind poly light.
+    // The results are cached by uniqueID, and the function is called again
+    // only if the light is moved, or potential visibility is changed.
     PFN_rgIsLightVisibleFromSector  pfnIsLightVisibleFromSector;
     // Is passed to pfnIsLightVisibleFromSector.
     void                            *pUserDataForPfn;
@@ -830,6 +1090,11 @@ RGAPI RgResult RGCONV rgDestroyMaterial(
     RgInstance                          rgInstance,
     RgMaterial                          material);
 
+// Update the list of existing override files, if RgInstanceCreateInfo::indexOverridenTexturesFolder
+// was true. Affects only materials and cubemaps that are created after the call.
+RGAPI RgResult RGCONV rgRescanOverridenTexturesFolder(
+    RgInstance                          rgInstance);
+
 
 
 typedef struct RgCubemapFaceData
@@ -1164,6 +1429,13 @@ typedef struct RgDrawFrameInfo
     double                  currentTime;
     RgBool32                disableEyeAdaptation;
     RgBool32                useSqrtRoughnessForIndirect;
+    // If true and static geometry chunking is enabled, chunks of the sectors that are not
+    // potentially visible from cameraSectorID are not added to TLAS. Note: the geometry of
+    // such chunks won't be visible in reflections and won't cast shadows.
+    RgBool32                cullStaticChunksBySector;
+    // Sector, in which the camera is. If it wasn't referenced with rgSetPotentialVisibility
+    // for the currently drawn static scene, chunks are not culled.
+    uint32_t                cameraSectorID;
 
     // Set to null, to use default values.
     const RgDrawFrameRenderResolutionParams     *pRenderResolutionParams;
@@ -1190,6 +1462,43 @@ RGAPI RgResult RGCONV rgIsRenderUpscaleTechniqueAvailable(
     RgRenderUpscaleTechnique            technique,
     RgBool32                            *pOutResult);
 
+typedef struct RgStatistics
+{
+    // Size in bytes of the bottom level acceleration structures of the active static scene.
+    uint64_t                    staticAccelerationStructureSize;
+    // Size in bytes that was saved by compacting static acceleration structures.
+    // Zero, if compactStaticAccelerationStructures is false.
+    uint64_t                    staticAccelerationStructureCompactionSavedSize;
+} RgStatistics;
+
+RGAPI RgResult RGCONV rgGetStatistics(
+    RgInstance                          rgInstance,
+    RgStatistics                        *pResult);
+
+#define RG_MAX_FRAME_TIMING_COUNT 32
+
+typedef struct RgFrameTiming
+{
+    // Name of the render stage. Valid while the instance exists.
+    const char                  *pName;
+    float                       durationInMs;
+} RgFrameTiming;
+
+typedef struct RgFrameTimings
+{
+    // GPU time of the whole frame.
+    float                       frameDurationInMs;
+    uint32_t                    timingCount;
+    RgFrameTiming               timings[RG_MAX_FRAME_TIMING_COUNT];
+} RgFrameTimings;
+
+// Get GPU durations of the render stages of the latest completed frame.
+// As frames are in flight, the results are one frame behind the last rgDrawFrame.
+// If the device doesn't support timestamp queries, timingCount is 0.
+RGAPI RgResult RGCONV rgGetFrameTimings(
+    RgInstance                          rgInstance,
+    RgFrameTimings                      *pResult);
+
 RGAPI const char* RGCONV rgGetResultDescription(RgResult result);
 
 #ifdef __cplusplus
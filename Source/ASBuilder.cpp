@@ -38,7 +38,7 @@ VkAccelerationStructureBuildSizesInfoKHR ASBuilder::GetBuildSizes(
     uint32_t geometryCount, 
     const VkAccelerationStructureGeometryKHR *pGeometries,
     const uint32_t *pMaxPrimitiveCount, 
-    bool fastTrace) const
+    VkBuildAccelerationStructureFlagsKHR flags) const
 {
     assert(geometryCount > 0);
 
@@ -48,9 +48,8 @@ VkAccelerationStructureBuildSizesInfoKHR ASBuilder::GetBuildSizes(
     VkAccelerationStructureBuildGeometryInfoKHR buildInfo = {};
     buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
     buildInfo.type = type;
-    buildInfo.flags = fastTrace ?
-        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR :
-        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+    // sizes depend on flags, so they must be the same as in the build
+    buildInfo.flags = flags;
     buildInfo.geometryCount = geometryCount;
     buildInfo.pGeometries = pGeometries;
     buildInfo.ppGeometries = nullptr;
@@ -67,11 +66,12 @@ VkAccelerationStructureBuildSizesInfoKHR ASBuilder::GetBuildSizes(
 
 VkAccelerationStructureBuildSizesInfoKHR ASBuilder::GetBottomBuildSizes(
     uint32_t geometryCount,
-    const VkAccelerationStructureGeometryKHR *pGeometries, const uint32_t *pMaxPrimitiveCount, bool fastTrace) const
+    const VkAccelerationStructureGeometryKHR *pGeometries, const uint32_t *pMaxPrimitiveCount,
+    bool fastTrace, bool isBLASUpdateable, bool allowCompaction) const
 {
     return GetBuildSizes(
         VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, geometryCount,
-        pGeometries, pMaxPrimitiveCount, fastTrace);
+        pGeometries, pMaxPrimitiveCount, GetBottomBuildFlags(fastTrace, isBLASUpdateable, allowCompaction));
 }
 
 VkAccelerationStructureBuildSizesInfoKHR ASBuilder::GetTopBuildSizes(
@@ -79,7 +79,33 @@ VkAccelerationStructureBuildSizesInfoKHR ASBuilder::GetTopBuildSizes(
 {
     return GetBuildSizes(
         VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, 1,
-        pGeometry, &maxPrimitiveCount, fastTrace);
+        pGeometry, &maxPrimitiveCount, GetTopBuildFlags(fastTrace));
+}
+
+VkBuildAccelerationStructureFlagsKHR ASBuilder::GetBottomBuildFlags(bool fastTrace, bool isBLASUpdateable, bool allowCompaction)
+{
+    VkBuildAccelerationStructureFlagsKHR flags = fastTrace ?
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR :
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+
+    if (isBLASUpdateable)
+    {
+        flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+    }
+
+    if (allowCompaction)
+    {
+        flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+    }
+
+    return flags;
+}
+
+VkBuildAccelerationStructureFlagsKHR ASBuilder::GetTopBuildFlags(bool fastTrace)
+{
+    return fastTrace ?
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR :
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
 }
 
 void ASBuilder::AddBLAS(
@@ -87,7 +113,8 @@ void ASBuilder::AddBLAS(
     const VkAccelerationStructureGeometryKHR* pGeometries,
     const VkAccelerationStructureBuildRangeInfoKHR *pRangeInfos,
     const VkAccelerationStructureBuildSizesInfoKHR &buildSizes,
-    bool fastTrace, bool update, bool isBLASUpdateable)
+    bool fastTrace, bool update, bool isBLASUpdateable, bool allowCompaction,
+    VkAccelerationStructureKHR updateSrc)
 {
     // while building bottom level, top level must be not
     assert(topLBuildInfo.geomInfos.empty() && topLBuildInfo.rangeInfos.empty());
@@ -96,14 +123,8 @@ void ASBuilder::AddBLAS(
 
     VkDeviceSize scratchSize = std::max(buildSizes.updateScratchSize, buildSizes.buildScratchSize);
 
-    VkBuildAccelerationStructureFlagsKHR flags = fastTrace ?
-        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR :
-        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
-
-    if (isBLASUpdateable || update)
-    {
-        flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
-    }
+    // updated BLAS must have been built as updateable
+    VkBuildAccelerationStructureFlagsKHR flags = GetBottomBuildFlags(fastTrace, isBLASUpdateable || update, allowCompaction);
 
     VkAccelerationStructureBuildGeometryInfoKHR buildInfo = {};
     buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
@@ -112,7 +133,7 @@ void ASBuilder::AddBLAS(
     buildInfo.mode = update ? 
         VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR :
         VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-    buildInfo.srcAccelerationStructure = update ? as : VK_NULL_HANDLE;
+    buildInfo.srcAccelerationStructure = update ? (updateSrc != VK_NULL_HANDLE ? updateSrc : as) : VK_NULL_HANDLE;
     buildInfo.dstAccelerationStructure = as;
     buildInfo.scratchData.deviceAddress = scratchBuffer->GetScratchAddress(scratchSize);
     buildInfo.geometryCount = geometryCount;
@@ -151,9 +172,7 @@ void ASBuilder::AddTLAS(
     VkAccelerationStructureBuildGeometryInfoKHR buildInfo = {};
     buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
     buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-    buildInfo.flags = fastTrace ?
-        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR :
-        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+    buildInfo.flags = GetTopBuildFlags(fastTrace);
     buildInfo.mode = update ?
         VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR :
         VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
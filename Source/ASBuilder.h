@@ -42,13 +42,16 @@ public:
 
     // pGeometries is a pointer to an array of size "geometryCount",
     // pRangeInfos is an array of size "geometryCount".
-    // All pointers must be valid until BuildBottomLevel is called
+    // All pointers must be valid until BuildBottomLevel is called.
+    // If "update" is true and "updateSrc" is not null, then "as"
+    // is written with the refitted "updateSrc", otherwise, "as" is updated in-place.
     void AddBLAS(
         VkAccelerationStructureKHR as, uint32_t geometryCount,
         const VkAccelerationStructureGeometryKHR *pGeometries,
         const VkAccelerationStructureBuildRangeInfoKHR *pRangeInfos,
         const VkAccelerationStructureBuildSizesInfoKHR &buildSizes,
-        bool fastTrace, bool update, bool isBLASUpdateable);
+        bool fastTrace, bool update, bool isBLASUpdateable, bool allowCompaction,
+        VkAccelerationStructureKHR updateSrc = VK_NULL_HANDLE);
 
     void BuildBottomLevel(VkCommandBuffer cmd);
 
@@ -69,13 +72,13 @@ public:
     VkAccelerationStructureBuildSizesInfoKHR GetBuildSizes(
         VkAccelerationStructureTypeKHR type, uint32_t geometryCount,
         const VkAccelerationStructureGeometryKHR *pGeometries,
-        const uint32_t *pMaxPrimitiveCount, bool fastTrace) const;
+        const uint32_t *pMaxPrimitiveCount, VkBuildAccelerationStructureFlagsKHR flags) const;
 
-    // GetBuildSizes(..) for BLAS
+    // GetBuildSizes(..) for BLAS, flags must be the same as in AddBLAS
     VkAccelerationStructureBuildSizesInfoKHR GetBottomBuildSizes(
         uint32_t geometryCount,
         const VkAccelerationStructureGeometryKHR *pGeometries,
-        const uint32_t *pMaxPrimitiveCount, bool fastTrace) const;
+        const uint32_t *pMaxPrimitiveCount, bool fastTrace, bool isBLASUpdateable, bool allowCompaction) const;
     // GetBuildSizes(..) for TLAS
     VkAccelerationStructureBuildSizesInfoKHR GetTopBuildSizes(
         const VkAccelerationStructureGeometryKHR *pGeometry,
@@ -83,6 +86,10 @@ public:
 
     bool IsEmpty() const;
 
+private:
+    static VkBuildAccelerationStructureFlagsKHR GetBottomBuildFlags(bool fastTrace, bool isBLASUpdateable, bool allowCompaction);
+    static VkBuildAccelerationStructureFlagsKHR GetTopBuildFlags(bool fastTrace);
+
 private:
     VkDevice device;
     std::shared_ptr<ScratchBuffer> scratchBuffer;
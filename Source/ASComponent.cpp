@@ -124,6 +124,11 @@ VkAccelerationStructureKHR RTGL1::ASComponent::GetAS() const
     return as;
 }
 
+VkDeviceSize RTGL1::ASComponent::GetSize() const
+{
+    return buffer.IsInitted() ? buffer.GetSize() : 0;
+}
+
 VkDeviceAddress RTGL1::ASComponent::GetASAddress() const
 {
     assert(buffer.IsInitted());
@@ -48,6 +48,8 @@ public:
 
     VkAccelerationStructureKHR GetAS() const;
     VkDeviceAddress GetASAddress() const;
+    // Size of the buffer that stores AS, 0 if not created
+    VkDeviceSize GetSize() const;
 
     bool IsValid(const VkAccelerationStructureBuildSizesInfoKHR &buildSizes) const;
 
@@ -20,15 +20,50 @@
 
 #include "ASManager.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 
 #include "Utils.h"
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
+#include "Matrix.h"
 
 using namespace RTGL1;
 
+// After this count of refits in a row, dynamic BLAS is fully rebuilt,
+// as BVH quality degrades with each refit
+constexpr uint32_t MAX_DYNAMIC_BLAS_REFIT_COUNT = 16;
+
+// Used, if triangle count of static geometry chunks is not specified
+constexpr uint32_t DEFAULT_STATIC_CHUNK_TRIANGLE_COUNT = 65536;
+
+// Each static geometry can be in its own chunk
+constexpr uint32_t MAX_STATIC_CHUNK_COUNT = MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT;
+
+namespace
+{
+
+// Wait for BLAS building before reading them in the next AS commands
+void ASBuildToASBuildBarrier(VkCommandBuffer cmd)
+{
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+}
+
+}
+
 ASManager::ASManager(
     VkDevice _device,
     std::shared_ptr<PhysicalDevice> physDevice,
@@ -38,15 +73,31 @@ ASManager::ASManager(
     std::shared_ptr<GeomInfoManager> _geomInfoManager,
     std::shared_ptr<TriangleInfoManager> _triangleInfoMgr,
     std::shared_ptr<SectorVisibility> &_sectorVisibility,
-    const VertexBufferProperties &_properties)
+    const VertexBufferProperties &_properties,
+    bool _compactStaticBlas,
+    RgStaticGeometryChunking _staticChunking,
+    uint32_t _staticChunkTriangleCount)
 :
     device(_device),
     allocator(std::move(_allocator)),
-    staticCopyFence(VK_NULL_HANDLE),
+    staticBuildFence(VK_NULL_HANDLE),
+    staticBuildCmd(VK_NULL_HANDLE),
+    isStaticBuildPending(false),
+    wasStaticApplied(false),
+    framesSinceStaticApply(MAX_FRAMES_IN_FLIGHT),
+    compactStaticBlas(_compactStaticBlas),
+    compactedSizeQueryPool(VK_NULL_HANDLE),
+    compactedSizeQueryCount(0),
+    isStaticCompactionSizeQueried(false),
+    staticCompactionSavedSize{},
+    activeStatic(0),
+    latestStatic(0),
+    staticInBuffersDescSet{},
     cmdManager(std::move(_cmdManager)),
     textureMgr(std::move(_textureManager)),
     geomInfoMgr(std::move(_geomInfoManager)),
     triangleInfoMgr(std::move(_triangleInfoMgr)),
+    sectorVisibility(_sectorVisibility),
     descPool(VK_NULL_HANDLE),
     buffersDescSetLayout(VK_NULL_HANDLE),
     asDescSetLayout(VK_NULL_HANDLE),
@@ -64,11 +115,15 @@ ASManager::ASManager(
             for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
             {
                 allDynamicBlas[i].emplace_back(std::make_unique<BLASComponent>(device, filter));
+                dynamicBlasRefitCount[i].push_back(0);
             }
         }
         else
         {
-            allStaticBlas.emplace_back(std::make_unique<BLASComponent>(device, filter));
+            for (uint32_t i = 0; i < STATIC_SCENE_BUFFER_COUNT; i++)
+            {
+                allStaticBlas[i].emplace_back(std::make_unique<BLASComponent>(device, filter));
+            }
         }
     });
 
@@ -81,19 +136,27 @@ ASManager::ASManager(
     scratchBuffer = std::make_shared<ScratchBuffer>(allocator, scratchOffsetAligment);
     asBuilder = std::make_shared<ASBuilder>(device, scratchBuffer);
 
+    staticScratchBuffer = std::make_shared<ScratchBuffer>(allocator, scratchOffsetAligment);
+    staticAsBuilder = std::make_shared<ASBuilder>(device, staticScratchBuffer);
 
-    // static and movable static vertices share the same buffer as their data won't be changing
-    collectorStatic = std::make_shared<VertexCollector>(
-        device, allocator, geomInfoMgr, triangleInfoMgr, _sectorVisibility,
-        sizeof(ShVertexBufferStatic), properties,
-        FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE | 
-        FT::MASK_PASS_THROUGH_GROUP | 
-        FT::MASK_PRIMARY_VISIBILITY_GROUP);
 
-    // subscribe to texture manager only static collector,
-    // as static geometries aren't updating its material info (in ShGeometryInstance)
-    // every frame unlike dynamic ones
-    textureMgr->Subscribe(collectorStatic);
+    for (uint32_t i = 0; i < STATIC_SCENE_BUFFER_COUNT; i++)
+    {
+        // static and movable static vertices share the same buffer as their data won't be changing
+        collectorStatic[i] = std::make_shared<VertexCollector>(
+            device, allocator, geomInfoMgr, triangleInfoMgr, _sectorVisibility,
+            sizeof(ShVertexBufferStatic), properties,
+            FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE | 
+            FT::MASK_PASS_THROUGH_GROUP | 
+            FT::MASK_PRIMARY_VISIBILITY_GROUP,
+            _staticChunking,
+            _staticChunkTriangleCount != 0 ? _staticChunkTriangleCount : DEFAULT_STATIC_CHUNK_TRIANGLE_COUNT);
+
+        // subscribe to texture manager only static collectors,
+        // as static geometries aren't updating its material info (in ShGeometryInstance)
+        // every frame unlike dynamic ones
+        textureMgr->Subscribe(collectorStatic[i]);
+    }
 
 
     // dynamic vertices
@@ -102,7 +165,8 @@ ASManager::ASManager(
         sizeof(ShVertexBufferDynamic), properties,
         FT::CF_DYNAMIC | 
         FT::MASK_PASS_THROUGH_GROUP | 
-        FT::MASK_PRIMARY_VISIBILITY_GROUP);
+        FT::MASK_PRIMARY_VISIBILITY_GROUP,
+        RG_STATIC_GEOMETRY_CHUNKING_NONE, 0);
 
     // other dynamic vertex collectors should share the same device local buffers as the first one
     for (uint32_t i = 1; i < MAX_FRAMES_IN_FLIGHT; i++)
@@ -123,13 +187,13 @@ ASManager::ASManager(
     // instance buffer for TLAS
     instanceBuffer = std::make_unique<AutoBuffer>(device, allocator);
 
-    VkDeviceSize instanceBufferSize = MAX_TOP_LEVEL_INSTANCE_COUNT * sizeof(VkAccelerationStructureInstanceKHR);
+    VkDeviceSize instanceBufferSize = (MAX_TOP_LEVEL_INSTANCE_COUNT + MAX_STATIC_CHUNK_COUNT + MAX_MESH_INSTANCE_COUNT) * sizeof(VkAccelerationStructureInstanceKHR);
     instanceBuffer->Create(instanceBufferSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, "TLAS instance buffer");
 
 
     CreateDescriptors();
 
-    // buffers won't be changing, update once
+    // buffers are changing only when new static scene is applied
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
         UpdateBufferDescriptors(i);
@@ -139,10 +203,10 @@ ASManager::ASManager(
     VkFenceCreateInfo fenceInfo = {};
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = 0;
-    VkResult r = vkCreateFence(device, &fenceInfo, nullptr, &staticCopyFence);
+    VkResult r = vkCreateFence(device, &fenceInfo, nullptr, &staticBuildFence);
     VK_CHECKERROR(r);
 
-    SET_DEBUG_NAME(device, staticCopyFence, VK_OBJECT_TYPE_FENCE, "Static BLAS fence");
+    SET_DEBUG_NAME(device, staticBuildFence, VK_OBJECT_TYPE_FENCE, "Static BLAS fence");
 }
 
 #pragma region AS descriptors
@@ -276,9 +340,12 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     std::array<VkDescriptorBufferInfo, bindingCount> bufferInfos{};
     std::array<VkWriteDescriptorSet, bindingCount> writes{};
 
+    const auto &colStatic = collectorStatic[activeStatic];
+    staticInBuffersDescSet[frameIndex] = activeStatic;
+
     // buffer infos
     VkDescriptorBufferInfo &stVertsBufInfo = bufferInfos[BINDING_VERTEX_BUFFER_STATIC];
-    stVertsBufInfo.buffer = collectorStatic->GetVertexBuffer();
+    stVertsBufInfo.buffer = colStatic->GetVertexBuffer();
     stVertsBufInfo.offset = 0;
     stVertsBufInfo.range = VK_WHOLE_SIZE;
 
@@ -288,7 +355,7 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     dnVertsBufInfo.range = VK_WHOLE_SIZE;
 
     VkDescriptorBufferInfo &stIndexBufInfo = bufferInfos[BINDING_INDEX_BUFFER_STATIC];
-    stIndexBufInfo.buffer = collectorStatic->GetIndexBuffer();
+    stIndexBufInfo.buffer = colStatic->GetIndexBuffer();
     stIndexBufInfo.offset = 0;
     stIndexBufInfo.range = VK_WHOLE_SIZE;
 
@@ -434,11 +501,20 @@ void ASManager::UpdateASDescriptors(uint32_t frameIndex)
 
 ASManager::~ASManager()
 {
-    for (auto &as : allStaticBlas)
+    for (uint32_t i = 0; i < STATIC_SCENE_BUFFER_COUNT; i++)
     {
-        as->Destroy();
+        DestroyStaticBLAS(i);
+        DestroyMeshBLAS(i);
+    }
+
+    if (staticBuildCmd != VK_NULL_HANDLE)
+    {
+        cmdManager->FreeDetachedCmd(staticBuildCmd);
     }
 
+    uncompactedStaticBlas.clear();
+    vkDestroyQueryPool(device, compactedSizeQueryPool, nullptr);
+
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
         for (auto &as : allDynamicBlas[i])
@@ -446,16 +522,18 @@ ASManager::~ASManager()
             as->Destroy();
         }
 
+        incrementalToRemove[i].clear();
+
         tlas[i]->Destroy();
     }
 
     vkDestroyDescriptorPool(device, descPool, nullptr);
     vkDestroyDescriptorSetLayout(device, buffersDescSetLayout, nullptr);
     vkDestroyDescriptorSetLayout(device, asDescSetLayout, nullptr);
-    vkDestroyFence(device, staticCopyFence, nullptr);
+    vkDestroyFence(device, staticBuildFence, nullptr);
 }
 
-bool ASManager::SetupBLAS(BLASComponent &blas, const std::shared_ptr<VertexCollector> &vertCollector)
+bool ASManager::SetupBLAS(BLASComponent &blas, const std::shared_ptr<VertexCollector> &vertCollector, ASBuilder &builder, const BLASComponent *pUpdateSrc)
 {
     auto filter = blas.GetFilter();
     const std::vector<VkAccelerationStructureGeometryKHR> &geoms = vertCollector->GetASGeometries(filter);
@@ -471,56 +549,107 @@ bool ASManager::SetupBLAS(BLASComponent &blas, const std::shared_ptr<VertexColle
     const std::vector<uint32_t> &primCounts = vertCollector->GetPrimitiveCounts(filter);
 
     const bool fastTrace = !IsFastBuild(filter);
-    const bool update = false;
+    const bool update = pUpdateSrc != nullptr;
+
+    // dynamic BLAS are always updateable, so the next frame could refit them
+    const bool isBLASUpdateable = filter & (VertexCollectorFilterTypeFlagBits::CF_STATIC_MOVABLE | VertexCollectorFilterTypeFlagBits::CF_DYNAMIC);
+
+    // compacted BLAS can't be updated in-place with the original build sizes
+    const bool allowCompaction = compactStaticBlas && !isBLASUpdateable;
 
     // get AS size and create buffer for AS
-    const auto buildSizes = asBuilder->GetBottomBuildSizes(geoms.size(), geoms.data(), primCounts.data(), fastTrace);
+    const auto buildSizes = builder.GetBottomBuildSizes(geoms.size(), geoms.data(), primCounts.data(), fastTrace, isBLASUpdateable || update, allowCompaction);
 
     // if no buffer, or it was created, but its size is too small for current AS
     blas.RecreateIfNotValid(buildSizes, allocator);
 
     assert(blas.GetAS() != VK_NULL_HANDLE);
+    assert(!update || pUpdateSrc->GetAS() != VK_NULL_HANDLE);
 
     // add BLAS, all passed arrays must be alive until BuildBottomLevel() call
-    asBuilder->AddBLAS(blas.GetAS(), geoms.size(),
+    builder.AddBLAS(blas.GetAS(), geoms.size(),
                        geoms.data(), ranges.data(),
                        buildSizes,
-                       fastTrace, update, blas.GetFilter() & VertexCollectorFilterTypeFlagBits::CF_STATIC_MOVABLE);
+                       fastTrace, update, isBLASUpdateable, allowCompaction,
+                       update ? pUpdateSrc->GetAS() : VK_NULL_HANDLE);
 
     return true;
 }
 
-void ASManager::UpdateBLAS(BLASComponent &blas, const std::shared_ptr<VertexCollector> &vertCollector)
+void ASManager::SetupMeshBLAS(BLASComponent &blas, const VertexCollector::InstancedMesh &mesh, ASBuilder &builder, bool allowCompaction)
+{
+    blas.SetGeometryCount(1);
+
+    // meshes are static, so prefer fast trace
+    const bool fastTrace = true;
+    const bool update = false;
+
+    const auto buildSizes = builder.GetBottomBuildSizes(1, &mesh.geom, &mesh.primitiveCount, fastTrace, false, allowCompaction);
+
+    blas.RecreateIfNotValid(buildSizes, allocator);
+
+    assert(blas.GetAS() != VK_NULL_HANDLE);
+
+    // mesh must be alive until BuildBottomLevel() call
+    builder.AddBLAS(blas.GetAS(), 1,
+                       &mesh.geom, &mesh.range,
+                       buildSizes,
+                       fastTrace, update, false, allowCompaction);
+}
+
+void ASManager::SetupChunkBLAS(BLASComponent &blas, const std::shared_ptr<VertexCollector> &vertCollector, const VertexCollectorFilter::Chunk &chunk, ASBuilder &builder)
 {
     auto filter = blas.GetFilter();
-    const std::vector<VkAccelerationStructureGeometryKHR> &geoms = vertCollector->GetASGeometries(filter);
 
-    blas.SetGeometryCount((uint32_t)geoms.size());
+    const auto &geoms = vertCollector->GetASGeometries(filter);
+    const auto &ranges = vertCollector->GetASBuildRangeInfos(filter);
+    const auto &primCounts = vertCollector->GetPrimitiveCounts(filter);
 
-    if (blas.IsEmpty())
-    {
-        return;
-    }
+    assert(chunk.geometryCount > 0);
+    assert(chunk.firstGeometry + chunk.geometryCount <= geoms.size());
 
-    const std::vector<VkAccelerationStructureBuildRangeInfoKHR> &ranges = vertCollector->GetASBuildRangeInfos(filter);
-    const std::vector<uint32_t> &primCounts = vertCollector->GetPrimitiveCounts(filter);
+    blas.SetGeometryCount(chunk.geometryCount);
 
-    const bool fastTrace = !IsFastBuild(filter);
+    // chunks are static, so prefer fast trace
+    const bool fastTrace = true;
+    const bool update = false;
 
-    // must be just updated
-    const bool update = true;
+    const auto buildSizes = builder.GetBottomBuildSizes(chunk.geometryCount, &geoms[chunk.firstGeometry], &primCounts[chunk.firstGeometry], fastTrace, false, compactStaticBlas);
 
-    const auto buildSizes = asBuilder->GetBottomBuildSizes(
-        geoms.size(), geoms.data(), primCounts.data(), fastTrace);
+    blas.RecreateIfNotValid(buildSizes, allocator);
 
-    assert(blas.IsValid(buildSizes));
     assert(blas.GetAS() != VK_NULL_HANDLE);
 
-    // add BLAS, all passed arrays must be alive until BuildBottomLevel() call
-    asBuilder->AddBLAS(blas.GetAS(), geoms.size(),
-                       geoms.data(), ranges.data(),
+    // collector's arrays must be alive until BuildBottomLevel() call
+    builder.AddBLAS(blas.GetAS(), chunk.geometryCount,
+                       &geoms[chunk.firstGeometry], &ranges[chunk.firstGeometry],
                        buildSizes,
-                       fastTrace, update, blas.GetFilter() & VertexCollectorFilterTypeFlagBits::CF_STATIC_MOVABLE);
+                       fastTrace, update, false, compactStaticBlas);
+}
+
+void ASManager::DestroyStaticBLAS(uint32_t staticIndex)
+{
+    for (auto &staticBlas : allStaticBlas[staticIndex])
+    {
+        assert(!(staticBlas->GetFilter() & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC));
+
+        staticBlas->Destroy();
+        staticBlas->SetGeometryCount(0);
+    }
+
+    staticChunks[staticIndex].clear();
+
+    staticCompactionSavedSize[staticIndex] = 0;
+}
+
+void ASManager::DestroyMeshBLAS(uint32_t staticIndex)
+{
+    for (auto &as : meshBlas[staticIndex])
+    {
+        as->Destroy();
+    }
+
+    meshBlas[staticIndex].clear();
 }
 
 // separate functions to make adding between Begin..Geometry() and Submit..Geometry() a bit clearer
@@ -536,16 +665,16 @@ uint32_t ASManager::AddStaticGeometry(uint32_t frameIndex, const RgGeometryUploa
             textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
         };
 
-        return collectorStatic->AddGeometry(frameIndex, info, materials);
+        return collectorStatic[latestStatic]->AddGeometry(frameIndex, info, materials);
     }
 
     assert(0);
     return UINT32_MAX;
 }
 
-uint32_t ASManager::AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info)
+uint32_t ASManager::AddStaticMesh(uint32_t frameIndex, const RgGeometryUploadInfo &info)
 {
-    if (info.geomType == RG_GEOMETRY_TYPE_DYNAMIC)
+    if (info.geomType == RG_GEOMETRY_TYPE_STATIC || info.geomType == RG_GEOMETRY_TYPE_STATIC_MOVABLE)
     {
         MaterialTextures materials[3] =
         {
@@ -554,244 +683,1095 @@ uint32_t ASManager::AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUplo
             textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
         };
 
-        return collectorDynamic[frameIndex]->AddGeometry(frameIndex, info, materials);
+        return collectorStatic[latestStatic]->AddInstancedMesh(frameIndex, info, materials);
     }
 
     assert(0);
     return UINT32_MAX;
 }
 
-void ASManager::ResetStaticGeometry()
+bool ASManager::AddMeshInstance(uint32_t frameIndex, uint32_t meshIndex, const RgMeshInstanceUploadInfo &info)
 {
-    collectorStatic->Reset();
-    geomInfoMgr->ResetWithStatic();
-    triangleInfoMgr->Reset();
-}
+    // mesh index is from the latest static scene, but its BLAS-es are not built yet
+    if (latestStatic != activeStatic)
+    {
+        return true;
+    }
 
-void ASManager::BeginStaticGeometry()
-{
-    // the whole static vertex data must be recreated, clear previous data
-    collectorStatic->Reset();
-    geomInfoMgr->ResetWithStatic();
-    triangleInfoMgr->Reset();
+    const auto &colStatic = collectorStatic[activeStatic];
+    const auto &meshes = colStatic->GetInstancedMeshes();
+
+    if (meshIndex >= meshes.size())
+    {
+        assert(0);
+        return false;
+    }
+
+    // static placements are added at the frame end, so leave space for them
+    if (meshPlacements[frameIndex].size() + GetStaticPlacementCount() >= MAX_MESH_INSTANCE_COUNT)
+    {
+        return false;
+    }
 
-    collectorStatic->BeginCollecting(true);
+    return AddMeshPlacement(frameIndex, meshIndex, colStatic->GetInstancedMeshGeomInfo(meshIndex), meshes[meshIndex].layerMaterials,
+                            info.uniqueID, info.transform);
 }
 
-void ASManager::SubmitStaticGeometry()
+uint32_t ASManager::AddStaticMovableGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info)
 {
-    collectorStatic->EndCollecting();
-
-    // static geometry submission happens very infrequently, e.g. on level load
-    vkDeviceWaitIdle(device);
+    if (info.geomType != RG_GEOMETRY_TYPE_STATIC_MOVABLE)
+    {
+        assert(0);
+        return UINT32_MAX;
+    }
 
-    typedef VertexCollectorFilterTypeFlagBits FT;
+    const auto &colStatic = collectorStatic[latestStatic];
 
-    auto staticFlags = FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE;
+    uint32_t meshIndex = AddStaticMesh(frameIndex, info);
 
-    // destroy previous static
-    for (auto &staticBlas : allStaticBlas)
+    if (meshIndex == UINT32_MAX)
     {
-        assert(!(staticBlas->GetFilter() & FT::CF_DYNAMIC));
-
-        // if flags have any of static bits
-        if (staticBlas->GetFilter() & staticFlags)
-        {
-            staticBlas->Destroy();
-            staticBlas->SetGeometryCount(0);
-        }
+        return UINT32_MAX;
     }
 
-    assert(asBuilder->IsEmpty());
+    MovablePlacement m = {};
+    m.meshIndex = meshIndex;
+    m.uniqueID = info.uniqueID;
+    m.transform = info.transform;
+    memcpy(m.layerMaterials, colStatic->GetInstancedMeshes()[meshIndex].layerMaterials, sizeof(m.layerMaterials));
 
-    // skip if all static geometries are empty
-    if (collectorStatic->AreGeometriesEmpty(staticFlags))
-    {
-        return;
-    }
+    movablePlacements[latestStatic].push_back(m);
+    // save a copy, as the collector is reset when a new scene is started,
+    // but the active scene's movables must be placed until the new one is applied
+    movableGeomInfos[latestStatic].push_back(colStatic->GetInstancedMeshGeomInfo(meshIndex));
 
-    VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
+    return (uint32_t)movablePlacements[latestStatic].size() - 1;
+}
 
-    // copy from staging with barrier
-    collectorStatic->CopyFromStaging(cmd, true);
+void ASManager::AddStaticPlacements(uint32_t frameIndex)
+{
+    const auto &placements = movablePlacements[activeStatic];
 
-    // setup static blas
-    for (auto &staticBlas : allStaticBlas)
+    assert(placements.size() == movableGeomInfos[activeStatic].size());
+
+    for (uint32_t i = 0; i < placements.size(); i++)
     {
-        // if flags have any of static bits
-        if (staticBlas->GetFilter() & staticFlags)
-        {
-            SetupBLAS(*staticBlas, collectorStatic);
-        }
+        const MovablePlacement &m = placements[i];
+
+        // space was left by AddMeshInstance
+        bool added = AddMeshPlacement(frameIndex, m.meshIndex, movableGeomInfos[activeStatic][i], m.layerMaterials, m.uniqueID, m.transform);
+        assert(added);
     }
-    
-    // build AS
-    asBuilder->BuildBottomLevel(cmd);
 
-    // submit geom info, in case if rgStartNewScene and rgSubmitStaticGeometries 
-    // were out of rgStartFrame - rgDrawFrame, so static geominfo-s won't be
-    // erased on GeomInfoManager::PrepareForFrame
-    geomInfoMgr->CopyFromStaging(cmd, 0, false);
-    triangleInfoMgr->CopyFromStaging(cmd, 0, false);
+    assert(incrementalPlacements.size() == incrementalGeomInfos.size());
+    assert(incrementalToBuild.empty());
 
-    // submit and wait
-    cmdManager->Submit(cmd, staticCopyFence);
-    Utils::WaitAndResetFence(device, staticCopyFence);
+    for (uint32_t i = 0; i < incrementalPlacements.size(); i++)
+    {
+        const MovablePlacement &m = incrementalPlacements[i];
+
+        bool added = AddMeshPlacement(frameIndex, m.meshIndex, incrementalGeomInfos[i], m.layerMaterials, m.uniqueID, m.transform);
+        assert(added);
+    }
 }
 
-void ASManager::BeginDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
+uint32_t ASManager::GetStaticPlacementCount() const
 {
-    scratchBuffer->Reset();
-
-    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "");
-    uint32_t prevFrameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+    return (uint32_t)(movablePlacements[activeStatic].size() + incrementalPlacements.size());
+}
 
-    // store data of current frame to use it in the next one
-    CopyDynamicDataToPrevBuffers(cmd, prevFrameIndex);
+uint32_t ASManager::GetLatestMovableCount() const
+{
+    return (uint32_t)movablePlacements[latestStatic].size();
+}
 
-    // dynamic AS must be recreated
-    collectorDynamic[frameIndex]->Reset();
-    collectorDynamic[frameIndex]->BeginCollecting(false);
+bool ASManager::CanChangeStaticIncrementally() const
+{
+    return latestStatic == activeStatic && !isStaticBuildPending;
 }
 
-void ASManager::SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
+bool ASManager::AddIncrementalStaticGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info)
 {
-    typedef VertexCollectorFilterTypeFlagBits FT;
+    if (!CanChangeStaticIncrementally() || info.geomType != RG_GEOMETRY_TYPE_STATIC)
+    {
+        assert(0);
+        return false;
+    }
 
-    CmdLabel label(cmd, "Building dynamic BLAS");
+    MaterialTextures materials[3] =
+    {
+        textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
+        textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
+        textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+    };
 
-    const auto &colDyn = collectorDynamic[frameIndex];
+    const auto &colStatic = collectorStatic[activeStatic];
 
-    colDyn->EndCollecting();
-    colDyn->CopyFromStaging(cmd, false);
+    uint32_t meshIndex = colStatic->AddIncrementalMesh(frameIndex, info, materials);
 
-    assert(asBuilder->IsEmpty());
+    if (meshIndex == UINT32_MAX)
+    {
+        return false;
+    }
 
-    bool toBuild = false;
+    const VertexCollector::InstancedMesh &mesh = colStatic->GetInstancedMeshes()[meshIndex];
 
-    // recreate dynamic blas
-    for (auto &dynamicBlas : allDynamicBlas[frameIndex])
-    {
-        // must be dynamic
-        assert(dynamicBlas->GetFilter() & FT::CF_DYNAMIC);
+    // mesh index is either new or of a removed mesh, which BLAS was replaced by an empty one
+    auto blas = std::make_unique<BLASComponent>(device, mesh.filter);
 
-        toBuild |= SetupBLAS(*dynamicBlas, colDyn);
+    if (meshIndex < meshBlas[activeStatic].size())
+    {
+        meshBlas[activeStatic][meshIndex] = std::move(blas);
     }
-    
-    if (!toBuild)
+    else
     {
-        return;
+        assert(meshIndex == meshBlas[activeStatic].size());
+        meshBlas[activeStatic].push_back(std::move(blas));
     }
 
-    // build BLAS
-    asBuilder->BuildBottomLevel(cmd);
+    MovablePlacement m = {};
+    m.meshIndex = meshIndex;
+    m.uniqueID = info.uniqueID;
+    m.transform = info.transform;
+    memcpy(m.layerMaterials, mesh.layerMaterials, sizeof(m.layerMaterials));
 
-    // sync AS access
-    Utils::ASBuildMemoryBarrier(cmd);
-}
+    incrementalUniqueIDToIndex[info.uniqueID] = (uint32_t)incrementalPlacements.size();
+    incrementalPlacements.push_back(m);
+    incrementalGeomInfos.push_back(colStatic->GetInstancedMeshGeomInfo(meshIndex));
 
-void ASManager::UpdateStaticMovableTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo)
-{
-    collectorStatic->UpdateTransform(simpleIndex, updateInfo);
-}
+    incrementalToBuild.push_back(meshIndex);
 
-void RTGL1::ASManager::UpdateStaticTexCoords(uint32_t simpleIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
-{
-    collectorStatic->UpdateTexCoords(simpleIndex, texCoordsInfo);
+    return true;
 }
 
-void RTGL1::ASManager::ResubmitStaticTexCoords(VkCommandBuffer cmd)
+bool ASManager::RemoveIncrementalStaticGeometry(uint32_t frameIndex, uint64_t uniqueID)
 {
-    typedef VertexCollectorFilterTypeFlagBits FT;
+    if (!CanChangeStaticIncrementally())
+    {
+        assert(0);
+        return false;
+    }
 
-    if (collectorStatic->AreGeometriesEmpty(FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE))
+    auto f = incrementalUniqueIDToIndex.find(uniqueID);
+
+    if (f == incrementalUniqueIDToIndex.end())
     {
-        return;
+        return false;
     }
 
-    CmdLabel label(cmd, "Recopying static tex coords");
+    const uint32_t index = f->second;
+    const uint32_t meshIndex = incrementalPlacements[index].meshIndex;
+    const uint32_t lastIndex = (uint32_t)incrementalPlacements.size() - 1;
+
+    incrementalUniqueIDToIndex.erase(f);
+
+    // order of placements doesn't matter, so move the last one to the removed
+    if (index != lastIndex)
+    {
+        incrementalPlacements[index] = incrementalPlacements[lastIndex];
+        incrementalGeomInfos[index] = incrementalGeomInfos[lastIndex];
+
+        incrementalUniqueIDToIndex[incrementalPlacements[index].uniqueID] = index;
+    }
+
+    incrementalPlacements.pop_back();
+    incrementalGeomInfos.pop_back();
+
+    // could be removed in the same frame
+    incrementalToBuild.erase(std::remove(incrementalToBuild.begin(), incrementalToBuild.end(), meshIndex), incrementalToBuild.end());
+
+    // BLAS and vertex data could be still in use by the frames in flight
+    auto &blas = meshBlas[activeStatic][meshIndex];
 
-    collectorStatic->RecopyTexCoordsFromStaging(cmd);
+    RemovedIncremental r = {};
+    r.meshIndex = meshIndex;
+    r.freeMesh = true;
+    r.blas = std::make_unique<BLASComponent>(device, blas->GetFilter());
+    std::swap(r.blas, blas);
+
+    incrementalToRemove[frameIndex].push_back(std::move(r));
+
+    return true;
 }
 
-void ASManager::ResubmitStaticMovable(VkCommandBuffer cmd)
+void ASManager::SubmitIncrementalStaticGeometry(VkCommandBuffer cmd)
 {
-    typedef VertexCollectorFilterTypeFlagBits FT;
-
-    if (collectorStatic->AreGeometriesEmpty(FT::CF_STATIC_MOVABLE))
+    if (incrementalToBuild.empty())
     {
         return;
     }
 
+    CmdLabel label(cmd, "Building incremental static BLAS");
+
+    const auto &colStatic = collectorStatic[activeStatic];
+    const auto &meshes = colStatic->GetInstancedMeshes();
+
+    colStatic->CopyIncrementalFromStaging(cmd);
+
     assert(asBuilder->IsEmpty());
 
-    // update movable blas
-    for (auto &blas : allStaticBlas)
+    for (uint32_t meshIndex : incrementalToBuild)
     {
-        assert(!(blas->GetFilter() & FT::CF_DYNAMIC));
-
-        if (blas->GetFilter() & FT::CF_STATIC_MOVABLE)
-        {
-            UpdateBLAS(*blas, collectorStatic);
-        }
+        // incremental BLAS-es are not compacted
+        SetupMeshBLAS(*meshBlas[activeStatic][meshIndex], meshes[meshIndex], *asBuilder, false);
     }
 
-    CmdLabel label(cmd, "Building static movable BLAS");
-
-    // copy transforms to device-local memory
-    collectorStatic->RecopyTransformsFromStaging(cmd);
+    incrementalToBuild.clear();
 
     asBuilder->BuildBottomLevel(cmd);
+
+    // sync AS access
+    Utils::ASBuildMemoryBarrier(cmd);
 }
 
-bool ASManager::SetupTLASInstanceFromBLAS(const BLASComponent &blas, uint32_t rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, VkAccelerationStructureInstanceKHR &instance)
+bool ASManager::AddMeshPlacement(
+    uint32_t frameIndex, uint32_t meshIndex, 
+    const ShGeometryInstance &meshGeomInfo, const uint32_t layerMaterials[MATERIALS_MAX_LAYER_COUNT],
+    uint64_t uniqueID, const RgTransform &transform)
 {
-    typedef VertexCollectorFilterTypeFlagBits FT;
-
-    if (blas.GetAS() == VK_NULL_HANDLE || blas.IsEmpty())
+    if (meshIndex >= meshBlas[activeStatic].size())
     {
+        assert(0);
         return false;
     }
 
-    auto filter = blas.GetFilter();
-
-    instance.accelerationStructureReference = blas.GetASAddress();
+    // each placement has its own copy of geometry info
+    ShGeometryInstance geomInfo = meshGeomInfo;
 
-    instance.transform = 
+    // get materials every time, as they could be changed after the mesh upload
+    MaterialTextures materials[3] =
     {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f
+        textureMgr->GetMaterialTextures(layerMaterials[0]),
+        textureMgr->GetMaterialTextures(layerMaterials[1]),
+        textureMgr->GetMaterialTextures(layerMaterials[2])
     };
 
-    instance.instanceCustomIndex = 0;
+    geomInfo.materials0A = materials[0].indices[0];
+    geomInfo.materials0B = materials[0].indices[1];
+    geomInfo.materials0C = materials[0].indices[2];
 
+    geomInfo.materials1A = materials[1].indices[0];
+    geomInfo.materials1B = materials[1].indices[1];
+    geomInfo.materials1C = materials[1].indices[2];
 
-    if (filter & FT::CF_DYNAMIC)
-    {
-        // for choosing buffers with dynamic data
-        instance.instanceCustomIndex = INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
-    }
+    geomInfo.materials2A = materials[2].indices[0];
+    geomInfo.materials2B = materials[2].indices[1];
 
+    Matrix::ToMat4Transposed(geomInfo.model, transform);
 
-    if (filter & FT::PV_FIRST_PERSON)
+    // placements can be moved between frames, so use previous model matrix for motion vectors
+    geomInfo.flags |= GEOM_INST_FLAG_IS_MOVABLE;
+
+    uint32_t globalGeomIndex = geomInfoMgr->WriteMeshInstanceGeomInfo(frameIndex, uniqueID, geomInfo);
+
+    if (globalGeomIndex == UINT32_MAX)
     {
-        instance.mask = INSTANCE_MASK_FIRST_PERSON;
-        instance.instanceCustomIndex |= INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON;
+        return false;
     }
-    else if (filter & FT::PV_FIRST_PERSON_VIEWER)
+
+    MeshPlacement p = {};
+    p.meshIndex = meshIndex;
+    p.globalGeomIndex = globalGeomIndex;
+
+    static_assert(sizeof(RgTransform) == sizeof(VkTransformMatrixKHR), "RgTransform and VkTransformMatrixKHR must have the same structure to be used in AS building");
+    memcpy(&p.transform, &transform, sizeof(VkTransformMatrixKHR));
+
+    meshPlacements[frameIndex].push_back(p);
+    return true;
+}
+
+uint32_t ASManager::AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info)
+{
+    if (info.geomType == RG_GEOMETRY_TYPE_DYNAMIC)
     {
-        instance.mask = INSTANCE_MASK_FIRST_PERSON_VIEWER;
-        instance.instanceCustomIndex |= INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER;
+        MaterialTextures materials[3] =
+        {
+            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
+            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
+            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+        };
+
+        return collectorDynamic[frameIndex]->AddGeometry(frameIndex, info, materials);
     }
-    else
-    {
-        // also check rayCullMaskWorld, if world part is not included in the cull mask,
-        // then don't add it to BLAS at all, it helps culling PT_REFLECT if it was a world part
 
-        if (filter & FT::PV_WORLD_0)
-        {
-            instance.mask = INSTANCE_MASK_WORLD_0;
+    assert(0);
+    return UINT32_MAX;
+}
+
+bool ASManager::ReserveDynamicGeometry(uint32_t frameIndex, uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping &outMapping)
+{
+    return collectorDynamic[frameIndex]->ReserveDynamicGeometry(vertexCount, indexCount, outMapping);
+}
+
+uint32_t ASManager::AddDeviceWrittenDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, bool generateNormals,
+                                                    VertexCollector::DeviceWrittenRange &outRange)
+{
+    if (info.geomType == RG_GEOMETRY_TYPE_DYNAMIC)
+    {
+        MaterialTextures materials[3] =
+        {
+            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
+            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
+            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+        };
+
+        return collectorDynamic[frameIndex]->AddDeviceWrittenGeometry(frameIndex, info, materials, generateNormals, outRange);
+    }
+
+    assert(0);
+    return UINT32_MAX;
+}
+
+void ASManager::ResetStaticGeometry()
+{
+    // placements reference previous meshes
+    for (auto &p : meshPlacements)
+    {
+        p.clear();
+    }
+
+    collectorStatic[latestStatic]->Reset();
+    geomInfoMgr->ResetWithStatic();
+    triangleInfoMgr->Reset();
+
+    movablePlacements[latestStatic].clear();
+    movableGeomInfos[latestStatic].clear();
+}
+
+void ASManager::BeginStaticGeometry()
+{
+    // if previous submission is not applied yet, it must be done,
+    // as its buffers will be drawn while recording the new scene
+    if (isStaticBuildPending)
+    {
+        WaitForStaticGeometry();
+    }
+
+    assert(latestStatic == activeStatic);
+
+    // the whole static vertex data must be recreated, clear previous data
+    for (auto &p : meshPlacements)
+    {
+        p.clear();
+    }
+
+    // incremental geometry that wasn't built can't be drawn, as its
+    // mesh data is cleared by the reset below
+    std::vector<uint64_t> notBuilt;
+
+    for (const auto &m : incrementalPlacements)
+    {
+        if (std::find(incrementalToBuild.begin(), incrementalToBuild.end(), m.meshIndex) != incrementalToBuild.end())
+        {
+            notBuilt.push_back(m.uniqueID);
+        }
+    }
+
+    for (uint64_t uniqueID : notBuilt)
+    {
+        // BLAS-es are empty, so any frame index
+        RemoveIncrementalStaticGeometry(0, uniqueID);
+    }
+    assert(incrementalToBuild.empty());
+
+    // ranges of the reset collector must not be freed
+    for (auto &toRemove : incrementalToRemove)
+    {
+        for (auto &r : toRemove)
+        {
+            r.freeMesh = false;
+        }
+    }
+
+    // previous scene's simple indices will be reused by the new one,
+    // so its material changes must not be tracked anymore;
+    // device-local data is not affected, so the scene is still drawn
+    collectorStatic[activeStatic]->Reset();
+
+    // record into the other buffers
+    latestStatic = (activeStatic + 1) % STATIC_SCENE_BUFFER_COUNT;
+
+    collectorStatic[latestStatic]->Reset();
+    geomInfoMgr->ResetWithStatic();
+    triangleInfoMgr->Reset();
+
+    movablePlacements[latestStatic].clear();
+    movableGeomInfos[latestStatic].clear();
+
+    collectorStatic[latestStatic]->BeginCollecting(true);
+}
+
+void ASManager::SubmitStaticGeometry()
+{
+    assert(!isStaticBuildPending);
+
+    const auto &colStatic = collectorStatic[latestStatic];
+    colStatic->EndCollecting();
+
+    // buffers of the recorded scene could be still in use by the frames in flight,
+    // if they were active recently; static geometry submission happens very infrequently
+    if (framesSinceStaticApply < MAX_FRAMES_IN_FLIGHT)
+    {
+        vkDeviceWaitIdle(device);
+        framesSinceStaticApply = MAX_FRAMES_IN_FLIGHT;
+    }
+
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    auto staticFlags = FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE;
+
+    // destroy previous static and instanced meshes
+    DestroyStaticBLAS(latestStatic);
+    DestroyMeshBLAS(latestStatic);
+
+    // the scene will be applied on the next frame start
+    isStaticBuildPending = true;
+
+    assert(staticAsBuilder->IsEmpty());
+
+    const auto &meshes = colStatic->GetInstancedMeshes();
+
+    // skip if all static geometries are empty
+    if (colStatic->AreGeometriesEmpty(staticFlags) && meshes.empty())
+    {
+        return;
+    }
+
+    // previous build was completed, so scratch memory can be reused
+    staticScratchBuffer->Reset();
+
+    // command buffer can be in pending state for several frames
+    VkCommandBuffer cmd = cmdManager->StartDetachedGraphicsCmd();
+
+    // copy from staging with barrier
+    colStatic->CopyFromStaging(cmd, true);
+
+    // chunks of all filters share the instance buffer range, so each filter must get at least one
+    uint32_t chunkedFilterCount = 0;
+
+    for (const auto &staticBlas : allStaticBlas[latestStatic])
+    {
+        if ((staticBlas->GetFilter() & staticFlags) && colStatic->IsChunked(staticBlas->GetFilter()))
+        {
+            chunkedFilterCount++;
+        }
+    }
+
+    assert(chunkedFilterCount <= MAX_STATIC_CHUNK_COUNT);
+
+    // setup static blas
+    for (auto &staticBlas : allStaticBlas[latestStatic])
+    {
+        auto filter = staticBlas->GetFilter();
+
+        // if flags have any of static bits
+        if (!(filter & staticFlags))
+        {
+            continue;
+        }
+
+        if (!colStatic->IsChunked(filter))
+        {
+            SetupBLAS(*staticBlas, colStatic, *staticAsBuilder);
+            continue;
+        }
+
+        // filter's BLAS is not built, but its geometry count is required for vertex preprocessing
+        staticBlas->SetGeometryCount((uint32_t)colStatic->GetASGeometries(filter).size());
+
+        const uint32_t filterGeomOffset = VertexCollectorFilterTypeFlags_GetOffsetInGlobalArray(filter);
+        const auto &chunks = colStatic->GetChunks(filter);
+
+        chunkedFilterCount--;
+
+        // leave a slot for each of the remaining chunked filters
+        const size_t chunkBudget = MAX_STATIC_CHUNK_COUNT - staticChunks[latestStatic].size() - chunkedFilterCount;
+
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            VertexCollectorFilter::Chunk chunk = chunks[i];
+
+            // if there are too many chunks, merge the rest into the last one
+            if (i + 1 == chunkBudget)
+            {
+                for (size_t j = i + 1; j < chunks.size(); j++)
+                {
+                    chunk.geometryCount += chunks[j].geometryCount;
+                    chunk.primitiveCount += chunks[j].primitiveCount;
+
+                    if (chunk.sectorArrayIndex != chunks[j].sectorArrayIndex)
+                    {
+                        chunk.sectorArrayIndex = VertexCollectorFilter::NO_SECTOR;
+                    }
+                }
+
+                i = chunks.size();
+            }
+
+            StaticChunk c = {};
+            c.blas = std::make_unique<BLASComponent>(device, filter);
+            c.globalGeomIndex = filterGeomOffset + chunk.firstGeometry;
+            c.sectorArrayIndex = chunk.sectorArrayIndex;
+
+            SetupChunkBLAS(*c.blas, colStatic, chunk, *staticAsBuilder);
+
+            staticChunks[latestStatic].push_back(std::move(c));
+        }
+
+        assert(staticChunks[latestStatic].size() <= MAX_STATIC_CHUNK_COUNT);
+    }
+
+    // setup BLAS for each instanced mesh
+    for (const auto &mesh : meshes)
+    {
+        meshBlas[latestStatic].emplace_back(std::make_unique<BLASComponent>(device, mesh.filter));
+        SetupMeshBLAS(*meshBlas[latestStatic].back(), mesh, *staticAsBuilder, compactStaticBlas);
+    }
+    
+    // build AS
+    staticAsBuilder->BuildBottomLevel(cmd);
+
+    if (compactStaticBlas)
+    {
+        // compaction itself is done in a separate submission,
+        // as compacted sizes must be read on CPU
+        isStaticCompactionSizeQueried = QueryCompactedSizes(cmd, latestStatic);
+    }
+
+    // geom and triangle infos are copied when the scene is applied,
+    // as the device-local ones are used by the previous scene
+
+    // submit, but don't wait
+    cmdManager->Submit(cmd, staticBuildFence);
+    staticBuildCmd = cmd;
+}
+
+bool ASManager::TryApplyStaticGeometry(uint32_t frameIndex)
+{
+    if (isStaticBuildPending)
+    {
+        bool isBuilt = true;
+
+        if (staticBuildCmd != VK_NULL_HANDLE)
+        {
+            VkResult r = vkGetFenceStatus(device, staticBuildFence);
+
+            if (r == VK_NOT_READY)
+            {
+                isBuilt = false;
+            }
+            else
+            {
+                VK_CHECKERROR(r);
+            }
+        }
+
+        if (isBuilt && isStaticCompactionSizeQueried)
+        {
+            FinishStaticBuildCmd();
+            isStaticCompactionSizeQueried = false;
+
+            // apply only after compacted BLAS-es are copied
+            isBuilt = !SubmitStaticCompaction(latestStatic);
+        }
+
+        if (isBuilt)
+        {
+            ApplyStaticGeometry();
+
+            // copy new scene's infos in this frame
+            geomInfoMgr->MarkStaticToCopy(frameIndex);
+            triangleInfoMgr->MarkStaticRangeToCopy();
+        }
+    }
+    else if (framesSinceStaticApply < MAX_FRAMES_IN_FLIGHT)
+    {
+        framesSinceStaticApply++;
+
+        // previous scene is not used by any frame in flight, free its memory
+        if (framesSinceStaticApply == MAX_FRAMES_IN_FLIGHT && latestStatic == activeStatic)
+        {
+            uint32_t inactive = (activeStatic + 1) % STATIC_SCENE_BUFFER_COUNT;
+
+            DestroyStaticBLAS(inactive);
+            DestroyMeshBLAS(inactive);
+        }
+    }
+
+    // descriptor set of this frame index is not in use, so it can be updated
+    if (staticInBuffersDescSet[frameIndex] != activeStatic)
+    {
+        UpdateBufferDescriptors(frameIndex);
+    }
+
+    bool applied = wasStaticApplied;
+    wasStaticApplied = false;
+
+    return applied;
+}
+
+void ASManager::ApplyStaticGeometry()
+{
+    assert(isStaticBuildPending);
+
+    if (staticBuildCmd != VK_NULL_HANDLE)
+    {
+        FinishStaticBuildCmd();
+    }
+
+    // copying to compacted BLAS-es was completed
+    uncompactedStaticBlas.clear();
+    isStaticCompactionSizeQueried = false;
+
+    activeStatic = latestStatic;
+    sectorVisibility->ApplyNewScene();
+
+    // incremental geometry was a part of the previous scene
+    incrementalPlacements.clear();
+    incrementalGeomInfos.clear();
+    incrementalUniqueIDToIndex.clear();
+
+    isStaticBuildPending = false;
+    wasStaticApplied = true;
+    framesSinceStaticApply = 0;
+}
+
+void ASManager::WaitForStaticGeometry()
+{
+    assert(isStaticBuildPending);
+
+    // no frames must use descriptor sets and previous scene's buffers
+    vkDeviceWaitIdle(device);
+
+    if (isStaticCompactionSizeQueried)
+    {
+        FinishStaticBuildCmd();
+        isStaticCompactionSizeQueried = false;
+
+        if (SubmitStaticCompaction(latestStatic))
+        {
+            Utils::WaitForFence(device, staticBuildFence);
+        }
+    }
+
+    ApplyStaticGeometry();
+
+    // infos in staging will be overwritten by the next scene,
+    // so copy them now, as the applied scene will be drawn
+    VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
+
+    geomInfoMgr->MarkStaticToCopy(0);
+    geomInfoMgr->CopyFromStaging(cmd, 0, false);
+
+    triangleInfoMgr->MarkStaticRangeToCopy();
+    triangleInfoMgr->CopyFromStaging(cmd, 0, false);
+
+    cmdManager->Submit(cmd, staticBuildFence);
+    Utils::WaitAndResetFence(device, staticBuildFence);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        UpdateBufferDescriptors(i);
+    }
+
+    // device is idle
+    framesSinceStaticApply = MAX_FRAMES_IN_FLIGHT;
+}
+
+void ASManager::FinishStaticBuildCmd()
+{
+    assert(staticBuildCmd != VK_NULL_HANDLE);
+
+    VkResult r = vkResetFences(device, 1, &staticBuildFence);
+    VK_CHECKERROR(r);
+
+    cmdManager->FreeDetachedCmd(staticBuildCmd);
+    staticBuildCmd = VK_NULL_HANDLE;
+}
+
+std::vector<std::unique_ptr<BLASComponent> *> ASManager::GetCompactableStaticBLAS(uint32_t staticIndex)
+{
+    std::vector<std::unique_ptr<BLASComponent> *> result;
+
+    for (auto &staticBlas : allStaticBlas[staticIndex])
+    {
+        // movable BLAS-es are updated, so they're not compacted
+        if (!staticBlas->IsEmpty() && staticBlas->GetAS() != VK_NULL_HANDLE &&
+            !(staticBlas->GetFilter() & VertexCollectorFilterTypeFlagBits::CF_STATIC_MOVABLE))
+        {
+            result.push_back(&staticBlas);
+        }
+    }
+
+    for (auto &chunk : staticChunks[staticIndex])
+    {
+        result.push_back(&chunk.blas);
+    }
+
+    for (auto &mesh : meshBlas[staticIndex])
+    {
+        result.push_back(&mesh);
+    }
+
+    return result;
+}
+
+bool ASManager::QueryCompactedSizes(VkCommandBuffer cmd, uint32_t staticIndex)
+{
+    VkResult r;
+
+    const auto toCompact = GetCompactableStaticBLAS(staticIndex);
+    const uint32_t count = (uint32_t)toCompact.size();
+
+    if (count == 0)
+    {
+        return false;
+    }
+
+    // previous build was completed, so the pool can be recreated
+    if (count > compactedSizeQueryCount)
+    {
+        vkDestroyQueryPool(device, compactedSizeQueryPool, nullptr);
+
+        VkQueryPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+        poolInfo.queryCount = count;
+
+        r = vkCreateQueryPool(device, &poolInfo, nullptr, &compactedSizeQueryPool);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, compactedSizeQueryPool, VK_OBJECT_TYPE_QUERY_POOL, "Static BLAS compacted size query pool");
+
+        compactedSizeQueryCount = count;
+    }
+
+    std::vector<VkAccelerationStructureKHR> handles;
+    handles.reserve(count);
+
+    for (const auto *blas : toCompact)
+    {
+        handles.push_back((*blas)->GetAS());
+    }
+
+    vkCmdResetQueryPool(cmd, compactedSizeQueryPool, 0, count);
+
+    ASBuildToASBuildBarrier(cmd);
+
+    svkCmdWriteAccelerationStructuresPropertiesKHR(
+        cmd, count, handles.data(),
+        VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, compactedSizeQueryPool, 0);
+
+    return true;
+}
+
+bool ASManager::SubmitStaticCompaction(uint32_t staticIndex)
+{
+    assert(staticBuildCmd == VK_NULL_HANDLE);
+    assert(uncompactedStaticBlas.empty());
+
+    const auto toCompact = GetCompactableStaticBLAS(staticIndex);
+    const uint32_t count = (uint32_t)toCompact.size();
+
+    assert(count > 0 && count <= compactedSizeQueryCount);
+
+    std::vector<VkDeviceSize> compactedSizes(count);
+
+    VkResult r = vkGetQueryPoolResults(
+        device, compactedSizeQueryPool, 0, count,
+        count * sizeof(VkDeviceSize), compactedSizes.data(), sizeof(VkDeviceSize),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    VK_CHECKERROR(r);
+
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::unique_ptr<BLASComponent> &original = *toCompact[i];
+        const VkDeviceSize originalSize = original->GetSize();
+
+        if (compactedSizes[i] == 0 || compactedSizes[i] >= originalSize)
+        {
+            continue;
+        }
+
+        if (cmd == VK_NULL_HANDLE)
+        {
+            cmd = cmdManager->StartDetachedGraphicsCmd();
+            ASBuildToASBuildBarrier(cmd);
+        }
+
+        auto compacted = std::make_unique<BLASComponent>(device, original->GetFilter());
+        compacted->SetGeometryCount(original->GetGeomCount());
+
+        VkAccelerationStructureBuildSizesInfoKHR compactedBuildSizes = {};
+        compactedBuildSizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        compactedBuildSizes.accelerationStructureSize = compactedSizes[i];
+
+        compacted->RecreateIfNotValid(compactedBuildSizes, allocator);
+
+        VkCopyAccelerationStructureInfoKHR copyInfo = {};
+        copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+        copyInfo.src = original->GetAS();
+        copyInfo.dst = compacted->GetAS();
+        copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+
+        svkCmdCopyAccelerationStructureKHR(cmd, &copyInfo);
+
+        staticCompactionSavedSize[staticIndex] += originalSize - compacted->GetSize();
+
+        // the scene is not applied yet, so the compacted one can be set right away
+        uncompactedStaticBlas.push_back(std::move(original));
+        original = std::move(compacted);
+    }
+
+    if (cmd == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+
+    cmdManager->Submit(cmd, staticBuildFence);
+    staticBuildCmd = cmd;
+
+    return true;
+}
+
+void ASManager::GetStatistics(RgStatistics &result) const
+{
+    VkDeviceSize staticSize = 0;
+
+    for (const auto &staticBlas : allStaticBlas[activeStatic])
+    {
+        staticSize += staticBlas->GetSize();
+    }
+
+    for (const auto &chunk : staticChunks[activeStatic])
+    {
+        staticSize += chunk.blas->GetSize();
+    }
+
+    for (const auto &mesh : meshBlas[activeStatic])
+    {
+        staticSize += mesh->GetSize();
+    }
+
+    result.staticAccelerationStructureSize = staticSize;
+    result.staticAccelerationStructureCompactionSavedSize = staticCompactionSavedSize[activeStatic];
+}
+
+void ASManager::BeginDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    scratchBuffer->Reset();
+
+    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "");
+    uint32_t prevFrameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    // store data of current frame to use it in the next one
+    CopyDynamicDataToPrevBuffers(cmd, prevFrameIndex);
+
+    // placements of instanced meshes must be uploaded each frame
+    meshPlacements[frameIndex].clear();
+
+    // the frame, in which incremental geometry was removed, is completed
+    for (auto &r : incrementalToRemove[frameIndex])
+    {
+        r.blas->Destroy();
+
+        if (r.freeMesh)
+        {
+            collectorStatic[activeStatic]->RemoveIncrementalMesh(r.meshIndex);
+        }
+    }
+    incrementalToRemove[frameIndex].clear();
+
+    // dynamic AS must be recreated
+    collectorDynamic[frameIndex]->Reset();
+    collectorDynamic[frameIndex]->BeginCollecting(false);
+}
+
+void ASManager::CopyDynamicGeometryFromStaging(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    CmdLabel label(cmd, "Copying dynamic geometry");
+
+    const auto &colDyn = collectorDynamic[frameIndex];
+
+    colDyn->EndCollecting();
+    colDyn->CopyFromStaging(cmd, false);
+}
+
+void ASManager::SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    CmdLabel label(cmd, "Building dynamic BLAS");
+
+    const auto &colDyn = collectorDynamic[frameIndex];
+
+    assert(asBuilder->IsEmpty());
+
+    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "Assuming MAX_FRAMES_IN_FLIGHT==2");
+    const uint32_t prevFrameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    bool toBuild = false;
+
+    // recreate dynamic blas, or refit previous frame's one, if topology is the same
+    for (uint32_t i = 0; i < allDynamicBlas[frameIndex].size(); i++)
+    {
+        auto &dynamicBlas = allDynamicBlas[frameIndex][i];
+
+        // must be dynamic
+        assert(dynamicBlas->GetFilter() & FT::CF_DYNAMIC);
+
+        const bool refit = CanRefitDynamicBLAS(frameIndex, i);
+
+        toBuild |= SetupBLAS(*dynamicBlas, colDyn, *asBuilder, refit ? allDynamicBlas[prevFrameIndex][i].get() : nullptr);
+
+        dynamicBlasRefitCount[frameIndex][i] = refit ? dynamicBlasRefitCount[prevFrameIndex][i] + 1 : 0;
+    }
+    
+    if (!toBuild)
+    {
+        return;
+    }
+
+    // build BLAS
+    asBuilder->BuildBottomLevel(cmd);
+
+    // sync AS access
+    Utils::ASBuildMemoryBarrier(cmd);
+}
+
+bool ASManager::CanRefitDynamicBLAS(uint32_t frameIndex, uint32_t blasIndex) const
+{
+    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "Assuming MAX_FRAMES_IN_FLIGHT==2");
+    const uint32_t prevFrameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    const auto &prevBlas = allDynamicBlas[prevFrameIndex][blasIndex];
+    auto filter = prevBlas->GetFilter();
+
+    assert(filter == allDynamicBlas[frameIndex][blasIndex]->GetFilter());
+
+    if (prevBlas->IsEmpty() || prevBlas->GetAS() == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+
+    // periodically rebuild to restore BVH quality
+    if (dynamicBlasRefitCount[prevFrameIndex][blasIndex] >= MAX_DYNAMIC_BLAS_REFIT_COUNT)
+    {
+        return false;
+    }
+
+    // previous frame's collector wasn't reset yet, so its counts are still valid;
+    // geometry count and primitive count of each geometry must be the same
+    if (collectorDynamic[frameIndex]->GetPrimitiveCounts(filter) != collectorDynamic[prevFrameIndex]->GetPrimitiveCounts(filter))
+    {
+        return false;
+    }
+
+    // and geometries must be the same in the same order
+    return geomInfoMgr->IsDynamicGeometryUnchanged(frameIndex, filter);
+}
+
+void ASManager::UpdateStaticMovableTransform(uint32_t movableIndex, const RgUpdateTransformInfo &updateInfo)
+{
+    if (movableIndex >= movablePlacements[latestStatic].size())
+    {
+        assert(0);
+        return;
+    }
+
+    // TLAS instance will have the new transform, BLAS-es are not changed
+    movablePlacements[latestStatic][movableIndex].transform = updateInfo.transform;
+}
+
+void ASManager::UpdateStaticMovableTexCoords(uint32_t movableIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
+{
+    if (movableIndex >= movablePlacements[latestStatic].size())
+    {
+        assert(0);
+        return;
+    }
+
+    collectorStatic[latestStatic]->UpdateInstancedMeshTexCoords(movablePlacements[latestStatic][movableIndex].meshIndex, texCoordsInfo);
+}
+
+void RTGL1::ASManager::UpdateStaticTexCoords(uint32_t simpleIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
+{
+    collectorStatic[latestStatic]->UpdateTexCoords(simpleIndex, texCoordsInfo);
+}
+
+void RTGL1::ASManager::ResubmitStaticTexCoords(VkCommandBuffer cmd)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    // copying must not overlap with static scene's building,
+    // so keep the changes until the scene is applied
+    if (latestStatic != activeStatic)
+    {
+        return;
+    }
+
+    const auto &colStatic = collectorStatic[activeStatic];
+
+    if (colStatic->AreGeometriesEmpty(FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE) && colStatic->GetInstancedMeshes().empty())
+    {
+        return;
+    }
+
+    CmdLabel label(cmd, "Recopying static tex coords");
+
+    colStatic->RecopyTexCoordsFromStaging(cmd);
+}
+
+bool ASManager::SetupTLASInstanceFromBLAS(const BLASComponent &blas, uint32_t rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, VkAccelerationStructureInstanceKHR &instance)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    if (blas.GetAS() == VK_NULL_HANDLE || blas.IsEmpty())
+    {
+        return false;
+    }
+
+    auto filter = blas.GetFilter();
+
+    instance.accelerationStructureReference = blas.GetASAddress();
+
+    instance.transform = 
+    {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    instance.instanceCustomIndex = 0;
+
+
+    if (filter & FT::CF_DYNAMIC)
+    {
+        // for choosing buffers with dynamic data
+        instance.instanceCustomIndex = INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
+    }
+
+
+    if (filter & FT::PV_FIRST_PERSON)
+    {
+        instance.mask = INSTANCE_MASK_FIRST_PERSON;
+        instance.instanceCustomIndex |= INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON;
+    }
+    else if (filter & FT::PV_FIRST_PERSON_VIEWER)
+    {
+        instance.mask = INSTANCE_MASK_FIRST_PERSON_VIEWER;
+        instance.instanceCustomIndex |= INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER;
+    }
+    else
+    {
+        // also check rayCullMaskWorld, if world part is not included in the cull mask,
+        // then don't add it to BLAS at all, it helps culling PT_REFLECT if it was a world part
+
+        if (filter & FT::PV_WORLD_0)
+        {
+            instance.mask = INSTANCE_MASK_WORLD_0;
 
             if (!(rayCullMaskWorld & INSTANCE_MASK_WORLD_0))
             {
@@ -916,19 +1896,18 @@ void ASManager::PrepareForBuildingTLAS(
     uint32_t uniformData_rayCullMaskWorld,
     bool allowGeometryWithSkyFlag,
     bool isReflRefrAlphaTested,
+    const SectorArrayIndex *pCameraSector,
     ShVertPreprocessing *outPush,
     TLASPrepareResult *outResult) const
 {
     typedef VertexCollectorFilterTypeFlagBits FT;
 
-    static_assert(sizeof(TLASPrepareResult::instances) / sizeof(TLASPrepareResult::instances[0]) == MAX_TOP_LEVEL_INSTANCE_COUNT, "Change TLASPrepareResult sizes");
-
-
     *outResult = {};
     *outPush = {};
 
 
     auto &r = *outResult;
+    r.instances.reserve(MAX_TOP_LEVEL_INSTANCE_COUNT + staticChunks[activeStatic].size() + meshPlacements[frameIndex].size());
 
 
     // write geometry offsets to uniform to access geomInfos
@@ -941,7 +1920,7 @@ void ASManager::PrepareForBuildingTLAS(
 
     const std::vector<std::unique_ptr<BLASComponent>> *blasArrays[] =
     {
-        &allStaticBlas,
+        &allStaticBlas[activeStatic],
         &allDynamicBlas[frameIndex],
     };
 
@@ -951,24 +1930,87 @@ void ASManager::PrepareForBuildingTLAS(
         {
             bool isDynamic = blas->GetFilter() & FT::CF_DYNAMIC;
 
+            const uint32_t instanceIndex = (uint32_t)r.instances.size();
+
             // add to TLAS instances array
-            bool isAdded = ASManager::SetupTLASInstanceFromBLAS(*blas, uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, r.instances[r.instanceCount]);
+            VkAccelerationStructureInstanceKHR instance = {};
+            bool isAdded = ASManager::SetupTLASInstanceFromBLAS(*blas, uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, instance);
 
             if (isAdded)
             {
                 // mark bit if dynamic
                 if (isDynamic)
                 {
-                    outPush->tlasInstanceIsDynamicBits[r.instanceCount / MAX_TOP_LEVEL_INSTANCE_COUNT] |= 1 << (r.instanceCount % MAX_TOP_LEVEL_INSTANCE_COUNT);
+                    outPush->tlasInstanceIsDynamicBits[instanceIndex / MAX_TOP_LEVEL_INSTANCE_COUNT] |= 1 << (instanceIndex % MAX_TOP_LEVEL_INSTANCE_COUNT);
                 }
 
-                WriteInstanceGeomInfo(instanceGeomInfoOffset, instanceGeomCount, r.instanceCount, *blas);
-                r.instanceCount++;
+                WriteInstanceGeomInfo(instanceGeomInfoOffset, instanceGeomCount, instanceIndex, *blas);
+                r.instances.push_back(instance);
             }
         }
     }
 
-    outPush->tlasInstanceCount = r.instanceCount;
+    // vertex preprocessing is done only for filters' BLAS-es,
+    // instanced meshes' normals are always provided
+    uint32_t preprocCount = (uint32_t)r.instances.size();
+
+    // chunked filters don't have TLAS instances, so they're preprocessed after all instances of filters;
+    // instances after them are not indexed by instance ID in shaders, so there is no conflict
+    for (const auto &blas : allStaticBlas[activeStatic])
+    {
+        if (!blas->IsEmpty() && collectorStatic[activeStatic]->IsChunked(blas->GetFilter()))
+        {
+            WriteInstanceGeomInfo(instanceGeomInfoOffset, instanceGeomCount, preprocCount, *blas);
+            preprocCount++;
+        }
+    }
+
+    outPush->tlasInstanceCount = preprocCount;
+
+
+    // chunks of static geometry reference consecutive geometry infos
+    for (const StaticChunk &c : staticChunks[activeStatic])
+    {
+        // skip chunks that can't be seen from the camera's sector
+        if (pCameraSector != nullptr && c.sectorArrayIndex != VertexCollectorFilter::NO_SECTOR &&
+            !sectorVisibility->IsPotentiallyVisible(*pCameraSector, SectorArrayIndex{ c.sectorArrayIndex }))
+        {
+            continue;
+        }
+
+        VkAccelerationStructureInstanceKHR instance = {};
+        bool isAdded = ASManager::SetupTLASInstanceFromBLAS(*c.blas, uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, instance);
+
+        if (isAdded)
+        {
+            // shaders get geometry info by the first geometry's index in custom index and the local geometry index
+            assert(c.globalGeomIndex < (1u << (24 - INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT)));
+            instance.instanceCustomIndex |= INSTANCE_CUSTOM_INDEX_FLAG_MESH_INSTANCE | (c.globalGeomIndex << INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT);
+
+            r.instances.push_back(instance);
+        }
+    }
+
+
+    // placements of instanced meshes reference their own BLAS-es
+    for (const MeshPlacement &p : meshPlacements[frameIndex])
+    {
+        assert(p.meshIndex < meshBlas[activeStatic].size());
+
+        VkAccelerationStructureInstanceKHR instance = {};
+        bool isAdded = ASManager::SetupTLASInstanceFromBLAS(*meshBlas[activeStatic][p.meshIndex], uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, instance);
+
+        if (isAdded)
+        {
+            instance.transform = p.transform;
+
+            // shaders get geometry info by the index in custom index, and not by instance ID
+            assert(p.globalGeomIndex < (1u << (24 - INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT)));
+            instance.instanceCustomIndex |= INSTANCE_CUSTOM_INDEX_FLAG_MESH_INSTANCE | (p.globalGeomIndex << INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT);
+
+            r.instances.push_back(instance);
+        }
+    }
 }
 
 void ASManager::BuildTLAS(VkCommandBuffer cmd, uint32_t frameIndex, const TLASPrepareResult &r)
@@ -986,13 +2028,15 @@ void ASManager::BuildTLAS(VkCommandBuffer cmd, uint32_t frameIndex, const TLASPr
     // fill buffer
     auto *mapped = (VkAccelerationStructureInstanceKHR*)instanceBuffer->GetMapped(frameIndex);
 
-    memcpy(mapped, r.instances, r.instanceCount * sizeof(VkAccelerationStructureInstanceKHR));
+    assert(r.instances.size() <= MAX_TOP_LEVEL_INSTANCE_COUNT + MAX_STATIC_CHUNK_COUNT + MAX_MESH_INSTANCE_COUNT);
+    memcpy(mapped, r.instances.data(), r.instances.size() * sizeof(VkAccelerationStructureInstanceKHR));
 
-    instanceBuffer->CopyFromStaging(cmd, frameIndex);
+    // instance buffer is big enough for all mesh placements, copy only used part
+    instanceBuffer->CopyFromStaging(cmd, frameIndex, r.instances.size() * sizeof(VkAccelerationStructureInstanceKHR));
 
 
     TLASComponent *pCurrentTLAS = tlas[frameIndex].get();
-    uint32_t instanceCount = r.instanceCount;
+    uint32_t instanceCount = (uint32_t)r.instances.size();
 
 
     VkAccelerationStructureGeometryKHR instGeom = {};
@@ -1069,7 +2113,7 @@ void ASManager::OnVertexPreprocessingBegin(VkCommandBuffer cmd, uint32_t frameIn
 {
     if (!onlyDynamic)
     {
-        collectorStatic->InsertVertexPreprocessBeginBarrier(cmd);
+        collectorStatic[activeStatic]->InsertVertexPreprocessBeginBarrier(cmd);
     }
 
     collectorDynamic[frameIndex]->InsertVertexPreprocessBeginBarrier(cmd);
@@ -1079,7 +2123,7 @@ void ASManager::OnVertexPreprocessingFinish(VkCommandBuffer cmd, uint32_t frameI
 {
     if (!onlyDynamic)
     {
-        collectorStatic->InsertVertexPreprocessFinishBarrier(cmd);
+        collectorStatic[activeStatic]->InsertVertexPreprocessFinishBarrier(cmd);
     }
 
     collectorDynamic[frameIndex]->InsertVertexPreprocessFinishBarrier(cmd);
@@ -1120,3 +2164,13 @@ VkDescriptorSetLayout ASManager::GetTLASDescSetLayout() const
 {
     return asDescSetLayout;
 }
+
+VkBuffer ASManager::GetDynamicVertexBuffer() const
+{
+    return collectorDynamic[0]->GetVertexBuffer();
+}
+
+VkBuffer ASManager::GetDynamicIndexBuffer() const
+{
+    return collectorDynamic[0]->GetIndexBuffer();
+}
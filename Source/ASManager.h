@@ -34,17 +34,22 @@ namespace RTGL1
 
 struct ShVertPreprocessing;
 
+// Static scene is double-buffered: new one is built,
+// while the previous is still used for rendering
+constexpr uint32_t STATIC_SCENE_BUFFER_COUNT = 2;
+
 class ASManager
 {
 public:
     struct TLASPrepareResult
     {
-        VkAccelerationStructureInstanceKHR instances[45];
-        uint32_t instanceCount;
+        // first, instances of filters' BLAS-es, then chunks of static geometry,
+        // then placements of instanced meshes
+        std::vector<VkAccelerationStructureInstanceKHR> instances;
 
         bool IsEmpty() const
         {
-            return instanceCount == 0;
+            return instances.empty();
         }
     };
 
@@ -57,7 +62,10 @@ public:
               std::shared_ptr<GeomInfoManager> geomInfoManager,
               std::shared_ptr<TriangleInfoManager> triangleInfoMgr,
               std::shared_ptr<SectorVisibility> &_sectorVisibility,
-              const VertexBufferProperties &properties);
+              const VertexBufferProperties &properties,
+              bool compactStaticBlas,
+              RgStaticGeometryChunking staticChunking,
+              uint32_t staticChunkTriangleCount);
     ~ASManager();
 
     ASManager(const ASManager& other) = delete;
@@ -68,21 +76,63 @@ public:
 
     void BeginStaticGeometry();
     uint32_t AddStaticGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info);
-    // Submitting static geometry to the building is a heavy operation
-    // with waiting for it to complete.
+    // Submitting static geometry to the building doesn't wait for it to complete,
+    // previous static scene is drawn until TryApplyStaticGeometry succeeds.
     void SubmitStaticGeometry();
     // If all the added geometries must be removed, call this function before submitting
     void ResetStaticGeometry();
+    // Must be called on frame start. If submitted static geometry was built,
+    // it replaces the previous one. Returns true, if the static scene
+    // was replaced and its vertices must be preprocessed in this frame.
+    bool TryApplyStaticGeometry(uint32_t frameIndex);
 
     void BeginDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex);
     uint32_t AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info);
+    // Returns false, if there's not enough space
+    bool ReserveDynamicGeometry(uint32_t frameIndex, uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping &outMapping);
+    // Add dynamic geometry, vertices and indices of which will be written on device
+    // between CopyDynamicGeometryFromStaging and SubmitDynamicGeometry.
+    uint32_t AddDeviceWrittenDynamicGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, bool generateNormals,
+                                             VertexCollector::DeviceWrittenRange &outRange);
+    void CopyDynamicGeometryFromStaging(VkCommandBuffer cmd, uint32_t frameIndex);
+    // Build dynamic BLAS, must be called after CopyDynamicGeometryFromStaging
     void SubmitDynamicGeometry(VkCommandBuffer cmd, uint32_t frameIndex);
 
-
-    // Update transform for static movable geometry
-    void UpdateStaticMovableTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo);
-    // After updating transforms, acceleration structures should be rebuilt
-    void ResubmitStaticMovable(VkCommandBuffer cmd);
+    // Instanced mesh is static geometry with its own BLAS, returns mesh index.
+    uint32_t AddStaticMesh(uint32_t frameIndex, const RgGeometryUploadInfo &info);
+    // Place instanced mesh in the current frame, as a separate TLAS instance.
+    bool AddMeshInstance(uint32_t frameIndex, uint32_t meshIndex, const RgMeshInstanceUploadInfo &info);
+
+
+    // Static movable geometry is an instanced mesh with its own BLAS, that is placed
+    // every frame with its current transform, until a new static scene is applied.
+    // Returns movable index.
+    uint32_t AddStaticMovableGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info);
+    // Only TLAS instance transform is changed, so no BLAS-es are rebuilt
+    void UpdateStaticMovableTransform(uint32_t movableIndex, const RgUpdateTransformInfo &updateInfo);
+    void UpdateStaticMovableTexCoords(uint32_t movableIndex, const RgUpdateTexCoordsInfo &texCoordsInfo);
+    // Place static movable and incremental geometry of the active static scene in the current frame.
+    // Their placements are reserved in MAX_MESH_INSTANCE_COUNT before mesh instances of the user.
+    void AddStaticPlacements(uint32_t frameIndex);
+    // Count of placements that AddStaticPlacements adds each frame
+    uint32_t GetStaticPlacementCount() const;
+    // Movable geometry of the latest static scene will be placed each frame, after it's applied
+    uint32_t GetLatestMovableCount() const;
+
+
+    // Static geometry can be added to the active scene or removed from it
+    // only if a new static scene is not being recorded or built.
+    bool CanChangeStaticIncrementally() const;
+    // Incremental static geometry is an instanced mesh in the free space of the active scene's
+    // buffers, with its own BLAS, so the rest of the scene is not rebuilt. It's placed every frame
+    // until it's removed or a new static scene is applied. Returns false, if there's no space.
+    bool AddIncrementalStaticGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info);
+    // BLAS and buffer ranges are freed, when the frames in flight don't use them anymore.
+    // Returns false, if there's no such geometry.
+    bool RemoveIncrementalStaticGeometry(uint32_t frameIndex, uint64_t uniqueID);
+    // Copy and build BLAS-es of the added incremental static geometry,
+    // must be called after BeginDynamicGeometry and before AddStaticPlacements
+    void SubmitIncrementalStaticGeometry(VkCommandBuffer cmd);
 
     // Update texture coordinates for static geometry, it 
     // doesn't require AS rebuilding, but only copying from staging to device-local 
@@ -92,12 +142,15 @@ public:
 
     // Prepare data for building TLAS.
     // Also fill uniform with current state.
+    // If "pCameraSector" is not null, static chunks of the sectors
+    // that are not potentially visible from it are not added.
     void PrepareForBuildingTLAS(
         uint32_t frameIndex,
         ShGlobalUniform &uniformData,
         uint32_t uniformData_rayCullMaskWorld,
         bool allowGeometryWithSkyFlag,
         bool isReflRefrAlphaTested,
+        const SectorArrayIndex *pCameraSector,
         ShVertPreprocessing *outPush,
         TLASPrepareResult *outResult) const;
     void BuildTLAS(
@@ -120,18 +173,63 @@ public:
     VkDescriptorSetLayout GetBuffersDescSetLayout() const;
     VkDescriptorSetLayout GetTLASDescSetLayout() const;
 
+    // Device local dynamic buffers are shared by all frames
+    VkBuffer GetDynamicVertexBuffer() const;
+    VkBuffer GetDynamicIndexBuffer() const;
+
+    // Fill acceleration structure related fields
+    void GetStatistics(RgStatistics &result) const;
+
 private:
     void CreateDescriptors();
     void UpdateBufferDescriptors(uint32_t frameIndex);
     void UpdateASDescriptors(uint32_t frameIndex);
 
+    // If "pUpdateSrc" is not null, "as" is built by refitting it
     bool SetupBLAS(
         BLASComponent &as,
-        const std::shared_ptr<VertexCollector> &vertCollector);
+        const std::shared_ptr<VertexCollector> &vertCollector,
+        ASBuilder &builder,
+        const BLASComponent *pUpdateSrc = nullptr);
+
+    bool CanRefitDynamicBLAS(uint32_t frameIndex, uint32_t blasIndex) const;
+
+    void SetupMeshBLAS(
+        BLASComponent &as,
+        const VertexCollector::InstancedMesh &mesh,
+        ASBuilder &builder,
+        bool allowCompaction);
 
-    void UpdateBLAS(
+    // Chunk's BLAS consists of the chunk's range of its filter's geometries
+    void SetupChunkBLAS(
         BLASComponent &as,
-        const std::shared_ptr<VertexCollector> &vertCollector);
+        const std::shared_ptr<VertexCollector> &vertCollector,
+        const VertexCollectorFilter::Chunk &chunk,
+        ASBuilder &builder);
+
+    // Place a mesh of the active static scene in the current frame
+    bool AddMeshPlacement(
+        uint32_t frameIndex, uint32_t meshIndex,
+        const ShGeometryInstance &meshGeomInfo, const uint32_t layerMaterials[MATERIALS_MAX_LAYER_COUNT],
+        uint64_t uniqueID, const RgTransform &transform);
+
+    void DestroyStaticBLAS(uint32_t staticIndex);
+    void DestroyMeshBLAS(uint32_t staticIndex);
+
+    // Make the latest static scene active
+    void ApplyStaticGeometry();
+    // Block until the pending static scene is built and apply it
+    void WaitForStaticGeometry();
+    // Free the command buffer of the static build, its fence must be signaled
+    void FinishStaticBuildCmd();
+
+    // BLAS-es of the static scene that are built with compaction allowed
+    std::vector<std::unique_ptr<BLASComponent> *> GetCompactableStaticBLAS(uint32_t staticIndex);
+    // Write compacted sizes of GetCompactableStaticBLAS to the query pool,
+    // returns false if there is nothing to compact
+    bool QueryCompactedSizes(VkCommandBuffer cmd, uint32_t staticIndex);
+    // Returns true, if copying to compacted BLAS-es was submitted
+    bool SubmitStaticCompaction(uint32_t staticIndex);
 
     static bool SetupTLASInstanceFromBLAS(
         const BLASComponent &as,
@@ -142,14 +240,71 @@ private:
 
     static bool IsFastBuild(VertexCollectorFilterTypeFlags filter);
 
+private:
+    struct MeshPlacement
+    {
+        uint32_t meshIndex;
+        // index of placement's ShGeometryInstance
+        uint32_t globalGeomIndex;
+        VkTransformMatrixKHR transform;
+    };
+
+    struct MovablePlacement
+    {
+        uint32_t meshIndex;
+        uint64_t uniqueID;
+        RgTransform transform;
+        uint32_t layerMaterials[MATERIALS_MAX_LAYER_COUNT];
+    };
+
+    struct StaticChunk
+    {
+        std::unique_ptr<BLASComponent> blas;
+        // index of the first geometry's ShGeometryInstance, the others follow it
+        uint32_t globalGeomIndex;
+        // VertexCollectorFilter::NO_SECTOR, if the chunk is not in one sector
+        uint32_t sectorArrayIndex;
+    };
+
+    struct RemovedIncremental
+    {
+        std::unique_ptr<BLASComponent> blas;
+        uint32_t meshIndex;
+        // false, if the active collector was reset since the removal
+        bool freeMesh;
+    };
+
 private:
     VkDevice device;
     std::shared_ptr<MemoryAllocator> allocator;
 
-    VkFence staticCopyFence;
+    // signaled when static BLAS-es are built
+    VkFence staticBuildFence;
+    VkCommandBuffer staticBuildCmd;
+    bool isStaticBuildPending;
+    bool wasStaticApplied;
+    uint32_t framesSinceStaticApply;
+
+    // static BLAS compaction
+    bool compactStaticBlas;
+    VkQueryPool compactedSizeQueryPool;
+    uint32_t compactedSizeQueryCount;
+    // true, if the pending build wrote compacted sizes and they must be read
+    bool isStaticCompactionSizeQueried;
+    // original BLAS-es, must be alive until compacting copy is completed
+    std::vector<std::unique_ptr<BLASComponent>> uncompactedStaticBlas;
+    VkDeviceSize staticCompactionSavedSize[STATIC_SCENE_BUFFER_COUNT];
+
+    // static scene that is used for rendering
+    uint32_t activeStatic;
+    // static scene that was recorded the last, it's not equal
+    // to the active one only until the new scene is applied
+    uint32_t latestStatic;
+    // which static scene's buffers are bound in buffersDescSets
+    uint32_t staticInBuffersDescSet[MAX_FRAMES_IN_FLIGHT];
 
     // for filling buffers
-    std::shared_ptr<VertexCollector> collectorStatic;
+    std::shared_ptr<VertexCollector> collectorStatic[STATIC_SCENE_BUFFER_COUNT];
     std::shared_ptr<VertexCollector> collectorDynamic[MAX_FRAMES_IN_FLIGHT];
     // device-local buffer for storing previous info
     Buffer previousDynamicPositions;
@@ -158,14 +313,41 @@ private:
     // building
     std::shared_ptr<ScratchBuffer> scratchBuffer;
     std::shared_ptr<ASBuilder> asBuilder;
+    // static BLAS-es are built in a separate submission,
+    // its scratch memory must not be reused by frames
+    std::shared_ptr<ScratchBuffer> staticScratchBuffer;
+    std::shared_ptr<ASBuilder> staticAsBuilder;
 
     std::shared_ptr<CommandBufferManager> cmdManager;
     std::shared_ptr<TextureManager> textureMgr;
     std::shared_ptr<GeomInfoManager> geomInfoMgr;
     std::shared_ptr<TriangleInfoManager> triangleInfoMgr;
+    std::shared_ptr<SectorVisibility> sectorVisibility;
 
-    std::vector<std::unique_ptr<BLASComponent>> allStaticBlas;
+    // if a filter is chunked, its BLAS is not built, but it's still used for vertex preprocessing
+    std::vector<std::unique_ptr<BLASComponent>> allStaticBlas[STATIC_SCENE_BUFFER_COUNT];
+    std::vector<StaticChunk> staticChunks[STATIC_SCENE_BUFFER_COUNT];
     std::vector<std::unique_ptr<BLASComponent>> allDynamicBlas[MAX_FRAMES_IN_FLIGHT];
+    // how many times in a row each of allDynamicBlas was refitted instead of rebuilt
+    std::vector<uint32_t> dynamicBlasRefitCount[MAX_FRAMES_IN_FLIGHT];
+
+    // BLAS for each instanced mesh, same indices as in collectorStatic's instanced meshes
+    std::vector<std::unique_ptr<BLASComponent>> meshBlas[STATIC_SCENE_BUFFER_COUNT];
+    std::vector<MeshPlacement> meshPlacements[MAX_FRAMES_IN_FLIGHT];
+    // static movable geometry of each static scene
+    std::vector<MovablePlacement> movablePlacements[STATIC_SCENE_BUFFER_COUNT];
+    // same indices as in movablePlacements
+    std::vector<ShGeometryInstance> movableGeomInfos[STATIC_SCENE_BUFFER_COUNT];
+
+    // incremental static geometry of the active scene, it's placed as movable one
+    std::vector<MovablePlacement> incrementalPlacements;
+    // same indices as in incrementalPlacements
+    std::vector<ShGeometryInstance> incrementalGeomInfos;
+    rgl::unordered_map<uint64_t, uint32_t> incrementalUniqueIDToIndex;
+    // mesh indices of the added incremental geometry, that must be built
+    std::vector<uint32_t> incrementalToBuild;
+    // removed in the frame with the same index, freed when that index is reused
+    std::vector<RemovedIncremental> incrementalToRemove[MAX_FRAMES_IN_FLIGHT];
 
     // top level AS
     std::unique_ptr<AutoBuffer> instanceBuffer;
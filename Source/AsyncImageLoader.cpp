@@ -0,0 +1,150 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "AsyncImageLoader.h"
+
+#include <algorithm>
+
+
+constexpr uint32_t MAX_WORKER_COUNT = 4;
+
+
+RTGL1::AsyncImageLoader::Result::Result(uint64_t _loadID)
+:
+    loadID(_loadID),
+    isLoaded(false),
+    info{}
+{}
+
+RTGL1::AsyncImageLoader::Result::~Result()
+{
+    if (imageLoader)
+    {
+        imageLoader->FreeLoaded();
+    }
+}
+
+RTGL1::AsyncImageLoader::AsyncImageLoader(std::shared_ptr<UserFileLoad> _userFileLoad)
+:
+    userFileLoad(std::move(_userFileLoad)),
+    stop(false),
+    loadIDCounter(0)
+{
+    // leave one hardware thread for the main thread
+    const uint32_t hwThreadCount = std::thread::hardware_concurrency();
+    const uint32_t workerCount = std::clamp(hwThreadCount > 1 ? hwThreadCount - 1 : 1, 1u, MAX_WORKER_COUNT);
+
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&AsyncImageLoader::WorkerMain, this);
+    }
+}
+
+RTGL1::AsyncImageLoader::~AsyncImageLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    requestAdded.notify_all();
+
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
+
+uint64_t RTGL1::AsyncImageLoader::Load(const char *pFilePath)
+{
+    assert(pFilePath != nullptr);
+
+    uint64_t loadID;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        loadID = ++loadIDCounter;
+        requests.push_back({ loadID, pFilePath });
+    }
+    requestAdded.notify_one();
+
+    return loadID;
+}
+
+void RTGL1::AsyncImageLoader::Cancel(uint64_t loadID)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = std::find_if(requests.begin(), requests.end(), [loadID] (const Request &r)
+    {
+        return r.loadID == loadID;
+    });
+
+    if (it != requests.end())
+    {
+        requests.erase(it);
+    }
+}
+
+std::optional<RTGL1::AsyncImageLoader::Result> RTGL1::AsyncImageLoader::TryPopLoaded()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (loaded.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Result> r(std::move(loaded.front()));
+    loaded.pop_front();
+
+    return r;
+}
+
+void RTGL1::AsyncImageLoader::WorkerMain()
+{
+    while (true)
+    {
+        Request request;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            requestAdded.wait(lock, [this] { return stop || !requests.empty(); });
+
+            if (stop)
+            {
+                return;
+            }
+
+            request = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        // ImageLoader is not thread-safe, so each result has its own instance
+        Result result(request.loadID);
+        result.imageLoader = std::make_unique<ImageLoader>(userFileLoad);
+        result.isLoaded = result.imageLoader->Load(request.filePath.c_str(), &result.info);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded.push_back(std::move(result));
+        }
+    }
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImageLoader.h"
+
+namespace RTGL1
+{
+
+// Loads image files on worker threads. Each request is identified by a load ID,
+// its result must be taken on the main thread with TryPopLoaded.
+class AsyncImageLoader
+{
+public:
+    struct Result
+    {
+        uint64_t                        loadID;
+        bool                            isLoaded;
+        ImageLoader::ResultInfo         info;
+
+        explicit Result(uint64_t loadID);
+        ~Result();
+
+        Result(Result &&other) noexcept = default;
+        Result(const Result &other) = delete;
+        Result &operator=(const Result &other) = delete;
+        Result &operator=(Result &&other) noexcept = delete;
+
+    private:
+        friend class AsyncImageLoader;
+        // owns the memory that 'info' points to
+        std::unique_ptr<ImageLoader>    imageLoader;
+    };
+
+public:
+    explicit AsyncImageLoader(std::shared_ptr<UserFileLoad> userFileLoad);
+    ~AsyncImageLoader();
+
+    AsyncImageLoader(const AsyncImageLoader &other) = delete;
+    AsyncImageLoader(AsyncImageLoader &&other) noexcept = delete;
+    AsyncImageLoader &operator=(const AsyncImageLoader &other) = delete;
+    AsyncImageLoader &operator=(AsyncImageLoader &&other) noexcept = delete;
+
+    // Returns load ID, it's never 0.
+    uint64_t Load(const char *pFilePath);
+    // If the request is still in a queue, it's removed.
+    // Otherwise, its result will be available anyway.
+    void Cancel(uint64_t loadID);
+
+    std::optional<Result> TryPopLoaded();
+
+private:
+    struct Request
+    {
+        uint64_t        loadID;
+        std::string     filePath;
+    };
+
+    void WorkerMain();
+
+private:
+    std::shared_ptr<UserFileLoad> userFileLoad;
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable requestAdded;
+    std::deque<Request> requests;
+    std::deque<Result> loaded;
+    bool stop;
+
+    uint64_t loadIDCounter;
+};
+
+}
@@ -262,7 +262,7 @@ void RTGL1::Bloom::CreateStepPipelines(const ShaderManager *shaderManager)
             plInfo.stage = shaderManager->GetStageInfo("CBloomDownsample");
             plInfo.stage.pSpecializationInfo = &specInfo;
 
-            VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &downsamplePipelines[i]);
+            VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &downsamplePipelines[i]);
             VK_CHECKERROR(r);
 
             SET_DEBUG_NAME(device, downsamplePipelines[i], VK_OBJECT_TYPE_PIPELINE, dnsmplDebugNames[i]);
@@ -272,7 +272,7 @@ void RTGL1::Bloom::CreateStepPipelines(const ShaderManager *shaderManager)
             plInfo.stage = shaderManager->GetStageInfo("CBloomUpsample");
             plInfo.stage.pSpecializationInfo = &specInfo;
 
-            VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &upsamplePipelines[i]);
+            VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &upsamplePipelines[i]);
             VK_CHECKERROR(r);
 
             SET_DEBUG_NAME(device, upsamplePipelines[i], VK_OBJECT_TYPE_PIPELINE, upsmplDebugNames[i]);
@@ -313,7 +313,7 @@ void RTGL1::Bloom::CreateApplyPipelines(const ShaderManager *shaderManager)
         // modify specInfo.pData
         isSourcePing = b;
         
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &applyPipelines[isSourcePing]);
+        VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &applyPipelines[isSourcePing]);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, applyPipelines[isSourcePing], VK_OBJECT_TYPE_PIPELINE, ("Bloom apply from " + std::string(isSourcePing ? "Ping" : "Pong")).c_str());
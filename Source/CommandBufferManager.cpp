@@ -24,7 +24,8 @@
 using namespace RTGL1;
 
 CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queues> queues) :
-    currentFrameIndex(MAX_FRAMES_IN_FLIGHT - 1)
+    currentFrameIndex(MAX_FRAMES_IN_FLIGHT - 1),
+    detachedGraphicsPool(VK_NULL_HANDLE)
 {
     this->device = device;
     this->queues = queues;
@@ -49,6 +50,10 @@ CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queu
         r = vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &transferCmds[i].pool);
         VK_CHECKERROR(r);
     }
+
+    cmdPoolInfo.queueFamilyIndex = queues->GetIndexGraphics();
+    VkResult r = vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &detachedGraphicsPool);
+    VK_CHECKERROR(r);
 }
 
 CommandBufferManager::~CommandBufferManager()
@@ -61,6 +66,9 @@ CommandBufferManager::~CommandBufferManager()
         vkDestroyCommandPool(device, computeCmds[i].pool, nullptr);
         vkDestroyCommandPool(device, transferCmds[i].pool, nullptr);
     }
+
+    assert(detachedCmdQueues.empty());
+    vkDestroyCommandPool(device, detachedGraphicsPool, nullptr);
 }
 
 void CommandBufferManager::PrepareForFrame(uint32_t frameIndex)
@@ -144,6 +152,66 @@ VkCommandBuffer CommandBufferManager::StartTransferCmd()
     return StartCmd(currentFrameIndex, transferCmds[currentFrameIndex], queues.lock()->GetTransfer());
 }
 
+VkCommandBuffer CommandBufferManager::StartDetachedGraphicsCmd()
+{
+    if (queues.expired())
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = detachedGraphicsPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer cmd;
+    VkResult r = vkAllocateCommandBuffers(device, &allocInfo, &cmd);
+    VK_CHECKERROR(r);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    r = vkBeginCommandBuffer(cmd, &beginInfo);
+    VK_CHECKERROR(r);
+
+    detachedCmdQueues[cmd] = queues.lock()->GetGraphics();
+
+    return cmd;
+}
+
+void CommandBufferManager::FreeDetachedCmd(VkCommandBuffer cmd)
+{
+    // must be already submitted
+    assert(detachedCmdQueues.find(cmd) == detachedCmdQueues.end());
+
+    vkFreeCommandBuffers(device, detachedGraphicsPool, 1, &cmd);
+}
+
+VkQueue CommandBufferManager::PopCmdQueue(VkCommandBuffer cmd)
+{
+    auto &qs = cmdQueues[currentFrameIndex];
+    auto f = qs.find(cmd);
+
+    if (f == qs.end())
+    {
+        // if it's not in the current frame, it must be a detached one
+        f = detachedCmdQueues.find(cmd);
+        assert(f != detachedCmdQueues.end());
+
+        VkQueue q = f->second;
+        detachedCmdQueues.erase(f);
+
+        return q;
+    }
+
+    VkQueue q = f->second;
+    qs.erase(f);
+
+    return q;
+}
+
 void CommandBufferManager::Submit(VkCommandBuffer cmd, VkFence fence)
 {
     VkResult r = vkEndCommandBuffer(cmd);
@@ -154,13 +222,7 @@ void CommandBufferManager::Submit(VkCommandBuffer cmd, VkFence fence)
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmd;
 
-    assert(cmdQueues[currentFrameIndex].find(cmd) != cmdQueues[currentFrameIndex].end());
-
-    auto &qs = cmdQueues[currentFrameIndex];
-    assert(qs.find(cmd) != qs.end());
-
-    VkQueue q = qs[cmd];
-    qs.erase(cmd);
+    VkQueue q = PopCmdQueue(cmd);
 
     r = vkQueueSubmit(q, 1, &submitInfo, fence);
     VK_CHECKERROR(r);
@@ -176,17 +238,14 @@ void CommandBufferManager::Submit(VkCommandBuffer cmd, VkSemaphore waitSemaphore
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmd;
-    submitInfo.waitSemaphoreCount = 1;
+    // semaphores can be null, e.g. if there's no swapchain image to wait for
+    submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
     submitInfo.pWaitSemaphores = &waitSemaphore;
     submitInfo.pWaitDstStageMask = &waitStages;
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 1 : 0;
     submitInfo.pSignalSemaphores = &signalSemaphore;
 
-    auto &qs = cmdQueues[currentFrameIndex];
-    assert(qs.find(cmd) != qs.end());
-
-    VkQueue q = qs[cmd];
-    qs.erase(cmd);
+    VkQueue q = PopCmdQueue(cmd);
 
     r = vkQueueSubmit(q, 1, &submitInfo, fence);
     VK_CHECKERROR(r);
@@ -48,6 +48,11 @@ public:
     VkCommandBuffer StartComputeCmd();
     // Start transfer command buffer for current frame index
     VkCommandBuffer StartTransferCmd();
+    // Start graphics command buffer that is not bound to any frame index,
+    // so it can stay in pending state for several frames.
+    // Must be freed with FreeDetachedCmd, after its fence was signaled.
+    VkCommandBuffer StartDetachedGraphicsCmd();
+    void FreeDetachedCmd(VkCommandBuffer cmd);
 
     void Submit(VkCommandBuffer cmd, VkFence fence = VK_NULL_HANDLE);
     void Submit(VkCommandBuffer cmd, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStages, VkSemaphore signalSemaphore, VkFence fence);
@@ -68,6 +73,7 @@ private:
 
 private:
     VkCommandBuffer StartCmd(uint32_t frameIndex, AllocatedCmds &cmds, VkQueue queue);
+    VkQueue PopCmdQueue(VkCommandBuffer cmd);
 
 private:
     VkDevice device;
@@ -81,8 +87,12 @@ private:
     AllocatedCmds computeCmds[MAX_FRAMES_IN_FLIGHT];
     AllocatedCmds transferCmds[MAX_FRAMES_IN_FLIGHT];
 
+    // pool is not reset on frame start
+    VkCommandPool detachedGraphicsPool;
+
     std::weak_ptr<Queues> queues;
     rgl::unordered_map<VkCommandBuffer, VkQueue> cmdQueues[MAX_FRAMES_IN_FLIGHT];
+    rgl::unordered_map<VkCommandBuffer, VkQueue> detachedCmdQueues;
 };
 
 }
\ No newline at end of file
@@ -25,6 +25,7 @@ namespace RTGL1
 
 constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_STAGING_TEXTURES   = 64 * 512 * 512 * 4;
 constexpr uint32_t      ALLOCATOR_BLOCK_SIZE_TEXTURES           = 64 * 512 * 512 * 4;
+constexpr uint32_t      TEXTURE_STAGING_RING_DEFAULT_SIZE_IN_MB = 32;
 
 constexpr uint32_t      TEXTURE_FILE_PATH_MAX_LENGTH            = 512;
 constexpr uint32_t      TEXTURE_FILE_NAME_MAX_LENGTH            = 256;
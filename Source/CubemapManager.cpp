@@ -35,14 +35,17 @@ RTGL1::CubemapManager::CubemapManager(
     VkDevice _device,
     std::shared_ptr<MemoryAllocator> _allocator,
     std::shared_ptr<SamplerManager> _samplerManager,
+    std::shared_ptr<TextureStagingRing> _stagingRing,
     const std::shared_ptr<CommandBufferManager> &_cmdManager,
     std::shared_ptr<UserFileLoad> _userFileLoad,
+    std::shared_ptr<OverrideFileIndex> _overrideFileIndex,
     const char *_defaultTexturesPath,
     const char *_overridenTexturePostfix)
 :
     device(_device),
     allocator(std::move(_allocator)),
     samplerManager(std::move(_samplerManager)),
+    overrideFileIndex(std::move(_overrideFileIndex)),
     cubemaps(MAX_CUBEMAP_COUNT)
 {
     defaultTexturesPath = _defaultTexturesPath != nullptr ? _defaultTexturesPath : DEFAULT_TEXTURES_PATH;
@@ -50,7 +53,7 @@ RTGL1::CubemapManager::CubemapManager(
 
     imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad));
     cubemapDesc = std::make_shared<TextureDescriptors>(device, samplerManager, MAX_CUBEMAP_COUNT, BINDING_CUBEMAPS);
-    cubemapUploader = std::make_shared<CubemapUploader>(device, allocator);
+    cubemapUploader = std::make_shared<CubemapUploader>(device, allocator, std::move(_stagingRing));
 
     VkCommandBuffer cmd = _cmdManager->StartGraphicsCmd();
     CreateEmptyCubemap(cmd);
@@ -130,6 +133,7 @@ uint32_t RTGL1::CubemapManager::CreateCubemap(VkCommandBuffer cmd, uint32_t fram
     parseInfo.texturesPath = defaultTexturesPath.c_str();
     parseInfo.postfixes[MATERIAL_COLOR_TEXTURE_INDEX] = overridenTexturePostfix.c_str();
     parseInfo.overridenIsSRGB[MATERIAL_COLOR_TEXTURE_INDEX] = true;
+    parseInfo.fileIndex = overrideFileIndex.get();
 
     RgExtent2D size = { info.sideSize, info.sideSize };
 
@@ -32,6 +32,7 @@
 #include "CubemapUploader.h"
 #include "CommandBufferManager.h"
 #include "ImageLoader.h"
+#include "OverrideFileIndex.h"
 
 namespace RTGL1
 {
@@ -43,8 +44,10 @@ public:
         VkDevice device, 
         std::shared_ptr<MemoryAllocator> allocator,
         std::shared_ptr<SamplerManager> samplerManager,
+        std::shared_ptr<TextureStagingRing> stagingRing,
         const std::shared_ptr<CommandBufferManager> &cmdManager,
         std::shared_ptr<UserFileLoad> userFileLoad,
+        std::shared_ptr<OverrideFileIndex> overrideFileIndex,
         const char *defaultTexturesPath,
         const char *albedoAlphaPostfix);
     ~CubemapManager();
@@ -76,6 +79,8 @@ private:
     std::shared_ptr<SamplerManager>     samplerManager;
     std::shared_ptr<TextureDescriptors> cubemapDesc;
     std::shared_ptr<CubemapUploader>    cubemapUploader;
+    // null, if override files are opened without checking
+    std::shared_ptr<OverrideFileIndex>  overrideFileIndex;
 
     std::vector<Texture>    cubemaps;
     std::vector<Texture>    cubemapsToDestroy[MAX_FRAMES_IN_FLIGHT];
@@ -20,8 +20,8 @@
 
 #include "CubemapUploader.h"
 
-RTGL1::CubemapUploader::CubemapUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator)
-    :TextureUploader(device, std::move(memAllocator))
+RTGL1::CubemapUploader::CubemapUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator, std::shared_ptr<TextureStagingRing> stagingRing)
+    :TextureUploader(device, std::move(memAllocator), std::move(stagingRing), nullptr)
 {}
 
 RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage(const UploadInfo &info)
@@ -38,35 +38,24 @@ RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage(const U
 
     VkImage image;
 
-    VkBuffer stagingBuffers[6] = {};
-    void *mappedData[6] = {};
+    StagingAllocation staging[6] = {};
 
     // 1. Allocate and fill buffer
-    const uint32_t faceNumber = 6;
     VkDeviceSize faceSize = (VkDeviceSize)info.dataSize;
 
-    VkBufferCreateInfo stagingInfo = {};
-    stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    stagingInfo.size = faceSize;
-    stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
     for (uint32_t i = 0; i < 6; i++)
     {
-        stagingBuffers[i] = memAllocator->CreateStagingSrcTextureBuffer(&stagingInfo, info.pDebugName, &mappedData[i]);
-
         // if couldn't allocate memory
-        if (stagingBuffers[i] == VK_NULL_HANDLE)
+        if (!AllocateStaging(info.frameIndex, faceSize, info.pDebugName, &staging[i]))
         {
             // clear allocated
             for (uint32_t j = 0; j < i; j++)
             {
-                memAllocator->DestroyStagingSrcTextureBuffer(stagingBuffers[j]);
+                FreeStagingNow(staging[j]);
             }
 
             return result;
         }
-
-        SET_DEBUG_NAME(device, stagingBuffers[i], VK_OBJECT_TYPE_BUFFER, info.pDebugName);
     }
 
 
@@ -76,7 +65,7 @@ RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage(const U
         // clean created resources
         for (uint32_t j = 0; j < 6; j++)
         {
-            memAllocator->DestroyStagingSrcTextureBuffer(stagingBuffers[j]);
+            FreeStagingNow(staging[j]);
         }
 
         return result;
@@ -85,12 +74,12 @@ RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage(const U
     // copy image data to buffer
     for (uint32_t i = 0; i < 6; i++)
     {
-        memcpy(mappedData[i], info.cubemap.pFaces[i], faceSize);
+        memcpy(staging[i].pMappedData, info.cubemap.pFaces[i], faceSize);
     }
 
 
     // and copy it to image
-    PrepareImage(image, stagingBuffers, info, ImagePrepareType::INIT);
+    PrepareImage(image, staging, info, ImagePrepareType::INIT);
 
     // create image view
     VkImageView imageView = CreateImageView(image, info.format, info.isCubemap, GetMipmapCount(size, info));
@@ -101,7 +90,7 @@ RTGL1::TextureUploader::UploadResult RTGL1::CubemapUploader::UploadImage(const U
     // push staging buffer to be deleted when it won't be in use
     for (uint32_t i = 0; i < 6; i++)
     {
-        stagingToFree[info.frameIndex].push_back(stagingBuffers[i]);
+        FreeStagingWhenUnused(info.frameIndex, staging[i]);
     }
 
     // return results
@@ -28,7 +28,7 @@ namespace RTGL1
 class CubemapUploader : public TextureUploader
 {
 public:
-    CubemapUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator);
+    CubemapUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator, std::shared_ptr<TextureStagingRing> stagingRing);
 
     UploadResult UploadImage(const UploadInfo &info) override;
 };
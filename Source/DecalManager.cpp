@@ -407,7 +407,7 @@ void RTGL1::DecalManager::CreatePipelines(const ShaderManager *shaderManager)
     info.subpass = 0;
     info.basePipelineHandle = VK_NULL_HANDLE;
 
-    VkResult r = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline);
+    VkResult r = vkCreateGraphicsPipelines(device, shaderManager->GetPipelineCache(), 1, &info, nullptr, &pipeline);
     VK_CHECKERROR(r);
 }
 
@@ -415,7 +415,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
         plInfo.layout = pipelineVerticesLayout;
         plInfo.stage = shaderManager->GetStageInfo("CASVGFMerging");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &merging);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &merging);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, merging, VK_OBJECT_TYPE_PIPELINE, "ASVGF Merging pipeline");
@@ -428,7 +428,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
     {
         plInfo.stage = shaderManager->GetStageInfo("CASVGFGradientSamples");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &gradientSamples);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &gradientSamples);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, gradientSamples, VK_OBJECT_TYPE_PIPELINE, "ASVGF Create gradient samples pipeline");
@@ -450,7 +450,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
         {
             atrousIteration = i;
 
-            r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &gradientAtrous[i]);
+            r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &gradientAtrous[i]);
             VK_CHECKERROR(r);
 
             SET_DEBUG_NAME(device, gradientAtrous[i], VK_OBJECT_TYPE_PIPELINE, debugNames[i]);
@@ -460,7 +460,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
     {
         plInfo.stage = shaderManager->GetStageInfo("CSVGFTemporalAccum");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &temporalAccumulation);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &temporalAccumulation);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, temporalAccumulation, VK_OBJECT_TYPE_PIPELINE, "SVGF Temporal accumulation pipeline");
@@ -469,7 +469,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
     {
         plInfo.stage = shaderManager->GetStageInfo("CSVGFVarianceEstim");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &varianceEstimation);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &varianceEstimation);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, varianceEstimation, VK_OBJECT_TYPE_PIPELINE, "SVGF Variance estimation pipeline");
@@ -487,7 +487,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
         {
             plInfo.stage = shaderManager->GetStageInfo("CSVGFAtrous_Iter0");
 
-            r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &atrous[0]);
+            r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &atrous[0]);
             VK_CHECKERROR(r);
 
             SET_DEBUG_NAME(device, atrous[0], VK_OBJECT_TYPE_PIPELINE, debugNames[0]);
@@ -500,7 +500,7 @@ void RTGL1::Denoiser::CreatePipelines(const ShaderManager *shaderManager)
         {
             atrousIteration = i;
 
-            r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &atrous[i]);
+            r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &atrous[i]);
             VK_CHECKERROR(r);
 
             SET_DEBUG_NAME(device, atrous[i], VK_OBJECT_TYPE_PIPELINE, debugNames[i]);
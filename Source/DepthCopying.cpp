@@ -322,7 +322,7 @@ void RTGL1::DepthCopying::CreatePipeline(const ShaderManager *shaderManager)
     plInfo.subpass = 0;
     plInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    VkResult r = vkCreateGraphicsPipelines(device, nullptr, 1, &plInfo, nullptr, &pipeline);
+    VkResult r = vkCreateGraphicsPipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipeline);
     VK_CHECKERROR(r);
 
     SET_DEBUG_NAME(device, pipeline, VK_OBJECT_TYPE_PIPELINE, "Rasterizer raster draw pipeline");
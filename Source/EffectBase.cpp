@@ -71,7 +71,7 @@ void RTGL1::EffectBase::CreatePipelines(const ShaderManager *shaderManager)
         // modify specInfo.pData
         isSourcePing = b;
 
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelines[isSourcePing]);
+        VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipelines[isSourcePing]);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, pipelines[isSourcePing], VK_OBJECT_TYPE_PIPELINE, (std::string(GetShaderName()) + " from " + (isSourcePing ? "Ping" : "Pong")).c_str());
@@ -99,7 +99,7 @@ struct EffectWipe final : public EffectBase
             Utils::BarrierImage(
                 args.cmd, src,
                 VK_ACCESS_NONE_KHR, VK_ACCESS_TRANSFER_READ_BIT,
-                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+                swapchain->GetImageLayout(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
             Utils::BarrierImage(
                 args.cmd, dst,
@@ -119,7 +119,7 @@ struct EffectWipe final : public EffectBase
             Utils::BarrierImage(
                 args.cmd, src,
                 VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_NONE_KHR,
-                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, swapchain->GetImageLayout());
 
         }
 
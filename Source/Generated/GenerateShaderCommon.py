@@ -215,6 +215,11 @@ CONST = {
     "MAX_STATIC_VERTEX_COUNT"               : 1 << 20,
     "MAX_DYNAMIC_VERTEX_COUNT"              : 1 << 21,
     "MAX_INDEXED_PRIMITIVE_COUNT"           : 1 << 20,
+    # bind poses of skinned meshes, they persist in device memory
+    "MAX_SKINNED_VERTEX_COUNT"              : 1 << 19,
+    "MAX_SKINNED_INDEX_COUNT"               : 1 << 21,
+    # bone matrices that can be uploaded in one frame
+    "MAX_SKINNING_BONE_COUNT"               : 1 << 14,
    
     "MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT"     : 1 << 12,
     "MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT_POW" : CONST_TO_EVALUATE,
@@ -224,6 +229,8 @@ CONST = {
     "LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT"   : 1 << 8,
     
     "MAX_TOP_LEVEL_INSTANCE_COUNT"          : 45,
+    # TLAS instances of instanced meshes, they're added after MAX_TOP_LEVEL_INSTANCE_COUNT
+    "MAX_MESH_INSTANCE_COUNT"               : 1 << 14,
     
     "BINDING_VERTEX_BUFFER_STATIC"              : 0,
     "BINDING_VERTEX_BUFFER_DYNAMIC"             : 1,
@@ -251,16 +258,27 @@ CONST = {
     "BINDING_SECTOR_TO_LIGHT_LIST_REGION_POLY"  : 7,
     "BINDING_PLAIN_LIGHT_LIST_SPH"              : 8,
     "BINDING_SECTOR_TO_LIGHT_LIST_REGION_SPH"   : 9,
+    "BINDING_LIGHT_TREE_NODES_POLY"             : 10,
+    "BINDING_SECTOR_TO_LIGHT_TREE_ROOT_POLY"    : 11,
+    "BINDING_LIGHT_TREE_NODES_SPH"              : 12,
+    "BINDING_SECTOR_TO_LIGHT_TREE_ROOT_SPH"     : 13,
     "BINDING_LENS_FLARES_CULLING_INPUT"         : 0,
     "BINDING_LENS_FLARES_DRAW_CMDS"             : 1,
     "BINDING_DRAW_LENS_FLARES_INSTANCES"        : 0,
     "BINDING_DECAL_INSTANCES"                   : 0,
+    "BINDING_MIPMAP_LEVELS"                     : 0,
+    "BINDING_SKINNED_VERTICES"                  : 0,
+    "BINDING_SKINNING_BONES"                    : 1,
+    "BINDING_SKINNING_OUTPUT"                   : 2,
     
     "INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC"                : "1 << 0",
     "INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON"           : "1 << 1",
     "INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER"    : "1 << 2",
     "INSTANCE_CUSTOM_INDEX_FLAG_REFLECT_REFRACT"        : "1 << 3",
     "INSTANCE_CUSTOM_INDEX_FLAG_SKY"                    : "1 << 4",
+    # if set, global index of BLAS's first geometry is stored in the bits after INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT
+    "INSTANCE_CUSTOM_INDEX_FLAG_MESH_INSTANCE"          : "1 << 5",
+    "INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT"         : 6,
 
     "INSTANCE_MASK_WORLD_0"                 : 1 << 0,
     "INSTANCE_MASK_WORLD_1"                 : 1 << 1,
@@ -344,11 +362,18 @@ CONST = {
     "COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y"    : 16,
     "COMPUTE_LUM_HISTOGRAM_BIN_COUNT"       : 256,
 
+    # each thread averages 4x4 texels of a source mip level, so one pass
+    # creates log2(2 * COMPUTE_MIPMAP_GROUP_SIZE_X) levels
+    "COMPUTE_MIPMAP_GROUP_SIZE_X"           : 16,
+    "COMPUTE_MIPMAP_LEVELS_PER_PASS"        : 6,
+
     "COMPUTE_VERT_PREPROC_GROUP_SIZE_X"     : 256,
     "VERT_PREPROC_MODE_ONLY_DYNAMIC"        : 0,
     "VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE" : 1,
     "VERT_PREPROC_MODE_ALL"                 : 2,
 
+    "COMPUTE_VERT_SKINNING_GROUP_SIZE_X"    : 256,
+
     "GRADIENT_ESTIMATION_ENABLED"           : int(GRADIENT_ESTIMATION_ENABLED),
     "COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X" : 16,
     "COMPUTE_GRADIENT_MERGING_GROUP_SIZE_X" : 16,
@@ -380,6 +405,9 @@ CONST = {
 
     "GEOM_INST_NO_TRIANGLE_INFO"            : "UINT32_MAX",
     "SECTOR_INDEX_NONE"                     : ((1 << 15) - 1),
+    # if set in ShLightTreeNode::secondChildOrLight, then the node is a leaf
+    # and the other bits contain an index in a plain light list
+    "LIGHT_TREE_NODE_FLAG_LEAF"             : "1u << 31",
 }
 
 CONST_GLSL_ONLY = {
@@ -628,6 +656,16 @@ LIGHT_POLYGONAL_STRUCT = [
     (TYPE_FLOAT32,      3,      "color",                1),
 ]
 
+# light tree nodes are stored in depth-first order:
+# the first child of an inner node is the next node,
+# 'secondChildOrLight' is an index of the second child
+LIGHT_TREE_NODE_STRUCT = [
+    (TYPE_FLOAT32,      3,      "boundsMin",            1),
+    (TYPE_FLOAT32,      1,      "power",                1),
+    (TYPE_FLOAT32,      3,      "boundsMax",            1),
+    (TYPE_UINT32,       1,      "secondChildOrLight",   1),
+]
+
 TONEMAPPING_STRUCT = [
     (TYPE_UINT32,       1,      "histogram",            CONST["COMPUTE_LUM_HISTOGRAM_BIN_COUNT"]),
     (TYPE_FLOAT32,      1,      "avgLuminance",         1),
@@ -638,6 +676,28 @@ VERT_PREPROC_PUSH_STRUCT = [
     (TYPE_UINT32,       1,      "tlasInstanceIsDynamicBits",        align(CONST["MAX_TOP_LEVEL_INSTANCE_COUNT"], 32) // 32),
 ]
 
+# bone indices are 16-bit, packed in pairs
+SKINNED_VERTEX_STRUCT = [
+    (TYPE_FLOAT32,      4,      "position",             1),
+    (TYPE_FLOAT32,      4,      "normal",               1),
+    (TYPE_FLOAT32,      2,      "texCoord",             1),
+    (TYPE_UINT32,       1,      "boneIndices01",        1),
+    (TYPE_UINT32,       1,      "boneIndices23",        1),
+    (TYPE_FLOAT32,      4,      "boneWeights",          1),
+]
+
+VERT_SKINNING_PUSH_STRUCT = [
+    (TYPE_UINT32,       1,      "srcBaseVertex",        1),
+    (TYPE_UINT32,       1,      "dstBaseVertex",        1),
+    (TYPE_UINT32,       1,      "vertexCount",          1),
+    (TYPE_UINT32,       1,      "baseBone",             1),
+    (TYPE_UINT32,       1,      "boneCount",            1),
+    (TYPE_UINT32,       1,      "writeNormals",         1),
+    (TYPE_UINT32,       1,      "positionsStride",      1),
+    (TYPE_UINT32,       1,      "normalsStride",        1),
+    (TYPE_UINT32,       1,      "texCoordsStride",      1),
+]
+
 INDIRECT_DRAW_CMD_STRUCT = [
     (TYPE_UINT32,       1,      "indexCount",           1),
     (TYPE_UINT32,       1,      "instanceCount",        1),
@@ -681,7 +741,10 @@ STRUCTS = {
     "ShLightSpherical":         (LIGHT_SPHERICAL_STRUCT,        False,  STRUCT_ALIGNMENT_STD430,    0),
     # "ShLightDirectional":     (LIGHT_DIRECTIONAL_STRUCT,      False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShLightPolygonal":         (LIGHT_POLYGONAL_STRUCT,        False,  STRUCT_ALIGNMENT_STD430,    0),
+    "ShLightTreeNode":          (LIGHT_TREE_NODE_STRUCT,        False,  STRUCT_ALIGNMENT_STD430,    0),
     "ShVertPreprocessing":      (VERT_PREPROC_PUSH_STRUCT,      False,  0,                          0),
+    "ShSkinnedVertex":          (SKINNED_VERTEX_STRUCT,         False,  STRUCT_ALIGNMENT_STD430,    0),
+    "ShVertSkinning":           (VERT_SKINNING_PUSH_STRUCT,     False,  0,                          0),
     "ShIndirectDrawCommand":    (INDIRECT_DRAW_CMD_STRUCT,      False,  STRUCT_ALIGNMENT_STD430,    0),
     # TODO: should be STRUCT_ALIGNMENT_STD430, but current generator is not great as it just adds pads at the end, so it's 0
     "ShLensFlareInstance":      (LENS_FLARES_INSTANCE_STRUCT,   False,  0,                          0),
@@ -3,12 +3,16 @@
 #define MAX_STATIC_VERTEX_COUNT (1048576)
 #define MAX_DYNAMIC_VERTEX_COUNT (2097152)
 #define MAX_INDEXED_PRIMITIVE_COUNT (1048576)
+#define MAX_SKINNED_VERTEX_COUNT (524288)
+#define MAX_SKINNED_INDEX_COUNT (2097152)
+#define MAX_SKINNING_BONE_COUNT (16384)
 #define MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT (4096)
 #define MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT_POW (12)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT (1048576)
 #define MAX_GEOMETRY_PRIMITIVE_COUNT_POW (20)
 #define LOWER_BOTTOM_LEVEL_GEOMETRIES_COUNT (256)
 #define MAX_TOP_LEVEL_INSTANCE_COUNT (45)
+#define MAX_MESH_INSTANCE_COUNT (16384)
 #define BINDING_VERTEX_BUFFER_STATIC (0)
 #define BINDING_VERTEX_BUFFER_DYNAMIC (1)
 #define BINDING_INDEX_BUFFER_STATIC (2)
@@ -35,15 +39,25 @@
 #define BINDING_SECTOR_TO_LIGHT_LIST_REGION_POLY (7)
 #define BINDING_PLAIN_LIGHT_LIST_SPH (8)
 #define BINDING_SECTOR_TO_LIGHT_LIST_REGION_SPH (9)
+#define BINDING_LIGHT_TREE_NODES_POLY (10)
+#define BINDING_SECTOR_TO_LIGHT_TREE_ROOT_POLY (11)
+#define BINDING_LIGHT_TREE_NODES_SPH (12)
+#define BINDING_SECTOR_TO_LIGHT_TREE_ROOT_SPH (13)
 #define BINDING_LENS_FLARES_CULLING_INPUT (0)
 #define BINDING_LENS_FLARES_DRAW_CMDS (1)
 #define BINDING_DRAW_LENS_FLARES_INSTANCES (0)
 #define BINDING_DECAL_INSTANCES (0)
+#define BINDING_MIPMAP_LEVELS (0)
+#define BINDING_SKINNED_VERTICES (0)
+#define BINDING_SKINNING_BONES (1)
+#define BINDING_SKINNING_OUTPUT (2)
 #define INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC (1 << 0)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON (1 << 1)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER (1 << 2)
 #define INSTANCE_CUSTOM_INDEX_FLAG_REFLECT_REFRACT (1 << 3)
 #define INSTANCE_CUSTOM_INDEX_FLAG_SKY (1 << 4)
+#define INSTANCE_CUSTOM_INDEX_FLAG_MESH_INSTANCE (1 << 5)
+#define INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT (6)
 #define INSTANCE_MASK_WORLD_0 (1)
 #define INSTANCE_MASK_WORLD_1 (2)
 #define INSTANCE_MASK_WORLD_2 (4)
@@ -113,10 +127,13 @@
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_X (16)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y (16)
 #define COMPUTE_LUM_HISTOGRAM_BIN_COUNT (256)
+#define COMPUTE_MIPMAP_GROUP_SIZE_X (16)
+#define COMPUTE_MIPMAP_LEVELS_PER_PASS (6)
 #define COMPUTE_VERT_PREPROC_GROUP_SIZE_X (256)
 #define VERT_PREPROC_MODE_ONLY_DYNAMIC (0)
 #define VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE (1)
 #define VERT_PREPROC_MODE_ALL (2)
+#define COMPUTE_VERT_SKINNING_GROUP_SIZE_X (256)
 #define GRADIENT_ESTIMATION_ENABLED (1)
 #define COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X (16)
 #define COMPUTE_GRADIENT_MERGING_GROUP_SIZE_X (16)
@@ -142,6 +159,7 @@
 #define MEDIA_TYPE_COUNT (3)
 #define GEOM_INST_NO_TRIANGLE_INFO (UINT32_MAX)
 #define SECTOR_INDEX_NONE (32767)
+#define LIGHT_TREE_NODE_FLAG_LEAF (1u << 31)
 
 #define FIDELITY_SUPER_RESOLUTION_GAMMA_SPACE (3.0)
 #define SURFACE_POSITION_INCORRECT (10000000.0)
@@ -322,12 +340,43 @@ struct ShLightPolygonal
     uint __pad0;
 };
 
+struct ShLightTreeNode
+{
+    vec3 boundsMin;
+    float power;
+    vec3 boundsMax;
+    uint secondChildOrLight;
+};
+
 struct ShVertPreprocessing
 {
     uint tlasInstanceCount;
     uint tlasInstanceIsDynamicBits[2];
 };
 
+struct ShSkinnedVertex
+{
+    vec4 position;
+    vec4 normal;
+    vec2 texCoord;
+    uint boneIndices01;
+    uint boneIndices23;
+    vec4 boneWeights;
+};
+
+struct ShVertSkinning
+{
+    uint srcBaseVertex;
+    uint dstBaseVertex;
+    uint vertexCount;
+    uint baseBone;
+    uint boneCount;
+    uint writeNormals;
+    uint positionsStride;
+    uint normalsStride;
+    uint texCoordsStride;
+};
+
 struct ShIndirectDrawCommand
 {
     uint indexCount;
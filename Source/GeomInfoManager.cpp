@@ -33,12 +33,18 @@ RTGL1::GeomInfoManager::GeomInfoManager(VkDevice _device, std::shared_ptr<Memory
 :
     device(_device),
     staticGeomCount(0),
-    dynamicGeomCount(0)
+    dynamicGeomCount(0),
+    meshInstanceCount(0),
+    deferStaticCopy(false)
 {
     buffer = std::make_shared<AutoBuffer>(device, _allocator);
     matchPrev = std::make_shared<AutoBuffer>(device, _allocator);
 
-    const uint32_t allBottomLevelGeomsCount = VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount();
+    // reserve space for instanced meshes' placements after all filters' regions
+    const uint32_t allBottomLevelGeomsCount = VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount() + MAX_MESH_INSTANCE_COUNT;
+
+    // global geometry index of a placement must fit into instance custom index
+    assert(allBottomLevelGeomsCount <= (1u << (24 - INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT)));
 
     buffer->Create(allBottomLevelGeomsCount * sizeof(RTGL1::ShGeometryInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Geometry info buffer");
     matchPrev->Create(allBottomLevelGeomsCount * sizeof(int32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Match previous Geometry infos buffer");
@@ -48,6 +54,7 @@ RTGL1::GeomInfoManager::GeomInfoManager(VkDevice _device, std::shared_ptr<Memory
     {
         copyRegionLowerBounds[i].resize(MAX_TOP_LEVEL_INSTANCE_COUNT, UINT32_MAX);
         copyRegionUpperBounds[i].resize(MAX_TOP_LEVEL_INSTANCE_COUNT, 0);
+        dynamicChangedCount[i].resize(MAX_TOP_LEVEL_INSTANCE_COUNT, 0);
     }
 }
 
@@ -60,13 +67,19 @@ bool RTGL1::GeomInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frame
     CmdLabel label(cmd, "Copying geom infos");
 
     {
-        VkBufferCopy copyInfos[MAX_TOP_LEVEL_INSTANCE_COUNT];
-        VkBufferMemoryBarrier barriers[MAX_TOP_LEVEL_INSTANCE_COUNT];
+        // + 1 for mesh instances' region
+        VkBufferCopy copyInfos[MAX_TOP_LEVEL_INSTANCE_COUNT + 1];
+        VkBufferMemoryBarrier barriers[MAX_TOP_LEVEL_INSTANCE_COUNT + 1];
 
         uint32_t infoCount = 0;
 
         for (auto cf : VertexCollectorFilterGroup_ChangeFrequency)
         {
+            if (deferStaticCopy && !(cf & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC))
+            {
+                continue;
+            }
+
             uint64_t upperBoundSize = cf & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC ?
                 matchPrevCopyInfo.maxDynamicGeomCount * sizeof(int32_t) :
                 matchPrevCopyInfo.maxStaticGeomCount * sizeof(int32_t);
@@ -124,6 +137,42 @@ bool RTGL1::GeomInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frame
             }
         }
 
+        // previous frame's placements of instanced meshes
+        if (matchPrevCopyInfo.maxMeshInstanceCount > 0)
+        {
+            uint64_t offset = VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount() * sizeof(int32_t);
+            uint64_t size = matchPrevCopyInfo.maxMeshInstanceCount * sizeof(int32_t);
+
+            {
+                uint8_t *pDst = (uint8_t*)matchPrev->GetMapped(frameIndex);
+                uint8_t *pSrc = (uint8_t*)matchPrevShadow.get();
+
+                memcpy(pDst + offset, pSrc + offset, size);
+            }
+
+            VkBufferCopy &c = copyInfos[infoCount];
+
+            c = {};
+            c.srcOffset = offset;
+            c.dstOffset = offset;
+            c.size = size;
+
+            VkBufferMemoryBarrier &b = barriers[infoCount];
+
+            b = {};
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            b.buffer = matchPrev->GetDeviceLocal();
+            b.offset = offset;
+            b.size = size;
+
+            infoCount++;
+        }
+
         if (infoCount > 0)
         {
             matchPrev->CopyFromStaging(cmd, frameIndex, copyInfos, infoCount);
@@ -143,13 +192,19 @@ bool RTGL1::GeomInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frame
 
 
     {
-        VkBufferCopy copyInfos[MAX_TOP_LEVEL_INSTANCE_COUNT];
-        VkBufferMemoryBarrier barriers[MAX_TOP_LEVEL_INSTANCE_COUNT];
+        // + 1 for mesh instances' region
+        VkBufferCopy copyInfos[MAX_TOP_LEVEL_INSTANCE_COUNT + 1];
+        VkBufferMemoryBarrier barriers[MAX_TOP_LEVEL_INSTANCE_COUNT + 1];
 
         uint32_t infoCount = 0;
 
         for (auto cf : VertexCollectorFilterGroup_ChangeFrequency)
         {
+            if (deferStaticCopy && !(cf & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC))
+            {
+                continue;
+            }
+
             for (auto pt : VertexCollectorFilterGroup_PassThrough)
             {
                 for (auto pm : VertexCollectorFilterGroup_PrimaryVisibility)
@@ -196,6 +251,35 @@ bool RTGL1::GeomInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frame
             }
         }
 
+        // placements of instanced meshes
+        if (meshInstanceCount > 0)
+        {
+            const uint64_t offset = sizeof(ShGeometryInstance) * VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount();
+            const uint64_t size = sizeof(ShGeometryInstance) * meshInstanceCount;
+
+            VkBufferCopy &c = copyInfos[infoCount];
+
+            c = {};
+            c.srcOffset = offset;
+            c.dstOffset = offset;
+            c.size = size;
+
+            VkBufferMemoryBarrier &b = barriers[infoCount];
+
+            b = {};
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            b.buffer = buffer->GetDeviceLocal();
+            b.offset = offset;
+            b.size = size;
+
+            infoCount++;
+        }
+
         if (infoCount == 0)
         {
             return false;
@@ -267,17 +351,33 @@ void RTGL1::GeomInfoManager::ResetOnlyDynamic(uint32_t frameIndex)
         dynamicGeomCount = 0;
     }
 
+    // placements of instanced meshes are readded every frame too
+    if (meshInstanceCount > 0)
+    {
+        int32_t *toReset = matchPrevShadow.get() + VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount();
+        memset(toReset, 0xFF, meshInstanceCount * sizeof(int32_t));
+
+        meshInstanceCount = 0;
+    }
+
     for (uint32_t type = 0; type < MAX_TOP_LEVEL_INSTANCE_COUNT; type++)
     {
         std::fill(copyRegionLowerBounds[frameIndex].begin(), copyRegionLowerBounds[frameIndex].end(), UINT32_MAX);
         std::fill(copyRegionUpperBounds[frameIndex].begin(), copyRegionUpperBounds[frameIndex].end(), 0);
     }
+
+    std::fill(dynamicChangedCount[frameIndex].begin(), dynamicChangedCount[frameIndex].end(), 0);
 }
 
 void RTGL1::GeomInfoManager::ResetWithStatic()
 {
     movableIDToGeomFrameInfo.clear();
 
+    for (auto &m : meshInstanceIDToGeomFrameInfo)
+    {
+        m.clear();
+    }
+
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
         // reset each group
@@ -303,6 +403,38 @@ void RTGL1::GeomInfoManager::ResetWithStatic()
     {
         ResetOnlyDynamic(i);
     }
+
+    deferStaticCopy = true;
+}
+
+void RTGL1::GeomInfoManager::MarkStaticToCopy(uint32_t frameIndex)
+{
+    deferStaticCopy = false;
+
+    if (staticGeomCount == 0)
+    {
+        return;
+    }
+
+    for (auto cf : VertexCollectorFilterGroup_ChangeFrequency)
+    {
+        if (cf & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC)
+        {
+            continue;
+        }
+
+        for (auto pt : VertexCollectorFilterGroup_PassThrough)
+        {
+            for (auto pm : VertexCollectorFilterGroup_PrimaryVisibility)
+            {
+                // approximate exact size with staticGeomCount
+                uint32_t count = std::min(staticGeomCount, VertexCollectorFilterTypeFlags_GetAmountInGlobalArray(cf | pt | pm));
+
+                MarkGeomInfoIndexToCopy(frameIndex, 0, VertexCollectorFilterTypeFlags_GetID(cf | pt | pm));
+                MarkGeomInfoIndexToCopy(frameIndex, count - 1, VertexCollectorFilterTypeFlags_GetID(cf | pt | pm));
+            }
+        }
+    }
 }
 
 uint32_t RTGL1::GeomInfoManager::GetGlobalGeomIndex(uint32_t localGeomIndex, VertexCollectorFilterTypeFlags flags)
@@ -334,8 +466,10 @@ void RTGL1::GeomInfoManager::PrepareForFrame(uint32_t frameIndex)
     // save counts before resetting
     matchPrevCopyInfo.maxDynamicGeomCount = dynamicGeomCount;
     matchPrevCopyInfo.maxStaticGeomCount = staticGeomCount;
+    matchPrevCopyInfo.maxMeshInstanceCount = meshInstanceCount;
 
     dynamicIDToGeomFrameInfo[frameIndex].clear();
+    meshInstanceIDToGeomFrameInfo[frameIndex].clear();
     ResetOnlyDynamic(frameIndex);
 }
 
@@ -390,6 +524,11 @@ uint32_t RTGL1::GeomInfoManager::WriteGeomInfo(
 
     uint32_t flagsId = VertexCollectorFilterTypeFlags_GetID(flags);
 
+    if (!isStatic && !IsSameAsPrevFrame(frameIndex, geomUniqueID, globalGeomIndex, src))
+    {
+        dynamicChangedCount[frameIndex][flagsId]++;
+    }
+
     for (uint32_t i = frameBegin; i < frameEnd; i++)
     {
         FillWithPrevFrameData(flags, geomUniqueID, globalGeomIndex, src, i);
@@ -405,6 +544,63 @@ uint32_t RTGL1::GeomInfoManager::WriteGeomInfo(
     return simpleIndex;
 }
 
+uint32_t RTGL1::GeomInfoManager::WriteMeshInstanceGeomInfo(
+    uint32_t frameIndex,
+    uint64_t instanceUniqueID,
+    ShGeometryInstance &src)
+{
+    // reported to the user by the caller
+    if (meshInstanceCount >= MAX_MESH_INSTANCE_COUNT)
+    {
+        return UINT32_MAX;
+    }
+
+    const uint32_t globalGeomIndex = VertexCollectorFilterTypeFlags_GetAllBottomLevelGeomsCount() + meshInstanceCount;
+    meshInstanceCount++;
+
+    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "Assuming MAX_FRAMES_IN_FLIGHT==2");
+    const uint32_t prevFrame = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    const auto &prevIdToInfo = meshInstanceIDToGeomFrameInfo[prevFrame];
+    const auto prev = prevIdToInfo.find(instanceUniqueID);
+
+    if (prev != prevIdToInfo.end() &&
+        prev->second.vertexCount == src.vertexCount &&
+        prev->second.indexCount == src.indexCount)
+    {
+        // local positions are the same, only model matrices are changing
+        src.prevBaseVertexIndex = src.baseVertexIndex;
+        src.prevBaseIndexIndex = src.baseIndexIndex;
+        memcpy(src.prevModel, prev->second.model, sizeof(float) * 16);
+
+        matchPrevShadow[prev->second.prevGlobalGeomIndex] = (int32_t)globalGeomIndex;
+    }
+    else
+    {
+        MarkNoPrevInfo(src);
+    }
+
+    ShGeometryInstance *dst = GetGeomInfoAddressByGlobalIndex(frameIndex, globalGeomIndex);
+    memcpy(dst, &src, sizeof(ShGeometryInstance));
+
+    auto &idToInfo = meshInstanceIDToGeomFrameInfo[frameIndex];
+
+    // IDs must be unique
+    assert(idToInfo.find(instanceUniqueID) == idToInfo.end());
+
+    GeomFrameInfo f = {};
+    memcpy(f.model, src.model, sizeof(float) * 16);
+    f.baseVertexIndex = src.baseVertexIndex;
+    f.baseIndexIndex = src.baseIndexIndex;
+    f.vertexCount = src.vertexCount;
+    f.indexCount = src.indexCount;
+    f.prevGlobalGeomIndex = globalGeomIndex;
+
+    idToInfo[instanceUniqueID] = f;
+
+    return globalGeomIndex;
+}
+
 void RTGL1::GeomInfoManager::MarkGeomInfoIndexToCopy(uint32_t frameIndex, uint32_t localGeomIndex, uint32_t flagsId)
 {
     assert(flagsId < MAX_TOP_LEVEL_INSTANCE_COUNT);
@@ -477,6 +673,28 @@ void RTGL1::GeomInfoManager::FillWithPrevFrameData(
     }
 }
 
+bool RTGL1::GeomInfoManager::IsSameAsPrevFrame(uint32_t frameIndex, uint64_t geomUniqueID, uint32_t currentGlobalGeomIndex, const ShGeometryInstance &src) const
+{
+    static_assert(MAX_FRAMES_IN_FLIGHT == 2, "Assuming MAX_FRAMES_IN_FLIGHT==2");
+    uint32_t prevFrame = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    const auto &prevIdToInfo = dynamicIDToGeomFrameInfo[prevFrame];
+    const auto prev = prevIdToInfo.find(geomUniqueID);
+
+    return
+        prev != prevIdToInfo.end() &&
+        prev->second.prevGlobalGeomIndex == currentGlobalGeomIndex &&
+        prev->second.vertexCount == src.vertexCount &&
+        prev->second.indexCount == src.indexCount;
+}
+
+bool RTGL1::GeomInfoManager::IsDynamicGeometryUnchanged(uint32_t frameIndex, VertexCollectorFilterTypeFlags flags) const
+{
+    assert(flags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC);
+
+    return dynamicChangedCount[frameIndex][VertexCollectorFilterTypeFlags_GetID(flags)] == 0;
+}
+
 void RTGL1::GeomInfoManager::MarkNoPrevInfo(ShGeometryInstance &dst)
 {
     dst.prevBaseVertexIndex = UINT32_MAX;
@@ -549,66 +767,6 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoMaterials(uint32_t simpleIndex,
     }
 }
 
-void RTGL1::GeomInfoManager::WriteStaticGeomInfoTransform(uint32_t simpleIndex, uint64_t geomUniqueID, const RgTransform &src)
-{
-    if (simpleIndex >= geomType.size())
-    {
-        assert(0);
-        return;
-    }
-
-    assert(geomType.size() == simpleToLocalIndex.size());
-
-
-    const auto flags = geomType[simpleIndex];
-    const uint32_t flagsId = VertexCollectorFilterTypeFlags_GetID(flags);
-
-    // only static and movable
-    // geoms are allowed to update transforms
-    if (!(flags & VertexCollectorFilterTypeFlagBits::CF_STATIC_MOVABLE))
-    {
-        assert(0);
-        return;
-    }
-
-
-    float modelMatix[16];
-    Matrix::ToMat4Transposed(modelMatix, src);
-
-    auto prev = movableIDToGeomFrameInfo.find(geomUniqueID);
-
-    // if movable is updated, then it must be added previously
-    if (prev == movableIDToGeomFrameInfo.end())
-    {
-        assert(0);
-        return;
-    }
-
-    float *prevModelMatrix = prev->second.model;
-
-    const uint32_t localGeomIndex = simpleToLocalIndex[simpleIndex];
-    const uint32_t globalIndex = GetGlobalGeomIndex(localGeomIndex, flags);
-
-    // need to write to both staging buffers for static geometry
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        ShGeometryInstance *dst = GetGeomInfoAddressByGlobalIndex(i, globalIndex);
-
-        memcpy(dst->model, modelMatix, 16 * sizeof(float));
-        memcpy(dst->prevModel, prevModelMatrix, 16 * sizeof(float));
-
-        // mark that movable has a previous info now
-        MarkMovableHasPrevInfo(*dst);
-
-        // mark to be copied
-        MarkGeomInfoIndexToCopy(i, localGeomIndex, flagsId);
-    }
-
-
-    // save new prev data
-    memcpy(prevModelMatrix, modelMatix, 16 * sizeof(float));
-}
-
 uint32_t RTGL1::GeomInfoManager::GetCount() const
 {
     return staticGeomCount + dynamicGeomCount;
@@ -37,6 +37,8 @@ struct ShGeometryInstance;
 // SimpleIndex -- linear index, incremented with each addition of new geometry
 // LocalGeomIndex -- geometry index in its filter's space
 // GlobalGeomIndex = ToOffset(geomType) * MAX_BLAS_GEOMS + geomLocalIndex
+// Geometry infos of instanced meshes' placements are stored after all filters' regions:
+// GlobalGeomIndex = AllBottomLevelGeomsCount + meshInstanceIndex
 class GeomInfoManager
 {
 public:
@@ -52,7 +54,10 @@ public:
 
 
     void PrepareForFrame(uint32_t frameIndex);
+    // Static geometry infos won't be copied to device-local buffer until
+    // MarkStaticToCopy call, so previous static scene could still be drawn.
     void ResetWithStatic();
+    void MarkStaticToCopy(uint32_t frameIndex);
 
 
     // Save instance for copying into buffer and fill previous frame's data.
@@ -66,14 +71,26 @@ public:
         VertexCollectorFilterTypeFlags flags,
         ShGeometryInstance &src);
 
+    // Save a copy of instanced mesh's info for one of its placements.
+    // As placements are uploaded every frame, it should be called every frame.
+    // Returns global geometry index, or UINT32_MAX if the limit was exceeded.
+    uint32_t WriteMeshInstanceGeomInfo(
+        uint32_t frameIndex,
+        uint64_t instanceUniqueID,
+        ShGeometryInstance &src);
+
 
     void WriteStaticGeomInfoMaterials(uint32_t simpleIndex, uint32_t layer, const MaterialTextures &src);
-    void WriteStaticGeomInfoTransform(uint32_t simpleIndex, uint64_t geomUniqueID, const RgTransform &src);
 
 
     bool CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, bool insertBarrier = true);
 
 
+    // True, if each dynamic geometry of the filter has the same unique ID
+    // and vertex/index counts as the one with the same index in the previous frame
+    bool IsDynamicGeometryUnchanged(uint32_t frameIndex, VertexCollectorFilterTypeFlags flags) const;
+
+
     uint32_t GetCount() const;
     uint32_t GetStaticCount() const;
     uint32_t GetDynamicCount() const;
@@ -96,6 +113,7 @@ private:
     {
         uint32_t maxStaticGeomCount = 0;
         uint32_t maxDynamicGeomCount = 0;
+        uint32_t maxMeshInstanceCount = 0;
     };
 
 private:
@@ -117,6 +135,8 @@ private:
         VertexCollectorFilterTypeFlags flags, uint64_t geomUniqueID, 
         uint32_t currentGlobalGeomIndex, ShGeometryInstance &dst, int32_t frameIndex = 0);
 
+    bool IsSameAsPrevFrame(uint32_t frameIndex, uint64_t geomUniqueID, uint32_t currentGlobalGeomIndex, const ShGeometryInstance &src) const;
+
     void MarkNoPrevInfo(ShGeometryInstance &dst);
     void MarkMovableHasPrevInfo(ShGeometryInstance &dst);
     // Save data for the next frame
@@ -134,6 +154,10 @@ private:
     // but static ones are added very infrequently, e.g. on level load
     uint32_t staticGeomCount;
     uint32_t dynamicGeomCount;
+    // placements of instanced meshes are readded every frame
+    uint32_t meshInstanceCount;
+    // if true, static regions in device-local buffers belong to the previous static scene
+    bool deferStaticCopy;
 
     // buffer for getting info for geometry in BLAS
     std::shared_ptr<AutoBuffer> buffer;
@@ -145,6 +169,10 @@ private:
     std::vector<uint32_t> copyRegionLowerBounds[MAX_FRAMES_IN_FLIGHT];
     std::vector<uint32_t> copyRegionUpperBounds[MAX_FRAMES_IN_FLIGHT];
 
+    // count of dynamic geometries in each filter that
+    // were changed or added since the previous frame
+    std::vector<uint32_t> dynamicChangedCount[MAX_FRAMES_IN_FLIGHT];
+
     // each geometry has its type as they're can be in different filters
     std::vector<VertexCollectorFilterTypeFlags> geomType;
 
@@ -154,6 +182,7 @@ private:
     // used for getting info from previous frame
     rgl::unordered_map<uint64_t, GeomFrameInfo> dynamicIDToGeomFrameInfo[MAX_FRAMES_IN_FLIGHT];
     rgl::unordered_map<uint64_t, GeomFrameInfo> movableIDToGeomFrameInfo;
+    rgl::unordered_map<uint64_t, GeomFrameInfo> meshInstanceIDToGeomFrameInfo[MAX_FRAMES_IN_FLIGHT];
 };
 
 }
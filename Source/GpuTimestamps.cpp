@@ -0,0 +1,223 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GpuTimestamps.h"
+
+#include <cassert>
+
+// the first two queries are for the whole frame
+constexpr uint32_t FRAME_BEGIN_QUERY = 0;
+constexpr uint32_t FRAME_END_QUERY = 1;
+constexpr uint32_t QUERY_COUNT = 2 + 2 * RG_MAX_FRAME_TIMING_COUNT;
+
+static uint32_t GetScopeBeginQuery(uint32_t scopeIndex)
+{
+    return 2 + scopeIndex * 2;
+}
+
+static uint32_t GetScopeEndQuery(uint32_t scopeIndex)
+{
+    return 2 + scopeIndex * 2 + 1;
+}
+
+
+RTGL1::GpuTimestamps::GpuTimestamps(
+    VkDevice _device,
+    const std::shared_ptr<PhysicalDevice> &_physDevice,
+    const std::shared_ptr<Queues> &_queues)
+:
+    device(_device),
+    isSupported(false),
+    msPerTick(0),
+    validBitsMask(0),
+    queryPools{},
+    isFrameRecorded{},
+    latestTimings{}
+{
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(_physDevice->Get(), &familyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(_physDevice->Get(), &familyCount, families.data());
+
+    const uint32_t validBits = families[_queues->GetIndexGraphics()].timestampValidBits;
+    const VkPhysicalDeviceLimits &limits = _physDevice->GetProperties().limits;
+
+    isSupported = validBits > 0 && limits.timestampPeriod > 0;
+
+    if (!isSupported)
+    {
+        return;
+    }
+
+    validBitsMask = validBits >= 64 ? UINT64_MAX : (1ULL << validBits) - 1;
+    msPerTick = static_cast<double>(limits.timestampPeriod) / 1000000.0;
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        VkQueryPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = QUERY_COUNT;
+
+        VkResult r = vkCreateQueryPool(device, &poolInfo, nullptr, &queryPools[i]);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, queryPools[i], VK_OBJECT_TYPE_QUERY_POOL, "Timestamp query pool");
+
+        scopeNames[i].reserve(RG_MAX_FRAME_TIMING_COUNT);
+    }
+}
+
+RTGL1::GpuTimestamps::~GpuTimestamps()
+{
+    for (VkQueryPool p : queryPools)
+    {
+        if (p != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(device, p, nullptr);
+        }
+    }
+}
+
+void RTGL1::GpuTimestamps::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (!isSupported)
+    {
+        return;
+    }
+
+    if (isFrameRecorded[frameIndex])
+    {
+        ReadResults(frameIndex);
+    }
+
+    isFrameRecorded[frameIndex] = false;
+    scopeNames[frameIndex].clear();
+    openScopes.clear();
+
+    vkCmdResetQueryPool(cmd, queryPools[frameIndex], 0, QUERY_COUNT);
+
+    // bottom of pipe for all timestamps: each one is written after the
+    // previously recorded work is done, so nested and adjacent scopes add up
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPools[frameIndex], FRAME_BEGIN_QUERY);
+}
+
+void RTGL1::GpuTimestamps::FinishFrame(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (!isSupported)
+    {
+        return;
+    }
+
+    // close the scopes that were not ended, e.g. if rendering was skipped
+    while (!openScopes.empty())
+    {
+        EndScope(cmd, frameIndex);
+    }
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPools[frameIndex], FRAME_END_QUERY);
+    isFrameRecorded[frameIndex] = true;
+}
+
+void RTGL1::GpuTimestamps::BeginScope(VkCommandBuffer cmd, uint32_t frameIndex, const char *pName)
+{
+    if (!isSupported)
+    {
+        return;
+    }
+
+    auto &names = scopeNames[frameIndex];
+
+    // still push to open scopes, to keep EndScope calls balanced
+    if (names.size() >= RG_MAX_FRAME_TIMING_COUNT)
+    {
+        assert(0 && "Increase RG_MAX_FRAME_TIMING_COUNT");
+        openScopes.push_back(UINT32_MAX);
+        return;
+    }
+
+    const uint32_t scopeIndex = static_cast<uint32_t>(names.size());
+    names.push_back(pName);
+    openScopes.push_back(scopeIndex);
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPools[frameIndex], GetScopeBeginQuery(scopeIndex));
+}
+
+void RTGL1::GpuTimestamps::EndScope(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (!isSupported)
+    {
+        return;
+    }
+
+    assert(!openScopes.empty());
+
+    const uint32_t scopeIndex = openScopes.back();
+    openScopes.pop_back();
+
+    if (scopeIndex == UINT32_MAX)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPools[frameIndex], GetScopeEndQuery(scopeIndex));
+}
+
+void RTGL1::GpuTimestamps::ReadResults(uint32_t frameIndex)
+{
+    const auto &names = scopeNames[frameIndex];
+    const uint32_t queryCount = GetScopeBeginQuery(static_cast<uint32_t>(names.size()));
+
+    uint64_t ticks[QUERY_COUNT];
+
+    // frame fence was waited, so the results must be available
+    VkResult r = vkGetQueryPoolResults(
+        device, queryPools[frameIndex], 0, queryCount,
+        sizeof(ticks), ticks, sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT);
+
+    if (r == VK_NOT_READY)
+    {
+        return;
+    }
+    VK_CHECKERROR(r);
+
+    latestTimings = {};
+    latestTimings.frameDurationInMs = ToMs(ticks[FRAME_BEGIN_QUERY], ticks[FRAME_END_QUERY]);
+    latestTimings.timingCount = static_cast<uint32_t>(names.size());
+
+    for (uint32_t i = 0; i < latestTimings.timingCount; i++)
+    {
+        latestTimings.timings[i].pName = names[i];
+        latestTimings.timings[i].durationInMs = ToMs(ticks[GetScopeBeginQuery(i)], ticks[GetScopeEndQuery(i)]);
+    }
+}
+
+float RTGL1::GpuTimestamps::ToMs(uint64_t begin, uint64_t end) const
+{
+    const uint64_t delta = ((end & validBitsMask) - (begin & validBitsMask)) & validBitsMask;
+    return static_cast<float>(static_cast<double>(delta) * msPerTick);
+}
+
+void RTGL1::GpuTimestamps::GetFrameTimings(RgFrameTimings &result) const
+{
+    result = latestTimings;
+}
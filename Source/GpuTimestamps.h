@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "Common.h"
+#include "PhysicalDevice.h"
+#include "Queues.h"
+
+namespace RTGL1
+{
+
+// Timestamp queries around the render stages.
+// Results are read back after the frame fence was waited,
+// so there's no stall, but they are MAX_FRAMES_IN_FLIGHT-1 frames old.
+class GpuTimestamps
+{
+public:
+    explicit GpuTimestamps(
+        VkDevice device,
+        const std::shared_ptr<PhysicalDevice> &physDevice,
+        const std::shared_ptr<Queues> &queues);
+    ~GpuTimestamps();
+
+    GpuTimestamps(const GpuTimestamps &other) = delete;
+    GpuTimestamps(GpuTimestamps &&other) noexcept = delete;
+    GpuTimestamps &operator=(const GpuTimestamps &other) = delete;
+    GpuTimestamps &operator=(GpuTimestamps &&other) noexcept = delete;
+
+    // Must be called after waiting for the frame fence of "frameIndex":
+    // reads the results of the previous frame with the same index and starts recording new ones.
+    void PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+    void FinishFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    // Scopes can be nested. "pName" must be a static string.
+    void BeginScope(VkCommandBuffer cmd, uint32_t frameIndex, const char *pName);
+    void EndScope(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    void GetFrameTimings(RgFrameTimings &result) const;
+
+private:
+    void ReadResults(uint32_t frameIndex);
+    float ToMs(uint64_t begin, uint64_t end) const;
+
+private:
+    VkDevice device;
+
+    bool isSupported;
+    double msPerTick;
+    uint64_t validBitsMask;
+
+    VkQueryPool queryPools[MAX_FRAMES_IN_FLIGHT];
+
+    // names of the scopes that were written to a query pool
+    std::vector<const char *> scopeNames[MAX_FRAMES_IN_FLIGHT];
+    bool isFrameRecorded[MAX_FRAMES_IN_FLIGHT];
+
+    std::vector<uint32_t> openScopes;
+
+    RgFrameTimings latestTimings;
+};
+
+
+class GpuTimestampScope
+{
+public:
+    explicit GpuTimestampScope(GpuTimestamps &_timestamps, VkCommandBuffer _cmd, uint32_t _frameIndex, const char *_pName)
+        : timestamps(_timestamps), cmd(_cmd), frameIndex(_frameIndex)
+    {
+        timestamps.BeginScope(_cmd, _frameIndex, _pName);
+    }
+
+    ~GpuTimestampScope()
+    {
+        timestamps.EndScope(cmd, frameIndex);
+    }
+
+    GpuTimestampScope(const GpuTimestampScope &other) = delete;
+    GpuTimestampScope(GpuTimestampScope &&other) noexcept = delete;
+    GpuTimestampScope &operator=(const GpuTimestampScope &other) = delete;
+    GpuTimestampScope &operator=(GpuTimestampScope &&other) noexcept = delete;
+
+private:
+    GpuTimestamps &timestamps;
+    VkCommandBuffer cmd;
+    uint32_t frameIndex;
+};
+
+}
@@ -184,7 +184,7 @@ void RTGL1::ImageComposition::CreatePipelines(const ShaderManager *shaderManager
         plInfo.layout = composePipelineLayout;
         plInfo.stage = shaderManager->GetStageInfo("CComposition");
 
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &composePipeline);
+        VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &composePipeline);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, composePipeline, VK_OBJECT_TYPE_PIPELINE, "Composition pipeline");
@@ -196,7 +196,7 @@ void RTGL1::ImageComposition::CreatePipelines(const ShaderManager *shaderManager
         plInfo.layout = checkerboardPipelineLayout;
         plInfo.stage = shaderManager->GetStageInfo("CCheckerboard");
 
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &checkerboardPipeline);
+        VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &checkerboardPipeline);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, checkerboardPipeline, VK_OBJECT_TYPE_PIPELINE, "Checkerboard pipeline");
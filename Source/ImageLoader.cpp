@@ -25,15 +25,60 @@
 
 #include <ktx.h>
 #include <ktxvulkan.h>
+#include <zstd.h>
+
+#include "Utils.h"
 
 using namespace RTGL1;
 
+
+namespace
+{
+
+constexpr uint8_t KTX2_IDENTIFIER[] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct KTX2Header
+{
+    uint8_t     identifier[12];
+    uint32_t    vkFormat;
+    uint32_t    typeSize;
+    uint32_t    pixelWidth;
+    uint32_t    pixelHeight;
+    uint32_t    pixelDepth;
+    uint32_t    layerCount;
+    uint32_t    faceCount;
+    uint32_t    levelCount;
+    uint32_t    supercompressionScheme;
+    uint32_t    dfdByteOffset;
+    uint32_t    dfdByteLength;
+    uint32_t    kvdByteOffset;
+    uint32_t    kvdByteLength;
+    uint64_t    sgdByteOffset;
+    uint64_t    sgdByteLength;
+};
+static_assert(sizeof(KTX2Header) == 80, "KTX2 header must be tightly packed");
+
+struct KTX2LevelIndex
+{
+    uint64_t    byteOffset;
+    uint64_t    byteLength;
+    uint64_t    uncompressedByteLength;
+};
+static_assert(sizeof(KTX2LevelIndex) == 24, "KTX2 level index must be tightly packed");
+
+// offsets of inflated levels, must be a multiple of any texel block size
+constexpr uint64_t KTX2_INFLATED_LEVEL_ALIGNMENT = 16;
+
+}
+
 ImageLoader::ImageLoader(std::shared_ptr<UserFileLoad> _userFileLoad) : userFileLoad(std::move( _userFileLoad))
 {}
 
 ImageLoader::~ImageLoader()
 {
     assert(loadedImages.empty());
+    assert(mappedFiles.empty());
+    assert(inflatedImages.empty());
 }
 
 bool ImageLoader::LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture)
@@ -79,13 +124,46 @@ bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
     }
 
     ktxTexture *pTexture = nullptr;
-    bool loaded = LoadTextureFile(pFilePath, &pTexture);
+    bool loaded;
+
+    if (userFileLoad->Exists())
+    {
+        loaded = LoadTextureFile(pFilePath, &pTexture);
+    }
+    else
+    {
+        auto file = std::make_unique<MappedFile>(pFilePath);
+
+        if (!file->IsMapped())
+        {
+            return false;
+        }
+
+        if (LoadMappedKTX2(file, pResultInfo))
+        {
+            return true;
+        }
+
+        // otherwise, let libktx parse and decompress it, without reopening the file
+        loaded = ktxTexture_CreateFromMemory(
+            file->GetData(), file->GetSize(),
+            KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+            &pTexture) == KTX_SUCCESS;
+    }
 
     if (!loaded)
     {
         return false;
     }
 
+    // Basis Universal transcoder is not built with libktx, so such
+    // files are ignored, and their default data will be used instead
+    if (pTexture->classId == ktxTexture2_c && ktxTexture2_NeedsTranscoding(reinterpret_cast<ktxTexture2 *>(pTexture)))
+    {
+        ktxTexture_Destroy(pTexture);
+        return false;
+    }
+
     assert(pTexture->numDimensions == 2);
     assert(pTexture->numLevels <= MAX_PREGENERATED_MIPMAP_LEVELS);
     assert(pTexture->numLayers == 1);
@@ -181,4 +259,127 @@ void ImageLoader::FreeLoaded()
     }
 
     loadedImages.clear();
+    mappedFiles.clear();
+    inflatedImages.clear();
+}
+
+bool ImageLoader::LoadMappedKTX2(std::unique_ptr<MappedFile> &file, ResultInfo *pResultInfo)
+{
+    const uint8_t *pFileData = file->GetData();
+    const size_t fileSize = file->GetSize();
+
+    if (fileSize < sizeof(KTX2Header))
+    {
+        return false;
+    }
+
+    KTX2Header header;
+    memcpy(&header, pFileData, sizeof(header));
+
+    if (memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+    {
+        return false;
+    }
+
+    const bool isZstd = header.supercompressionScheme == KTX_SS_ZSTD;
+
+    // only plain 2D images with a known format
+    if (header.vkFormat == VK_FORMAT_UNDEFINED ||
+        (header.supercompressionScheme != KTX_SS_NONE && !isZstd) ||
+        header.pixelWidth == 0 ||
+        header.pixelHeight == 0 ||
+        header.pixelDepth != 0 ||
+        header.layerCount != 0 ||
+        header.faceCount != 1)
+    {
+        return false;
+    }
+
+    // 0 means that mipmaps should be generated
+    const uint32_t fileLevelCount = std::max(header.levelCount, 1u);
+
+    if (fileSize < sizeof(KTX2Header) + fileLevelCount * sizeof(KTX2LevelIndex))
+    {
+        return false;
+    }
+
+    const uint32_t levelCount = std::min(fileLevelCount, MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    KTX2LevelIndex levels[MAX_PREGENERATED_MIPMAP_LEVELS];
+    memcpy(levels, pFileData + sizeof(KTX2Header), levelCount * sizeof(KTX2LevelIndex));
+
+    // levels are stored from the smallest one, so find the range that contains them all
+    uint64_t dataStart = UINT64_MAX;
+    uint64_t dataEnd = 0;
+    uint64_t inflatedSize = 0;
+
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+        if (levels[i].byteLength == 0 ||
+            levels[i].byteOffset > fileSize ||
+            levels[i].byteLength > fileSize - levels[i].byteOffset ||
+            (isZstd && levels[i].uncompressedByteLength == 0))
+        {
+            return false;
+        }
+
+        dataStart = std::min(dataStart, levels[i].byteOffset);
+        dataEnd = std::max(dataEnd, levels[i].byteOffset + levels[i].byteLength);
+
+        inflatedSize += Utils::Align(levels[i].uncompressedByteLength, KTX2_INFLATED_LEVEL_ALIGNMENT);
+    }
+
+    if (dataEnd - dataStart > UINT32_MAX || inflatedSize > UINT32_MAX)
+    {
+        return false;
+    }
+
+    pResultInfo->baseSize = { header.pixelWidth, header.pixelHeight };
+    pResultInfo->format = static_cast<VkFormat>(header.vkFormat);
+    pResultInfo->isPregenerated = true;
+    pResultInfo->levelCount = levelCount;
+
+    if (!isZstd)
+    {
+        // mip levels will be copied to staging directly from the mapping
+        pResultInfo->pData = pFileData + dataStart;
+        pResultInfo->dataSize = static_cast<uint32_t>(dataEnd - dataStart);
+
+        for (uint32_t i = 0; i < levelCount; i++)
+        {
+            pResultInfo->levelOffsets[i] = static_cast<uint32_t>(levels[i].byteOffset - dataStart);
+            pResultInfo->levelSizes[i] = static_cast<uint32_t>(levels[i].byteLength);
+        }
+
+        mappedFiles.push_back(std::move(file));
+        return true;
+    }
+
+    // inflate each level from the mapping, the file itself is not needed after that
+    std::vector<uint8_t> inflated(inflatedSize);
+    uint64_t offset = 0;
+
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+        const size_t r = ZSTD_decompress(
+            inflated.data() + offset, levels[i].uncompressedByteLength,
+            pFileData + levels[i].byteOffset, levels[i].byteLength);
+
+        if (ZSTD_isError(r) || r != levels[i].uncompressedByteLength)
+        {
+            *pResultInfo = {};
+            return false;
+        }
+
+        pResultInfo->levelOffsets[i] = static_cast<uint32_t>(offset);
+        pResultInfo->levelSizes[i] = static_cast<uint32_t>(levels[i].uncompressedByteLength);
+
+        offset += Utils::Align(levels[i].uncompressedByteLength, KTX2_INFLATED_LEVEL_ALIGNMENT);
+    }
+
+    pResultInfo->pData = inflated.data();
+    pResultInfo->dataSize = static_cast<uint32_t>(inflated.size());
+
+    inflatedImages.push_back(std::move(inflated));
+    return true;
 }
@@ -24,6 +24,7 @@
 
 #include "Common.h"
 #include "Const.h"
+#include "MappedFile.h"
 #include "UserFunction.h"
 
 struct ktxTexture;
@@ -72,10 +73,17 @@ public:
 
 private:
     bool LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture);
+    // If the file is a KTX2 file in a GPU format without supercompression or with zstd,
+    // fill the result and take ownership of the file or of the inflated data.
+    // Otherwise, returns false and the file must be parsed by libktx.
+    bool LoadMappedKTX2(std::unique_ptr<MappedFile> &file, ResultInfo *pResultInfo);
 
 private:
     std::shared_ptr<UserFileLoad> userFileLoad;
     std::vector<void *> loadedImages;
+    // loaded images, data of which is read directly from the mapped files
+    std::vector<std::unique_ptr<MappedFile>> mappedFiles;
+    std::vector<std::vector<uint8_t>> inflatedImages;
 };
 
 }
\ No newline at end of file
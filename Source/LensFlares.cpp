@@ -472,7 +472,7 @@ void RTGL1::LensFlares::CreatePipelines(const ShaderManager *shaderManager)
     info.stage = shaderManager->GetStageInfo("CCullLensFlares");
     info.stage.pSpecializationInfo = &spec;
 
-    VkResult r = vkCreateComputePipelines(device, nullptr, 1, &info, nullptr, &cullPipeline);
+    VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &info, nullptr, &cullPipeline);
     VK_CHECKERROR(r);
 }
 
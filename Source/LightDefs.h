@@ -29,6 +29,8 @@ namespace RTGL1
 
 constexpr size_t MAX_SECTOR_COUNT = 4096;
 constexpr size_t MAX_LIGHT_LIST_SIZE = 1024;
+// for all sectors; if a sector's light tree doesn't fit, its light list is sampled without a tree
+constexpr size_t MAX_LIGHT_TREE_NODE_COUNT = 65536;
 
 
 // Passed to the library by user.
@@ -20,6 +20,8 @@
 
 #include "LightLists.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <string>
 
 #include "RgException.h"
@@ -28,9 +30,16 @@
 
 #define PLAIN_LIGHT_LIST_SIZEOF_ELEMENT             (sizeof(decltype(plainLightList_Raw)::value_type))
 #define SECTOR_TO_LIGHT_LIST_REGION_SIZEOF_ELEMENT  (sizeof(decltype(sectorToLightListRegion_Raw)::value_type))
+#define LIGHT_TREE_NODE_SIZEOF_ELEMENT              (sizeof(decltype(lightTreeNodes_Raw)::value_type))
+#define SECTOR_TO_LIGHT_TREE_ROOT_SIZEOF_ELEMENT    (sizeof(decltype(sectorToLightTreeRoot_Raw)::value_type))
 
 constexpr std::size_t VECTOR_START_CAPACITY = 128;
 
+// Shaders sample light lists with subset importance sampling,
+// and if a list fits into one subset (MAX_SUBSET_LEN in RaygenCommon.h), all its lights are weighted exactly,
+// so a tree is built only for longer lists
+constexpr uint32_t LIGHT_TREE_MIN_LIGHT_COUNT = 8 + 1;
+
 
 static_assert(RTGL1::MAX_SECTOR_COUNT < SECTOR_INDEX_NONE, "");
 
@@ -41,7 +50,10 @@ RTGL1::LightLists::LightLists(
     std::shared_ptr<SectorVisibility> _sectorVisibility,
     const char *_pDebugName)
 :
-    sectorVisibility(std::move(_sectorVisibility))
+    sectorVisibility(std::move(_sectorVisibility)),
+    visibilityCacheSectorVisibilityVersion(sectorVisibility->GetVersion()),
+    frameCounter(1),
+    needRebuild(true)
 {
     using namespace std::string_literals;
 
@@ -57,16 +69,36 @@ RTGL1::LightLists::LightLists(
 
     sectorToLightListRegion = std::make_shared<AutoBuffer>(_device, _memoryAllocator);
     sectorToLightListRegion->Create(sectorToLightListRegion_Raw.size() * SECTOR_TO_LIGHT_LIST_REGION_SIZEOF_ELEMENT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Sector to light list region buffer - "s + _pDebugName);
+
+
+    // light trees of all sectors, nodes reference ranges in the plain light list
+    lightTreeNodes_Raw.resize(MAX_LIGHT_TREE_NODE_COUNT);
+
+    lightTreeNodes = std::make_shared<AutoBuffer>(_device, _memoryAllocator);
+    lightTreeNodes->Create(lightTreeNodes_Raw.size() * LIGHT_TREE_NODE_SIZEOF_ELEMENT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Light tree nodes buffer - "s + _pDebugName);
+
+
+    // root node index for each sector, or UINT32_MAX if sector doesn't have a tree
+    sectorToLightTreeRoot_Raw.resize(MAX_SECTOR_COUNT);
+
+    sectorToLightTreeRoot = std::make_shared<AutoBuffer>(_device, _memoryAllocator);
+    sectorToLightTreeRoot->Create(sectorToLightTreeRoot_Raw.size() * SECTOR_TO_LIGHT_TREE_ROOT_SIZEOF_ELEMENT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Sector to light tree root buffer - "s + _pDebugName);
 }
 
+RTGL1::LightLists::~LightLists() = default;
+
 void RTGL1::LightLists::PrepareForFrame()
 {
-    // clear the vectors but without deallocating; they can be reused,
-    // since the static scene sectors most probably will be the same
-    for (auto &v : lightLists)
+    frameCounter++;
+
+    // if potential visibility was changed, cached sectors can be wrong
+    if (visibilityCacheSectorVisibilityVersion != sectorVisibility->GetVersion())
     {
-        v.clear();
+        ClearVisibilityCache();
     }
+
+    std::swap(insertedLights, insertedLightsPrev);
+    insertedLights.clear();
 }
 
 void RTGL1::LightLists::Reset()
@@ -75,6 +107,46 @@ void RTGL1::LightLists::Reset()
     {
         v = {};
     }
+
+    ClearVisibilityCache();
+
+    insertedLights = {};
+    visibilityCache = {};
+}
+
+void RTGL1::LightLists::ClearVisibilityCache()
+{
+    visibilityCache.clear();
+    visibilityCacheSectorVisibilityVersion = sectorVisibility->GetVersion();
+
+    // pointed to the cache
+    insertedLights.clear();
+    insertedLightsPrev.clear();
+
+    needRebuild = true;
+}
+
+void RTGL1::LightLists::RemoveUnusedFromVisibilityCache()
+{
+    // remove lights that weren't uploaded in this frame,
+    // but only if there are too many of them, so the lights
+    // that are uploaded not in every frame will not be recalculated
+    if (visibilityCache.size() <= 2 * insertedLights.size() + VECTOR_START_CAPACITY)
+    {
+        return;
+    }
+
+    for (auto it = visibilityCache.begin(); it != visibilityCache.end(); )
+    {
+        if (it->second->lastUsedFrame != frameCounter)
+        {
+            it = visibilityCache.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 }
 
 void RTGL1::LightLists::AddLightToSectorLightList(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex)
@@ -89,12 +161,57 @@ void RTGL1::LightLists::AddLightToSectorLightList(LightArrayIndex lightIndex, Se
     assert(std::count(v.cbegin(), v.cend(), lightIndex) == 1);
 }
 
+static bool IsSamePosition(const RTGL1::LightBounds &a, const RTGL1::LightBounds &b)
+{
+    return 
+        memcmp(a.boundsMin, b.boundsMin, sizeof(a.boundsMin)) == 0 &&
+        memcmp(a.boundsMax, b.boundsMax, sizeof(a.boundsMax)) == 0;
+}
 
-void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
+void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, UniqueLightID uniqueID, const LightBounds &bounds, SectorArrayIndex lightSectorIndex,
                                     PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn)
 {
+    auto &cached = visibilityCache[uniqueID];
+
+    if (!cached)
+    {
+        cached = std::make_unique<LightVisibility>();
+
+        CalculateLightVisibility(*cached, lightSectorIndex, pfnRgIsLightVisibleFromSector, pUserDataForPfn);
+        needRebuild = true;
+    }
+    else if (cached->lightSector != lightSectorIndex || !IsSamePosition(cached->bounds, bounds))
+    {
+        CalculateLightVisibility(*cached, lightSectorIndex, pfnRgIsLightVisibleFromSector, pUserDataForPfn);
+        needRebuild = true;
+    }
+    else if (cached->bounds.power != bounds.power)
+    {
+        // sectors are the same, but light trees must be rebuilt
+        needRebuild = true;
+    }
+
+    // must be unique
+    assert(cached->lastUsedFrame != frameCounter);
+
+    cached->bounds = bounds;
+    cached->lastUsedFrame = frameCounter;
+
+    if (insertedLights.size() <= lightIndex.GetArrayIndex())
+    {
+        insertedLights.resize(lightIndex.GetArrayIndex() + 1, nullptr);
+    }
+    insertedLights[lightIndex.GetArrayIndex()] = cached.get();
+}
+
+void RTGL1::LightLists::CalculateLightVisibility(LightVisibility &dst, SectorArrayIndex lightSectorIndex,
+                                                 PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn) const
+{
+    dst.lightSector = lightSectorIndex;
+    dst.sectors.clear();
+
     // sector is always visible from itself, so append the light unconditionally
-    AddLightToSectorLightList(lightIndex, lightSectorIndex);
+    dst.sectors.push_back(lightSectorIndex);
 
 
     if (sectorVisibility->ArePotentiallyVisibleSectorsExist(lightSectorIndex))
@@ -117,33 +234,84 @@ void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, SectorArrayIndex
             }
 
             // append given light to light list of such sector
-            AddLightToSectorLightList(lightIndex, visibleSector);
+            dst.sectors.push_back(visibleSector);
+        }
+    }
+}
+
+bool RTGL1::LightLists::AreInsertedLightsSameAsPrev() const
+{
+    // each value in 'visibilityCache' has a unique pointer and is not changed without 'needRebuild',
+    // so if pointers are the same, then the same lights with the same indices are inserted
+    return insertedLights == insertedLightsPrev;
+}
+
+void RTGL1::LightLists::FillSectorLightLists()
+{
+    // clear the vectors but without deallocating; they can be reused,
+    // since the static scene sectors most probably will be the same
+    for (auto &v : lightLists)
+    {
+        v.clear();
+    }
+
+    for (LightArrayIndex::index_t i = 0; i < insertedLights.size(); i++)
+    {
+        // all indices must be inserted
+        assert(insertedLights[i] != nullptr);
+
+        for (SectorArrayIndex sector : insertedLights[i]->sectors)
+        {
+            AddLightToSectorLightList(LightArrayIndex{ i }, sector);
         }
     }
 }
 
 void RTGL1::LightLists::BuildAndCopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex)
 {
-    uint32_t plainLightListSize, sectorCountToCopy;
+    RemoveUnusedFromVisibilityCache();
+
+    // device-local buffers already contain the same lists
+    if (!needRebuild && AreInsertedLightsSameAsPrev())
+    {
+        return;
+    }
+
+    needRebuild = false;
+    FillSectorLightLists();
+
+
+    uint32_t plainLightListSize, sectorCountToCopy, lightTreeNodeCount;
 
     BuildArrays(plainLightList_Raw.data(), &plainLightListSize,
-                sectorToLightListRegion_Raw.data(), &sectorCountToCopy);
+                sectorToLightListRegion_Raw.data(), &sectorCountToCopy,
+                lightTreeNodes_Raw.data(), &lightTreeNodeCount,
+                sectorToLightTreeRoot_Raw.data());
 
     uint64_t plainLightList_Bytes = plainLightListSize * PLAIN_LIGHT_LIST_SIZEOF_ELEMENT;
     uint64_t sectorToLightListRegion_Bytes = 2 * sectorCountToCopy * SECTOR_TO_LIGHT_LIST_REGION_SIZEOF_ELEMENT;
+    uint64_t lightTreeNodes_Bytes = lightTreeNodeCount * LIGHT_TREE_NODE_SIZEOF_ELEMENT;
+    uint64_t sectorToLightTreeRoot_Bytes = sectorCountToCopy * SECTOR_TO_LIGHT_TREE_ROOT_SIZEOF_ELEMENT;
 
     memcpy(plainLightList->GetMapped(frameIndex),           plainLightList_Raw.data(),          plainLightList_Bytes);
     memcpy(sectorToLightListRegion->GetMapped(frameIndex),  sectorToLightListRegion_Raw.data(), sectorToLightListRegion_Bytes);
+    memcpy(lightTreeNodes->GetMapped(frameIndex),           lightTreeNodes_Raw.data(),          lightTreeNodes_Bytes);
+    memcpy(sectorToLightTreeRoot->GetMapped(frameIndex),    sectorToLightTreeRoot_Raw.data(),   sectorToLightTreeRoot_Bytes);
     
     plainLightList->CopyFromStaging(cmd, frameIndex, plainLightList_Bytes);
     sectorToLightListRegion->CopyFromStaging(cmd, frameIndex, sectorToLightListRegion_Bytes);
+    lightTreeNodes->CopyFromStaging(cmd, frameIndex, lightTreeNodes_Bytes);
+    sectorToLightTreeRoot->CopyFromStaging(cmd, frameIndex, sectorToLightTreeRoot_Bytes);
 }
 
 void RTGL1::LightLists::BuildArrays(
     LightArrayIndex::index_t *pOutputPlainLightList, uint32_t *pOutputPlainLightListSize,
-    SectorArrayIndex::index_t *pOutputSectorToLightListStartEnd, uint32_t *pOutputSectorCountToCopy) const
+    SectorArrayIndex::index_t *pOutputSectorToLightListStartEnd, uint32_t *pOutputSectorCountToCopy,
+    ShLightTreeNode *pOutputLightTreeNodes, uint32_t *pOutputLightTreeNodeCount,
+    uint32_t *pOutputSectorToLightTreeRoot) const
 {
     uint32_t iter = 0;
+    uint32_t nodeCount = 0;
 
     for (SectorArrayIndex::index_t _i = 0; _i < lightLists.size(); _i++)
     {
@@ -172,10 +340,100 @@ void RTGL1::LightLists::BuildArrays(
         // write start/end, so the sector's light list can be accessed by sector array index
         pOutputSectorToLightListStartEnd[sectorIndex.GetArrayIndex() * 2 + 0] = startArrayOffset;
         pOutputSectorToLightListStartEnd[sectorIndex.GetArrayIndex() * 2 + 1] = endArrayOffset;
+
+
+        const uint32_t lightCount = iter - startArrayOffset;
+        uint32_t treeRoot = UINT32_MAX;
+
+        // binary tree with a leaf per light
+        if (lightCount >= LIGHT_TREE_MIN_LIGHT_COUNT && 
+            nodeCount + 2 * lightCount - 1 <= MAX_LIGHT_TREE_NODE_COUNT)
+        {
+            treeRoot = BuildLightTreeNode(&pOutputPlainLightList[startArrayOffset], startArrayOffset, lightCount,
+                                          pOutputLightTreeNodes, &nodeCount);
+        }
+
+        pOutputSectorToLightTreeRoot[sectorIndex.GetArrayIndex()] = treeRoot;
     }
 
     *pOutputPlainLightListSize = iter;
     *pOutputSectorCountToCopy = lightLists.size();
+    *pOutputLightTreeNodeCount = nodeCount;
+}
+
+uint32_t RTGL1::LightLists::BuildLightTreeNode(
+    LightArrayIndex::index_t *pPlainLightListPart, uint32_t plainLightListOffset, uint32_t lightCount,
+    ShLightTreeNode *pOutputLightTreeNodes, uint32_t *pOutputLightTreeNodeCount) const
+{
+    assert(lightCount > 0);
+    assert(*pOutputLightTreeNodeCount < MAX_LIGHT_TREE_NODE_COUNT);
+
+    const uint32_t nodeIndex = *pOutputLightTreeNodeCount;
+    (*pOutputLightTreeNodeCount)++;
+
+    ShLightTreeNode node = {};
+    node.boundsMin[0] = node.boundsMin[1] = node.boundsMin[2] = FLT_MAX;
+    node.boundsMax[0] = node.boundsMax[1] = node.boundsMax[2] = -FLT_MAX;
+
+    float centerMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float centerMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        const LightBounds &b = insertedLights[pPlainLightListPart[i]]->bounds;
+
+        for (int k = 0; k < 3; k++)
+        {
+            node.boundsMin[k] = std::min(node.boundsMin[k], b.boundsMin[k]);
+            node.boundsMax[k] = std::max(node.boundsMax[k], b.boundsMax[k]);
+
+            const float c = (b.boundsMin[k] + b.boundsMax[k]) * 0.5f;
+            centerMin[k] = std::min(centerMin[k], c);
+            centerMax[k] = std::max(centerMax[k], c);
+        }
+
+        node.power += b.power;
+    }
+
+    if (lightCount == 1)
+    {
+        node.secondChildOrLight = plainLightListOffset | LIGHT_TREE_NODE_FLAG_LEAF;
+        pOutputLightTreeNodes[nodeIndex] = node;
+
+        return nodeIndex;
+    }
+
+
+    // split by the median along the longest axis of light centers
+    int axis = 0;
+    for (int k = 1; k < 3; k++)
+    {
+        if (centerMax[k] - centerMin[k] > centerMax[axis] - centerMin[axis])
+        {
+            axis = k;
+        }
+    }
+
+    const uint32_t firstCount = lightCount / 2;
+
+    std::nth_element(pPlainLightListPart, pPlainLightListPart + firstCount, pPlainLightListPart + lightCount, 
+                     [this, axis] (LightArrayIndex::index_t a, LightArrayIndex::index_t b)
+    {
+        const LightBounds &ba = insertedLights[a]->bounds;
+        const LightBounds &bb = insertedLights[b]->bounds;
+
+        return ba.boundsMin[axis] + ba.boundsMax[axis] < bb.boundsMin[axis] + bb.boundsMax[axis];
+    });
+
+    // first child is the next node
+    BuildLightTreeNode(pPlainLightListPart, plainLightListOffset, firstCount,
+                       pOutputLightTreeNodes, pOutputLightTreeNodeCount);
+
+    node.secondChildOrLight = BuildLightTreeNode(pPlainLightListPart + firstCount, plainLightListOffset + firstCount, lightCount - firstCount,
+                                                 pOutputLightTreeNodes, pOutputLightTreeNodeCount);
+    pOutputLightTreeNodes[nodeIndex] = node;
+
+    return nodeIndex;
 }
 
 RTGL1::SectorArrayIndex RTGL1::LightLists::SectorIDToArrayIndex(SectorID id) const
@@ -192,3 +450,13 @@ VkBuffer RTGL1::LightLists::GetSectorToLightListRegionDeviceLocalBuffer()
 {
     return sectorToLightListRegion->GetDeviceLocal();
 }
+
+VkBuffer RTGL1::LightLists::GetLightTreeNodesDeviceLocalBuffer()
+{
+    return lightTreeNodes->GetDeviceLocal();
+}
+
+VkBuffer RTGL1::LightLists::GetSectorToLightTreeRootDeviceLocalBuffer()
+{
+    return sectorToLightTreeRoot->GetDeviceLocal();
+}
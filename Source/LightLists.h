@@ -31,6 +31,16 @@
 namespace RTGL1
 {
 
+struct ShLightTreeNode;
+
+// Spatial bounds and emitted power of a light, used to build per-sector light trees
+struct LightBounds
+{
+    float boundsMin[3];
+    float boundsMax[3];
+    float power;
+};
+
 class LightLists
 {
 public:
@@ -38,7 +48,7 @@ public:
                const std::shared_ptr<MemoryAllocator> &memoryAllocator,
                std::shared_ptr<SectorVisibility> sectorVisibility,
                const char *pDebugName);
-    ~LightLists() = default;
+    ~LightLists();
 
     LightLists(const LightLists &other) = delete;
     LightLists(LightLists &&other) noexcept = delete;
@@ -48,7 +58,9 @@ public:
     void PrepareForFrame();
     void Reset();
 
-    void InsertLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex, 
+    // Sectors that can see the light are cached by its unique ID, and the callback
+    // is called again only if the light is moved or sector visibility was changed.
+    void InsertLight(LightArrayIndex lightIndex, UniqueLightID uniqueID, const LightBounds &lightBounds, SectorArrayIndex lightSectorIndex, 
                      PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn);
     void BuildAndCopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex);
 
@@ -56,13 +68,40 @@ public:
 
     VkBuffer GetPlainLightListDeviceLocalBuffer();
     VkBuffer GetSectorToLightListRegionDeviceLocalBuffer();
+    VkBuffer GetLightTreeNodesDeviceLocalBuffer();
+    VkBuffer GetSectorToLightTreeRootDeviceLocalBuffer();
+
+private:
+    struct LightVisibility
+    {
+        LightBounds bounds;
+        SectorArrayIndex lightSector;
+        // sectors, light lists of which contain the light, including 'lightSector'
+        std::vector<SectorArrayIndex> sectors;
+        uint64_t lastUsedFrame;
+    };
 
 private:
+    void CalculateLightVisibility(LightVisibility &dst, SectorArrayIndex lightSectorIndex,
+                                  PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn) const;
+    bool AreInsertedLightsSameAsPrev() const;
+    void ClearVisibilityCache();
+    void RemoveUnusedFromVisibilityCache();
+
     void AddLightToSectorLightList(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex);
+    void FillSectorLightLists();
 
     void BuildArrays(
         LightArrayIndex::index_t *pOutputPlainLightList, uint32_t *pOutputPlainLightListSize,
-        SectorArrayIndex::index_t *pOutputSectorToLightListStartEnd, uint32_t *pOutputSectorCountToCopy) const;
+        SectorArrayIndex::index_t *pOutputSectorToLightListStartEnd, uint32_t *pOutputSectorCountToCopy,
+        ShLightTreeNode *pOutputLightTreeNodes, uint32_t *pOutputLightTreeNodeCount,
+        uint32_t *pOutputSectorToLightTreeRoot) const;
+
+    // Reorders the given part of a plain light list, so each tree node references a contiguous range.
+    // Returns the index of the created node.
+    uint32_t BuildLightTreeNode(
+        LightArrayIndex::index_t *pPlainLightListPart, uint32_t plainLightListOffset, uint32_t lightCount,
+        ShLightTreeNode *pOutputLightTreeNodes, uint32_t *pOutputLightTreeNodeCount) const;
 
 private:
     std::shared_ptr<SectorVisibility> sectorVisibility;
@@ -71,12 +110,27 @@ private:
     // assume that it's indexed by 'SectorArrayIndex'
     std::array<std::vector<LightArrayIndex>, MAX_SECTOR_COUNT> lightLists;
 
+    rgl::unordered_map<UniqueLightID, std::unique_ptr<LightVisibility>> visibilityCache;
+    uint32_t visibilityCacheSectorVisibilityVersion;
+    uint64_t frameCounter;
+
+    // indexed by 'LightArrayIndex', point to 'visibilityCache' values
+    std::vector<const LightVisibility *> insertedLights;
+    std::vector<const LightVisibility *> insertedLightsPrev;
+    // if true, then light lists in device-local buffers must be rebuilt,
+    // otherwise, the lists are the same as in the previous frame
+    bool needRebuild;
+
     std::shared_ptr<AutoBuffer> plainLightList;
     std::shared_ptr<AutoBuffer> sectorToLightListRegion;
+    std::shared_ptr<AutoBuffer> lightTreeNodes;
+    std::shared_ptr<AutoBuffer> sectorToLightTreeRoot;
 
     // used to copy to mapped memory, to reduce interactions with mapped memory
     std::vector<LightArrayIndex::index_t> plainLightList_Raw;
     std::vector<SectorArrayIndex::index_t> sectorToLightListRegion_Raw;
+    std::vector<ShLightTreeNode> lightTreeNodes_Raw;
+    std::vector<uint32_t> sectorToLightTreeRoot_Raw;
 };
 
 }
\ No newline at end of file
@@ -20,6 +20,7 @@
 
 #include "LightManager.h"
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 
@@ -112,6 +113,58 @@ static void FillInfoPolygonal(const RgPolygonalLightUploadInfo &info, RTGL1::ShL
     memcpy(dst, &lt, sizeof(RTGL1::ShLightPolygonal));
 }
 
+static float GetLuminance(const RgFloat3D &c)
+{
+    return 0.2126f * c.data[0] + 0.7152f * c.data[1] + 0.0722f * c.data[2];
+}
+
+static RTGL1::LightBounds GetBoundsSpherical(const RTGL1::ShLightSpherical &lt)
+{
+    RTGL1::LightBounds b = {};
+
+    for (int i = 0; i < 3; i++)
+    {
+        b.boundsMin[i] = lt.position[i] - lt.radius;
+        b.boundsMax[i] = lt.position[i] + lt.radius;
+    }
+
+    // intensity of a spherical light doesn't depend on its radius
+    b.power = GetLuminance({ lt.color[0], lt.color[1], lt.color[2] });
+
+    return b;
+}
+
+static RTGL1::LightBounds GetBoundsPolygonal(const RgPolygonalLightUploadInfo &info)
+{
+    RTGL1::LightBounds b = {};
+
+    for (int i = 0; i < 3; i++)
+    {
+        b.boundsMin[i] = std::min({ info.positions[0].data[i], info.positions[1].data[i], info.positions[2].data[i] });
+        b.boundsMax[i] = std::max({ info.positions[0].data[i], info.positions[1].data[i], info.positions[2].data[i] });
+    }
+
+    const float *p0 = info.positions[0].data;
+    const float *p1 = info.positions[1].data;
+    const float *p2 = info.positions[2].data;
+
+    const float e1[] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const float e2[] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+    const float c[] = 
+    {
+        e1[1] * e2[2] - e1[2] * e2[1],
+        e1[2] * e2[0] - e1[0] * e2[2],
+        e1[0] * e2[1] - e1[1] * e2[0],
+    };
+
+    const float area = 0.5f * sqrtf(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+
+    b.power = GetLuminance(info.color) * area;
+
+    return b;
+}
+
 static void FillInfoDirectional(const RgDirectionalLightUploadInfo &info, RTGL1::ShGlobalUniform *dst)
 {
     memcpy(dst->directionalLightColor, info.color.data, sizeof(float) * 3);
@@ -251,7 +304,7 @@ void RTGL1::LightManager::AddSphericalLight(uint32_t frameIndex, const RgSpheric
     sphericalUniqueIDToPrevIndex[frameIndex][info.uniqueID] = index;
 
 
-    lightListsForSpherical->InsertLight(index, sectorArrayIndex,
+    lightListsForSpherical->InsertLight(index, info.uniqueID, GetBoundsSpherical(dst[index.GetArrayIndex()]), sectorArrayIndex,
                                         nullptr, nullptr);
 }
 
@@ -288,7 +341,7 @@ void RTGL1::LightManager::AddPolygonalLight(uint32_t frameIndex, const RgPolygon
     polygonalUniqueIDToPrevIndex[frameIndex][info.uniqueID] = index;
 
 
-    lightListsForPolygonal->InsertLight(index, sectorArrayIndex,
+    lightListsForPolygonal->InsertLight(index, info.uniqueID, GetBoundsPolygonal(info), sectorArrayIndex,
                                         info.pfnIsLightVisibleFromSector, info.pUserDataForPfn);
 }
 
@@ -414,6 +467,10 @@ constexpr uint32_t BINDINGS[] =
     BINDING_SECTOR_TO_LIGHT_LIST_REGION_POLY,
     BINDING_PLAIN_LIGHT_LIST_SPH,
     BINDING_SECTOR_TO_LIGHT_LIST_REGION_SPH,
+    BINDING_LIGHT_TREE_NODES_POLY,
+    BINDING_SECTOR_TO_LIGHT_TREE_ROOT_POLY,
+    BINDING_LIGHT_TREE_NODES_SPH,
+    BINDING_SECTOR_TO_LIGHT_TREE_ROOT_SPH,
 };
 
 void RTGL1::LightManager::CreateDescriptors()
@@ -493,6 +550,10 @@ void RTGL1::LightManager::UpdateDescriptors(uint32_t frameIndex)
         lightListsForPolygonal->GetSectorToLightListRegionDeviceLocalBuffer(),
         lightListsForSpherical->GetPlainLightListDeviceLocalBuffer(),
         lightListsForSpherical->GetSectorToLightListRegionDeviceLocalBuffer(),
+        lightListsForPolygonal->GetLightTreeNodesDeviceLocalBuffer(),
+        lightListsForPolygonal->GetSectorToLightTreeRootDeviceLocalBuffer(),
+        lightListsForSpherical->GetLightTreeNodesDeviceLocalBuffer(),
+        lightListsForSpherical->GetSectorToLightTreeRootDeviceLocalBuffer(),
     };
     static_assert(std::size(BINDINGS) == std::size(buffers), "");
 
@@ -0,0 +1,394 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+
+#include "Generated/ShaderCommonC.h"
+#include "CmdLabel.h"
+#include "Const.h"
+#include "Utils.h"
+
+
+// max amount of dispatches per frame, the rest will use blit
+constexpr uint32_t MAX_PASS_COUNT_PER_FRAME = 1024;
+constexpr uint32_t VIEWS_PER_PASS = COMPUTE_MIPMAP_LEVELS_PER_PASS + 1;
+constexpr uint32_t MAX_PASS_COUNT_PER_IMAGE = (MAX_PREGENERATED_MIPMAP_LEVELS - 1 + COMPUTE_MIPMAP_LEVELS_PER_PASS - 1) / COMPUTE_MIPMAP_LEVELS_PER_PASS;
+
+struct MipmapGenerationPush
+{
+    uint32_t sourceSize[2];
+    uint32_t dstLevelCount;
+    uint32_t isSRGB;
+};
+
+
+static VkFormat GetStorageFormat(VkFormat format)
+{
+    // sRGB formats are not supported by storage images,
+    // so the shader converts colors manually
+    switch (format)
+    {
+        case VK_FORMAT_R8G8B8A8_SRGB: return VK_FORMAT_R8G8B8A8_UNORM;
+        default: return format;
+    }
+}
+
+
+RTGL1::MipmapGenerator::MipmapGenerator(VkDevice _device, const std::shared_ptr<const ShaderManager> &_shaderManager)
+:
+    device(_device),
+    descSetLayout(VK_NULL_HANDLE),
+    descPools{},
+    usedDescSetCount{},
+    pipelineLayout(VK_NULL_HANDLE),
+    pipeline(VK_NULL_HANDLE)
+{
+    CreateDescriptors();
+    CreatePipelineLayout();
+    CreatePipelines(_shaderManager.get());
+}
+
+RTGL1::MipmapGenerator::~MipmapGenerator()
+{
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        for (VkImageView v : viewsToDestroy[i])
+        {
+            vkDestroyImageView(device, v, nullptr);
+        }
+
+        vkDestroyDescriptorPool(device, descPools[i], nullptr);
+    }
+
+    vkDestroyDescriptorSetLayout(device, descSetLayout, nullptr);
+
+    DestroyPipelines();
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+}
+
+void RTGL1::MipmapGenerator::PrepareForFrame(uint32_t frameIndex)
+{
+    for (VkImageView v : viewsToDestroy[frameIndex])
+    {
+        vkDestroyImageView(device, v, nullptr);
+    }
+    viewsToDestroy[frameIndex].clear();
+
+    if (usedDescSetCount[frameIndex] > 0)
+    {
+        VkResult r = vkResetDescriptorPool(device, descPools[frameIndex], 0);
+        VK_CHECKERROR(r);
+
+        usedDescSetCount[frameIndex] = 0;
+    }
+}
+
+bool RTGL1::MipmapGenerator::IsFormatSupported(VkFormat format)
+{
+    // storage image support for R8G8B8A8_UNORM is mandatory
+    return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+VkImageCreateFlags RTGL1::MipmapGenerator::GetRequiredImageCreateFlags(VkFormat format)
+{
+    // to create storage views with other format;
+    // storage usage is not supported by the image's own format, so it must be extended
+    return GetStorageFormat(format) != format ? 
+        VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT : 0;
+}
+
+VkImageUsageFlags RTGL1::MipmapGenerator::GetRequiredImageUsage()
+{
+    return VK_IMAGE_USAGE_STORAGE_BIT;
+}
+
+bool RTGL1::MipmapGenerator::Generate(
+    VkCommandBuffer cmd, uint32_t frameIndex,
+    VkImage image, VkFormat format, const RgExtent2D &baseSize, uint32_t mipmapCount,
+    VkAccessFlags firstMipAccessMask, VkImageLayout firstMipLayout, VkPipelineStageFlags firstMipStageMask)
+{
+    assert(IsFormatSupported(format));
+    assert(mipmapCount > 1);
+
+    const uint32_t passCount = Utils::GetWorkGroupCount(mipmapCount - 1, COMPUTE_MIPMAP_LEVELS_PER_PASS);
+
+    if (usedDescSetCount[frameIndex] + passCount > MAX_PASS_COUNT_PER_FRAME)
+    {
+        return false;
+    }
+
+    CmdLabel label(cmd, "Mipmap generation");
+
+
+    // allocate descriptor sets
+
+    VkDescriptorSetLayout layouts[MAX_PASS_COUNT_PER_IMAGE];
+    VkDescriptorSet sets[MAX_PASS_COUNT_PER_IMAGE];
+    assert(passCount <= MAX_PASS_COUNT_PER_IMAGE);
+
+    std::fill(layouts, layouts + passCount, descSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descPools[frameIndex];
+    allocInfo.descriptorSetCount = passCount;
+    allocInfo.pSetLayouts = layouts;
+
+    VkResult r = vkAllocateDescriptorSets(device, &allocInfo, sets);
+    VK_CHECKERROR(r);
+
+    usedDescSetCount[frameIndex] += passCount;
+
+
+    // create a view for each mip level and write them to the sets
+
+    VkImageView levelViews[MAX_PREGENERATED_MIPMAP_LEVELS];
+    assert(mipmapCount <= MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    for (uint32_t i = 0; i < mipmapCount; i++)
+    {
+        levelViews[i] = CreateLevelView(image, format, i);
+        viewsToDestroy[frameIndex].push_back(levelViews[i]);
+    }
+
+    for (uint32_t p = 0; p < passCount; p++)
+    {
+        const uint32_t srcLevel = p * COMPUTE_MIPMAP_LEVELS_PER_PASS;
+
+        VkDescriptorImageInfo imageInfos[VIEWS_PER_PASS] = {};
+
+        for (uint32_t i = 0; i < VIEWS_PER_PASS; i++)
+        {
+            // unused elements must be valid too, but they won't be accessed
+            imageInfos[i].imageView = levelViews[std::min(srcLevel + i, mipmapCount - 1)];
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        VkWriteDescriptorSet wrt = {};
+        wrt.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wrt.dstSet = sets[p];
+        wrt.dstBinding = BINDING_MIPMAP_LEVELS;
+        wrt.dstArrayElement = 0;
+        wrt.descriptorCount = VIEWS_PER_PASS;
+        wrt.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        wrt.pImageInfo = imageInfos;
+
+        vkUpdateDescriptorSets(device, 1, &wrt, 0, nullptr);
+    }
+
+
+    // all mipmaps to GENERAL
+
+    VkImageSubresourceRange firstMipmap = {};
+    firstMipmap.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    firstMipmap.baseMipLevel = 0;
+    firstMipmap.levelCount = 1;
+    firstMipmap.baseArrayLayer = 0;
+    firstMipmap.layerCount = 1;
+
+    VkImageSubresourceRange otherMipmaps = firstMipmap;
+    otherMipmaps.baseMipLevel = 1;
+    otherMipmaps.levelCount = mipmapCount - 1;
+
+    VkImageSubresourceRange allMipmaps = firstMipmap;
+    allMipmaps.levelCount = mipmapCount;
+
+    Utils::BarrierImage(
+        cmd, image,
+        firstMipAccessMask, VK_ACCESS_SHADER_READ_BIT,
+        firstMipLayout, VK_IMAGE_LAYOUT_GENERAL,
+        firstMipStageMask, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        firstMipmap);
+
+    Utils::BarrierImage(
+        cmd, image,
+        0, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        otherMipmaps);
+
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+    for (uint32_t p = 0; p < passCount; p++)
+    {
+        const uint32_t srcLevel = p * COMPUTE_MIPMAP_LEVELS_PER_PASS;
+
+        if (p > 0)
+        {
+            // wait for the previous pass, its last level is the source
+            Utils::BarrierImage(
+                cmd, image,
+                VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                allMipmaps);
+        }
+
+        MipmapGenerationPush push = {};
+        push.sourceSize[0] = std::max(baseSize.width >> srcLevel, 1u);
+        push.sourceSize[1] = std::max(baseSize.height >> srcLevel, 1u);
+        push.dstLevelCount = std::min<uint32_t>(mipmapCount - 1 - srcLevel, COMPUTE_MIPMAP_LEVELS_PER_PASS);
+        push.isSRGB = GetStorageFormat(format) != format;
+
+        vkCmdBindDescriptorSets(
+            cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+            0, 1, &sets[p],
+            0, nullptr);
+
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+
+        // each group covers (2 * COMPUTE_MIPMAP_GROUP_SIZE_X)^2 texels of the first destination level
+        const uint32_t firstDstWidth = std::max(push.sourceSize[0] >> 1, 1u);
+        const uint32_t firstDstHeight = std::max(push.sourceSize[1] >> 1, 1u);
+
+        vkCmdDispatch(
+            cmd,
+            Utils::GetWorkGroupCount(firstDstWidth, COMPUTE_MIPMAP_GROUP_SIZE_X * 2),
+            Utils::GetWorkGroupCount(firstDstHeight, COMPUTE_MIPMAP_GROUP_SIZE_X * 2),
+            1);
+    }
+
+
+    // prepare all mipmaps for reading in ray tracing and fragment shaders
+    Utils::BarrierImage(
+        cmd, image,
+        VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        allMipmaps);
+
+    return true;
+}
+
+void RTGL1::MipmapGenerator::OnShaderReload(const ShaderManager *shaderManager)
+{
+    DestroyPipelines();
+    CreatePipelines(shaderManager);
+}
+
+VkImageView RTGL1::MipmapGenerator::CreateLevelView(VkImage image, VkFormat format, uint32_t mipLevel)
+{
+    VkImageView view;
+
+    VkImageViewUsageCreateInfo usageInfo = {};
+    usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+    usageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT;
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.pNext = &usageInfo;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = GetStorageFormat(format);
+    viewInfo.components = {};
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = mipLevel;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VkResult r = vkCreateImageView(device, &viewInfo, nullptr, &view);
+    VK_CHECKERROR(r);
+
+    return view;
+}
+
+void RTGL1::MipmapGenerator::CreateDescriptors()
+{
+    VkResult r;
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = BINDING_MIPMAP_LEVELS;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    binding.descriptorCount = VIEWS_PER_PASS;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    r = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descSetLayout);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, descSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Mipmap generation Desc set layout");
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSize.descriptorCount = MAX_PASS_COUNT_PER_FRAME * VIEWS_PER_PASS;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = MAX_PASS_COUNT_PER_FRAME;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        r = vkCreateDescriptorPool(device, &poolInfo, nullptr, &descPools[i]);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, descPools[i], VK_OBJECT_TYPE_DESCRIPTOR_POOL, "Mipmap generation Desc pool");
+    }
+}
+
+void RTGL1::MipmapGenerator::CreatePipelineLayout()
+{
+    VkPushConstantRange push = {};
+    push.offset = 0;
+    push.size = sizeof(MipmapGenerationPush);
+    push.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkPipelineLayoutCreateInfo plLayoutInfo = {};
+    plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plLayoutInfo.setLayoutCount = 1;
+    plLayoutInfo.pSetLayouts = &descSetLayout;
+    plLayoutInfo.pushConstantRangeCount = 1;
+    plLayoutInfo.pPushConstantRanges = &push;
+
+    VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &pipelineLayout);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Mipmap generation pipeline layout");
+}
+
+void RTGL1::MipmapGenerator::CreatePipelines(const ShaderManager *shaderManager)
+{
+    assert(pipeline == VK_NULL_HANDLE);
+
+    VkComputePipelineCreateInfo plInfo = {};
+    plInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    plInfo.layout = pipelineLayout;
+    plInfo.stage = shaderManager->GetStageInfo("CMipmapGeneration");
+
+    VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipeline);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipeline, VK_OBJECT_TYPE_PIPELINE, "Mipmap generation pipeline");
+}
+
+void RTGL1::MipmapGenerator::DestroyPipelines()
+{
+    vkDestroyPipeline(device, pipeline, nullptr);
+    pipeline = VK_NULL_HANDLE;
+}
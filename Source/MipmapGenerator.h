@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "Common.h"
+#include "ShaderManager.h"
+#include "RTGL1/RTGL1.h"
+
+namespace RTGL1
+{
+
+// Generates mipmaps of a texture in compute shaders, one dispatch per
+// COMPUTE_MIPMAP_LEVELS_PER_PASS levels, instead of a blit per level.
+class MipmapGenerator final : public IShaderDependency
+{
+public:
+    MipmapGenerator(VkDevice device, const std::shared_ptr<const ShaderManager> &shaderManager);
+    ~MipmapGenerator() override;
+
+    MipmapGenerator(const MipmapGenerator &other) = delete;
+    MipmapGenerator(MipmapGenerator &&other) noexcept = delete;
+    MipmapGenerator &operator=(const MipmapGenerator &other) = delete;
+    MipmapGenerator &operator=(MipmapGenerator &&other) noexcept = delete;
+
+    // Free the resources that were used MAX_FRAMES_IN_FLIGHT ago.
+    void PrepareForFrame(uint32_t frameIndex);
+
+    static bool IsFormatSupported(VkFormat format);
+    // Flags for an image that will be passed to Generate.
+    static VkImageCreateFlags GetRequiredImageCreateFlags(VkFormat format);
+    static VkImageUsageFlags GetRequiredImageUsage();
+
+    // The first mipmap must contain the data and have the specified layout,
+    // the others are considered undefined. After the call, all mipmaps are
+    // prepared for reading in ray tracing and fragment shaders.
+    // Returns false, if nothing was recorded, because the limit for the current
+    // frame is reached; then mipmaps should be generated by other means.
+    bool Generate(
+        VkCommandBuffer cmd, uint32_t frameIndex,
+        VkImage image, VkFormat format, const RgExtent2D &baseSize, uint32_t mipmapCount,
+        VkAccessFlags firstMipAccessMask, VkImageLayout firstMipLayout, VkPipelineStageFlags firstMipStageMask);
+
+    void OnShaderReload(const ShaderManager *shaderManager) override;
+
+private:
+    void CreateDescriptors();
+    void CreatePipelineLayout();
+    void CreatePipelines(const ShaderManager *shaderManager);
+    void DestroyPipelines();
+
+    VkImageView CreateLevelView(VkImage image, VkFormat format, uint32_t mipLevel);
+
+private:
+    VkDevice device;
+
+    VkDescriptorSetLayout descSetLayout;
+    VkDescriptorPool descPools[MAX_FRAMES_IN_FLIGHT];
+    uint32_t usedDescSetCount[MAX_FRAMES_IN_FLIGHT];
+
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+
+    // views of single mip levels can be destroyed only
+    // when the frame's command buffer is not in use
+    std::vector<VkImageView> viewsToDestroy[MAX_FRAMES_IN_FLIGHT];
+};
+
+}
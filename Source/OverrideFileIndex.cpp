@@ -0,0 +1,80 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OverrideFileIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+RTGL1::OverrideFileIndex::OverrideFileIndex(const char *pFolderPath)
+:
+    folderPath(pFolderPath != nullptr && pFolderPath[0] != '\0' ? pFolderPath : ".")
+{
+    Rescan();
+}
+
+void RTGL1::OverrideFileIndex::Rescan()
+{
+    namespace fs = std::filesystem;
+
+    existingFiles.clear();
+
+    const fs::path root(folderPath);
+    std::error_code ec;
+
+    // if folder doesn't exist, there are no overrides
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+        {
+            continue;
+        }
+
+        existingFiles.insert(Normalize(it->path().lexically_relative(root).generic_string()));
+    }
+}
+
+bool RTGL1::OverrideFileIndex::Contains(const char *pRelativePath) const
+{
+    if (pRelativePath == nullptr || pRelativePath[0] == '\0')
+    {
+        return false;
+    }
+
+    return existingFiles.find(Normalize(pRelativePath)) != existingFiles.end();
+}
+
+std::string RTGL1::OverrideFileIndex::Normalize(std::string path)
+{
+    // relative paths from a user can have any delimiters
+    std::replace(path.begin(), path.end(), '\\', '/');
+
+    path = std::filesystem::path(path).lexically_normal().generic_string();
+
+#ifdef _WIN32
+    // file system is case-insensitive
+    std::transform(path.begin(), path.end(), path.begin(), [] (unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+
+    return path;
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+#include "Containers.h"
+
+namespace RTGL1
+{
+
+// Set of files that exist in the overriding textures folder, so override paths
+// can be checked without trying to open them. The folder is scanned with standard
+// methods, so it doesn't take into account files that are provided only by pfnOpenFile.
+class OverrideFileIndex
+{
+public:
+    explicit OverrideFileIndex(const char *pFolderPath);
+    ~OverrideFileIndex() = default;
+
+    OverrideFileIndex(const OverrideFileIndex &other) = delete;
+    OverrideFileIndex(OverrideFileIndex &&other) noexcept = delete;
+    OverrideFileIndex &operator=(const OverrideFileIndex &other) = delete;
+    OverrideFileIndex &operator=(OverrideFileIndex &&other) noexcept = delete;
+
+    // Scan the folder again, if files were added or removed.
+    void Rescan();
+
+    // 'pRelativePath' is relative to the indexed folder.
+    bool Contains(const char *pRelativePath) const;
+
+private:
+    static std::string Normalize(std::string path);
+
+private:
+    std::string folderPath;
+    rgl::unordered_set<std::string> existingFiles;
+};
+
+}
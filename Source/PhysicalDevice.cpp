@@ -28,7 +28,7 @@
 using namespace RTGL1;
 
 PhysicalDevice::PhysicalDevice(VkInstance instance)
-    : physDevice(VK_NULL_HANDLE), memoryProperties{}, rtPipelineProperties{}, asProperties{}
+    : physDevice(VK_NULL_HANDLE), properties{}, memoryProperties{}, rtPipelineProperties{}, asProperties{}
 {
     VkResult r;
 
@@ -67,6 +67,7 @@ PhysicalDevice::PhysicalDevice(VkInstance instance)
             rtPipelineProperties.pNext = &asProperties;
 
             vkGetPhysicalDeviceProperties2(physDevice, &deviceProp2);
+            properties = deviceProp2.properties;
             vkGetPhysicalDeviceMemoryProperties(physDevice, &memoryProperties);
 
             break;
@@ -84,6 +85,11 @@ VkPhysicalDevice PhysicalDevice::Get() const
     return physDevice;
 }
 
+const VkPhysicalDeviceProperties &PhysicalDevice::GetProperties() const
+{
+    return properties;
+}
+
 uint32_t PhysicalDevice::GetMemoryTypeIndex(uint32_t memoryTypeBits, VkFlags requirementsMask) const
 {
     VkMemoryPropertyFlags flagsToIgnore = 0;
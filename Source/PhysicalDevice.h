@@ -37,6 +37,7 @@ public:
     PhysicalDevice& operator=(PhysicalDevice&& other) noexcept = delete;
 
     VkPhysicalDevice Get() const;
+    const VkPhysicalDeviceProperties &GetProperties() const;
     uint32_t GetMemoryTypeIndex(uint32_t memoryTypeBits, VkFlags requirementsMask) const;
     const VkPhysicalDeviceMemoryProperties &GetMemoryProperties() const;
     const VkPhysicalDeviceRayTracingPipelinePropertiesKHR &GetRTPipelineProperties() const;
@@ -45,6 +46,7 @@ public:
 private:
     // selected physical device
     VkPhysicalDevice physDevice;
+    VkPhysicalDeviceProperties properties;
     VkPhysicalDeviceMemoryProperties memoryProperties;
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR rtPipelineProperties;
     VkPhysicalDeviceAccelerationStructurePropertiesKHR asProperties;
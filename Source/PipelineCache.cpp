@@ -0,0 +1,150 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PipelineCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace RTGL1;
+
+PipelineCache::PipelineCache(
+    VkDevice _device,
+    const std::shared_ptr<PhysicalDevice> &_physDevice,
+    const char *_pFilePath,
+    std::shared_ptr<UserFileLoad> _userFileLoad)
+:
+    device(_device),
+    userFileLoad(std::move(_userFileLoad)),
+    filePath(_pFilePath != nullptr ? _pFilePath : ""),
+    vendorID(_physDevice->GetProperties().vendorID),
+    deviceID(_physDevice->GetProperties().deviceID),
+    pipelineCacheUUID{},
+    pipelineCache(VK_NULL_HANDLE)
+{
+    static_assert(sizeof(pipelineCacheUUID) == sizeof(VkPhysicalDeviceProperties::pipelineCacheUUID), "");
+    memcpy(pipelineCacheUUID, _physDevice->GetProperties().pipelineCacheUUID, VK_UUID_SIZE);
+
+    pipelineCache = CreateFromFile();
+    SET_DEBUG_NAME(device, pipelineCache, VK_OBJECT_TYPE_PIPELINE_CACHE, "Pipeline cache");
+}
+
+PipelineCache::~PipelineCache()
+{
+    Save();
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+}
+
+VkPipelineCache PipelineCache::Get() const
+{
+    return pipelineCache;
+}
+
+VkPipelineCache PipelineCache::CreateFromFile()
+{
+    if (filePath.empty())
+    {
+        return CreateFromMemory(nullptr, 0);
+    }
+
+    if (userFileLoad->Exists())
+    {
+        auto fileHandle = userFileLoad->Open(filePath.c_str());
+
+        if (fileHandle.Contains() && IsDataCompatible(fileHandle.pData, fileHandle.dataSize))
+        {
+            return CreateFromMemory(fileHandle.pData, fileHandle.dataSize);
+        }
+    }
+    else
+    {
+        std::ifstream file(filePath, std::ios::binary);
+        std::vector<uint8_t> data(std::istreambuf_iterator<char>(file), {});
+
+        if (!data.empty() && IsDataCompatible(data.data(), data.size()))
+        {
+            return CreateFromMemory(data.data(), data.size());
+        }
+    }
+
+    // file doesn't exist or it was created by other device / driver version
+    return CreateFromMemory(nullptr, 0);
+}
+
+VkPipelineCache PipelineCache::CreateFromMemory(const void *pData, size_t dataSize) const
+{
+    VkPipelineCacheCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = dataSize;
+    info.pInitialData = pData;
+
+    VkPipelineCache cache;
+
+    VkResult r = vkCreatePipelineCache(device, &info, nullptr, &cache);
+    VK_CHECKERROR(r);
+
+    return cache;
+}
+
+bool PipelineCache::IsDataCompatible(const void *pData, size_t dataSize) const
+{
+    VkPipelineCacheHeaderVersionOne header = {};
+
+    if (dataSize < sizeof(header))
+    {
+        return false;
+    }
+
+    // data can be unaligned
+    memcpy(&header, pData, sizeof(header));
+
+    return 
+        header.headerSize >= sizeof(header) &&
+        header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+        header.vendorID == vendorID &&
+        header.deviceID == deviceID &&
+        memcmp(header.pipelineCacheUUID, pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::Save() const
+{
+    if (filePath.empty() || pipelineCache == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    size_t dataSize = 0;
+    VkResult r = vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr);
+    VK_CHECKERROR(r);
+
+    if (dataSize == 0)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> data(dataSize);
+    r = vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data());
+    VK_CHECKERROR(r);
+
+    // it's only a cache, so failure to write is not an error
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(dataSize));
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+#include "Common.h"
+#include "PhysicalDevice.h"
+#include "UserFunction.h"
+
+namespace RTGL1
+{
+
+// Device-wide VkPipelineCache. Initial data is loaded from a file,
+// if its header matches the current physical device; the data is written
+// back to the same file on destruction.
+class PipelineCache
+{
+public:
+    explicit PipelineCache(
+        VkDevice device, 
+        const std::shared_ptr<PhysicalDevice> &physDevice,
+        const char *pFilePath,
+        std::shared_ptr<UserFileLoad> userFileLoad);
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache &other) = delete;
+    PipelineCache(PipelineCache &&other) noexcept = delete;
+    PipelineCache &operator=(const PipelineCache &other) = delete;
+    PipelineCache &operator=(PipelineCache &&other) noexcept = delete;
+
+    VkPipelineCache Get() const;
+
+    // Write cache data to the file. Safe to call, if file path wasn't specified.
+    void Save() const;
+
+private:
+    bool IsDataCompatible(const void *pData, size_t dataSize) const;
+    VkPipelineCache CreateFromFile();
+    VkPipelineCache CreateFromMemory(const void *pData, size_t dataSize) const;
+
+private:
+    VkDevice device;
+    std::shared_ptr<UserFileLoad> userFileLoad;
+    std::string filePath;
+
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+
+    VkPipelineCache pipelineCache;
+};
+
+}
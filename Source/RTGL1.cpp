@@ -124,6 +124,15 @@ RgResult rgUploadGeometry(RgInstance rgInstance, const RgGeometryUploadInfo *pUp
     CATCH_OR_RETURN;
 }
 
+RgResult rgReserveDynamicGeometry(RgInstance rgInstance, uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->ReserveDynamicGeometry(vertexCount, indexCount, pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgUpdateGeometryTransform(RgInstance rgInstance, const RgUpdateTransformInfo* pUpdateInfo)
 {
     try
@@ -142,6 +151,78 @@ RgResult rgUpdateGeometryTexCoords(RgInstance rgInstance, const RgUpdateTexCoord
     CATCH_OR_RETURN;
 }
 
+RgResult rgUploadMeshInstance(RgInstance rgInstance, const RgMeshInstanceUploadInfo *pUploadInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->UploadMeshInstance(pUploadInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgCreateSkinnedMesh(RgInstance rgInstance, const RgSkinnedMeshCreateInfo *pCreateInfo, RgSkinnedMesh *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->CreateSkinnedMesh(pCreateInfo, pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgDestroySkinnedMesh(RgInstance rgInstance, RgSkinnedMesh skinnedMesh)
+{
+    try
+    {
+        GetDevice(rgInstance)->DestroySkinnedMesh(skinnedMesh);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgUploadSkinnedGeometry(RgInstance rgInstance, const RgSkinnedGeometryUploadInfo *pUploadInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->UploadSkinnedGeometry(pUploadInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgCreateRetainedGeometry(RgInstance rgInstance, const RgGeometryUploadInfo *pCreateInfo, RgRetainedGeometry *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->CreateRetainedGeometry(pCreateInfo, pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgDestroyRetainedGeometry(RgInstance rgInstance, RgRetainedGeometry retainedGeometry)
+{
+    try
+    {
+        GetDevice(rgInstance)->DestroyRetainedGeometry(retainedGeometry);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgUpdateRetainedGeometryTransform(RgInstance rgInstance, RgRetainedGeometry retainedGeometry, const RgTransform *pTransform)
+{
+    try
+    {
+        GetDevice(rgInstance)->UpdateRetainedGeometryTransform(retainedGeometry, pTransform);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgUpdateRetainedGeometryVertices(RgInstance rgInstance, const RgUpdateRetainedVerticesInfo *pUpdateInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->UpdateRetainedGeometryVertices(pUpdateInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgUploadRasterizedGeometry(RgInstance rgInstance, const RgRasterizedGeometryUploadInfo *pUploadInfo, 
                                     const float *pViewProjection, const RgViewport *pViewport)
 {
@@ -189,6 +270,24 @@ RgResult rgStartNewScene(RgInstance rgInstance)
     CATCH_OR_RETURN;
 }
 
+RgResult rgAddStaticGeometry(RgInstance rgInstance, const RgGeometryUploadInfo *pUploadInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->AddStaticGeometry(pUploadInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgRemoveStaticGeometry(RgInstance rgInstance, uint64_t staticUniqueID)
+{
+    try
+    {
+        GetDevice(rgInstance)->RemoveStaticGeometry(staticUniqueID);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgUploadDirectionalLight(RgInstance rgInstance, const RgDirectionalLightUploadInfo *pLightInfo)
 {
     try
@@ -285,6 +384,15 @@ RgResult rgDestroyMaterial(RgInstance rgInstance, RgMaterial material)
     CATCH_OR_RETURN;
 }
 
+RgResult rgRescanOverridenTexturesFolder(RgInstance rgInstance)
+{
+    try
+    {
+        GetDevice(rgInstance)->RescanOverridenTexturesFolder();
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgCreateCubemap(RgInstance rgInstance, const RgCubemapCreateInfo *pCreateInfo, RgCubemap *pResult)
 {
     *pResult = RG_EMPTY_CUBEMAP;
@@ -331,6 +439,24 @@ RgResult rgIsRenderUpscaleTechniqueAvailable(RgInstance rgInstance, RgRenderUpsc
     CATCH_OR_RETURN;
 }
 
+RgResult rgGetStatistics(RgInstance rgInstance, RgStatistics *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetStatistics(pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetFrameTimings(RgInstance rgInstance, RgFrameTimings *pResult)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetFrameTimings(pResult);
+    }
+    CATCH_OR_RETURN;
+}
+
 
 const char *rgGetResultDescription(RgResult result)
 {
@@ -345,3 +471,12 @@ RgResult rgSetPotentialVisibility(RgInstance rgInstance, uint32_t sectorID_A, ui
     }
     CATCH_OR_RETURN;
 }
+
+RgResult rgSetPotentialVisibilityMatrix(RgInstance rgInstance, const RgPotentialVisibilityMatrixInfo *pInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->SetPotentialVisibility(pInfo);
+    }
+    CATCH_OR_RETURN;
+}
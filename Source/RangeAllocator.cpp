@@ -0,0 +1,107 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "RangeAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+RTGL1::RangeAllocator::RangeAllocator(uint32_t _capacity) : capacity(_capacity)
+{
+    Reset();
+}
+
+bool RTGL1::RangeAllocator::Allocate(uint32_t count, uint32_t *pOutFirst)
+{
+    if (count == 0)
+    {
+        *pOutFirst = 0;
+        return true;
+    }
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+    {
+        if (it->count >= count)
+        {
+            *pOutFirst = it->first;
+
+            it->first += count;
+            it->count -= count;
+
+            if (it->count == 0)
+            {
+                freeRanges.erase(it);
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void RTGL1::RangeAllocator::Free(uint32_t first, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    assert((uint64_t)first + count <= capacity);
+
+    auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), first,
+                                 [] (const Range &r, uint32_t f) { return r.first < f; });
+
+    auto it = freeRanges.insert(next, { first, count });
+
+    // merge with the next one
+    auto after = it + 1;
+    if (after != freeRanges.end() && it->first + it->count == after->first)
+    {
+        it->count += after->count;
+        it = freeRanges.erase(after) - 1;
+    }
+
+    // merge with the previous one
+    if (it != freeRanges.begin())
+    {
+        auto before = it - 1;
+
+        if (before->first + before->count == it->first)
+        {
+            before->count += it->count;
+            freeRanges.erase(it);
+        }
+    }
+}
+
+void RTGL1::RangeAllocator::Reset()
+{
+    freeRanges.clear();
+
+    if (capacity > 0)
+    {
+        freeRanges.push_back({ 0, capacity });
+    }
+}
+
+uint32_t RTGL1::RangeAllocator::GetCapacity() const
+{
+    return capacity;
+}
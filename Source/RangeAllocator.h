@@ -0,0 +1,57 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace RTGL1
+{
+
+// First fit allocator of ranges in [0, capacity),
+// e.g. of vertices or indices in a buffer.
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(uint32_t capacity);
+
+    // Returns false, if there's no free range of the given size
+    bool Allocate(uint32_t count, uint32_t *pOutFirst);
+    void Free(uint32_t first, uint32_t count);
+    // Make the whole capacity free
+    void Reset();
+
+    uint32_t GetCapacity() const;
+
+private:
+    struct Range
+    {
+        uint32_t    first;
+        uint32_t    count;
+    };
+
+private:
+    uint32_t capacity;
+    // sorted by "first", adjacent ranges are always merged
+    std::vector<Range> freeRanges;
+};
+
+}
@@ -225,12 +225,6 @@ RTGL1::RasterizerPipelines::RasterizerPipelines(
     applyVertexColorGamma(_applyVertexColorGamma)
 {
     assert(TestFlags());
-
-    VkPipelineCacheCreateInfo info = {};
-    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-
-    VkResult r = vkCreatePipelineCache(device, &info, nullptr, &pipelineCache);
-    VK_CHECKERROR(r);
 }
 
 RTGL1::RasterizerPipelines::~RasterizerPipelines()
@@ -239,8 +233,6 @@ RTGL1::RasterizerPipelines::~RasterizerPipelines()
     {
         vkDestroyPipeline(device, p.second, nullptr);
     }
-
-    vkDestroyPipelineCache(device, pipelineCache, nullptr);
 }
 
 void RTGL1::RasterizerPipelines::Clear()
@@ -257,6 +249,7 @@ void RTGL1::RasterizerPipelines::SetShaders(const ShaderManager *shaderManager,
 {
     vertShaderStage         = shaderManager->GetStageInfo(vertexShaderName);
     fragShaderStage         = shaderManager->GetStageInfo(fragmentShaderName);
+    pipelineCache           = shaderManager->GetPipelineCache();
 }
 
 void RTGL1::RasterizerPipelines::DisableDynamicState(const VkViewport &viewport, const VkRect2D &scissors)
@@ -197,7 +197,7 @@ void RayTracingPipeline::CreatePipeline(const ShaderManager *shaderManager)
     pipelineInfo.layout = rtPipelineLayout;
     pipelineInfo.pLibraryInfo = &libInfo;
 
-    VkResult r = svkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &rtPipeline);
+    VkResult r = svkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, shaderManager->GetPipelineCache(), 1, &pipelineInfo, nullptr, &rtPipeline);
     VK_CHECKERROR(r);
 
     SET_DEBUG_NAME(device, rtPipeline, VK_OBJECT_TYPE_PIPELINE, "Ray tracing pipeline");
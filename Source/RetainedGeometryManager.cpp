@@ -0,0 +1,422 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "RetainedGeometryManager.h"
+
+#include <cstring>
+
+#include "Generated/ShaderCommonC.h"
+#include "CmdLabel.h"
+#include "RgException.h"
+
+using namespace RTGL1;
+
+constexpr uint32_t MAX_RETAINED_VERTEX_COUNT = 1 << 20;
+constexpr uint32_t MAX_RETAINED_INDEX_COUNT = 1 << 22;
+
+RetainedGeometryManager::RetainedGeometryManager(
+    VkDevice _device,
+    const std::shared_ptr<MemoryAllocator> &_allocator,
+    const std::shared_ptr<const ASManager> &_asManager,
+    const VertexBufferProperties &_properties)
+:
+    device(_device),
+    allocator(_allocator),
+    properties(_properties),
+    dynamicVertexBuffer(_asManager->GetDynamicVertexBuffer()),
+    dynamicIndexBuffer(_asManager->GetDynamicIndexBuffer()),
+    normalsOffset(0),
+    texCoordsOffset(0),
+    vertexAllocator(MAX_RETAINED_VERTEX_COUNT),
+    indexAllocator(MAX_RETAINED_INDEX_COUNT),
+    geomCounter(0)
+{
+    normalsOffset = (VkDeviceSize)MAX_RETAINED_VERTEX_COUNT * properties.positionStride;
+    texCoordsOffset = normalsOffset + (VkDeviceSize)MAX_RETAINED_VERTEX_COUNT * properties.normalStride;
+
+    const VkDeviceSize vertexBufferSize = texCoordsOffset + (VkDeviceSize)MAX_RETAINED_VERTEX_COUNT * properties.texCoordStride;
+
+    vertexBuffer.Init(
+        allocator, vertexBufferSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Retained geometry vertex buffer");
+
+    indexBuffer.Init(
+        allocator, MAX_RETAINED_INDEX_COUNT * sizeof(uint32_t),
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Retained geometry index buffer");
+}
+
+RetainedGeometryManager::~RetainedGeometryManager()
+{}
+
+void RetainedGeometryManager::PrepareForFrame(uint32_t frameIndex)
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    for (const Geometry &g : geometriesToFree[frameIndex])
+    {
+        vertexAllocator.Free(g.vertices.first, g.vertices.count);
+        indexAllocator.Free(g.indices.first, g.indices.count);
+    }
+    geometriesToFree[frameIndex].clear();
+
+    // buffers are destroyed in destructors
+    stagingToFree[frameIndex].clear();
+
+    instances.clear();
+}
+
+RgRetainedGeometry RetainedGeometryManager::Create(const RgGeometryUploadInfo &info)
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    Geometry geom = {};
+    geom.info = info;
+    geom.hasNormals = info.pNormalData != nullptr;
+
+    if (!vertexAllocator.Allocate(info.vertexCount, &geom.vertices.first))
+    {
+        throw RgException(RG_CANT_CREATE_RETAINED_GEOMETRY, "Not enough space for retained geometry vertices, MAX_RETAINED_VERTEX_COUNT is " + std::to_string(MAX_RETAINED_VERTEX_COUNT));
+    }
+    geom.vertices.count = info.vertexCount;
+
+    if (info.pIndexData != nullptr && info.indexCount > 0)
+    {
+        if (!indexAllocator.Allocate(info.indexCount, &geom.indices.first))
+        {
+            vertexAllocator.Free(geom.vertices.first, geom.vertices.count);
+            throw RgException(RG_CANT_CREATE_RETAINED_GEOMETRY, "Not enough space for retained geometry indices, MAX_RETAINED_INDEX_COUNT is " + std::to_string(MAX_RETAINED_INDEX_COUNT));
+        }
+        geom.indices.count = info.indexCount;
+    }
+
+    if (info.pTriangleSectorIDs != nullptr)
+    {
+        const uint32_t triangleCount = (geom.indices.count > 0 ? geom.indices.count : geom.vertices.count) / 3;
+        geom.triangleSectorIDs.assign(info.pTriangleSectorIDs, info.pTriangleSectorIDs + triangleCount);
+    }
+
+    QueueUpload(geom, info.pVertexData, info.pNormalData, info.pTexCoordLayerData[0], info.pIndexData);
+
+    // don't keep user's pointers
+    geom.info.flags &= ~RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT;
+    geom.info.pVertexData = nullptr;
+    geom.info.pNormalData = nullptr;
+    geom.info.pTexCoordLayerData[0] = nullptr;
+    geom.info.pTexCoordLayerData[1] = nullptr;
+    geom.info.pTexCoordLayerData[2] = nullptr;
+    geom.info.indexCount = geom.indices.count;
+    geom.info.pIndexData = nullptr;
+    geom.info.pTriangleSectorIDs = nullptr;
+
+    // 0 is RG_NO_RETAINED_GEOMETRY
+    const RgRetainedGeometry handle = ++geomCounter;
+    uniqueIDs.insert(geom.info.uniqueID);
+    geometries[handle] = std::move(geom);
+
+    return handle;
+}
+
+void RetainedGeometryManager::Destroy(uint32_t frameIndex, RgRetainedGeometry handle)
+{
+    if (handle == RG_NO_RETAINED_GEOMETRY)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    auto found = geometries.find(handle);
+
+    if (found == geometries.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Retained geometry with ID=" + std::to_string(handle) + " doesn't exist");
+    }
+
+    uniqueIDs.erase(found->second.info.uniqueID);
+
+    // the ranges could be read in the current frame
+    geometriesToFree[frameIndex].push_back(std::move(found->second));
+    geometries.erase(found);
+}
+
+void RetainedGeometryManager::UpdateTransform(RgRetainedGeometry handle, const RgTransform &transform)
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    auto found = geometries.find(handle);
+
+    if (found == geometries.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Retained geometry with ID=" + std::to_string(handle) + " doesn't exist");
+    }
+
+    found->second.info.transform = transform;
+}
+
+void RetainedGeometryManager::UpdateVertices(const RgUpdateRetainedVerticesInfo &updateInfo)
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    auto found = geometries.find(updateInfo.retainedGeometry);
+
+    if (found == geometries.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Retained geometry with ID=" + std::to_string(updateInfo.retainedGeometry) + " doesn't exist");
+    }
+
+    Geometry &geom = found->second;
+
+    // if normals were generated, then use the provided ones from now on
+    if (updateInfo.pNormalData != nullptr)
+    {
+        geom.hasNormals = true;
+    }
+
+    QueueUpload(geom, updateInfo.pVertexData, updateInfo.pNormalData, updateInfo.pTexCoordData, nullptr);
+}
+
+bool RetainedGeometryManager::DoesUniqueIDExist(uint64_t uniqueID) const
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    return uniqueIDs.find(uniqueID) != uniqueIDs.end();
+}
+
+void RetainedGeometryManager::QueueUpload(const Geometry &geom,
+                                          const void *pVertexData, const void *pNormalData, const void *pTexCoordData,
+                                          const void *pIndexData)
+{
+    const uint32_t vertexCount = geom.vertices.count;
+    const uint32_t indexCount = pIndexData != nullptr ? geom.indices.count : 0;
+
+    struct Region
+    {
+        const void      *src;
+        VkDeviceSize    size;
+        VkDeviceSize    dstOffset;
+        bool            isIndex;
+    };
+
+    const Region regions[] =
+    {
+        { pVertexData,      (VkDeviceSize)vertexCount * properties.positionStride,  0               + (VkDeviceSize)geom.vertices.first * properties.positionStride, false },
+        { pNormalData,      (VkDeviceSize)vertexCount * properties.normalStride,    normalsOffset   + (VkDeviceSize)geom.vertices.first * properties.normalStride,   false },
+        { pTexCoordData,    (VkDeviceSize)vertexCount * properties.texCoordStride,  texCoordsOffset + (VkDeviceSize)geom.vertices.first * properties.texCoordStride, false },
+        { pIndexData,       (VkDeviceSize)indexCount * sizeof(uint32_t),            (VkDeviceSize)geom.indices.first * sizeof(uint32_t),                             true  },
+    };
+
+    VkDeviceSize stagingSize = 0;
+
+    for (const Region &r : regions)
+    {
+        if (r.src != nullptr)
+        {
+            stagingSize += r.size;
+        }
+    }
+
+    if (stagingSize == 0)
+    {
+        return;
+    }
+
+    Upload upload = {};
+    upload.staging = std::make_unique<Buffer>();
+    upload.staging->Init(
+        allocator, stagingSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        "Retained geometry staging buffer");
+
+    auto *mapped = static_cast<uint8_t *>(upload.staging->Map());
+    VkDeviceSize offset = 0;
+
+    for (const Region &r : regions)
+    {
+        if (r.src == nullptr || r.size == 0)
+        {
+            continue;
+        }
+
+        memcpy(mapped + offset, r.src, r.size);
+
+        VkBufferCopy cp = {};
+        cp.srcOffset = offset;
+        cp.dstOffset = r.dstOffset;
+        cp.size = r.size;
+
+        (r.isIndex ? upload.toIndices : upload.toVertices).push_back(cp);
+
+        offset += r.size;
+    }
+
+    upload.staging->Unmap();
+
+    pendingUploads.push_back(std::move(upload));
+}
+
+void RetainedGeometryManager::AddToFrame(uint32_t frameIndex, const std::shared_ptr<ASManager> &asManager)
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    for (const auto &p : geometries)
+    {
+        const Geometry &geom = p.second;
+
+        RgGeometryUploadInfo info = geom.info;
+        info.pTriangleSectorIDs = geom.triangleSectorIDs.empty() ? nullptr : geom.triangleSectorIDs.data();
+
+        Instance inst = {};
+        inst.srcVertices = geom.vertices;
+        inst.srcIndices = geom.indices;
+        inst.hasNormals = geom.hasNormals;
+
+        uint32_t simpleIndex = asManager->AddDeviceWrittenDynamicGeometry(frameIndex, info, !geom.hasNormals, inst.dst);
+
+        if (simpleIndex != UINT32_MAX)
+        {
+            instances.push_back(inst);
+        }
+    }
+}
+
+void RetainedGeometryManager::CopyToDynamic(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    std::lock_guard<std::mutex> lock(geometriesMutex);
+
+    if (pendingUploads.empty() && instances.empty())
+    {
+        return;
+    }
+
+    CmdLabel label(cmd, "Retained geometry");
+
+
+    if (!pendingUploads.empty())
+    {
+        // previous frames could read the ranges that are rewritten
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0, nullptr,
+            0, nullptr,
+            0, nullptr);
+
+        for (Upload &u : pendingUploads)
+        {
+            if (!u.toVertices.empty())
+            {
+                vkCmdCopyBuffer(cmd, u.staging->GetBuffer(), vertexBuffer.GetBuffer(), u.toVertices.size(), u.toVertices.data());
+            }
+
+            if (!u.toIndices.empty())
+            {
+                vkCmdCopyBuffer(cmd, u.staging->GetBuffer(), indexBuffer.GetBuffer(), u.toIndices.size(), u.toIndices.data());
+            }
+
+            // free when this frame's command buffer is not in use
+            stagingToFree[frameIndex].push_back(std::move(u.staging));
+        }
+        pendingUploads.clear();
+
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+    }
+
+
+    if (instances.empty())
+    {
+        return;
+    }
+
+    std::vector<VkBufferCopy> vertCopies;
+    std::vector<VkBufferCopy> indexCopies;
+
+    for (const Instance &inst : instances)
+    {
+        const VkDeviceSize srcFirst = inst.srcVertices.first;
+        const VkDeviceSize dstFirst = inst.dst.firstVertex;
+        const VkDeviceSize count = inst.dst.vertexCount;
+
+        vertCopies.push_back({
+            srcFirst * properties.positionStride,
+            offsetof(ShVertexBufferDynamic, positions) + dstFirst * properties.positionStride,
+            count * properties.positionStride });
+
+        // otherwise, they'll be generated in vertex preprocessing
+        if (inst.hasNormals)
+        {
+            vertCopies.push_back({
+                normalsOffset + srcFirst * properties.normalStride,
+                offsetof(ShVertexBufferDynamic, normals) + dstFirst * properties.normalStride,
+                count * properties.normalStride });
+        }
+
+        vertCopies.push_back({
+            texCoordsOffset + srcFirst * properties.texCoordStride,
+            offsetof(ShVertexBufferDynamic, texCoords) + dstFirst * properties.texCoordStride,
+            count * properties.texCoordStride });
+
+        if (inst.dst.indexCount > 0)
+        {
+            indexCopies.push_back({
+                (VkDeviceSize)inst.srcIndices.first * sizeof(uint32_t),
+                (VkDeviceSize)inst.dst.firstIndex * sizeof(uint32_t),
+                (VkDeviceSize)inst.dst.indexCount * sizeof(uint32_t) });
+        }
+    }
+
+    vkCmdCopyBuffer(cmd, vertexBuffer.GetBuffer(), dynamicVertexBuffer, vertCopies.size(), vertCopies.data());
+
+    if (!indexCopies.empty())
+    {
+        vkCmdCopyBuffer(cmd, indexBuffer.GetBuffer(), dynamicIndexBuffer, indexCopies.size(), indexCopies.data());
+    }
+
+
+    // copied data is used in BLAS building and vertex preprocessing
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ASManager.h"
+#include "Buffer.h"
+#include "Containers.h"
+#include "RangeAllocator.h"
+#include "VertexBufferProperties.h"
+#include "VertexCollector.h"
+
+namespace RTGL1
+{
+
+// Retained geometry is dynamic geometry that persists between frames.
+// Its vertices and indices are stored in device-local buffers, and each frame
+// they're copied device-to-device to the ranges that were reserved in the dynamic buffers.
+// So only transforms are uploaded, and previous frame data is matched
+// by unique ID, as for usual dynamic geometry.
+class RetainedGeometryManager
+{
+public:
+    explicit RetainedGeometryManager(
+        VkDevice device,
+        const std::shared_ptr<MemoryAllocator> &allocator,
+        const std::shared_ptr<const ASManager> &asManager,
+        const VertexBufferProperties &properties);
+    ~RetainedGeometryManager();
+
+    RetainedGeometryManager(const RetainedGeometryManager &other) = delete;
+    RetainedGeometryManager(RetainedGeometryManager &&other) noexcept = delete;
+    RetainedGeometryManager &operator=(const RetainedGeometryManager &other) = delete;
+    RetainedGeometryManager &operator=(RetainedGeometryManager &&other) noexcept = delete;
+
+    // Free staging buffers and ranges of geometry that were destroyed MAX_FRAMES_IN_FLIGHT ago.
+    void PrepareForFrame(uint32_t frameIndex);
+
+    // Data is copied to device-local memory at the end of the current frame.
+    RgRetainedGeometry Create(const RgGeometryUploadInfo &info);
+    void Destroy(uint32_t frameIndex, RgRetainedGeometry geom);
+    void UpdateTransform(RgRetainedGeometry geom, const RgTransform &transform);
+    void UpdateVertices(const RgUpdateRetainedVerticesInfo &updateInfo);
+
+    bool DoesUniqueIDExist(uint64_t uniqueID) const;
+
+    // Add all retained geometry to the current frame's dynamic geometry.
+    // Must be called before dynamic geometry is copied from staging.
+    void AddToFrame(uint32_t frameIndex, const std::shared_ptr<ASManager> &asManager);
+    // Must be called after dynamic geometry is copied from staging,
+    // but before dynamic BLAS are built.
+    void CopyToDynamic(VkCommandBuffer cmd, uint32_t frameIndex);
+
+private:
+    struct Range
+    {
+        uint32_t    first;
+        uint32_t    count;
+    };
+
+    struct Geometry
+    {
+        // pointers to vertex data are null
+        RgGeometryUploadInfo    info;
+        std::vector<uint32_t>   triangleSectorIDs;
+        Range                   vertices;
+        Range                   indices;
+        bool                    hasNormals;
+    };
+
+    struct Instance
+    {
+        Range       srcVertices;
+        Range       srcIndices;
+        bool        hasNormals;
+        VertexCollector::DeviceWrittenRange dst;
+    };
+
+    struct Upload
+    {
+        std::unique_ptr<Buffer>     staging;
+        std::vector<VkBufferCopy>   toVertices;
+        std::vector<VkBufferCopy>   toIndices;
+    };
+
+private:
+    // Null pointers are ignored
+    void QueueUpload(const Geometry &geom,
+                     const void *pVertexData, const void *pNormalData, const void *pTexCoordData,
+                     const void *pIndexData);
+
+private:
+    VkDevice device;
+    std::shared_ptr<MemoryAllocator> allocator;
+    VertexBufferProperties properties;
+
+    VkBuffer dynamicVertexBuffer;
+    VkBuffer dynamicIndexBuffer;
+
+    // same layout as ShVertexBufferDynamic, but with its own capacity
+    Buffer vertexBuffer;
+    Buffer indexBuffer;
+    VkDeviceSize normalsOffset;
+    VkDeviceSize texCoordsOffset;
+
+    RangeAllocator vertexAllocator;
+    RangeAllocator indexAllocator;
+
+    rgl::unordered_map<RgRetainedGeometry, Geometry> geometries;
+    rgl::unordered_set<uint64_t> uniqueIDs;
+    uint32_t geomCounter;
+    mutable std::mutex geometriesMutex;
+
+    // ranges can be reused only when the frame's command buffer is not in use
+    std::vector<Geometry> geometriesToFree[MAX_FRAMES_IN_FLIGHT];
+
+    std::vector<Upload> pendingUploads;
+    std::vector<std::unique_ptr<Buffer>> stagingToFree[MAX_FRAMES_IN_FLIGHT];
+
+    std::vector<Instance> instances;
+};
+
+}
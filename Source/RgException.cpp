@@ -45,6 +45,13 @@ const char* RTGL1::RgException::GetRgResultName(RgResult r)
         case RG_ERROR_INCORRECT_SECTOR: return "RG_ERROR_INCORRECT_SECTOR";
         case RG_ERROR_CANT_FIND_BLUE_NOISE: return "RG_ERROR_CANT_FIND_BLUE_NOISE";
         case RG_ERROR_CANT_FIND_WATER_TEXTURES: return "RG_ERROR_CANT_FIND_WATER_TEXTURES";
+        case RG_CANT_RESERVE_DYNAMIC_GEOMETRY: return "RG_CANT_RESERVE_DYNAMIC_GEOMETRY";
+        case RG_CANT_CREATE_SKINNED_MESH: return "RG_CANT_CREATE_SKINNED_MESH";
+        case RG_CANT_CREATE_RETAINED_GEOMETRY: return "RG_CANT_CREATE_RETAINED_GEOMETRY";
+        case RG_CANT_ADD_STATIC_GEOMETRY: return "RG_CANT_ADD_STATIC_GEOMETRY";
+        case RG_CANT_REMOVE_STATIC_GEOMETRY: return "RG_CANT_REMOVE_STATIC_GEOMETRY";
+        case RG_CANT_UPLOAD_MESH_INSTANCE: return "RG_CANT_UPLOAD_MESH_INSTANCE";
+        case RG_TOO_MANY_TEXTURES: return "RG_TOO_MANY_TEXTURES";
         default: assert(0); return "Unknown RgResult";
     }
 }
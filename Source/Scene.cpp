@@ -33,11 +33,13 @@ Scene::Scene(
     std::shared_ptr<TextureManager> &_textureManager,
     const std::shared_ptr<const GlobalUniform> &_uniform,
     const std::shared_ptr<const ShaderManager> &_shaderManager,
-    const VertexBufferProperties &_properties)
+    const VertexBufferProperties &_properties,
+    bool _compactStaticBlas,
+    RgStaticGeometryChunking _staticChunking,
+    uint32_t _staticChunkTriangleCount)
 :
-    toResubmitMovable(false),
     isRecordingStatic(false),
-    submittedStaticInCurrentFrame(false)
+    appliedStaticInCurrentFrame(false)
 {
     VertexCollectorFilterTypeFlags_Init();
 
@@ -47,9 +49,11 @@ Scene::Scene(
     geomInfoMgr = std::make_shared<GeomInfoManager>(_device, _allocator);
     triangleInfoMgr = std::make_shared<TriangleInfoManager>(_device, _allocator, sectorVisibility);
 
-    asManager = std::make_shared<ASManager>(_device, _physDevice, _allocator, _cmdManager, _textureManager, geomInfoMgr, triangleInfoMgr, sectorVisibility, _properties);
+    asManager = std::make_shared<ASManager>(_device, _physDevice, _allocator, _cmdManager, _textureManager, geomInfoMgr, triangleInfoMgr, sectorVisibility, _properties, _compactStaticBlas, _staticChunking, _staticChunkTriangleCount);
   
     vertPreproc = std::make_shared<VertexPreprocessing>(_device, _uniform, asManager, _shaderManager);
+    skinning = std::make_shared<VertexSkinning>(_device, _allocator, _cmdManager, asManager, _shaderManager, _properties);
+    retainedGeometry = std::make_shared<RetainedGeometryManager>(_device, _allocator, asManager, _properties);
 }
 
 Scene::~Scene()
@@ -61,47 +65,74 @@ void Scene::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
 
     geomInfoMgr->PrepareForFrame(frameIndex);
     triangleInfoMgr->PrepareForFrame(frameIndex);
+
+    // replace static scene, if the submitted one was built
+    appliedStaticInCurrentFrame = asManager->TryApplyStaticGeometry(frameIndex);
+
+    if (appliedStaticInCurrentFrame)
+    {
+        // lights of the previous scene must not be matched with the new ones
+        lightManager->Reset();
+    }
+
     lightManager->PrepareForFrame(cmd, frameIndex);
+    skinning->PrepareForFrame(frameIndex);
+    retainedGeometry->PrepareForFrame(frameIndex);
 
     // dynamic geomtry
     asManager->BeginDynamicGeometry(cmd, frameIndex);
 }
 
 bool Scene::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, 
-                           uint32_t uniformData_rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, bool disableRayTracing)
+                           uint32_t uniformData_rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, bool disableRayTracing,
+                           const uint32_t *pCameraSectorID)
 {
-    uint32_t preprocMode = submittedStaticInCurrentFrame ? VERT_PREPROC_MODE_ALL : 
-                           toResubmitMovable             ? VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE : 
-                                                           VERT_PREPROC_MODE_ONLY_DYNAMIC;
-    submittedStaticInCurrentFrame = false;
-
-
     lightManager->CopyFromStaging(cmd, frameIndex);
 
 
     // copy to device-local, if there were any tex coords change for static geometry
     asManager->ResubmitStaticTexCoords(cmd);
 
-    if (toResubmitMovable)
-    {
-        // at least one transform of static movable geometry was changed
-        asManager->ResubmitStaticMovable(cmd);
-        toResubmitMovable = false;
-    }
-
-    // always submit dynamic geomtetry on the frame ending
+    // static movable geometry is placed using TLAS instance transforms,
+    // so only the whole static scene requires preprocessing
+    uint32_t preprocMode = appliedStaticInCurrentFrame ? VERT_PREPROC_MODE_ALL : VERT_PREPROC_MODE_ONLY_DYNAMIC;
+    appliedStaticInCurrentFrame = false;
+
+    // always submit dynamic geomtetry on the frame ending;
+    // retained and skinned geometry is written directly to device-local dynamic buffers
+    retainedGeometry->AddToFrame(frameIndex, asManager);
+    asManager->CopyDynamicGeometryFromStaging(cmd, frameIndex);
+    retainedGeometry->CopyToDynamic(cmd, frameIndex);
+    skinning->Skin(cmd, frameIndex);
     asManager->SubmitDynamicGeometry(cmd, frameIndex);
 
+    // build BLAS-es of the static geometry, that was added to the active scene
+    asManager->SubmitIncrementalStaticGeometry(cmd);
+
+    // place static movable and incremental geometry with their current transforms
+    asManager->AddStaticPlacements(frameIndex);
+
 
     // copy geom and tri infos to device-local
     geomInfoMgr->CopyFromStaging(cmd, frameIndex);
     triangleInfoMgr->CopyFromStaging(cmd, frameIndex);
 
 
+    // command buffer is already being recorded, so don't throw:
+    // if the camera's sector is unknown to the drawn scene, nothing is culled
+    std::optional<SectorArrayIndex> cameraSector;
+
+    if (pCameraSectorID != nullptr)
+    {
+        cameraSector = sectorVisibility->FindArrayIndex(SectorID{ *pCameraSectorID });
+    }
+
+
     ShVertPreprocessing push = {};
     ASManager::TLASPrepareResult prepare = {};
 
-    asManager->PrepareForBuildingTLAS(frameIndex, *uniform->GetData(), uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, &push, &prepare);
+    asManager->PrepareForBuildingTLAS(frameIndex, *uniform->GetData(), uniformData_rayCullMaskWorld, allowGeometryWithSkyFlag, isReflRefrAlphaTested, 
+                                      cameraSector ? &cameraSector.value() : nullptr, &push, &prepare);
 
     // upload uniform data
     uniform->GetData()->areFramebufsInitedByRT = !prepare.IsEmpty() && !disableRayTracing;
@@ -123,8 +154,6 @@ bool Scene::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::
 
 bool Scene::Upload(uint32_t frameIndex, const RgGeometryUploadInfo &uploadInfo)
 {
-    assert(!DoesUniqueIDExist(uploadInfo.uniqueID));
-
     if (uploadInfo.geomType == RG_GEOMETRY_TYPE_DYNAMIC)
     {
         if (isRecordingStatic)
@@ -132,33 +161,72 @@ bool Scene::Upload(uint32_t frameIndex, const RgGeometryUploadInfo &uploadInfo)
             throw RgException(RG_WRONG_FUNCTION_CALL, "Dynamic geometry must not be uploaded between rgStartNewScene and rgSubmitStaticGeometries calls");
         }
 
-        uint32_t simpleIndex = asManager->AddDynamicGeometry(frameIndex, uploadInfo);
+        // dynamic geometry can be uploaded from several threads
+        ReserveDynamicUniqueID(uploadInfo.uniqueID);
 
-        if (simpleIndex != UINT32_MAX)
+        uint32_t simpleIndex = UINT32_MAX;
+
+        try
         {
-            dynamicUniqueIDToSimpleIndex[uploadInfo.uniqueID] = simpleIndex;
-            return true;
+            simpleIndex = asManager->AddDynamicGeometry(frameIndex, uploadInfo);
+        }
+        catch (...)
+        {
+            ResolveDynamicUniqueID(uploadInfo.uniqueID, UINT32_MAX);
+            throw;
         }
+
+        ResolveDynamicUniqueID(uploadInfo.uniqueID, simpleIndex);
+        return simpleIndex != UINT32_MAX;
     }
     else
     {
+        assert(!DoesUniqueIDExist(uploadInfo.uniqueID));
+
         if (!isRecordingStatic)
         {          
             // never allow submitting static geometry out of StartNewStatic-SubmitStatic
             throw RgException(RG_WRONG_FUNCTION_CALL, "Submitting static geometry is only allowed between rgStartNewScene and rgSubmitStaticGeometries calls");
         }
 
-        uint32_t simpleIndex = asManager->AddStaticGeometry(frameIndex, uploadInfo);
+        if (uploadInfo.flags & RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT)
+        {
+            uint32_t meshIndex = asManager->AddStaticMesh(frameIndex, uploadInfo);
 
-        if (simpleIndex != UINT32_MAX)
+            if (meshIndex != UINT32_MAX)
+            {
+                staticUniqueIDToMeshIndex[uploadInfo.uniqueID] = meshIndex;
+                return true;
+            }
+
+            return false;
+        }
+
+        if (uploadInfo.geomType == RG_GEOMETRY_TYPE_STATIC_MOVABLE)
         {
-            staticUniqueIDToSimpleIndex[uploadInfo.uniqueID] = simpleIndex;
+            // each movable geometry is placed every frame as a mesh instance
+            if (asManager->GetLatestMovableCount() >= MAX_MESH_INSTANCE_COUNT)
+            {
+                throw RgException(RG_WRONG_ARGUMENT, "Can't add movable static geometry with ID=" + std::to_string(uploadInfo.uniqueID) + 
+                                  ", the limit of MAX_MESH_INSTANCE_COUNT mesh instances is reached");
+            }
+
+            uint32_t movableIndex = asManager->AddStaticMovableGeometry(frameIndex, uploadInfo);
 
-            if (uploadInfo.geomType == RG_GEOMETRY_TYPE_STATIC_MOVABLE)
+            if (movableIndex != UINT32_MAX)
             {
-                movableGeomIndices.push_back(simpleIndex);
+                staticUniqueIDToMovableIndex[uploadInfo.uniqueID] = movableIndex;
+                return true;
             }
 
+            return false;
+        }
+
+        uint32_t simpleIndex = asManager->AddStaticGeometry(frameIndex, uploadInfo);
+
+        if (simpleIndex != UINT32_MAX)
+        {
+            staticUniqueIDToSimpleIndex[uploadInfo.uniqueID] = simpleIndex;
             return true;
         }
     }
@@ -166,44 +234,181 @@ bool Scene::Upload(uint32_t frameIndex, const RgGeometryUploadInfo &uploadInfo)
     return false;
 }
 
-bool Scene::UpdateTransform(const RgUpdateTransformInfo &updateInfo)
+void Scene::ReserveDynamicGeometry(uint32_t frameIndex, uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping &outMapping)
 {
-    uint32_t simpleIndex;
-    if (!TryGetStaticSimpleIndex(updateInfo.movableStaticUniqueID, &simpleIndex))
+    if (isRecordingStatic)
     {
-        throw RgException(RG_CANT_UPDATE_TRANSFORM, "Can't find static geometry with unique ID=" + std::to_string(updateInfo.movableStaticUniqueID));
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Dynamic geometry must not be reserved between rgStartNewScene and rgSubmitStaticGeometries calls");
     }
 
-    // check if it's actually movable
-    if (std::find(movableGeomIndices.begin(), movableGeomIndices.end(), simpleIndex) == movableGeomIndices.end())
+    if (!asManager->ReserveDynamicGeometry(frameIndex, vertexCount, indexCount, outMapping))
     {
-        throw RgException(RG_CANT_UPDATE_TRANSFORM, "Static geometry with unique ID=" + std::to_string(updateInfo.movableStaticUniqueID) + " isn't movable");
+        throw RgException(RG_CANT_RESERVE_DYNAMIC_GEOMETRY, "Not enough space in dynamic vertex or index buffers");
     }
+}
 
-    asManager->UpdateStaticMovableTransform(simpleIndex, updateInfo);
+bool Scene::UpdateTransform(const RgUpdateTransformInfo &updateInfo)
+{
+    auto f = staticUniqueIDToMovableIndex.find(updateInfo.movableStaticUniqueID);
 
-    // if not recording, then static geometries were already submitted,
-    // as some movable transform was changed AS must be rebuilt
-    if (!isRecordingStatic)
+    if (f == staticUniqueIDToMovableIndex.end())
     {
-        toResubmitMovable = true;
+        uint32_t simpleIndex;
+        if (TryGetStaticSimpleIndex(updateInfo.movableStaticUniqueID, &simpleIndex))
+        {
+            throw RgException(RG_CANT_UPDATE_TRANSFORM, "Static geometry with unique ID=" + std::to_string(updateInfo.movableStaticUniqueID) + " isn't movable");
+        }
+
+        throw RgException(RG_CANT_UPDATE_TRANSFORM, "Can't find static geometry with unique ID=" + std::to_string(updateInfo.movableStaticUniqueID));
     }
 
+    // applied on the next TLAS build, no BLAS-es are rebuilt
+    asManager->UpdateStaticMovableTransform(f->second, updateInfo);
     return true;
 }
 
 bool RTGL1::Scene::UpdateTexCoords(const RgUpdateTexCoordsInfo &texCoordsInfo)
 {
     uint32_t simpleIndex;
-    if (!TryGetStaticSimpleIndex(texCoordsInfo.staticUniqueID, &simpleIndex))
+    if (TryGetStaticSimpleIndex(texCoordsInfo.staticUniqueID, &simpleIndex))
+    {
+        asManager->UpdateStaticTexCoords(simpleIndex, texCoordsInfo);
+        return true;
+    }
+
+    auto f = staticUniqueIDToMovableIndex.find(texCoordsInfo.staticUniqueID);
+
+    if (f != staticUniqueIDToMovableIndex.end())
+    {
+        asManager->UpdateStaticMovableTexCoords(f->second, texCoordsInfo);
+        return true;
+    }
+
+    throw RgException(RG_CANT_UPDATE_TEXCOORDS, "Can't find static geometry with unique ID=" + std::to_string(texCoordsInfo.staticUniqueID));
+}
+
+bool Scene::UploadMeshInstance(uint32_t frameIndex, const RgMeshInstanceUploadInfo &instanceInfo)
+{
+    if (isRecordingStatic)
+    {
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Mesh instances must not be uploaded between rgStartNewScene and rgSubmitStaticGeometries calls");
+    }
+
+    auto f = staticUniqueIDToMeshIndex.find(instanceInfo.meshUniqueID);
+
+    if (f == staticUniqueIDToMeshIndex.end())
     {
-        throw RgException(RG_CANT_UPDATE_TEXCOORDS, "Can't find static geometry with unique ID=" + std::to_string(texCoordsInfo.staticUniqueID));
+        assert(0);
+        return false;
     }
 
-    asManager->UpdateStaticTexCoords(simpleIndex, texCoordsInfo);
+    return asManager->AddMeshInstance(frameIndex, f->second, instanceInfo);
+}
+
+bool Scene::UploadSkinned(uint32_t frameIndex, const RgSkinnedGeometryUploadInfo &skinnedInfo)
+{
+    if (isRecordingStatic)
+    {
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Skinned geometry must not be uploaded between rgStartNewScene and rgSubmitStaticGeometries calls");
+    }
+
+    uint32_t vertexCount, indexCount;
+    bool hasNormals;
+
+    if (!skinning->GetMeshInfo(skinnedInfo.skinnedMesh, &vertexCount, &indexCount, &hasNormals))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Skinned mesh with ID=" + std::to_string(skinnedInfo.skinnedMesh) + " doesn't exist");
+    }
+
+    // vertex data will be written by skinning
+    RgGeometryUploadInfo info = skinnedInfo.geometry;
+    info.flags &= ~RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT;
+    info.vertexCount = vertexCount;
+    info.pVertexData = nullptr;
+    info.pNormalData = nullptr;
+    info.pTexCoordLayerData[0] = nullptr;
+    info.pTexCoordLayerData[1] = nullptr;
+    info.pTexCoordLayerData[2] = nullptr;
+    info.indexCount = indexCount;
+    info.pIndexData = nullptr;
+
+    // validate before reserving the geometry, so a failure doesn't leave it unwritten
+    VertexSkinning::Instance instance = skinning->PrepareInstance(frameIndex, skinnedInfo.skinnedMesh, skinnedInfo.pBoneTransforms, skinnedInfo.boneCount);
+
+    ReserveDynamicUniqueID(info.uniqueID);
+
+    VertexCollector::DeviceWrittenRange range = {};
+    uint32_t simpleIndex = UINT32_MAX;
+
+    try
+    {
+        simpleIndex = asManager->AddDeviceWrittenDynamicGeometry(frameIndex, info, !hasNormals, range);
+    }
+    catch (...)
+    {
+        ResolveDynamicUniqueID(info.uniqueID, UINT32_MAX);
+        throw;
+    }
+
+    ResolveDynamicUniqueID(info.uniqueID, simpleIndex);
+
+    if (simpleIndex == UINT32_MAX)
+    {
+        return false;
+    }
+
+    skinning->AddInstance(instance, range);
     return true;
 }
 
+void Scene::AddIncrementalStatic(uint32_t frameIndex, const RgGeometryUploadInfo &uploadInfo)
+{
+    if (isRecordingStatic || !asManager->CanChangeStaticIncrementally())
+    {
+        throw RgException(RG_CANT_ADD_STATIC_GEOMETRY, "Static geometry can't be added while a new static scene is being recorded or built");
+    }
+
+    if (uploadInfo.geomType != RG_GEOMETRY_TYPE_STATIC)
+    {
+        throw RgException(RG_CANT_ADD_STATIC_GEOMETRY, "Only geometry with RG_GEOMETRY_TYPE_STATIC can be added to the static scene");
+    }
+
+    if (uploadInfo.flags & RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT)
+    {
+        throw RgException(RG_CANT_ADD_STATIC_GEOMETRY, "Geometry with RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT can't be added to the static scene");
+    }
+
+    // each added geometry is placed every frame as a mesh instance
+    if (asManager->GetStaticPlacementCount() >= MAX_MESH_INSTANCE_COUNT)
+    {
+        throw RgException(RG_CANT_ADD_STATIC_GEOMETRY, "Can't add static geometry with unique ID=" + std::to_string(uploadInfo.uniqueID) + 
+                          ", the limit of MAX_MESH_INSTANCE_COUNT mesh instances is reached");
+    }
+
+    if (!asManager->AddIncrementalStaticGeometry(frameIndex, uploadInfo))
+    {
+        throw RgException(RG_CANT_ADD_STATIC_GEOMETRY, "Not enough space in static vertex or index buffers for geometry with unique ID=" + std::to_string(uploadInfo.uniqueID));
+    }
+
+    incrementalStaticUniqueIDs.insert(uploadInfo.uniqueID);
+}
+
+void Scene::RemoveIncrementalStatic(uint32_t frameIndex, uint64_t uniqueID)
+{
+    if (isRecordingStatic || !asManager->CanChangeStaticIncrementally())
+    {
+        throw RgException(RG_CANT_REMOVE_STATIC_GEOMETRY, "Static geometry can't be removed while a new static scene is being recorded or built");
+    }
+
+    if (incrementalStaticUniqueIDs.find(uniqueID) == incrementalStaticUniqueIDs.end())
+    {
+        throw RgException(RG_CANT_REMOVE_STATIC_GEOMETRY, "Can't find static geometry with unique ID=" + std::to_string(uniqueID) + ", that was added by rgAddStaticGeometry");
+    }
+
+    asManager->RemoveIncrementalStaticGeometry(frameIndex, uniqueID);
+    incrementalStaticUniqueIDs.erase(uniqueID);
+}
+
 void Scene::SubmitStatic()
 {
     // submit even if nothing was recorded, 
@@ -213,10 +418,10 @@ void Scene::SubmitStatic()
         asManager->BeginStaticGeometry();
     }
 
+    // static scene will be applied on one of the next frames' start,
+    // when its building is completed
     asManager->SubmitStaticGeometry();
     isRecordingStatic = false;
-
-    submittedStaticInCurrentFrame = true;
 }
 
 void Scene::StartNewStatic()
@@ -228,11 +433,15 @@ void Scene::StartNewStatic()
 
     isRecordingStatic = true;
     asManager->BeginStaticGeometry();
-    lightManager->Reset();
-    sectorVisibility->Reset();
+    // previous scene is drawn until the new one is applied,
+    // so lights are reset only then, and sectors are double-buffered
+    sectorVisibility->StartNewScene();
 
     staticUniqueIDToSimpleIndex.clear();
-    movableGeomIndices.clear();
+    staticUniqueIDToMeshIndex.clear();
+    staticUniqueIDToMovableIndex.clear();
+    // incremental geometry of the previous scene is drawn until the new one is applied
+    incrementalStaticUniqueIDs.clear();
 }
 
 const std::shared_ptr<ASManager> &Scene::GetASManager()
@@ -250,11 +459,64 @@ const std::shared_ptr<VertexPreprocessing> &RTGL1::Scene::GetVertexPreprocessing
     return vertPreproc;
 }
 
+const std::shared_ptr<VertexSkinning> &RTGL1::Scene::GetVertexSkinning()
+{
+    return skinning;
+}
+
+const std::shared_ptr<RetainedGeometryManager> &RTGL1::Scene::GetRetainedGeometryManager()
+{
+    return retainedGeometry;
+}
+
 bool Scene::DoesUniqueIDExist(uint64_t uniqueID) const
+{
+    std::lock_guard<std::mutex> lock(dynamicUniqueIDMutex);
+
+    return DoesUniqueIDExistLocked(uniqueID);
+}
+
+bool Scene::DoesUniqueIDExistLocked(uint64_t uniqueID) const
 {
     return
         staticUniqueIDToSimpleIndex.find(uniqueID) != staticUniqueIDToSimpleIndex.end() ||
-        dynamicUniqueIDToSimpleIndex.find(uniqueID) != dynamicUniqueIDToSimpleIndex.end();
+        staticUniqueIDToMeshIndex.find(uniqueID) != staticUniqueIDToMeshIndex.end() ||
+        staticUniqueIDToMovableIndex.find(uniqueID) != staticUniqueIDToMovableIndex.end() ||
+        incrementalStaticUniqueIDs.find(uniqueID) != incrementalStaticUniqueIDs.end() ||
+        dynamicUniqueIDToSimpleIndex.find(uniqueID) != dynamicUniqueIDToSimpleIndex.end() ||
+        retainedGeometry->DoesUniqueIDExist(uniqueID);
+}
+
+void Scene::ReserveDynamicUniqueID(uint64_t uniqueID)
+{
+    std::lock_guard<std::mutex> lock(dynamicUniqueIDMutex);
+
+    if (DoesUniqueIDExistLocked(uniqueID))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Geometry with ID=" + std::to_string(uniqueID) + " already exists");
+    }
+
+    // the ID is taken until the geometry is added
+    dynamicUniqueIDToSimpleIndex[uniqueID] = UINT32_MAX;
+}
+
+void Scene::ResolveDynamicUniqueID(uint64_t uniqueID, uint32_t simpleIndex)
+{
+    std::lock_guard<std::mutex> lock(dynamicUniqueIDMutex);
+
+    if (simpleIndex != UINT32_MAX)
+    {
+        dynamicUniqueIDToSimpleIndex[uniqueID] = simpleIndex;
+    }
+    else
+    {
+        dynamicUniqueIDToSimpleIndex.erase(uniqueID);
+    }
+}
+
+bool Scene::DoesMeshExist(uint64_t meshUniqueID) const
+{
+    return staticUniqueIDToMeshIndex.find(meshUniqueID) != staticUniqueIDToMeshIndex.end();
 }
 
 bool Scene::TryGetStaticSimpleIndex(uint64_t uniqueID, uint32_t *result) const
@@ -294,3 +556,8 @@ void RTGL1::Scene::SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID
 {
     sectorVisibility->SetPotentialVisibility(sectorID_A, sectorID_B);
 }
+
+void RTGL1::Scene::SetPotentialVisibility(const SectorID *pSectorIDs, uint32_t sectorCount, const uint32_t *pVisibilityBits)
+{
+    sectorVisibility->SetPotentialVisibility(pSectorIDs, sectorCount, pVisibilityBits);
+}
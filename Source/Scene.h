@@ -20,9 +20,13 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "ASManager.h"
 #include "LightManager.h"
+#include "RetainedGeometryManager.h"
 #include "VertexPreprocessing.h"
+#include "VertexSkinning.h"
 #include "SectorVisibility.h"
 
 namespace RTGL1
@@ -39,7 +43,10 @@ public:
         std::shared_ptr<TextureManager> &textureManager,
         const std::shared_ptr<const GlobalUniform> &uniform,
         const std::shared_ptr<const ShaderManager> &shaderManager,
-        const VertexBufferProperties &properties);
+        const VertexBufferProperties &properties,
+        bool compactStaticBlas,
+        RgStaticGeometryChunking staticChunking,
+        uint32_t staticChunkTriangleCount);
 
     ~Scene();
 
@@ -49,13 +56,22 @@ public:
     Scene& operator=(Scene&& other) noexcept = delete;
 
     void PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
-    // Return true if TLAS was built
+    // Return true if TLAS was built.
+    // If "pCameraSectorID" is not null and the sector is known, static chunks that are not potentially visible from it are culled.
     bool SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform,
-                        uint32_t uniformData_rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, bool disableRayTracing);
+                        uint32_t uniformData_rayCullMaskWorld, bool allowGeometryWithSkyFlag, bool isReflRefrAlphaTested, bool disableRayTracing,
+                        const uint32_t *pCameraSectorID);
 
     bool Upload(uint32_t frameIndex, const RgGeometryUploadInfo &uploadInfo);
+    void ReserveDynamicGeometry(uint32_t frameIndex, uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping &outMapping);
     bool UpdateTransform(const RgUpdateTransformInfo &updateInfo);
     bool UpdateTexCoords(const RgUpdateTexCoordsInfo &texCoordsInfo);
+    bool UploadMeshInstance(uint32_t frameIndex, const RgMeshInstanceUploadInfo &instanceInfo);
+    bool UploadSkinned(uint32_t frameIndex, const RgSkinnedGeometryUploadInfo &skinnedInfo);
+
+    // Add static geometry to the active static scene or remove it, without rebuilding the scene
+    void AddIncrementalStatic(uint32_t frameIndex, const RgGeometryUploadInfo &uploadInfo);
+    void RemoveIncrementalStatic(uint32_t frameIndex, uint64_t uniqueID);
 
     void UploadLight(uint32_t frameIndex, const RgSphericalLightUploadInfo &lightInfo);
     void UploadLight(uint32_t frameIndex, const RgPolygonalLightUploadInfo &lightInfo);
@@ -63,6 +79,7 @@ public:
     void UploadLight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const RgSpotlightUploadInfo &lightInfo);
 
     void SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B);
+    void SetPotentialVisibility(const SectorID *pSectorIDs, uint32_t sectorCount, const uint32_t *pVisibilityBits);
 
     void SubmitStatic();
     void StartNewStatic();
@@ -70,11 +87,21 @@ public:
     const std::shared_ptr<ASManager> &GetASManager();
     const std::shared_ptr<LightManager> &GetLightManager();
     const std::shared_ptr<VertexPreprocessing> &GetVertexPreprocessing();
+    const std::shared_ptr<VertexSkinning> &GetVertexSkinning();
+    const std::shared_ptr<RetainedGeometryManager> &GetRetainedGeometryManager();
 
     bool DoesUniqueIDExist(uint64_t uniqueID) const;
+    bool DoesMeshExist(uint64_t meshUniqueID) const;
 
 private:
     bool TryGetStaticSimpleIndex(uint64_t uniqueID, uint32_t *result) const;
+    // "dynamicUniqueIDMutex" must be locked
+    bool DoesUniqueIDExistLocked(uint64_t uniqueID) const;
+    // Atomically check that "uniqueID" is not used and take it for dynamic geometry,
+    // so several threads can't upload geometry with the same ID.
+    void ReserveDynamicUniqueID(uint64_t uniqueID);
+    // Set the simple index of a reserved ID, or free the ID, if it's UINT32_MAX.
+    void ResolveDynamicUniqueID(uint64_t uniqueID, uint32_t simpleIndex);
 
 private:
     std::shared_ptr<ASManager> asManager;
@@ -82,18 +109,25 @@ private:
     std::shared_ptr<GeomInfoManager> geomInfoMgr;
     std::shared_ptr<TriangleInfoManager> triangleInfoMgr;
     std::shared_ptr<VertexPreprocessing> vertPreproc;
+    std::shared_ptr<VertexSkinning> skinning;
+    std::shared_ptr<RetainedGeometryManager> retainedGeometry;
     std::shared_ptr<SectorVisibility> sectorVisibility;
 
     // Dynamic indices are cleared every frame
     rgl::unordered_map<uint64_t, uint32_t> dynamicUniqueIDToSimpleIndex;
+    // dynamic geometry can be uploaded from several threads
+    mutable std::mutex dynamicUniqueIDMutex;
     rgl::unordered_map<uint64_t, uint32_t> staticUniqueIDToSimpleIndex;
+    // Static geometry that was uploaded with RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT
+    rgl::unordered_map<uint64_t, uint32_t> staticUniqueIDToMeshIndex;
 
-    // Movable geometry IDs
-    std::vector<uint32_t> movableGeomIndices;
-    bool toResubmitMovable;
+    // Static movable geometry, value is movable index in ASManager
+    rgl::unordered_map<uint64_t, uint32_t> staticUniqueIDToMovableIndex;
+    // Static geometry that was added to the active scene incrementally
+    rgl::unordered_set<uint64_t> incrementalStaticUniqueIDs;
 
     bool isRecordingStatic;
-    bool submittedStaticInCurrentFrame;
+    bool appliedStaticInCurrentFrame;
 };
 
 }
\ No newline at end of file
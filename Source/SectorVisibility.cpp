@@ -20,8 +20,10 @@
 
 #include "SectorVisibility.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <utility>
 
 #include "RgException.h"
 
@@ -30,13 +32,26 @@
 constexpr RTGL1::SectorArrayIndex::index_t  SECTOR_ARRAY_INDEX_BASE_VALUE = 0;
 
 
-RTGL1::SectorVisibility::SectorVisibility() : lastSectorArrayIndex(SECTOR_ARRAY_INDEX_BASE_VALUE), sectorArrayIndexToID()
+RTGL1::SectorVisibility::SectorVisibility()
+:
+    pvs(MAX_SECTOR_COUNT * WORDS_PER_ROW, 0),
+    pvsRowCount(MAX_SECTOR_COUNT, 0),
+    version(0),
+    lastSectorArrayIndex(SECTOR_ARRAY_INDEX_BASE_VALUE),
+    sectorArrayIndexToID(),
+    isNewSceneStarted(false)
 {
     Reset();
 }
 
 void RTGL1::SectorVisibility::SetPotentialVisibility(SectorID a, SectorID b)
 {
+    if (isNewSceneStarted)
+    {
+        newScene->SetPotentialVisibility(a, b);
+        return;
+    }
+
     const SectorArrayIndex ia = AssignArrayIndexForID(a);
     const SectorArrayIndex ib = AssignArrayIndexForID(b);
 
@@ -46,17 +61,124 @@ void RTGL1::SectorVisibility::SetPotentialVisibility(SectorID a, SectorID b)
         return;
     }
 
-    CheckSize(ia, a);
-    CheckSize(ib, b);
+    if (SetBits(ia, ib))
+    {
+        version++;
+    }
+}
+
+void RTGL1::SectorVisibility::SetPotentialVisibility(const SectorID *pSectorIDs, uint32_t sectorCount, const uint32_t *pVisibilityBits)
+{
+    if (isNewSceneStarted)
+    {
+        newScene->SetPotentialVisibility(pSectorIDs, sectorCount, pVisibilityBits);
+        return;
+    }
+
+    if (sectorCount == 0)
+    {
+        return;
+    }
+
+    if (pSectorIDs == nullptr || pVisibilityBits == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Sector IDs and visibility bits must not be null");
+    }
+
+    // validate all IDs before registering any of them,
+    // so the state is not changed, if the limit is exceeded
+    rgl::unordered_set<SectorID> newIDs;
+
+    for (uint32_t i = 0; i < sectorCount; i++)
+    {
+        if (sectorIDToArrayIndex.find(pSectorIDs[i]) == sectorIDToArrayIndex.end())
+        {
+            newIDs.insert(pSectorIDs[i]);
+        }
+    }
+
+    if ((uint64_t)lastSectorArrayIndex + newIDs.size() > MAX_SECTOR_COUNT)
+    {
+        throw RgException(
+            RG_TOO_MANY_SECTORS,
+            "Can't register " + std::to_string(newIDs.size()) + 
+            " new sectors, as the number of sectors exceeds the limit of " + std::to_string(MAX_SECTOR_COUNT));
+    }
+
+    std::vector<SectorArrayIndex> indices(sectorCount);
+
+    for (uint32_t i = 0; i < sectorCount; i++)
+    {
+        indices[i] = AssignArrayIndexForID(pSectorIDs[i]);
+    }
 
-    pvs[ia].insert(ib);
-    pvs[ib].insert(ia);
+    const uint32_t wordsPerInputRow = (sectorCount + 31) / 32;
+    bool changed = false;
+
+    for (uint32_t i = 0; i < sectorCount; i++)
+    {
+        const uint32_t *pRow = &pVisibilityBits[(uint64_t)i * wordsPerInputRow];
+
+        for (uint32_t w = 0; w < wordsPerInputRow; w++)
+        {
+            uint32_t bits = pRow[w];
+
+            while (bits != 0)
+            {
+                const uint32_t j = w * 32 + std::countr_zero(bits);
+                bits &= bits - 1;
+
+                if (j >= sectorCount)
+                {
+                    break;
+                }
+
+                if (indices[i] != indices[j])
+                {
+                    changed |= SetBits(indices[i], indices[j]);
+                }
+            }
+        }
+    }
+
+    if (changed)
+    {
+        version++;
+    }
+}
+
+bool RTGL1::SectorVisibility::SetBits(SectorArrayIndex a, SectorArrayIndex b)
+{
+    const uint32_t ia = a.GetArrayIndex();
+    const uint32_t ib = b.GetArrayIndex();
+
+    uint64_t &wordA = pvs[ia * WORDS_PER_ROW + ib / 64];
+    const uint64_t bitA = 1ull << (ib % 64);
+
+    if (wordA & bitA)
+    {
+        // commutative, so the other must be set too
+        return false;
+    }
+
+    uint64_t &wordB = pvs[ib * WORDS_PER_ROW + ia / 64];
+    const uint64_t bitB = 1ull << (ia % 64);
+
+    wordA |= bitA;
+    wordB |= bitB;
+
+    pvsRowCount[ia]++;
+    pvsRowCount[ib]++;
+
+    return true;
 }
 
 void RTGL1::SectorVisibility::Reset()
 {
-    pvs.clear();
-    pvs.clear();
+    // only rows of assigned sectors can be non-zero
+    std::fill(pvs.begin(), pvs.begin() + (size_t)lastSectorArrayIndex * WORDS_PER_ROW, 0);
+    std::fill(pvsRowCount.begin(), pvsRowCount.begin() + lastSectorArrayIndex, 0);
+    version++;
 
     lastSectorArrayIndex = SECTOR_ARRAY_INDEX_BASE_VALUE;
     sectorIDToArrayIndex.clear();
@@ -69,31 +191,75 @@ void RTGL1::SectorVisibility::Reset()
     SetPotentialVisibility(defaultSectorId, defaultSectorId);
 }
 
+void RTGL1::SectorVisibility::StartNewScene()
+{
+    if (!newScene)
+    {
+        newScene = std::make_unique<SectorVisibility>();
+    }
+    else
+    {
+        // holds the state of the scene before the last applied one
+        newScene->Reset();
+    }
+
+    isNewSceneStarted = true;
+}
+
+void RTGL1::SectorVisibility::ApplyNewScene()
+{
+    if (!isNewSceneStarted)
+    {
+        return;
+    }
+
+    std::swap(pvs, newScene->pvs);
+    std::swap(pvsRowCount, newScene->pvsRowCount);
+    std::swap(lastSectorArrayIndex, newScene->lastSectorArrayIndex);
+    std::swap(sectorIDToArrayIndex, newScene->sectorIDToArrayIndex);
+    std::swap(sectorArrayIndexToID, newScene->sectorArrayIndexToID);
+
+    // sector array indices were reassigned
+    version++;
+
+    isNewSceneStarted = false;
+}
+
+uint32_t RTGL1::SectorVisibility::GetVersion() const
+{
+    return version;
+}
+
 bool RTGL1::SectorVisibility::ArePotentiallyVisibleSectorsExist(SectorArrayIndex forThisSector) const
 {
-    return pvs.find(forThisSector) != pvs.end();
+    return pvsRowCount[forThisSector.GetArrayIndex()] > 0;
 }
 
-const rgl::unordered_set<RTGL1::SectorArrayIndex> &RTGL1::SectorVisibility::GetPotentiallyVisibleSectors(SectorArrayIndex fromThisSector)
+RTGL1::SectorVisibility::PotentiallyVisibleSectors RTGL1::SectorVisibility::GetPotentiallyVisibleSectors(SectorArrayIndex fromThisSector) const
 {
     // should exist
     assert(ArePotentiallyVisibleSectorsExist(fromThisSector));
-    
-    return pvs[fromThisSector];
+
+    return PotentiallyVisibleSectors(&pvs[fromThisSector.GetArrayIndex() * WORDS_PER_ROW], GetUsedWordCount());
 }
 
-void RTGL1::SectorVisibility::CheckSize(SectorArrayIndex index, SectorID id) const
+bool RTGL1::SectorVisibility::IsPotentiallyVisible(SectorArrayIndex a, SectorArrayIndex b) const
 {
-    assert(SectorIDToArrayIndex(id) == index);
-    const auto &sv = pvs.find(index);
-
-    if (sv != pvs.end() && sv->second.size() >= RTGL1::MAX_SECTOR_COUNT)
+    if (a == b)
     {
-        throw RTGL1::RgException(
-            RG_TOO_MANY_SECTORS,
-            "Number of potentially visible sectors for the sector #" + std::to_string(id.GetID()) +
-            " exceeds the limit of " + std::to_string(RTGL1::MAX_SECTOR_COUNT));
+        return true;
     }
+
+    const uint32_t ia = a.GetArrayIndex();
+    const uint32_t ib = b.GetArrayIndex();
+
+    return (pvs[ia * WORDS_PER_ROW + ib / 64] & (1ull << (ib % 64))) != 0;
+}
+
+uint32_t RTGL1::SectorVisibility::GetUsedWordCount() const
+{
+    // no bits after the last assigned sector
+    return (lastSectorArrayIndex + 63) / 64;
 }
 
 RTGL1::SectorArrayIndex RTGL1::SectorVisibility::AssignArrayIndexForID(SectorID id)
@@ -101,7 +267,13 @@ RTGL1::SectorArrayIndex RTGL1::SectorVisibility::AssignArrayIndexForID(SectorID
     // if doesn't exist
     if (sectorIDToArrayIndex.find(id) == sectorIDToArrayIndex.end())
     {
-        assert(lastSectorArrayIndex < MAX_SECTOR_COUNT);
+        if (lastSectorArrayIndex >= MAX_SECTOR_COUNT)
+        {
+            throw RTGL1::RgException(
+                RG_TOO_MANY_SECTORS,
+                "Can't register the sector #" + std::to_string(id.GetID()) +
+                ", as the number of sectors exceeds the limit of " + std::to_string(RTGL1::MAX_SECTOR_COUNT));
+        }
 
 
         // add new
@@ -129,6 +301,23 @@ RTGL1::SectorArrayIndex RTGL1::SectorVisibility::SectorIDToArrayIndex(SectorID i
     return found->second;
 }
 
+std::optional<RTGL1::SectorArrayIndex> RTGL1::SectorVisibility::FindArrayIndex(SectorID id) const
+{
+    const auto &found = sectorIDToArrayIndex.find(id);
+
+    if (found == sectorIDToArrayIndex.end())
+    {
+        return std::nullopt;
+    }
+
+    return found->second;
+}
+
+RTGL1::SectorArrayIndex RTGL1::SectorVisibility::SectorIDToArrayIndexInNewScene(SectorID id) const
+{
+    return isNewSceneStarted ? newScene->SectorIDToArrayIndex(id) : SectorIDToArrayIndex(id);
+}
+
 RTGL1::SectorID RTGL1::SectorVisibility::SectorArrayIndexToID(SectorArrayIndex index) const
 {
     const SectorID &id = sectorArrayIndexToID[index.GetArrayIndex()];
@@ -137,3 +326,54 @@ RTGL1::SectorID RTGL1::SectorVisibility::SectorArrayIndexToID(SectorArrayIndex i
     return id;
 }
 
+
+
+
+RTGL1::SectorVisibility::PotentiallyVisibleSectors::PotentiallyVisibleSectors(const uint64_t *_pWords, uint32_t _wordCount)
+    : pWords(_pWords), wordCount(_wordCount)
+{}
+
+RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator RTGL1::SectorVisibility::PotentiallyVisibleSectors::begin() const
+{
+    return Iterator(pWords, 0, wordCount);
+}
+
+RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator RTGL1::SectorVisibility::PotentiallyVisibleSectors::end() const
+{
+    return Iterator(pWords, wordCount, wordCount);
+}
+
+RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator::Iterator(const uint64_t *_pWords, uint32_t _wordIndex, uint32_t _wordCount)
+    : pWords(_pWords), wordIndex(_wordIndex), wordCount(_wordCount), bits(_wordIndex < _wordCount ? _pWords[_wordIndex] : 0)
+{
+    SkipEmptyWords();
+}
+
+void RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator::SkipEmptyWords()
+{
+    while (bits == 0 && wordIndex < wordCount)
+    {
+        wordIndex++;
+        bits = wordIndex < wordCount ? pWords[wordIndex] : 0;
+    }
+}
+
+RTGL1::SectorArrayIndex RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator::operator*() const
+{
+    assert(bits != 0);
+    return SectorArrayIndex{ wordIndex * 64 + std::countr_zero(bits) };
+}
+
+RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator &RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator::operator++()
+{
+    // clear the lowest set bit
+    bits &= bits - 1;
+    SkipEmptyWords();
+
+    return *this;
+}
+
+bool RTGL1::SectorVisibility::PotentiallyVisibleSectors::Iterator::operator!=(const Iterator &other) const
+{
+    return wordIndex != other.wordIndex || bits != other.bits;
+}
@@ -20,6 +20,11 @@
 
 #pragma once
 
+#include <bit>
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "Containers.h"
 #include "LightDefs.h"
 
@@ -28,6 +33,42 @@ namespace RTGL1
 
 class SectorVisibility
 {
+public:
+    // A row of the potential visibility matrix,
+    // iterates over potentially visible sectors word by word.
+    class PotentiallyVisibleSectors
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator(const uint64_t *pWords, uint32_t wordIndex, uint32_t wordCount);
+
+            SectorArrayIndex operator*() const;
+            Iterator &operator++();
+            bool operator!=(const Iterator &other) const;
+
+        private:
+            void SkipEmptyWords();
+
+        private:
+            const uint64_t *pWords;
+            uint32_t wordIndex;
+            uint32_t wordCount;
+            // not yet visited bits of the current word
+            uint64_t bits;
+        };
+
+        PotentiallyVisibleSectors(const uint64_t *pWords, uint32_t wordCount);
+
+        Iterator begin() const;
+        Iterator end() const;
+
+    private:
+        const uint64_t *pWords;
+        uint32_t wordCount;
+    };
+
 public:
     SectorVisibility();
     ~SectorVisibility() = default;
@@ -39,26 +80,60 @@ public:
 
     // Potential visibility is a commutative relation.
     void SetPotentialVisibility(SectorID a, SectorID b);
+    // Set potential visibility for all pairs of the given sectors at once.
+    // 'pVisibilityBits' is a bit matrix of 'sectorCount' rows, each row is aligned to 32 bits.
+    // If j-th bit of i-th row is set, then sectors pSectorIDs[i] and pSectorIDs[j] are potentially visible.
+    void SetPotentialVisibility(const SectorID *pSectorIDs, uint32_t sectorCount, const uint32_t *pVisibilityBits);
     void Reset();
 
+    // New static scene is drawn only after it's built, so until ApplyNewScene
+    // potential visibility is set for the new scene, and the current one is left intact,
+    // as the drawn geometry and lights reference its sector array indices.
+    void StartNewScene();
+    void ApplyNewScene();
+
     SectorArrayIndex SectorIDToArrayIndex(SectorID id) const;
+    // Same as SectorIDToArrayIndex, but doesn't throw, if the sector wasn't referenced.
+    std::optional<SectorArrayIndex> FindArrayIndex(SectorID id) const;
+    // For the static geometry of the scene that was started by StartNewScene.
+    SectorArrayIndex SectorIDToArrayIndexInNewScene(SectorID id) const;
     SectorID SectorArrayIndexToID(SectorArrayIndex index) const;
 
+    // Changed each time, when potential visibility is changed.
+    uint32_t GetVersion() const;
+
     bool ArePotentiallyVisibleSectorsExist(SectorArrayIndex forThisSector) const;
-    const rgl::unordered_set<SectorArrayIndex> &GetPotentiallyVisibleSectors(SectorArrayIndex fromThisSector);
+    PotentiallyVisibleSectors GetPotentiallyVisibleSectors(SectorArrayIndex fromThisSector) const;
+    // A sector is always potentially visible from itself.
+    bool IsPotentiallyVisible(SectorArrayIndex a, SectorArrayIndex b) const;
 
 private:
-    void CheckSize(SectorArrayIndex index, SectorID id) const;
     SectorArrayIndex AssignArrayIndexForID(SectorID id);
+    // Returns true, if wasn't set before.
+    bool SetBits(SectorArrayIndex a, SectorArrayIndex b);
+    uint32_t GetUsedWordCount() const;
 
 private:
-    rgl::unordered_map<SectorArrayIndex, rgl::unordered_set<SectorArrayIndex>> pvs;
+    static constexpr uint32_t WORDS_PER_ROW = MAX_SECTOR_COUNT / 64;
+    static_assert(MAX_SECTOR_COUNT % 64 == 0, "");
+
+    // bit matrix MAX_SECTOR_COUNT x MAX_SECTOR_COUNT, indexed by SectorArrayIndex::index_t;
+    // a sector is not marked as visible from itself
+    std::vector<uint64_t> pvs;
+    // count of potentially visible sectors in each row
+    std::vector<uint32_t> pvsRowCount;
+
+    uint32_t version;
 
     SectorArrayIndex::index_t lastSectorArrayIndex;
     rgl::unordered_map<SectorID, SectorArrayIndex> sectorIDToArrayIndex;
 
     // indexed by SectorArrayIndex::index_t
     SectorID sectorArrayIndexToID[MAX_SECTOR_COUNT];
+
+    // the state is swapped with this one on ApplyNewScene
+    std::unique_ptr<SectorVisibility> newScene;
+    bool isNewSceneStarted;
 };
 
-}
\ No newline at end of file
+}
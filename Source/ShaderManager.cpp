@@ -72,6 +72,8 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"VertLensFlare",           "RsRasterizerLensFlare.vert.spv"       },
     {"FragLensFlare",           "RsRasterizerLensFlare.frag.spv"       },
     {"CCullLensFlares",         "CmCullLensFlares.comp.spv"            },
+    {"CMipmapGeneration",       "CmMipmapGeneration.comp.spv"          },
+    {"CVertexSkinning",         "CmVertexSkinning.comp.spv"            },
     {"VertDecal",               "RsDecal.vert.spv"                     },
     {"FragDecal",               "RsDecal.frag.spv"                     },
     {"EffectWipe",                  "EfWipe.comp.spv"                  },
@@ -87,8 +89,8 @@ static ShaderModuleDefinition G_SHADERS[] =
 };
 
 
-ShaderManager::ShaderManager(VkDevice _device, const char *_pShaderFolderPath, std::shared_ptr<UserFileLoad> _userFileLoad)
-    : device(_device), userFileLoad(std::move(_userFileLoad)), shaderFolderPath(_pShaderFolderPath)
+ShaderManager::ShaderManager(VkDevice _device, const char *_pShaderFolderPath, std::shared_ptr<UserFileLoad> _userFileLoad, std::shared_ptr<PipelineCache> _pipelineCache)
+    : device(_device), userFileLoad(std::move(_userFileLoad)), pipelineCache(std::move(_pipelineCache)), shaderFolderPath(_pShaderFolderPath)
 {
     LoadShaderModules();
 }
@@ -175,6 +177,11 @@ VkPipelineShaderStageCreateInfo ShaderManager::GetStageInfo(const char *name) co
     return info;
 }
 
+VkPipelineCache ShaderManager::GetPipelineCache() const
+{
+    return pipelineCache->Get();
+}
+
 VkShaderModule RTGL1::ShaderManager::LoadModule(const char *path)
 {
     if (userFileLoad->Exists())
@@ -26,16 +26,18 @@
 #include "Common.h"
 #include "Containers.h"
 #include "IShaderDependency.h"
+#include "PipelineCache.h"
 #include "UserFunction.h"
 
 namespace RTGL1
 {
 
-// This class provides shader modules by their name
+// This class provides shader modules by their name,
+// and the pipeline cache to create pipelines with
 class ShaderManager
 {
 public:
-    explicit ShaderManager(VkDevice device, const char *pShaderFolderPath, std::shared_ptr<UserFileLoad> userFileLoad);
+    explicit ShaderManager(VkDevice device, const char *pShaderFolderPath, std::shared_ptr<UserFileLoad> userFileLoad, std::shared_ptr<PipelineCache> pipelineCache);
     ~ShaderManager();
 
     ShaderManager(const ShaderManager& other) = delete;
@@ -48,6 +50,7 @@ public:
     VkShaderModule GetShaderModule(const char *name) const;
     VkShaderStageFlagBits GetModuleStage(const char *name) const;
     VkPipelineShaderStageCreateInfo GetStageInfo(const char *name) const;
+    VkPipelineCache GetPipelineCache() const;
 
     // Subscribe to shader reload event.
     // shared_ptr will be transformed to weak_ptr
@@ -75,6 +78,7 @@ private:
 private:
     VkDevice device;
     std::shared_ptr<UserFileLoad> userFileLoad;
+    std::shared_ptr<PipelineCache> pipelineCache;
     std::string shaderFolderPath;
 
     rgl::unordered_map<std::string, ShaderModule> modules;
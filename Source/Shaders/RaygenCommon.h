@@ -349,6 +349,133 @@ bool traceShadowRay(uint surfInstCustomIndex, vec3 start, vec3 end, bool ignoreF
 
 
 
+#define LIGHT_TREE_MAX_DEPTH 32
+
+
+// Light tree node importance for a surface point: node's power with inverse square falloff,
+// zero if the bounds are fully below the surface
+float getLightTreeNodeImportance(const ShLightTreeNode node, const vec3 surfPosition, const vec3 surfNormal)
+{
+    // corner of the bounds that is the farthest along the normal
+    const vec3 farthest = mix(node.boundsMin, node.boundsMax, greaterThan(surfNormal, vec3(0.0)));
+
+    if (dot(surfNormal, farthest - surfPosition) <= 0)
+    {
+        return 0;
+    }
+
+    const vec3 toCenter = (node.boundsMin + node.boundsMax) * 0.5 - surfPosition;
+    const vec3 halfExtent = (node.boundsMax - node.boundsMin) * 0.5;
+
+    // clamp by the node size, so importance doesn't explode when the point is inside or close to the bounds
+    const float dist2 = max(dot(toCenter, toCenter), dot(halfExtent, halfExtent));
+
+    return node.power / max(dist2, 0.0001);
+}
+
+
+// Choose a child proportionally to its importance, and reuse 'rnd' for the next choice.
+// Returns true, if the first child was chosen.
+bool chooseLightTreeChild(float wFirst, float wSecond, inout float rnd, inout float pdf)
+{
+    const float pFirst = wFirst / (wFirst + wSecond);
+    bool isFirst;
+
+    if (rnd < pFirst)
+    {
+        rnd /= pFirst;
+        pdf *= pFirst;
+        isFirst = true;
+    }
+    else
+    {
+        rnd = (rnd - pFirst) / (1 - pFirst);
+        pdf *= 1 - pFirst;
+        isFirst = false;
+    }
+
+    rnd = clamp(rnd, 0, 0.999);
+    return isFirst;
+}
+
+
+// Light BVH traversal: at each inner node, a child is chosen proportionally to its importance,
+// so the pdf of a light is a product of the probabilities along the path
+bool chooseLightFromTree_Sph(
+    uint rootNode, const vec3 surfPosition, const vec3 surfNormal, float rnd,
+    out uint out_plainLightListIndex, out float out_pdf)
+{
+    uint nodeIndex = rootNode;
+    out_plainLightListIndex = UINT32_MAX;
+    out_pdf = 1.0;
+
+    for (int depth = 0; depth < LIGHT_TREE_MAX_DEPTH; depth++)
+    {
+        const uint secondChildOrLight = lightTreeNodes_Sph[nodeIndex].secondChildOrLight;
+
+        if ((secondChildOrLight & LIGHT_TREE_NODE_FLAG_LEAF) != 0)
+        {
+            out_plainLightListIndex = secondChildOrLight & ~LIGHT_TREE_NODE_FLAG_LEAF;
+            return out_pdf > 0.0;
+        }
+
+        // nodes are in depth-first order, the first child is the next one
+        const uint firstChild = nodeIndex + 1;
+        const uint secondChild = secondChildOrLight;
+
+        const float wFirst  = getLightTreeNodeImportance(lightTreeNodes_Sph[firstChild],  surfPosition, surfNormal);
+        const float wSecond = getLightTreeNodeImportance(lightTreeNodes_Sph[secondChild], surfPosition, surfNormal);
+
+        if (wFirst + wSecond <= 0.0)
+        {
+            return false;
+        }
+
+        nodeIndex = chooseLightTreeChild(wFirst, wSecond, rnd, out_pdf) ? firstChild : secondChild;
+    }
+
+    return false;
+}
+
+
+bool chooseLightFromTree_Poly(
+    uint rootNode, const vec3 surfPosition, const vec3 surfNormal, float rnd,
+    out uint out_plainLightListIndex, out float out_pdf)
+{
+    uint nodeIndex = rootNode;
+    out_plainLightListIndex = UINT32_MAX;
+    out_pdf = 1.0;
+
+    for (int depth = 0; depth < LIGHT_TREE_MAX_DEPTH; depth++)
+    {
+        const uint secondChildOrLight = lightTreeNodes_Poly[nodeIndex].secondChildOrLight;
+
+        if ((secondChildOrLight & LIGHT_TREE_NODE_FLAG_LEAF) != 0)
+        {
+            out_plainLightListIndex = secondChildOrLight & ~LIGHT_TREE_NODE_FLAG_LEAF;
+            return out_pdf > 0.0;
+        }
+
+        // nodes are in depth-first order, the first child is the next one
+        const uint firstChild = nodeIndex + 1;
+        const uint secondChild = secondChildOrLight;
+
+        const float wFirst  = getLightTreeNodeImportance(lightTreeNodes_Poly[firstChild],  surfPosition, surfNormal);
+        const float wSecond = getLightTreeNodeImportance(lightTreeNodes_Poly[secondChild], surfPosition, surfNormal);
+
+        if (wFirst + wSecond <= 0.0)
+        {
+            return false;
+        }
+
+        nodeIndex = chooseLightTreeChild(wFirst, wSecond, rnd, out_pdf) ? firstChild : secondChild;
+    }
+
+    return false;
+}
+
+
+
 vec3 getDirectionalLightVector(uint seed, const vec3 dirlightDirection, float dirlightTanAngularRadius)
 {
     const vec2 u = getRandomSample(seed, RANDOM_SALT_DIRECTIONAL_LIGHT_DISK).xy;    
@@ -514,60 +641,74 @@ void processSphericalLight(
     // random in [0,1)
     float rnd = getRandomSample(seed, RANDOM_SALT_SPHERICAL_LIGHT_CHOOSE).x * 0.99;
 
-    const uint lightListBegin = sectorToLightListRegion_StartEnd_Sph[surfSectorArrayIndex * 2 + 0];
-    const uint lightListEnd   = sectorToLightListRegion_StartEnd_Sph[surfSectorArrayIndex * 2 + 1];
-
-    const uint S = uint(ceil(float(lightListEnd - lightListBegin) / MAX_SUBSET_LEN));
-    const uint subsetStride = S;
-    const uint subsetOffset = uint(floor(rnd * S));
-    rnd = rnd * S - subsetOffset;
-
     uint  selected_plainLightListIndex = UINT32_MAX;
-    float selected_mass = 0;
+    float pdf = 0;
 
-    float weightsTotal = 0;
-    uint plainLightListIndex_iter = lightListBegin + subsetOffset;
+    const uint lightTreeRoot = sectorToLightTreeRoot_Sph[surfSectorArrayIndex];
 
-    for (int i = 0; i < MAX_SUBSET_LEN; ++i) 
+    if (lightTreeRoot != UINT32_MAX)
     {
-        if (plainLightListIndex_iter >= lightListEnd) 
+        if (!chooseLightFromTree_Sph(lightTreeRoot, surfPosition, surfNormal, rnd, selected_plainLightListIndex, pdf))
         {
-            break;
+            return;
         }
+    }
+    else
+    {
+        const uint lightListBegin = sectorToLightListRegion_StartEnd_Sph[surfSectorArrayIndex * 2 + 0];
+        const uint lightListEnd   = sectorToLightListRegion_StartEnd_Sph[surfSectorArrayIndex * 2 + 1];
 
-        const float w = getSphericalLightWeight(surfPosition, surfNormal, surfRoughness, surfSpecularColor, toViewerDir, 
-                                                plainLightListIndex_iter);
+        const uint S = uint(ceil(float(lightListEnd - lightListBegin) / MAX_SUBSET_LEN));
+        const uint subsetStride = S;
+        const uint subsetOffset = uint(floor(rnd * S));
+        rnd = rnd * S - subsetOffset;
 
-        if (w > 0)
-        {
-            const float tau = weightsTotal / (weightsTotal + w);
-            weightsTotal += w;
+        float selected_mass = 0;
+
+        float weightsTotal = 0;
+        uint plainLightListIndex_iter = lightListBegin + subsetOffset;
 
-            if (rnd < tau)
+        for (int i = 0; i < MAX_SUBSET_LEN; ++i) 
+        {
+            if (plainLightListIndex_iter >= lightListEnd) 
             {
-                rnd /= tau;
+                break;
             }
-            else
-            {
-                selected_plainLightListIndex = plainLightListIndex_iter;
-                selected_mass = w;
 
-                rnd = (rnd - tau) / (1 - tau);
+            const float w = getSphericalLightWeight(surfPosition, surfNormal, surfRoughness, surfSpecularColor, toViewerDir, 
+                                                    plainLightListIndex_iter);
+
+            if (w > 0)
+            {
+                const float tau = weightsTotal / (weightsTotal + w);
+                weightsTotal += w;
+
+                if (rnd < tau)
+                {
+                    rnd /= tau;
+                }
+                else
+                {
+                    selected_plainLightListIndex = plainLightListIndex_iter;
+                    selected_mass = w;
+
+                    rnd = (rnd - tau) / (1 - tau);
+                }
+
+                rnd = clamp(rnd, 0, 0.999);
             }
 
-            rnd = clamp(rnd, 0, 0.999);
+            plainLightListIndex_iter += subsetStride;
         }
 
-        plainLightListIndex_iter += subsetStride;
-    }
+        if (weightsTotal <= 0.0 || selected_mass <= 0.0 || selected_plainLightListIndex == UINT32_MAX)
+        {
+            return;
+        }
 
-    if (weightsTotal <= 0.0 || selected_mass <= 0.0 || selected_plainLightListIndex == UINT32_MAX)
-    {
-        return;
+        pdf = selected_mass / (weightsTotal * S);
     }
 
-    float pdf = selected_mass / (weightsTotal * S);
-
 
     ShLightSpherical sphLight;
     uint sphLightIndex = plainLightList_Sph[selected_plainLightListIndex];
@@ -697,59 +838,73 @@ void processPolygonalLight(
     // random in [0,1)
     float rnd = getRandomSample(seed, RANDOM_SALT_POLYGONAL_LIGHT_CHOOSE).x * 0.99;
 
-    const uint lightListBegin = sectorToLightListRegion_StartEnd_Poly[surfSectorArrayIndex * 2 + 0];
-    const uint lightListEnd   = sectorToLightListRegion_StartEnd_Poly[surfSectorArrayIndex * 2 + 1];
-
-    const uint S = uint(ceil(float(lightListEnd - lightListBegin) / MAX_SUBSET_LEN));
-    const uint subsetStride = S;
-    const uint subsetOffset = uint(floor(rnd * S));
-    rnd = rnd * S - subsetOffset;
-
     uint  selected_plainLightListIndex = UINT32_MAX;
-    float selected_mass = 0;
+    float pdf = 0;
 
-    float weightsTotal = 0;
-    uint plainLightListIndex_iter = lightListBegin + subsetOffset;
+    const uint lightTreeRoot = sectorToLightTreeRoot_Poly[surfSectorArrayIndex];
 
-    for (int i = 0; i < MAX_SUBSET_LEN; ++i) 
+    if (lightTreeRoot != UINT32_MAX)
     {
-        if (plainLightListIndex_iter >= lightListEnd) 
+        if (!chooseLightFromTree_Poly(lightTreeRoot, surfPosition, surfNormalGeom, rnd, selected_plainLightListIndex, pdf))
         {
-            break;
+            return;
         }
+    }
+    else
+    {
+        const uint lightListBegin = sectorToLightListRegion_StartEnd_Poly[surfSectorArrayIndex * 2 + 0];
+        const uint lightListEnd   = sectorToLightListRegion_StartEnd_Poly[surfSectorArrayIndex * 2 + 1];
 
-        const float w = getPolygonalLightWeight(surfPosition, surfNormalGeom, plainLightListIndex_iter);
+        const uint S = uint(ceil(float(lightListEnd - lightListBegin) / MAX_SUBSET_LEN));
+        const uint subsetStride = S;
+        const uint subsetOffset = uint(floor(rnd * S));
+        rnd = rnd * S - subsetOffset;
 
-        if (w > 0)
-        {
-            const float tau = weightsTotal / (weightsTotal + w);
-            weightsTotal += w;
+        float selected_mass = 0;
 
-            if (rnd < tau)
+        float weightsTotal = 0;
+        uint plainLightListIndex_iter = lightListBegin + subsetOffset;
+
+        for (int i = 0; i < MAX_SUBSET_LEN; ++i) 
+        {
+            if (plainLightListIndex_iter >= lightListEnd) 
             {
-                rnd /= tau;
+                break;
             }
-            else
-            {
-                selected_plainLightListIndex = plainLightListIndex_iter;
-                selected_mass = w;
 
-                rnd = (rnd - tau) / (1 - tau);
+            const float w = getPolygonalLightWeight(surfPosition, surfNormalGeom, plainLightListIndex_iter);
+
+            if (w > 0)
+            {
+                const float tau = weightsTotal / (weightsTotal + w);
+                weightsTotal += w;
+
+                if (rnd < tau)
+                {
+                    rnd /= tau;
+                }
+                else
+                {
+                    selected_plainLightListIndex = plainLightListIndex_iter;
+                    selected_mass = w;
+
+                    rnd = (rnd - tau) / (1 - tau);
+                }
+
+                rnd = clamp(rnd, 0, 0.999);
             }
 
-            rnd = clamp(rnd, 0, 0.999);
+            plainLightListIndex_iter += subsetStride;
         }
 
-        plainLightListIndex_iter += subsetStride;
-    }
+        if (weightsTotal <= 0.0 || selected_mass <= 0.0 || selected_plainLightListIndex == UINT32_MAX)
+        {
+            return;
+        }
 
-    if (weightsTotal <= 0.0 || selected_mass <= 0.0 || selected_plainLightListIndex == UINT32_MAX)
-    {
-        return;
+        pdf = selected_mass / (weightsTotal * S);
     }
 
-    float pdf = selected_mass / (weightsTotal * S);
-
 
     
     ShLightPolygonal polyLight;
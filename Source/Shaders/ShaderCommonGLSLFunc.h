@@ -222,6 +222,27 @@ layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_SECTOR_TO_LIGHT_LIST_REGI
 {
     uint sectorToLightListRegion_StartEnd_Sph[];
 };
+
+layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_LIGHT_TREE_NODES_POLY) readonly buffer LightTreeNodesPoly_BT
+{
+    ShLightTreeNode lightTreeNodes_Poly[];
+};
+
+layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_SECTOR_TO_LIGHT_TREE_ROOT_POLY) readonly buffer SectorToLightTreeRootPoly_BT
+{
+    // index of a root node in 'lightTreeNodes', or UINT32_MAX if the sector doesn't have a tree
+    uint sectorToLightTreeRoot_Poly[];
+};
+
+layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_LIGHT_TREE_NODES_SPH) readonly buffer LightTreeNodesSph_BT
+{
+    ShLightTreeNode lightTreeNodes_Sph[];
+};
+
+layout(set = DESC_SET_LIGHT_SOURCES, binding = BINDING_SECTOR_TO_LIGHT_TREE_ROOT_SPH) readonly buffer SectorToLightTreeRootSph_BT
+{
+    uint sectorToLightTreeRoot_Sph[];
+};
 #endif
 
 
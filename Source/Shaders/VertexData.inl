@@ -365,15 +365,24 @@ ShTriangle getTriangleDynamic(uvec3 vertIndices, uint baseVertexIndex, uint base
 }
 
 // Get geometry index in "geometryInstances" array by instanceID, localGeometryIndex.
-int getGeometryIndex(int instanceID, int localGeometryIndex)
+int getGeometryIndex(int instanceID, int instanceCustomIndex, int localGeometryIndex)
 {
+    // instanced mesh's placement has its own geometry info, and its BLAS has only one geometry;
+    // static chunk's BLAS has several geometries with consecutive geometry infos
+    if ((instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_MESH_INSTANCE) != 0)
+    {
+        return (instanceCustomIndex >> INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT) + localGeometryIndex;
+    }
+
     return globalUniform.instanceGeomInfoOffset[instanceID / 4][instanceID % 4] + localGeometryIndex;
 }
 
-bool getCurrentGeometryIndexByPrev(int prevInstanceID, int prevLocalGeometryIndex, out int curFrameGlobalGeomIndex)
+bool getCurrentGeometryIndexByPrev(int prevInstanceID, int prevInstanceCustomIndex, int prevLocalGeometryIndex, out int curFrameGlobalGeomIndex)
 {
     // get previous frame's global geom index
-    const int prevFrameGeomIndex = globalUniform.instanceGeomInfoOffsetPrev[prevInstanceID / 4][prevInstanceID % 4] + prevLocalGeometryIndex;
+    const int prevFrameGeomIndex = (prevInstanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_MESH_INSTANCE) != 0 ?
+        (prevInstanceCustomIndex >> INSTANCE_CUSTOM_INDEX_MESH_INSTANCE_SHIFT) + prevLocalGeometryIndex :
+        globalUniform.instanceGeomInfoOffsetPrev[prevInstanceID / 4][prevInstanceID % 4] + prevLocalGeometryIndex;
     
     // try to find global geom index in current frame by it
     curFrameGlobalGeomIndex = geomIndexPrevToCur[prevFrameGeomIndex];
@@ -400,7 +409,7 @@ ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometr
     ShTriangle tr;
 
     // get info about geometry by the index in pGeometries in BLAS with index "instanceID"
-    const int globalGeometryIndex = getGeometryIndex(instanceID, localGeometryIndex);
+    const int globalGeometryIndex = getGeometryIndex(instanceID, instanceCustomIndex, localGeometryIndex);
     const ShGeometryInstance inst = geometryInstances[globalGeometryIndex];
 
     const bool isDynamic = (instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC) == INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
@@ -536,7 +545,7 @@ void getTriangle_PositionAndNormal(
     ShTriangle tr;
 
     // get info about geometry by the index in pGeometries in BLAS with index "instanceID"
-    const int globalGeometryIndex = getGeometryIndex(instanceID, localGeometryIndex);
+    const int globalGeometryIndex = getGeometryIndex(instanceID, instanceCustomIndex, localGeometryIndex);
     const ShGeometryInstance inst = geometryInstances[globalGeometryIndex];
 
     const bool isDynamic = (instanceCustomIndex & INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC) == INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC;
@@ -755,7 +764,7 @@ bool unpackPrevVisibilityBuffer(const vec4 v, out vec3 prevPos)
     unpackGeometryAndPrimitiveIndex(floatBitsToUint(v[1]), prevLocalGeomIndex, primIndex);
 
     int curFrameGlobalGeomIndex;
-    const bool matched = getCurrentGeometryIndexByPrev(prevInstanceID, prevLocalGeomIndex, curFrameGlobalGeomIndex);
+    const bool matched = getCurrentGeometryIndexByPrev(prevInstanceID, instCustomIndex, prevLocalGeomIndex, curFrameGlobalGeomIndex);
 
     if (!matched)
     {
@@ -770,9 +779,9 @@ bool unpackPrevVisibilityBuffer(const vec4 v, out vec3 prevPos)
     return true;
 }
 
-mat4 getModelMatrix(int instanceID, int localGeometryIndex)
+mat4 getModelMatrix(int instanceID, int instanceCustomIndex, int localGeometryIndex)
 {
-    int globalGeometryIndex = getGeometryIndex(instanceID, localGeometryIndex);
+    int globalGeometryIndex = getGeometryIndex(instanceID, instanceCustomIndex, localGeometryIndex);
     return geometryInstances[globalGeometryIndex].model;
 }
 #endif // DESC_SET_VERTEX_DATA
@@ -162,7 +162,7 @@ void RTGL1::SuperResolution::CreatePipelines(const ShaderManager *shaderManager)
         plInfo.layout = pipelineLayout;
         plInfo.stage = shaderManager->GetStageInfo("CFsrEasu");
 
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineEasu);
+        VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipelineEasu);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, pipelineEasu, VK_OBJECT_TYPE_PIPELINE, "FSR EASU pipeline");
@@ -174,7 +174,7 @@ void RTGL1::SuperResolution::CreatePipelines(const ShaderManager *shaderManager)
         plInfo.layout = pipelineLayout;
         plInfo.stage = shaderManager->GetStageInfo("CFsrRcas");
 
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineRcas);
+        VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipelineRcas);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, pipelineRcas, VK_OBJECT_TYPE_PIPELINE, "FSR RCAS pipeline");
@@ -28,7 +28,11 @@ using namespace RTGL1;
 
 Swapchain::Swapchain(VkDevice device, VkSurfaceKHR surface,
                      std::shared_ptr<PhysicalDevice> physDevice,
-                     std::shared_ptr<CommandBufferManager> cmdManager) :
+                     std::shared_ptr<CommandBufferManager> cmdManager,
+                     std::shared_ptr<MemoryAllocator> allocator,
+                     uint32_t headlessImageCount) :
+    isHeadless(surface == VK_NULL_HANDLE),
+    headlessImageCount(headlessImageCount > 0 ? headlessImageCount : 3),
     surfaceFormat{},
     surfCapabilities{},
     // default
@@ -45,6 +49,16 @@ Swapchain::Swapchain(VkDevice device, VkSurfaceKHR surface,
     this->surface = surface;
     this->physDevice = physDevice;
     this->cmdManager = cmdManager;
+    this->allocator = allocator;
+
+    if (isHeadless)
+    {
+        // offscreen images have the same format as the preferred surface format
+        surfaceFormat.format = VK_FORMAT_R8G8B8A8_SRGB;
+        surfaceFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+
+        return;
+    }
 
     VkResult r;
 
@@ -134,6 +148,13 @@ void Swapchain::AcquireImage(VkSemaphore imageAvailableSemaphore)
         TryRecreate(requestedExtent.width, requestedExtent.height, requestedVsync);
     }
 
+    if (isHeadless)
+    {
+        // just cycle through offscreen images, nothing to wait for
+        currentSwapchainIndex = (currentSwapchainIndex + 1) % GetImageCount();
+        return;
+    }
+
     while (true)
     {
         VkResult r = vkAcquireNextImageKHR(
@@ -178,7 +199,7 @@ void Swapchain::BlitForPresent(VkCommandBuffer cmd, VkImage srcImage, uint32_t s
     region.dstOffsets[1] = { static_cast<int32_t>(surfaceExtent.width), static_cast<int32_t>(surfaceExtent.height), 1 };
 
     VkImage swapchainImage = swapchainImages[currentSwapchainIndex];
-    VkImageLayout swapchainImageLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    VkImageLayout swapchainImageLayout = GetImageLayout();
 
     // set layout for blit
     Utils::BarrierImage(
@@ -210,6 +231,11 @@ void Swapchain::BlitForPresent(VkCommandBuffer cmd, VkImage srcImage, uint32_t s
 
 void Swapchain::Present(const std::shared_ptr<Queues> &queues, VkSemaphore renderFinishedSemaphore)
 {
+    if (isHeadless)
+    {
+        return;
+    }
+
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -229,6 +255,26 @@ void Swapchain::Present(const std::shared_ptr<Queues> &queues, VkSemaphore rende
 
 bool Swapchain::TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync)
 {
+    if (isHeadless)
+    {
+        newWidth  = std::max(newWidth,  1u);
+        newHeight = std::max(newHeight, 1u);
+
+        // vsync has no effect on offscreen images
+        if (surfaceExtent.width == newWidth && surfaceExtent.height == newHeight)
+        {
+            isVsync = vsync;
+            return false;
+        }
+
+        cmdManager->WaitDeviceIdle();
+
+        DestroyWithoutSwapchain();
+        Create(newWidth, newHeight, vsync);
+
+        return true;
+    }
+
     VkResult r = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physDevice->Get(), surface, &surfCapabilities);
     VK_CHECKERROR(r);
 
@@ -262,6 +308,14 @@ void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwap
     this->isVsync = vsync;
     this->surfaceExtent = { newWidth, newHeight };
 
+    if (isHeadless)
+    {
+        CreateHeadlessImages();
+        CallCreateSubscribers();
+
+        return;
+    }
+
     VkResult r;
 
 #ifndef NDEBUG
@@ -363,17 +417,97 @@ void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwap
     CallCreateSubscribers();
 }
 
+void Swapchain::CreateHeadlessImages()
+{
+    VkResult r;
+
+    assert(swapchainImages.empty());
+    assert(swapchainViews.empty());
+    assert(headlessImageMemories.empty());
+
+    swapchainImages.resize(headlessImageCount);
+    swapchainViews.resize(headlessImageCount);
+    headlessImageMemories.resize(headlessImageCount);
+
+    for (uint32_t i = 0; i < headlessImageCount; i++)
+    {
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = surfaceFormat.format;
+        imageInfo.extent = { surfaceExtent.width, surfaceExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage =
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        r = vkCreateImage(device, &imageInfo, nullptr, &swapchainImages[i]);
+        VK_CHECKERROR(r);
+
+        VkMemoryRequirements memReqs;
+        vkGetImageMemoryRequirements(device, swapchainImages[i], &memReqs);
+
+        headlessImageMemories[i] = allocator->AllocDedicated(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryAllocator::AllocType::DEFAULT, "Headless swapchain image memory");
+
+        r = vkBindImageMemory(device, swapchainImages[i], headlessImageMemories[i], 0);
+        VK_CHECKERROR(r);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = swapchainImages[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = surfaceFormat.format;
+        viewInfo.components = {};
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        r = vkCreateImageView(device, &viewInfo, nullptr, &swapchainViews[i]);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, swapchainImages[i], VK_OBJECT_TYPE_IMAGE, "Headless swapchain image");
+        SET_DEBUG_NAME(device, swapchainViews[i], VK_OBJECT_TYPE_IMAGE_VIEW, "Headless swapchain image view");
+    }
+
+    VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
+
+    for (uint32_t i = 0; i < headlessImageCount; i++)
+    {
+        Utils::BarrierImage(
+            cmd, swapchainImages[i],
+            0, 0,
+            VK_IMAGE_LAYOUT_UNDEFINED, GetImageLayout());
+    }
+
+    cmdManager->Submit(cmd);
+    cmdManager->WaitGraphicsIdle();
+
+    currentSwapchainIndex = 0;
+}
+
 void Swapchain::Destroy()
 {
     VkSwapchainKHR old = DestroyWithoutSwapchain();
-    vkDestroySwapchainKHR(device, old, nullptr);
+
+    if (old != VK_NULL_HANDLE)
+    {
+        vkDestroySwapchainKHR(device, old, nullptr);
+    }
 }
 
 VkSwapchainKHR RTGL1::Swapchain::DestroyWithoutSwapchain()
 {
     vkDeviceWaitIdle(device);
 
-    if (swapchain != VK_NULL_HANDLE)
+    if (swapchain != VK_NULL_HANDLE || (isHeadless && !swapchainImages.empty()))
     {
         CallDestroySubscribers();
     }
@@ -383,6 +517,21 @@ VkSwapchainKHR RTGL1::Swapchain::DestroyWithoutSwapchain()
         vkDestroyImageView(device, v, nullptr);
     }
 
+    if (isHeadless)
+    {
+        for (VkImage i : swapchainImages)
+        {
+            vkDestroyImage(device, i, nullptr);
+        }
+
+        for (VkDeviceMemory m : headlessImageMemories)
+        {
+            allocator->FreeDedicated(m);
+        }
+
+        headlessImageMemories.clear();
+    }
+
     swapchainViews.clear();
     swapchainImages.clear();
 
@@ -437,11 +586,21 @@ void Swapchain::Unsubscribe(const ISwapchainDependency *subscriber)
     });
 }
 
+bool Swapchain::IsHeadless() const
+{
+    return isHeadless;
+}
+
 VkFormat Swapchain::GetSurfaceFormat() const
 {
     return surfaceFormat.format;
 }
 
+VkImageLayout Swapchain::GetImageLayout() const
+{
+    return isHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
 uint32_t Swapchain::GetWidth() const
 {
     return surfaceExtent.width;
@@ -27,10 +27,14 @@
 #include "PhysicalDevice.h"
 #include "CommandBufferManager.h"
 #include "ISwapchainDependency.h"
+#include "MemoryAllocator.h"
 
 namespace RTGL1
 {
 
+// If surface is VK_NULL_HANDLE, swapchain is headless:
+// it owns offscreen images instead of presentable ones,
+// and acquire / present don't interact with a presentation engine.
 class Swapchain
 {
 public:
@@ -38,7 +42,9 @@ public:
         VkDevice device, 
         VkSurfaceKHR surface, 
         std::shared_ptr<PhysicalDevice> physDevice, 
-        std::shared_ptr<CommandBufferManager> cmdManager);
+        std::shared_ptr<CommandBufferManager> cmdManager,
+        std::shared_ptr<MemoryAllocator> allocator,
+        uint32_t headlessImageCount = 0);
     ~Swapchain();
 
     Swapchain(const Swapchain &other) = delete;
@@ -52,6 +58,7 @@ public:
     bool RequestNewSize(uint32_t newWidth, uint32_t newHeight);
     bool RequestVsync(bool enable);
 
+    // In headless mode, imageAvailableSemaphore is not signaled.
     void AcquireImage(VkSemaphore imageAvailableSemaphore);
     void BlitForPresent(VkCommandBuffer cmd, VkImage srcImage, uint32_t srcImageWidth, uint32_t srcImageHeight, VkFilter filter, VkImageLayout srcImageLayout = VK_IMAGE_LAYOUT_GENERAL);
     void Present(const std::shared_ptr<Queues> &queues, VkSemaphore renderFinishedSemaphore);
@@ -61,7 +68,10 @@ public:
     void Subscribe(std::shared_ptr<ISwapchainDependency> subscriber);
     void Unsubscribe(const ISwapchainDependency *subscriber);
 
+    bool IsHeadless() const;
     VkFormat GetSurfaceFormat() const;
+    // Layout of swapchain images between frames.
+    VkImageLayout GetImageLayout() const;
     uint32_t GetWidth() const;
     uint32_t GetHeight() const;
     uint32_t GetCurrentImageIndex() const;
@@ -75,6 +85,7 @@ private:
     bool TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync);
 
     void Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+    void CreateHeadlessImages();
     void Destroy();
     // Destroy dresources but not the swapchain itself. Old swapchain is returned.
     VkSwapchainKHR DestroyWithoutSwapchain();
@@ -87,6 +98,10 @@ private:
     VkSurfaceKHR surface;
     std::shared_ptr<PhysicalDevice> physDevice;
     std::shared_ptr<CommandBufferManager> cmdManager;
+    std::shared_ptr<MemoryAllocator> allocator;
+
+    bool isHeadless;
+    uint32_t headlessImageCount;
 
     VkSurfaceFormatKHR surfaceFormat;
     VkSurfaceCapabilitiesKHR surfCapabilities;
@@ -103,6 +118,8 @@ private:
     VkSwapchainKHR swapchain;
     std::vector<VkImage> swapchainImages;
     std::vector<VkImageView> swapchainViews;
+    // only for headless
+    std::vector<VkDeviceMemory> headlessImageMemories;
 
     uint32_t currentSwapchainIndex;
 
@@ -36,17 +36,70 @@ constexpr MaterialTextures EmptyMaterialTextures = { EMPTY_TEXTURE_INDEX, EMPTY_
 
 constexpr RgSamplerFilter DefaultDynamicSamplerFilter = RG_SAMPLER_FILTER_LINEAR;
 
+// textures loaded in background are uploaded in portions to limit staging memory
+constexpr uint64_t MAX_BACKGROUND_UPLOAD_SIZE_PER_FRAME = 64 * 1024 * 1024;
+
+
+namespace
+{
+
+uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+// Returns non-zero hash of pixel data and the parameters that affect the uploaded image
+uint64_t HashTextureContent(const ImageLoader::ResultInfo &info, bool useMipmaps)
+{
+    uint64_t h = robin_hood::hash_bytes(info.pData, info.dataSize);
+
+    h = HashCombine(h, info.dataSize);
+    h = HashCombine(h, info.format);
+    h = HashCombine(h, (uint64_t(info.baseSize.width) << 32) | info.baseSize.height);
+    h = HashCombine(h, info.isPregenerated ? info.levelCount : 0);
+    h = HashCombine(h, useMipmaps);
+
+    for (uint32_t i = 0; i < info.levelCount; i++)
+    {
+        h = HashCombine(h, info.levelOffsets[i]);
+    }
+
+    // 0 is reserved for non-shared textures
+    return h != 0 ? h : 1;
+}
+
+// FNV-1a of pixel data, independent from HashTextureContent,
+// to verify that a found shared texture has the same content
+uint64_t HashTextureData(const ImageLoader::ResultInfo &info)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    for (uint32_t i = 0; i < info.dataSize; i++)
+    {
+        h ^= info.pData[i];
+        h *= 0x100000001b3ull;
+    }
+
+    return h;
+}
+
+}
+
 
 TextureManager::TextureManager(
     VkDevice _device,
     std::shared_ptr<MemoryAllocator> _memAllocator,
     std::shared_ptr<SamplerManager> _samplerMgr,
+    std::shared_ptr<TextureStagingRing> _stagingRing,
+    std::shared_ptr<MipmapGenerator> _mipmapGenerator,
     const std::shared_ptr<CommandBufferManager> &_cmdManager,
     std::shared_ptr<UserFileLoad> _userFileLoad,
+    std::shared_ptr<OverrideFileIndex> _overrideFileIndex,
     const RgInstanceCreateInfo &_info)
 :
     device(_device),
     samplerMgr(std::move(_samplerMgr)),
+    overrideFileIndex(std::move(_overrideFileIndex)),
     currentDynamicSamplerFilter(DefaultDynamicSamplerFilter)
 {
     this->defaultTexturesPath = _info.pOverridenTexturesFolderPath != nullptr ? _info.pOverridenTexturesFolderPath : DEFAULT_TEXTURES_PATH;
@@ -73,11 +126,19 @@ TextureManager::TextureManager(
 
     const uint32_t maxTextureCount = std::max<uint32_t>(TEXTURE_COUNT_MIN, std::min<uint32_t>(_info.maxTextureCount, TEXTURE_COUNT_MAX));
 
+    if (_info.loadTexturesInBackground)
+    {
+        asyncImageLoader = std::make_unique<AsyncImageLoader>(_userFileLoad);
+    }
+
     imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad));
     textureDesc = std::make_shared<TextureDescriptors>(device, samplerMgr, maxTextureCount, BINDING_TEXTURES);
-    textureUploader = std::make_shared<TextureUploader>(device, std::move(_memAllocator));
+    textureUploader = std::make_shared<TextureUploader>(device, std::move(_memAllocator), std::move(_stagingRing), std::move(_mipmapGenerator));
 
     textures.resize(maxTextureCount);
+    textureLoadIDs.resize(maxTextureCount, 0);
+    textureRefCounts.resize(maxTextureCount, 0);
+    textureContentHashes.resize(maxTextureCount, 0);
 
     // submit cmd to create empty texture
     VkCommandBuffer cmd = _cmdManager->StartGraphicsCmd();
@@ -149,6 +210,9 @@ void RTGL1::TextureManager::CreateWaterNormalTexture(VkCommandBuffer cmd, uint32
 
 TextureManager::~TextureManager()
 {
+    // wait for the workers
+    asyncImageLoader.reset();
+
     for (auto &texture : textures)
     {
         assert((texture.image == VK_NULL_HANDLE && texture.view == VK_NULL_HANDLE) ||
@@ -182,6 +246,94 @@ void TextureManager::PrepareForFrame(uint32_t frameIndex)
     textureUploader->ClearStaging(frameIndex);
 }
 
+void TextureManager::UploadLoadedTextures(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (!asyncImageLoader)
+    {
+        return;
+    }
+
+    // limit staging memory per frame, but upload at least one texture
+    uint64_t uploadedSize = 0;
+
+    while (uploadedSize < MAX_BACKGROUND_UPLOAD_SIZE_PER_FRAME)
+    {
+        std::optional<AsyncImageLoader::Result> result = asyncImageLoader->TryPopLoaded();
+
+        if (!result)
+        {
+            break;
+        }
+
+        const auto it = pendingTextureLoads.find(result->loadID);
+
+        // material was destroyed while loading
+        if (it == pendingTextureLoads.end())
+        {
+            continue;
+        }
+
+        const PendingTextureLoad pending = std::move(it->second);
+        pendingTextureLoads.erase(it);
+
+        // if file wasn't found, keep the placeholder
+        if (!result->isLoaded)
+        {
+            OnBackgroundLoadFailed(frameIndex, pending.textureIndex);
+            continue;
+        }
+
+        ImageLoader::ResultInfo &imageInfo = result->info;
+        imageInfo.format = TextureOverrides::GetOverridenFormat(imageInfo.format, pending.overridenIsSRGB);
+
+        if (imageInfo.baseSize.width == 0 || imageInfo.baseSize.height == 0)
+        {
+            OnBackgroundLoadFailed(frameIndex, pending.textureIndex);
+            continue;
+        }
+
+        TextureUploader::UploadInfo info = {};
+        info.cmd = cmd;
+        info.frameIndex = frameIndex;
+        info.pData = imageInfo.pData;
+        info.dataSize = imageInfo.dataSize;
+        info.baseSize = imageInfo.baseSize;
+        info.format = imageInfo.format;
+        info.isDynamic = false;
+        info.useMipmaps = pending.useMipmaps;
+        info.pDebugName = pending.debugName.c_str();
+        info.isCubemap = false;
+        info.pregeneratedLevelCount = imageInfo.isPregenerated ? imageInfo.levelCount : 0;
+        info.pLevelDataOffsets = imageInfo.levelOffsets;
+        info.pLevelDataSizes = imageInfo.levelSizes;
+
+        auto uploaded = textureUploader->UploadImage(info);
+
+        if (!uploaded.wasUploaded)
+        {
+            OnBackgroundLoadFailed(frameIndex, pending.textureIndex);
+            continue;
+        }
+
+        uploadedSize += imageInfo.dataSize;
+
+        Texture &texture = textures[pending.textureIndex];
+        assert(textureLoadIDs[pending.textureIndex] == result->loadID);
+        textureLoadIDs[pending.textureIndex] = 0;
+
+        // placeholder might be in use by previous frames
+        if (texture.image != VK_NULL_HANDLE)
+        {
+            AddToBeDestroyed(frameIndex, texture);
+        }
+
+        // descriptor will be updated in SubmitDescriptors
+        texture.image = uploaded.image;
+        texture.view = uploaded.view;
+        texture.samplerHandle = pending.samplerHandle;
+    }
+}
+
 void TextureManager::SubmitDescriptors(uint32_t frameIndex, 
                                        const RgDrawFrameTexturesParams *pTexturesParams,
                                        bool forceUpdateAllDescriptors)
@@ -243,16 +395,48 @@ uint32_t TextureManager::CreateStaticMaterial(VkCommandBuffer cmd, uint32_t fram
         parseInfo.overridenIsSRGB[i] = overridenIsSRGB[i];
     }
 
+    parseInfo.fileIndex = overrideFileIndex.get();
+
+    // if loading in background, default data is uploaded now as a placeholder
+    parseInfo.onlyResolvePaths = asyncImageLoader != nullptr;
+
     // load additional textures, they'll be freed after leaving the scope
     TextureOverrides ovrd(createInfo.pRelativePath, createInfo.textures, createInfo.size, parseInfo, imageLoader);
 
+    const bool useMipmaps = !(createInfo.flags & RG_MATERIAL_CREATE_DONT_GENERATE_MIPMAPS_BIT);
+
 
     MaterialTextures mtextures = {};
 
     for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
     {
+        // placeholder's slot will receive a loaded image, so it must not be shared
+        const bool loadInBackground = parseInfo.onlyResolvePaths && ovrd.GetOverridePath(i)[0] != '\0';
+
         mtextures.indices[i] = PrepareStaticTexture(cmd, frameIndex, ovrd.GetResult(i), samplerHandle,
-                                                   !(createInfo.flags & RG_MATERIAL_CREATE_DONT_GENERATE_MIPMAPS_BIT), ovrd.GetDebugName());
+                                                   useMipmaps, ovrd.GetDebugName(), !loadInBackground);
+
+        if (loadInBackground)
+        {
+            try
+            {
+                mtextures.indices[i] = LoadTextureInBackground(mtextures.indices[i], ovrd.GetOverridePath(i), samplerHandle,
+                                                               useMipmaps, parseInfo.overridenIsSRGB[i], ovrd.GetDebugName());
+            }
+            catch (...)
+            {
+                // material won't be created, so release its already prepared textures
+                for (uint32_t t : mtextures.indices)
+                {
+                    if (t != EMPTY_TEXTURE_INDEX)
+                    {
+                        ReleaseTexture(frameIndex, t);
+                    }
+                }
+
+                throw;
+            }
+        }
     }
 
 
@@ -348,7 +532,7 @@ uint32_t TextureManager::PrepareStaticTexture(
     VkCommandBuffer cmd, uint32_t frameIndex, 
     const ImageLoader::ResultInfo &imageInfo,
     SamplerManager::Handle samplerHandle, bool useMipmaps,
-    const char *debugName)
+    const char *debugName, bool allowSharing)
 {
     // only dynamic textures can have null data
     if (imageInfo.pData == nullptr)
@@ -356,6 +540,43 @@ uint32_t TextureManager::PrepareStaticTexture(
         return EMPTY_TEXTURE_INDEX;
     }
 
+    uint64_t contentHash = 0;
+    uint64_t dataHash = 0;
+
+    if (allowSharing)
+    {
+        contentHash = HashTextureContent(imageInfo, useMipmaps);
+        dataHash = HashTextureData(imageInfo);
+
+        const auto it = sharedTextures.find(contentHash);
+
+        if (it != sharedTextures.end())
+        {
+            const SharedTexture &shared = it->second;
+
+            const bool isSameImage =
+                shared.format == imageInfo.format &&
+                shared.baseSize.width == imageInfo.baseSize.width &&
+                shared.baseSize.height == imageInfo.baseSize.height &&
+                shared.dataSize == imageInfo.dataSize &&
+                shared.pregeneratedLevelCount == (imageInfo.isPregenerated ? imageInfo.levelCount : 0) &&
+                shared.useMipmaps == useMipmaps &&
+                shared.dataHash == dataHash;
+
+            if (isSameImage && shared.samplerHandle == samplerHandle)
+            {
+                assert(textureContentHashes[shared.textureIndex] == contentHash);
+                assert(textureRefCounts[shared.textureIndex] > 0);
+
+                textureRefCounts[shared.textureIndex]++;
+                return shared.textureIndex;
+            }
+
+            // same content with another sampler or a hash collision, upload a separate copy
+            contentHash = 0;
+        }
+    }
+
     if (imageInfo.baseSize.width == 0 || imageInfo.baseSize.height == 0)
     {
         using namespace std::string_literals;
@@ -391,7 +612,25 @@ uint32_t TextureManager::PrepareStaticTexture(
         return EMPTY_TEXTURE_INDEX;
     }
 
-    return InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+    const uint32_t textureIndex = InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+
+    if (contentHash != 0 && textureIndex != EMPTY_TEXTURE_INDEX)
+    {
+        textureContentHashes[textureIndex] = contentHash;
+        SharedTexture shared = {};
+        shared.textureIndex = textureIndex;
+        shared.samplerHandle = samplerHandle;
+        shared.format = imageInfo.format;
+        shared.baseSize = imageInfo.baseSize;
+        shared.dataSize = imageInfo.dataSize;
+        shared.pregeneratedLevelCount = imageInfo.isPregenerated ? imageInfo.levelCount : 0;
+        shared.useMipmaps = useMipmaps;
+        shared.dataHash = dataHash;
+
+        sharedTextures.emplace(contentHash, shared);
+    }
+
+    return textureIndex;
 }
 
 uint32_t TextureManager::PrepareDynamicTexture(
@@ -592,16 +831,51 @@ void TextureManager::DestroyMaterialTextures(uint32_t frameIndex, const Material
     {
         if (t != EMPTY_TEXTURE_INDEX)
         {
-            Texture &texture = textures[t];
+            ReleaseTexture(frameIndex, t);
+        }
+    }
+}
 
-            AddToBeDestroyed(frameIndex, texture);
+void TextureManager::ReleaseTexture(uint32_t frameIndex, uint32_t textureIndex)
+{
+    assert(textureIndex != EMPTY_TEXTURE_INDEX);
+    assert(textureRefCounts[textureIndex] > 0);
 
-            // null data
-            texture.image = VK_NULL_HANDLE;
-            texture.view = VK_NULL_HANDLE;
-            texture.samplerHandle = SamplerManager::Handle();
-        }
+    textureRefCounts[textureIndex]--;
+
+    // still used by other materials
+    if (textureRefCounts[textureIndex] > 0)
+    {
+        return;
+    }
+
+    if (textureContentHashes[textureIndex] != 0)
+    {
+        sharedTextures.erase(textureContentHashes[textureIndex]);
+        textureContentHashes[textureIndex] = 0;
+    }
+
+    // if slot was reserved for a background load, cancel it
+    if (textureLoadIDs[textureIndex] != 0)
+    {
+        asyncImageLoader->Cancel(textureLoadIDs[textureIndex]);
+        pendingTextureLoads.erase(textureLoadIDs[textureIndex]);
+
+        textureLoadIDs[textureIndex] = 0;
+    }
+
+    Texture &texture = textures[textureIndex];
+
+    // might be not loaded yet
+    if (texture.image != VK_NULL_HANDLE)
+    {
+        AddToBeDestroyed(frameIndex, texture);
     }
+
+    // null data
+    texture.image = VK_NULL_HANDLE;
+    texture.view = VK_NULL_HANDLE;
+    texture.samplerHandle = SamplerManager::Handle();
 }
 
 void TextureManager::DestroyMaterial(uint32_t currentFrameIndex, uint32_t materialIndex)
@@ -648,15 +922,119 @@ void TextureManager::DestroyMaterial(uint32_t currentFrameIndex, uint32_t materi
     }
 }
 
-uint32_t TextureManager::InsertTexture(uint32_t frameIndex, VkImage image, VkImageView view, SamplerManager::Handle samplerHandle)
+std::optional<uint32_t> TextureManager::FindFreeTextureSlot() const
 {
-    auto texture = std::find_if(textures.begin(), textures.end(), [] (const Texture &t)
+    for (uint32_t i = 0; i < textures.size(); i++)
     {
-        return t.image == VK_NULL_HANDLE && t.view == VK_NULL_HANDLE;
-    });
+        if (textures[i].image == VK_NULL_HANDLE && textures[i].view == VK_NULL_HANDLE && textureLoadIDs[i] == 0)
+        {
+            return i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+uint32_t TextureManager::LoadTextureInBackground(
+    uint32_t textureIndex, const char *pFilePath,
+    SamplerManager::Handle samplerHandle, bool useMipmaps, bool overridenIsSRGB,
+    const char *debugName)
+{
+    assert(asyncImageLoader);
+
+    // if there's no placeholder, reserve a slot, until then empty texture is used for it
+    if (textureIndex == EMPTY_TEXTURE_INDEX)
+    {
+        std::optional<uint32_t> freeSlot = FindFreeTextureSlot();
+
+        if (!freeSlot)
+        {
+            throw RgException(RG_TOO_MANY_TEXTURES, 
+                              "Can't reserve a texture slot to load \"" + std::string(pFilePath) + 
+                              "\", the limit of " + std::to_string(textures.size()) + " textures is reached");
+        }
+
+        textureIndex = *freeSlot;
+        textureRefCounts[textureIndex] = 1;
+    }
+
+    assert(textureLoadIDs[textureIndex] == 0);
+
+    uint64_t loadID = asyncImageLoader->Load(pFilePath);
+    textureLoadIDs[textureIndex] = loadID;
+
+    PendingTextureLoad pending = {};
+    pending.textureIndex = textureIndex;
+    pending.samplerHandle = samplerHandle;
+    pending.useMipmaps = useMipmaps;
+    pending.overridenIsSRGB = overridenIsSRGB;
+    pending.debugName = debugName != nullptr ? debugName : "";
+
+    pendingTextureLoads[loadID] = std::move(pending);
+
+    return textureIndex;
+}
+
+void TextureManager::OnBackgroundLoadFailed(uint32_t frameIndex, uint32_t textureIndex)
+{
+    textureLoadIDs[textureIndex] = 0;
+
+    // keep the placeholder
+    if (textures[textureIndex].image != VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // slots of background loads are not shared, so only one material references it
+    for (auto &m : materials)
+    {
+        MaterialTextures &mtextures = m.second.textures;
+        bool isReferenced = false;
+
+        for (uint32_t &t : mtextures.indices)
+        {
+            if (t == textureIndex)
+            {
+                t = EMPTY_TEXTURE_INDEX;
+                isReferenced = true;
+            }
+        }
+
+        if (!isReferenced)
+        {
+            continue;
+        }
+
+        ReleaseTexture(frameIndex, textureIndex);
+
+        // notify subscribers
+        for (auto &ws : subscribers)
+        {
+            if (auto s = ws.lock())
+            {
+                s->OnMaterialChange(m.first, mtextures);
+
+                // animated materials that currently show this one
+                for (const auto &a : animatedMaterials)
+                {
+                    if (a.second.materialIndices[a.second.currentFrame] == m.first)
+                    {
+                        s->OnMaterialChange(a.first, mtextures);
+                    }
+                }
+            }
+        }
+
+        break;
+    }
+}
+
+uint32_t TextureManager::InsertTexture(uint32_t frameIndex, VkImage image, VkImageView view, SamplerManager::Handle samplerHandle)
+{
+    const std::optional<uint32_t> textureIndex = FindFreeTextureSlot();
 
     // if coudn't find empty space, use empty texture
-    if (texture == textures.end())
+    if (!textureIndex)
     {
         // clean created data
         Texture t = {};
@@ -670,11 +1048,15 @@ uint32_t TextureManager::InsertTexture(uint32_t frameIndex, VkImage image, VkIma
         return EMPTY_TEXTURE_INDEX;
     }
 
-    texture->image = image;
-    texture->view = view;
-    texture->samplerHandle = samplerHandle;
+    Texture &texture = textures[*textureIndex];
+    texture.image = image;
+    texture.view = view;
+    texture.samplerHandle = samplerHandle;
+
+    assert(textureRefCounts[*textureIndex] == 0 && textureContentHashes[*textureIndex] == 0);
+    textureRefCounts[*textureIndex] = 1;
 
-    return (uint32_t)std::distance(textures.begin(), texture);
+    return *textureIndex;
 }
 
 void TextureManager::DestroyTexture(const Texture &texture)
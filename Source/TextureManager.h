@@ -21,14 +21,17 @@
 #pragma once
 
 #include <list>
+#include <optional>
 #include <string>
 
+#include "AsyncImageLoader.h"
 #include "Common.h"
 #include "CommandBufferManager.h"
 #include "Material.h"
 #include "ImageLoader.h"
 #include "IMaterialDependency.h"
 #include "MemoryAllocator.h"
+#include "OverrideFileIndex.h"
 #include "SamplerManager.h"
 #include "TextureDescriptors.h"
 #include "TextureUploader.h"
@@ -43,8 +46,11 @@ public:
         VkDevice device,
         std::shared_ptr<MemoryAllocator> memAllocator,
         std::shared_ptr<SamplerManager> samplerManager,
+        std::shared_ptr<TextureStagingRing> stagingRing,
+        std::shared_ptr<MipmapGenerator> mipmapGenerator,
         const std::shared_ptr<CommandBufferManager> &cmdManager,
         std::shared_ptr<UserFileLoad> userFileLoad,
+        std::shared_ptr<OverrideFileIndex> overrideFileIndex,
         const RgInstanceCreateInfo &info);
     ~TextureManager();
 
@@ -54,6 +60,8 @@ public:
     TextureManager &operator=(TextureManager &&other) noexcept = delete;
 
     void PrepareForFrame(uint32_t frameIndex);
+    // Upload textures that were loaded in background, replacing their placeholders.
+    void UploadLoadedTextures(VkCommandBuffer cmd, uint32_t frameIndex);
     void SubmitDescriptors(uint32_t frameIndex,
                            const RgDrawFrameTexturesParams *pTexturesParams,
                            bool forceUpdateAllDescriptors = false); // true, if mip lod bias was changed, for example
@@ -85,15 +93,28 @@ private:
     void CreateEmptyTexture(VkCommandBuffer cmd, uint32_t frameIndex);
     void CreateWaterNormalTexture(VkCommandBuffer cmd, uint32_t frameIndex, const char *pFilePath);
 
+    // If 'allowSharing' is true, a texture with the same content, format, size and sampler
+    // is reused instead of uploading a new one.
     uint32_t PrepareStaticTexture(
         VkCommandBuffer cmd, uint32_t frameIndex, const ImageLoader::ResultInfo &info,
-        SamplerManager::Handle samplerHandle, bool useMipmaps, const char *debugName);
+        SamplerManager::Handle samplerHandle, bool useMipmaps, const char *debugName,
+        bool allowSharing = false);
 
     uint32_t PrepareDynamicTexture(
         VkCommandBuffer cmd, uint32_t frameIndex, const void *data, uint32_t dataSize, const RgExtent2D &size,
         SamplerManager::Handle samplerHandle, VkFormat format, bool generateMipmaps, const char *debugName);
 
     uint32_t InsertTexture(uint32_t frameIndex, VkImage image, VkImageView view, SamplerManager::Handle samplerHandle);
+    std::optional<uint32_t> FindFreeTextureSlot() const;
+    // Start loading an override file in background, 'textureIndex' can be EMPTY_TEXTURE_INDEX,
+    // if there's no default data. Returns the index of the texture slot that will receive the file.
+    uint32_t LoadTextureInBackground(uint32_t textureIndex, const char *pFilePath,
+                                     SamplerManager::Handle samplerHandle, bool useMipmaps, bool overridenIsSRGB, const char *debugName);
+    // If a slot was reserved without a placeholder, its material is changed to use
+    // the empty texture instead, and the slot is freed. Otherwise, the placeholder is kept.
+    void OnBackgroundLoadFailed(uint32_t frameIndex, uint32_t textureIndex);
+    // Decrement reference count of the texture slot and free it, if it's not referenced anymore.
+    void ReleaseTexture(uint32_t frameIndex, uint32_t textureIndex);
     void DestroyTexture(const Texture &texture);
     void AddToBeDestroyed(uint32_t frameIndex, const Texture &texture);
 
@@ -114,8 +135,18 @@ private:
     std::shared_ptr<SamplerManager> samplerMgr;
     std::shared_ptr<TextureDescriptors> textureDesc;
     std::shared_ptr<TextureUploader> textureUploader;
+    // null, if override files are opened without checking
+    std::shared_ptr<OverrideFileIndex> overrideFileIndex;
 
     std::vector<Texture> textures;
+    // Each element is 0 or ID of a background load that the corresponding
+    // texture slot is reserved for. The slot is reserved until its material is destroyed
+    // or until the load fails.
+    std::vector<uint64_t> textureLoadIDs;
+    // Count of material textures that reference the corresponding texture slot.
+    std::vector<uint32_t> textureRefCounts;
+    // Each element is 0 or content hash of the corresponding texture slot, if it can be shared.
+    std::vector<uint64_t> textureContentHashes;
     // Textures are not destroyed immediately, but when
     // they won't be in use
     std::vector<Texture> texturesToDestroy[MAX_FRAMES_IN_FLIGHT];
@@ -123,6 +154,37 @@ private:
     rgl::unordered_map<uint32_t, AnimatedMaterial> animatedMaterials;
     rgl::unordered_map<uint32_t, Material> materials;
 
+    struct SharedTexture
+    {
+        uint32_t                textureIndex;
+        // as it was at creation, as slot's handle can be changed by dynamic sampler filter
+        SamplerManager::Handle  samplerHandle;
+        // hashes can collide, so the parameters of the image
+        // and a second, independent hash of its data are compared too
+        VkFormat                format;
+        RgExtent2D              baseSize;
+        uint32_t                dataSize;
+        uint32_t                pregeneratedLevelCount;
+        bool                    useMipmaps;
+        uint64_t                dataHash;
+    };
+
+    // static textures with identical content are uploaded only once
+    rgl::unordered_map<uint64_t, SharedTexture> sharedTextures;
+
+    struct PendingTextureLoad
+    {
+        uint32_t                textureIndex;
+        SamplerManager::Handle  samplerHandle;
+        bool                    useMipmaps;
+        bool                    overridenIsSRGB;
+        std::string             debugName;
+    };
+
+    // null, if textures are loaded synchronously
+    std::unique_ptr<AsyncImageLoader> asyncImageLoader;
+    rgl::unordered_map<uint64_t, PendingTextureLoad> pendingTextureLoads;
+
     uint32_t waterNormalTextureIndex;
 
     RgSamplerFilter currentDynamicSamplerFilter;
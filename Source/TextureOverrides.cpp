@@ -87,6 +87,7 @@ TextureOverrides::TextureOverrides(
     std::shared_ptr<ImageLoader> _imageLoader) 
 :
     results{},
+    overridePaths{},
     debugName{},
     imageLoader(_imageLoader)
 {
@@ -104,19 +105,16 @@ TextureOverrides::TextureOverrides(
 
     if (!_overrideInfo.disableOverride)
     {
-        char paths[TEXTURES_PER_MATERIAL_COUNT][TEXTURE_FILE_PATH_MAX_LENGTH];
-        const bool hasOverrides = ParseOverrideTexturePaths(paths, _relativePath, _overrideInfo);
+        const bool hasOverrides = ParseOverrideTexturePaths(overridePaths, _relativePath, _overrideInfo);
 
-        if (hasOverrides)
+        if (hasOverrides && !_overrideInfo.onlyResolvePaths)
         {
             for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
             {
-                _imageLoader->Load(paths[i], &results[i]);
+                _imageLoader->Load(overridePaths[i], &results[i]);
 
                 // fix format, if needed
-                results[i].format = _overrideInfo.overridenIsSRGB[i] ?
-                    ConvertToSRGB(results[i].format) :
-                    ConvertToUnorm(results[i].format);
+                results[i].format = GetOverridenFormat(results[i].format, _overrideInfo.overridenIsSRGB[i]);
             }
 
             // don't check if wasn't loaded from file, pData might be provided by a user
@@ -240,6 +238,17 @@ const char *RTGL1::TextureOverrides::GetDebugName() const
     return debugName;
 }
 
+const char *RTGL1::TextureOverrides::GetOverridePath(uint32_t index) const
+{
+    assert(index < TEXTURES_PER_MATERIAL_COUNT);
+    return overridePaths[index];
+}
+
+VkFormat RTGL1::TextureOverrides::GetOverridenFormat(VkFormat loadedFormat, bool overridenIsSRGB)
+{
+    return overridenIsSRGB ? ConvertToSRGB(loadedFormat) : ConvertToUnorm(loadedFormat);
+}
+
 bool TextureOverrides::ParseOverrideTexturePaths(
     char paths[TEXTURES_PER_MATERIAL_COUNT][TEXTURE_FILE_PATH_MAX_LENGTH],
     const char *relativePath,
@@ -265,6 +274,20 @@ bool TextureOverrides::ParseOverrideTexturePaths(
     SPrintfIfNotNull(paths[1], overrideInfo.postfixes[1], overrideInfo.texturesPath, folderPath, name, newExtension);
     SPrintfIfNotNull(paths[2], overrideInfo.postfixes[2], overrideInfo.texturesPath, folderPath, name, newExtension);
 
+    if (overrideInfo.fileIndex != nullptr)
+    {
+        const size_t texturesPathLength = strlen(overrideInfo.texturesPath);
+
+        for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
+        {
+            // override file doesn't exist, don't try to open it
+            if (paths[i][0] != '\0' && !overrideInfo.fileIndex->Contains(paths[i] + texturesPathLength))
+            {
+                paths[i][0] = '\0';
+            }
+        }
+    }
+
     static_assert(TEXTURE_DEBUG_NAME_MAX_LENGTH < TEXTURE_FILE_PATH_MAX_LENGTH, "TEXTURE_DEBUG_NAME_MAX_LENGTH must be less than TEXTURE_FILE_PATH_MAX_LENGTH");
 
     memcpy(debugName, name, TEXTURE_DEBUG_NAME_MAX_LENGTH);
@@ -23,6 +23,7 @@
 #include "Common.h"
 #include "RTGL1/RTGL1.h"
 #include "ImageLoader.h"
+#include "OverrideFileIndex.h"
 
 namespace RTGL1
 {
@@ -43,6 +44,12 @@ public:
         // isn't overriden, RgTextureData::isSRGB value is used
         // instead of one of these params.
         bool overridenIsSRGB[TEXTURES_PER_MATERIAL_COUNT] = {};
+        // If true, override files are not loaded, only their paths are
+        // resolved, so the results contain only default data. See GetOverridePath.
+        bool onlyResolvePaths = false;
+        // If not null, override files that are not in the index of
+        // 'texturesPath' folder are ignored without trying to open them.
+        const OverrideFileIndex *fileIndex = nullptr;
     };
 
 public:
@@ -68,6 +75,11 @@ public:
 
     const ImageLoader::ResultInfo &GetResult(uint32_t index) const;
     const char *GetDebugName() const;
+    // Empty string, if there's no override for the texture.
+    const char *GetOverridePath(uint32_t index) const;
+
+    // Apply color space to the format of a loaded override file.
+    static VkFormat GetOverridenFormat(VkFormat loadedFormat, bool overridenIsSRGB);
 
 private:
     bool ParseOverrideTexturePaths(
@@ -77,6 +89,7 @@ private:
 
 private:
     ImageLoader::ResultInfo results[TEXTURES_PER_MATERIAL_COUNT];
+    char overridePaths[TEXTURES_PER_MATERIAL_COUNT][TEXTURE_FILE_PATH_MAX_LENGTH];
     char debugName[TEXTURE_DEBUG_NAME_MAX_LENGTH];
 
     std::weak_ptr<ImageLoader> imageLoader;
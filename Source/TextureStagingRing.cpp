@@ -0,0 +1,112 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureStagingRing.h"
+
+#include <algorithm>
+
+#include "Const.h"
+
+
+// enough for buffer-to-image copy offsets of 4-byte texels and BC blocks
+constexpr VkDeviceSize STAGING_RING_ALIGNMENT = 16;
+
+
+RTGL1::TextureStagingRing::TextureStagingRing(VkDevice device, std::shared_ptr<MemoryAllocator> _memAllocator, uint32_t sizeInMegabytes)
+:
+    memAllocator(std::move(_memAllocator)),
+    buffer(VK_NULL_HANDLE),
+    pMappedData(nullptr),
+    capacity(0),
+    head(0),
+    tail(0),
+    frameEnd{}
+{
+    if (sizeInMegabytes == 0)
+    {
+        sizeInMegabytes = TEXTURE_STAGING_RING_DEFAULT_SIZE_IN_MB;
+    }
+
+    // must fit into a block of the staging pool
+    capacity = std::min<VkDeviceSize>((VkDeviceSize)sizeInMegabytes * 1024 * 1024, ALLOCATOR_BLOCK_SIZE_STAGING_TEXTURES);
+
+    VkBufferCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    info.size = capacity;
+    info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    buffer = memAllocator->CreateStagingSrcTextureBuffer(&info, "Texture staging ring", &pMappedData);
+
+    // if couldn't allocate, all uploads will use dedicated buffers
+    if (buffer == VK_NULL_HANDLE)
+    {
+        capacity = 0;
+        return;
+    }
+
+    SET_DEBUG_NAME(device, buffer, VK_OBJECT_TYPE_BUFFER, "Texture staging ring");
+}
+
+RTGL1::TextureStagingRing::~TextureStagingRing()
+{
+    if (buffer != VK_NULL_HANDLE)
+    {
+        memAllocator->DestroyStagingSrcTextureBuffer(buffer);
+    }
+}
+
+void RTGL1::TextureStagingRing::PrepareForFrame(uint32_t frameIndex)
+{
+    // frame's fence was waited, its copies are finished
+    tail = std::max(tail, frameEnd[frameIndex]);
+}
+
+bool RTGL1::TextureStagingRing::Allocate(uint32_t frameIndex, VkDeviceSize size, Allocation *pResult)
+{
+    assert(pResult != nullptr);
+
+    if (buffer == VK_NULL_HANDLE || size == 0 || size > capacity)
+    {
+        return false;
+    }
+
+    uint64_t start = (head + STAGING_RING_ALIGNMENT - 1) / STAGING_RING_ALIGNMENT * STAGING_RING_ALIGNMENT;
+
+    // if doesn't fit until the end, start from the beginning
+    if (start % capacity + size > capacity)
+    {
+        start = (start / capacity + 1) * capacity;
+    }
+
+    // if it would overwrite the data that might be still in use
+    if (start + size - tail > capacity)
+    {
+        return false;
+    }
+
+    head = start + size;
+    frameEnd[frameIndex] = head;
+
+    pResult->buffer = buffer;
+    pResult->offset = start % capacity;
+    pResult->pMappedData = static_cast<uint8_t *>(pMappedData) + pResult->offset;
+
+    return true;
+}
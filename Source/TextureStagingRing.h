@@ -0,0 +1,70 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "MemoryAllocator.h"
+
+namespace RTGL1
+{
+
+// Persistently mapped staging buffer for texture uploads. Memory is sub-allocated
+// linearly, and the memory of a frame is reclaimed when the frame's fence was waited.
+class TextureStagingRing
+{
+public:
+    struct Allocation
+    {
+        VkBuffer        buffer;
+        VkDeviceSize    offset;
+        void            *pMappedData;
+    };
+
+public:
+    explicit TextureStagingRing(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator, uint32_t sizeInMegabytes);
+    ~TextureStagingRing();
+
+    TextureStagingRing(const TextureStagingRing &other) = delete;
+    TextureStagingRing(TextureStagingRing &&other) noexcept = delete;
+    TextureStagingRing &operator=(const TextureStagingRing &other) = delete;
+    TextureStagingRing &operator=(TextureStagingRing &&other) noexcept = delete;
+
+    // Reclaim the memory that was allocated MAX_FRAMES_IN_FLIGHT ago.
+    void PrepareForFrame(uint32_t frameIndex);
+
+    // Returns false, if there's not enough space: the caller should use a dedicated buffer instead.
+    bool Allocate(uint32_t frameIndex, VkDeviceSize size, Allocation *pResult);
+
+private:
+    std::shared_ptr<MemoryAllocator> memAllocator;
+
+    VkBuffer buffer;
+    void *pMappedData;
+    VkDeviceSize capacity;
+
+    // monotonic positions, actual offset is (position % capacity)
+    uint64_t head;
+    uint64_t tail;
+    // position of the end of the last allocation for each frame
+    uint64_t frameEnd[MAX_FRAMES_IN_FLIGHT];
+};
+
+}
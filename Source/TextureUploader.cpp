@@ -28,8 +28,9 @@
 
 using namespace RTGL1;
 
-TextureUploader::TextureUploader(VkDevice _device, std::shared_ptr<MemoryAllocator> _memAllocator)
-    : device(_device), memAllocator(std::move(_memAllocator))
+TextureUploader::TextureUploader(VkDevice _device, std::shared_ptr<MemoryAllocator> _memAllocator, std::shared_ptr<TextureStagingRing> _stagingRing,
+                                 std::shared_ptr<MipmapGenerator> _mipmapGenerator)
+    : device(_device), memAllocator(std::move(_memAllocator)), stagingRing(std::move(_stagingRing)), mipmapGenerator(std::move(_mipmapGenerator))
 {}
 
 TextureUploader::~TextureUploader()
@@ -57,7 +58,66 @@ void TextureUploader::ClearStaging(uint32_t frameIndex)
     }
 
     stagingToFree[frameIndex].clear();
+}
+
+bool TextureUploader::AllocateStaging(uint32_t frameIndex, VkDeviceSize size, const char *pDebugName, StagingAllocation *pResult)
+{
+    TextureStagingRing::Allocation r = {};
+
+    if (stagingRing->Allocate(frameIndex, size, &r))
+    {
+        pResult->buffer = r.buffer;
+        pResult->offset = r.offset;
+        pResult->pMappedData = r.pMappedData;
+        pResult->isDedicated = false;
+
+        return true;
+    }
+
+    // too large or the ring is full
+    return AllocateDedicatedStaging(size, pDebugName, pResult);
+}
+
+bool TextureUploader::AllocateDedicatedStaging(VkDeviceSize size, const char *pDebugName, StagingAllocation *pResult)
+{
+    VkBufferCreateInfo stagingInfo = {};
+    stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingInfo.size = size;
+    stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    void *mappedData = nullptr;
+
+    VkBuffer stagingBuffer = memAllocator->CreateStagingSrcTextureBuffer(&stagingInfo, pDebugName, &mappedData);
+    if (stagingBuffer == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+
+    SET_DEBUG_NAME(device, stagingBuffer, VK_OBJECT_TYPE_BUFFER, pDebugName);
+
+    pResult->buffer = stagingBuffer;
+    pResult->offset = 0;
+    pResult->pMappedData = mappedData;
+    pResult->isDedicated = true;
+
+    return true;
+}
+
+void TextureUploader::FreeStagingWhenUnused(uint32_t frameIndex, const StagingAllocation &staging)
+{
+    if (staging.isDedicated)
+    {
+        stagingToFree[frameIndex].push_back(staging.buffer);
+    }
+}
 
+void TextureUploader::FreeStagingNow(const StagingAllocation &staging)
+{
+    // ring memory is just left until its frame is reclaimed
+    if (staging.isDedicated)
+    {
+        memAllocator->DestroyStagingSrcTextureBuffer(staging.buffer);
+    }
 }
 
 bool TextureUploader::DoesFormatSupportBlit(VkFormat format) const
@@ -66,6 +126,16 @@ bool TextureUploader::DoesFormatSupportBlit(VkFormat format) const
     return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM;
 }
 
+bool TextureUploader::ShouldGenerateMipmapsInCompute(const UploadInfo &info) const
+{
+    // dynamic images are updated without frame index, cubemaps have several layers
+    return mipmapGenerator != nullptr &&
+        !info.isDynamic && !info.isCubemap &&
+        !AreMipmapsPregenerated(info) &&
+        MipmapGenerator::IsFormatSupported(info.format) &&
+        GetMipmapCount(info.baseSize, info) > 1;
+}
+
 bool TextureUploader::AreMipmapsPregenerated(const UploadInfo &info) const
 {
     return info.pregeneratedLevelCount > 0;
@@ -158,10 +228,10 @@ void TextureUploader::PrepareMipmaps(VkCommandBuffer cmd, VkImage image, uint32_
     }
 }
 
-void TextureUploader::CopyStagingToImage(VkCommandBuffer cmd, VkBuffer staging, VkImage image, const RgExtent2D &size, uint32_t baseLayer, uint32_t layerCount)
+void TextureUploader::CopyStagingToImage(VkCommandBuffer cmd, const StagingAllocation &staging, VkImage image, const RgExtent2D &size, uint32_t baseLayer, uint32_t layerCount)
 {
     VkBufferImageCopy copyRegion = {};
-    copyRegion.bufferOffset = 0;
+    copyRegion.bufferOffset = staging.offset;
     // tigthly packed
     copyRegion.bufferRowLength = 0;
     copyRegion.bufferImageHeight = 0;
@@ -173,11 +243,11 @@ void TextureUploader::CopyStagingToImage(VkCommandBuffer cmd, VkBuffer staging,
     copyRegion.imageSubresource.layerCount = layerCount;
 
     vkCmdCopyBufferToImage(
-        cmd, staging, image,
+        cmd, staging.buffer, image,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
 }
 
-void TextureUploader::CopyStagingToImageMipmaps(VkCommandBuffer cmd, VkBuffer staging, VkImage image, uint32_t layerIndex, const UploadInfo &info)
+void TextureUploader::CopyStagingToImageMipmaps(VkCommandBuffer cmd, const StagingAllocation &staging, VkImage image, uint32_t layerIndex, const UploadInfo &info)
 {
     uint32_t mipWidth = info.baseSize.width;
     uint32_t mipHeight = info.baseSize.height;
@@ -191,7 +261,7 @@ void TextureUploader::CopyStagingToImageMipmaps(VkCommandBuffer cmd, VkBuffer st
         auto &cr = copyRegions[mipLevel];
 
         cr = {};
-        cr.bufferOffset = info.pLevelDataOffsets[mipLevel];
+        cr.bufferOffset = staging.offset + info.pLevelDataOffsets[mipLevel];
         cr.bufferRowLength = 0;
         cr.bufferImageHeight = 0;
         cr.imageExtent = { mipWidth, mipHeight, 1 };
@@ -206,7 +276,7 @@ void TextureUploader::CopyStagingToImageMipmaps(VkCommandBuffer cmd, VkBuffer st
     }
 
     vkCmdCopyBufferToImage(
-        cmd, staging, image,
+        cmd, staging.buffer, image,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, copyRegions);
 }
 
@@ -229,6 +299,12 @@ bool TextureUploader::CreateImage(const UploadInfo &info, VkImage *result)
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
+    if (ShouldGenerateMipmapsInCompute(info))
+    {
+        imageInfo.flags |= MipmapGenerator::GetRequiredImageCreateFlags(info.format);
+        imageInfo.usage |= MipmapGenerator::GetRequiredImageUsage();
+    }
+
     VkImage image = memAllocator->CreateDstTextureImage(&imageInfo, info.pDebugName);
     if (image == VK_NULL_HANDLE)
     {
@@ -241,7 +317,7 @@ bool TextureUploader::CreateImage(const UploadInfo &info, VkImage *result)
     return true;
 }
 
-void TextureUploader::PrepareImage(VkImage image, VkBuffer staging[], const UploadInfo &info, ImagePrepareType prepareType)
+void TextureUploader::PrepareImage(VkImage image, const StagingAllocation staging[], const UploadInfo &info, ImagePrepareType prepareType)
 {
     VkCommandBuffer     cmd             = info.cmd;
     const RgExtent2D    &size           = info.baseSize;
@@ -334,6 +410,20 @@ void TextureUploader::PrepareImage(VkImage image, VkBuffer staging[], const Uplo
         }
     }
 
+    if (mipmapCount > 1 && ShouldGenerateMipmapsInCompute(info))
+    {
+        // 3A'. Generate mipmaps in compute, it also prepares all mipmaps for reading;
+        // if there's no space for it in this frame, use blit
+        bool wasGenerated = mipmapGenerator->Generate(
+            cmd, info.frameIndex, image, info.format, size, mipmapCount,
+            curAccessMask, curLayout, curStageMask);
+
+        if (wasGenerated)
+        {
+            return;
+        }
+    }
+
     if (mipmapCount > 1)
     {
         if (!AreMipmapsPregenerated(info) && DoesFormatSupportBlit(info.format))
@@ -385,8 +475,15 @@ VkImageView TextureUploader::CreateImageView(VkImage image, VkFormat format, boo
 {
     VkImageView view;
 
+    // image can have storage usage for mipmap generation,
+    // which is not supported by sRGB formats, but the view is only sampled
+    VkImageViewUsageCreateInfo usageInfo = {};
+    usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+    usageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+
     VkImageViewCreateInfo viewInfo = {};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.pNext = &usageInfo;
     viewInfo.image = image;
     viewInfo.viewType = isCubemap ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D;
     viewInfo.format = format;
@@ -418,30 +515,27 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     UploadResult result = {};
     result.wasUploaded = false;
 
-    VkResult r;
-    void *mappedData;
     VkImage image;
 
     // 1. Allocate and fill buffer
 
-    VkBufferCreateInfo stagingInfo = {};
-    stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    stagingInfo.size = dataSize;
-    stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    StagingAllocation staging = {};
 
-    VkBuffer stagingBuffer = memAllocator->CreateStagingSrcTextureBuffer(&stagingInfo, info.pDebugName, &mappedData);
-    if (stagingBuffer == VK_NULL_HANDLE)
+    // dynamic images keep their staging buffer for updating
+    bool wasAllocated = info.isDynamic ?
+        AllocateDedicatedStaging(dataSize, info.pDebugName, &staging) :
+        AllocateStaging(info.frameIndex, dataSize, info.pDebugName, &staging);
+
+    if (!wasAllocated)
     {
         return result;
     }
 
-    SET_DEBUG_NAME(device, stagingBuffer, VK_OBJECT_TYPE_BUFFER, info.pDebugName);
-
     bool wasCreated = CreateImage(info, &image);
     if (!wasCreated)
     {
         // clean created resources
-        memAllocator->DestroyStagingSrcTextureBuffer(stagingBuffer);
+        FreeStagingNow(staging);
         return result;
     }
 
@@ -449,15 +543,15 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     if (info.isDynamic && data == nullptr)
     {
         // create image without copying
-        PrepareImage(image, VK_NULL_HANDLE, info, ImagePrepareType::INIT_WITHOUT_COPYING);
+        PrepareImage(image, nullptr, info, ImagePrepareType::INIT_WITHOUT_COPYING);
     }
     else
     {
         // copy image data to buffer
-        memcpy(mappedData, data, dataSize);
+        memcpy(staging.pMappedData, data, dataSize);
 
         // and copy it to image
-        PrepareImage(image, &stagingBuffer, info, ImagePrepareType::INIT);
+        PrepareImage(image, &staging, info, ImagePrepareType::INIT);
     }
 
     // create image view
@@ -470,9 +564,11 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     {
         // for dynamic images:
         // save pointer for updating image data
+        assert(staging.isDedicated);
+
         DynamicImageInfo updateInfo = {};
-        updateInfo.stagingBuffer = stagingBuffer;
-        updateInfo.mappedData = mappedData;
+        updateInfo.stagingBuffer = staging.buffer;
+        updateInfo.mappedData = staging.pMappedData;
         updateInfo.dataSize = (uint32_t)dataSize;
         updateInfo.imageSize = size;
         updateInfo.generateMipmaps = info.useMipmaps;
@@ -483,7 +579,7 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     {
         // for static images that won't be updated:
         // push staging buffer to be deleted when it won't be in use
-        stagingToFree[info.frameIndex].push_back(stagingBuffer);
+        FreeStagingWhenUnused(info.frameIndex, staging);
     }
 
     // return results
@@ -511,8 +607,14 @@ void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicIma
         info.baseSize = updateInfo.imageSize;
         info.useMipmaps = updateInfo.generateMipmaps;
 
+        StagingAllocation staging = {};
+        staging.buffer = updateInfo.stagingBuffer;
+        staging.offset = 0;
+        staging.pMappedData = updateInfo.mappedData;
+        staging.isDedicated = true;
+
         // copy from staging
-        PrepareImage(dynamicImage, &updateInfo.stagingBuffer, info, ImagePrepareType::UPDATE);
+        PrepareImage(dynamicImage, &staging, info, ImagePrepareType::UPDATE);
     }
 }
 
@@ -24,6 +24,8 @@
 
 #include "Common.h"
 #include "MemoryAllocator.h"
+#include "MipmapGenerator.h"
+#include "TextureStagingRing.h"
 #include "RTGL1/RTGL1.h"
 
 namespace RTGL1
@@ -64,7 +66,9 @@ public:
     };
 
 public:
-    TextureUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator);
+    // If 'mipmapGenerator' is null, mipmaps are generated only using blit.
+    TextureUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator, std::shared_ptr<TextureStagingRing> stagingRing,
+                    std::shared_ptr<MipmapGenerator> mipmapGenerator);
     virtual ~TextureUploader();
 
     TextureUploader(const TextureUploader &other) = delete;
@@ -72,7 +76,8 @@ public:
     TextureUploader &operator=(const TextureUploader &other) = delete;
     TextureUploader &operator=(TextureUploader &&other) noexcept = delete;
 
-    // Clear staging buffer for given frame index.
+    // Clear dedicated staging buffers for given frame index.
+    // Staging ring memory is reclaimed by the ring itself.
     void ClearStaging(uint32_t frameIndex);
 
     virtual UploadResult UploadImage(const UploadInfo &info);
@@ -87,8 +92,26 @@ protected:
         UPDATE
     };
 
+    struct StagingAllocation
+    {
+        VkBuffer        buffer;
+        VkDeviceSize    offset;
+        void            *pMappedData;
+        // if false, it's a part of the staging ring
+        bool            isDedicated;
+    };
+
 protected:
+    // Sub-allocate from the staging ring, if there's no space, create a dedicated buffer.
+    bool AllocateStaging(uint32_t frameIndex, VkDeviceSize size, const char *pDebugName, StagingAllocation *pResult);
+    bool AllocateDedicatedStaging(VkDeviceSize size, const char *pDebugName, StagingAllocation *pResult);
+    // Dedicated buffer will be destroyed when it'll be certainly not in use.
+    void FreeStagingWhenUnused(uint32_t frameIndex, const StagingAllocation &staging);
+    // Must be called only if staging wasn't used in a command buffer.
+    void FreeStagingNow(const StagingAllocation &staging);
+
     bool DoesFormatSupportBlit(VkFormat format) const;
+    bool ShouldGenerateMipmapsInCompute(const UploadInfo &info) const;
     bool AreMipmapsPregenerated(const UploadInfo &info) const;
     uint32_t GetMipmapCount(const RgExtent2D &size, const UploadInfo &info) const;
 
@@ -100,13 +123,13 @@ protected:
 
     // Image must have TRANSFER_DST layout
     static void CopyStagingToImage(
-        VkCommandBuffer cmd, VkBuffer staging, VkImage image, const RgExtent2D &size, uint32_t baseLayer, uint32_t layerCount);
+        VkCommandBuffer cmd, const StagingAllocation &staging, VkImage image, const RgExtent2D &size, uint32_t baseLayer, uint32_t layerCount);
     void CopyStagingToImageMipmaps(
-        VkCommandBuffer cmd, VkBuffer staging, VkImage image, uint32_t layerIndex, const UploadInfo &info);
+        VkCommandBuffer cmd, const StagingAllocation &staging, VkImage image, uint32_t layerIndex, const UploadInfo &info);
 
     bool CreateImage(const UploadInfo &info, VkImage *result);
     // Create mipmaps and prepare image for usage in shaders
-    void PrepareImage(VkImage image, VkBuffer staging[], const UploadInfo &info, ImagePrepareType prepareType);
+    void PrepareImage(VkImage image, const StagingAllocation staging[], const UploadInfo &info, ImagePrepareType prepareType);
     VkImageView CreateImageView(VkImage image, VkFormat format, bool isCubemap, uint32_t mipmapCount);
 
 private:
@@ -123,6 +146,8 @@ protected:
     VkDevice device;
 
     std::shared_ptr<MemoryAllocator> memAllocator;
+    std::shared_ptr<TextureStagingRing> stagingRing;
+    std::shared_ptr<MipmapGenerator> mipmapGenerator;
 
     // Staging buffers that were used for uploading must be destroyed
     // on the frame with same index when it'll be certainly not in use
@@ -257,7 +257,7 @@ void RTGL1::Tonemapping::CreatePipelines(const ShaderManager *shaderManager)
     {
         plInfo.stage = shaderManager->GetStageInfo("CLuminanceHistogram");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &histogramPipeline);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &histogramPipeline);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, histogramPipeline, VK_OBJECT_TYPE_PIPELINE, "Tonemapping LuminanceHistogram pipeline");
@@ -266,7 +266,7 @@ void RTGL1::Tonemapping::CreatePipelines(const ShaderManager *shaderManager)
     {
         plInfo.stage = shaderManager->GetStageInfo("CLuminanceAvg");
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &avgLuminancePipeline);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &avgLuminancePipeline);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, avgLuminancePipeline, VK_OBJECT_TYPE_PIPELINE, "Tonemapping LuminanceAvg pipeline");
@@ -19,6 +19,9 @@
 // SOFTWARE.
 
 #include "TriangleInfoManager.h"
+
+#include <algorithm>
+
 #include "Generated/ShaderCommonC.h"
 
 constexpr VkDeviceSize TRIANGLE_INFO_SIZE = sizeof(uint32_t);
@@ -32,12 +35,13 @@ RTGL1::TriangleInfoManager::TriangleInfoManager(
     sectorVisibility(std::move(_sectorVisibility)),
     staticGeometryRange(0),
     dynamicGeometryRange(0),
-    copyStaticRange(false)
+    copyStaticRange(false),
+    copiedStaticRangeEnd(0)
 {
     triangleSectorIndicesBuffer = std::make_unique<AutoBuffer>(device, _allocator);
     triangleSectorIndicesBuffer->Create(MAX_INDEXED_PRIMITIVE_COUNT * TRIANGLE_INFO_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Triangle info");
 
-    static_assert(sizeof(decltype(tempValues)::value_type) == TRIANGLE_INFO_SIZE, "");
+    static_assert(sizeof(SectorArrayIndex::index_t) == TRIANGLE_INFO_SIZE, "");
 }
 
 RTGL1::TriangleInfoManager::~TriangleInfoManager()
@@ -61,8 +65,34 @@ uint32_t RTGL1::TriangleInfoManager::UploadAndGetArrayIndex(uint32_t frameIndex,
     }
 
 
-    auto &indices = TransformIdsToIndices(pTriangleSectorIDs, count);
+    auto &indices = TransformIdsToIndices(pTriangleSectorIDs, count, geomType);
+
+    // only reservation is serialized, copying is not
+    const uint32_t startIndexInArray = ReserveRange((uint32_t)indices.size(), geomType);
+
+    if (geomType == RG_GEOMETRY_TYPE_DYNAMIC)
+    {
+        uint32_t *pDst = (uint32_t *)triangleSectorIndicesBuffer->GetMapped(frameIndex);
+        memcpy(&pDst[startIndexInArray], indices.data(), indices.size() * TRIANGLE_INFO_SIZE);
+    }
+    else
+    {
+        // need to copy static geom data to both staging buffers, to be able to upload it in any frameIndex
+        for (uint32_t f = 0; f < MAX_FRAMES_IN_FLIGHT; f++)
+        {
+            uint32_t *pDst = (uint32_t *)triangleSectorIndicesBuffer->GetMapped(f);
+            memcpy(&pDst[startIndexInArray], indices.data(), indices.size() * TRIANGLE_INFO_SIZE);
+        }
+    }
+
+
+    indices.clear();
+    return startIndexInArray;
+}
 
+uint32_t RTGL1::TriangleInfoManager::ReserveRange(uint32_t count, RgGeometryType geomType)
+{
+    std::lock_guard<std::mutex> lock(rangeMutex);
 
     uint32_t startIndexInArray;
 
@@ -76,34 +106,18 @@ uint32_t RTGL1::TriangleInfoManager::UploadAndGetArrayIndex(uint32_t frameIndex,
         // to add dynamic, static must be already locked
         assert(staticGeometryRange.IsLocked());
 
-
         startIndexInArray = dynamicGeometryRange.GetFirstIndexAfterRange();
-
-        uint32_t *pDst = (uint32_t *)triangleSectorIndicesBuffer->GetMapped(frameIndex);
-        memcpy(&pDst[startIndexInArray], indices.data(), indices.size() * TRIANGLE_INFO_SIZE);
-
-        dynamicGeometryRange.Add(indices.size());
+        dynamicGeometryRange.Add(count);
     }
     else
     {
         startIndexInArray = staticGeometryRange.GetFirstIndexAfterRange();
-
-        // need to copy static geom data to both staging buffers, to be able to upload it in any frameIndex
-        for (uint32_t f = 0; f < MAX_FRAMES_IN_FLIGHT; f++)
-        {
-            uint32_t *pDst = (uint32_t *)triangleSectorIndicesBuffer->GetMapped(f);
-            memcpy(&pDst[startIndexInArray], indices.data(), indices.size() * TRIANGLE_INFO_SIZE);
-        }
-
-        staticGeometryRange.Add(indices.size());
-
+        staticGeometryRange.Add(count);
 
         // update dynamic, as it should start right after static
-        dynamicGeometryRange.StartIndexingAfter(staticGeometryRange);
+        dynamicGeometryRange.StartIndexingFrom(GetFirstDynamicIndex());
     }
 
-
-    indices.clear();
     return startIndexInArray;
 }
 
@@ -111,26 +125,46 @@ void RTGL1::TriangleInfoManager::PrepareForFrame(uint32_t frameIndex)
 {
     // start dynamic again, but don't touch static geom indices
     dynamicGeometryRange.Reset(0);
-    dynamicGeometryRange.StartIndexingAfter(staticGeometryRange);
+    dynamicGeometryRange.StartIndexingFrom(GetFirstDynamicIndex());
 }
 
 void RTGL1::TriangleInfoManager::Reset()
 {
     staticGeometryRange.Reset(0);
     dynamicGeometryRange.Reset(0);
+    dynamicGeometryRange.StartIndexingFrom(GetFirstDynamicIndex());
+    copyStaticRange = false;
+}
+
+void RTGL1::TriangleInfoManager::MarkStaticRangeToCopy()
+{
     copyStaticRange = true;
 }
 
-std::vector<RTGL1::SectorArrayIndex::index_t> &RTGL1::TriangleInfoManager::TransformIdsToIndices(const uint32_t *pTriangleSectorIDs, uint32_t count)
+uint32_t RTGL1::TriangleInfoManager::GetFirstDynamicIndex() const
+{
+    return std::max(staticGeometryRange.GetFirstIndexAfterRange(), copiedStaticRangeEnd);
+}
+
+std::vector<RTGL1::SectorArrayIndex::index_t> &RTGL1::TriangleInfoManager::TransformIdsToIndices(const uint32_t *pTriangleSectorIDs, uint32_t count, RgGeometryType geomType) const
 {
-    assert(tempValues.empty());
+    // per-thread scratch, so uploads from different threads don't interfere
+    thread_local std::vector<SectorArrayIndex::index_t> tempValues;
+
+    // could be not empty, if the previous call on this thread threw
+    tempValues.clear();
     tempValues.reserve(count);
 
     for (uint32_t i = 0; i < count; i++)
     {
         SectorID id = SectorID{ pTriangleSectorIDs[i] };
 
-        tempValues.push_back(sectorVisibility->SectorIDToArrayIndex(id).GetArrayIndex());
+        // static geometry is a part of the new scene
+        SectorArrayIndex index = geomType == RG_GEOMETRY_TYPE_DYNAMIC ?
+            sectorVisibility->SectorIDToArrayIndex(id) :
+            sectorVisibility->SectorIDToArrayIndexInNewScene(id);
+
+        tempValues.push_back(index.GetArrayIndex());
     }
 
     return tempValues;
@@ -148,6 +182,10 @@ bool RTGL1::TriangleInfoManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t f
         copyInfos[cc].size = staticGeometryRange.GetCount() * TRIANGLE_INFO_SIZE;
         cc++;
     }
+    if (copyStaticRange)
+    {
+        copiedStaticRangeEnd = staticGeometryRange.GetFirstIndexAfterRange();
+    }
     if (dynamicGeometryRange.GetCount() > 0)
     {
         copyInfos[cc].srcOffset = copyInfos[cc].dstOffset = dynamicGeometryRange.GetStartIndex() * TRIANGLE_INFO_SIZE;
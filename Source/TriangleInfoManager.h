@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <vector>
 
 #include "RTGL1/RTGL1.h"
@@ -42,14 +43,22 @@ public:
 
     void PrepareForFrame(uint32_t frameIndex);
     void Reset();
+    // Static range is not copied to device-local buffer until this call,
+    // so the previous static scene's data is valid while the new one is being built.
+    void MarkStaticRangeToCopy();
 
+    // Can be called from several threads for dynamic geometry
     uint32_t UploadAndGetArrayIndex(uint32_t frameIndex, const uint32_t *pTriangleSectorIDs, uint32_t count, RgGeometryType geomType);
 
     bool CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex, bool insertBarrier = true);
     VkBuffer GetBuffer() const;
 
 private:
-    std::vector<SectorArrayIndex::index_t> &TransformIdsToIndices(const uint32_t *pTriangleSectorIDs, uint32_t count);
+    std::vector<SectorArrayIndex::index_t> &TransformIdsToIndices(const uint32_t *pTriangleSectorIDs, uint32_t count, RgGeometryType geomType) const;
+    // Returns the start of the reserved range
+    uint32_t ReserveRange(uint32_t count, RgGeometryType geomType);
+    // Dynamic data must not overwrite static data that is in device-local buffer
+    uint32_t GetFirstDynamicIndex() const;
 
 private:
     struct Range
@@ -66,6 +75,7 @@ private:
         void Lock()                              { locked = true; }
         void Reset(uint32_t _startIndex)         { startIndex = _startIndex; count = 0; locked = false; }
         void StartIndexingAfter(const Range &r)  { assert(count == 0 && !locked); startIndex = r.GetFirstIndexAfterRange(); }
+        void StartIndexingFrom(uint32_t index)   { assert(count == 0 && !locked); startIndex = index; }
 
         uint32_t GetStartIndex() const           { return startIndex; }
         uint32_t GetFirstIndexAfterRange() const { return startIndex + count; }
@@ -87,9 +97,11 @@ private:
     Range staticGeometryRange;
     Range dynamicGeometryRange;
     bool copyStaticRange;
+    // end of the static range that was copied to device-local buffer
+    uint32_t copiedStaticRangeEnd;
 
-
-    std::vector<SectorArrayIndex::index_t> tempValues;
+    // guards ranges, as geometries can be uploaded from several threads
+    std::mutex rangeMutex;
 };
 
 }
\ No newline at end of file
@@ -21,10 +21,12 @@
 #include "VertexCollector.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 
 #include "Generated/ShaderCommonC.h"
 #include "Matrix.h"
+#include "RgException.h"
 
 using namespace RTGL1;
 
@@ -55,18 +57,25 @@ VertexCollector::VertexCollector(
     std::shared_ptr<SectorVisibility> _sectorVisibility,
     VkDeviceSize _bufferSize,
     const VertexBufferProperties &_properties,
-    VertexCollectorFilterTypeFlags _filters) 
+    VertexCollectorFilterTypeFlags _filters,
+    RgStaticGeometryChunking _staticChunking,
+    uint32_t _staticChunkPrimitiveCount) 
 :
     device(_device),
     properties(_properties),
     filtersFlags(_filters),
+    staticChunking(_staticChunking),
+    staticChunkPrimitiveCount(_staticChunkPrimitiveCount),
     geomInfoMgr(std::move(_geomInfoManager)),
     triangleInfoMgr(std::move(_triangleInfoMgr)),
     sectorVisibility(std::move(_sectorVisibility)),
     curVertexCount(0), curIndexCount(0), curPrimitiveCount(0), curTransformCount(0),
+    reservedGeometryTotal(0),
     mappedVertexData(nullptr), mappedIndexData(nullptr), mappedTransformData(nullptr), 
     texCoordsToCopyLowerBound(UINT64_MAX),
-    texCoordsToCopyUpperBound(0)
+    texCoordsToCopyUpperBound(0),
+    incrementalVertices(MAX_STATIC_VERTEX_COUNT),
+    incrementalIndices(MAX_INDEXED_PRIMITIVE_COUNT * 3)
 {
     assert(filtersFlags != 0);
 
@@ -114,6 +123,8 @@ VertexCollector::VertexCollector(
     device(_src->device),
     properties(_src->properties),
     filtersFlags(_src->filtersFlags),
+    staticChunking(_src->staticChunking),
+    staticChunkPrimitiveCount(_src->staticChunkPrimitiveCount),
     vertBuffer(_src->vertBuffer),
     indexBuffer(_src->indexBuffer),
     transformsBuffer(_src->transformsBuffer),
@@ -121,9 +132,12 @@ VertexCollector::VertexCollector(
     triangleInfoMgr(_src->triangleInfoMgr),
     sectorVisibility(_src->sectorVisibility),
     curVertexCount(0), curIndexCount(0), curPrimitiveCount(0), curTransformCount(0),
+    reservedGeometryTotal(0),
     mappedVertexData(nullptr), mappedIndexData(nullptr), mappedTransformData(nullptr),
     texCoordsToCopyLowerBound(UINT64_MAX),
-    texCoordsToCopyUpperBound(0)
+    texCoordsToCopyUpperBound(0),
+    incrementalVertices(MAX_STATIC_VERTEX_COUNT),
+    incrementalIndices(MAX_INDEXED_PRIMITIVE_COUNT * 3)
 {
     // device local buffers are shared with the "src" vertex collector
     InitStagingBuffers(_allocator);
@@ -207,11 +221,183 @@ static uint32_t AlignUpBy3(uint32_t x)
     return ((x + 2) / 3) * 3;
 }
 
+// If "pData" points to an element in the mapped array, that starts at "pArrayBegin"
+// and has "elementCount" elements, then return its index.
+static bool GetIndexInMappedArray(const void *pData, const void *pArrayBegin, uint64_t stride, uint32_t elementCount, uint32_t &outIndex)
+{
+    const auto p = reinterpret_cast<uintptr_t>(pData);
+    const auto begin = reinterpret_cast<uintptr_t>(pArrayBegin);
+
+    if (p < begin || p >= begin + elementCount * stride)
+    {
+        return false;
+    }
+
+    if ((p - begin) % stride != 0)
+    {
+        return false;
+    }
+
+    outIndex = static_cast<uint32_t>((p - begin) / stride);
+    return true;
+}
+
+// Atomically reserve "count" elements starting from the first index aligned by 3.
+// Returns false, if the range doesn't fit "maxCount".
+static bool ReserveAlignedRange(std::atomic<uint32_t> &counter, uint32_t count, uint32_t maxCount, uint32_t &outStart)
+{
+    uint32_t cur = counter.load(std::memory_order_relaxed);
+    uint32_t start;
+
+    do
+    {
+        start = AlignUpBy3(cur);
+
+        if ((uint64_t)start + count >= maxCount)
+        {
+            return false;
+        }
+    }
+    while (!counter.compare_exchange_weak(cur, start + count, std::memory_order_relaxed));
+
+    outStart = start;
+    return true;
+}
+
 uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT])
+{
+    const VertexCollectorFilterTypeFlags geomFlags = VertexCollectorFilterTypeFlags_GetForGeometry(info);
+
+
+    VkAccelerationStructureGeometryKHR geom;
+    uint32_t primitiveCount;
+    ShGeometryInstance geomInfo;
+    uint32_t transformIndex;
+
+    if (!ReserveGeometrySlot(geomFlags))
+    {
+        return UINT32_MAX;
+    }
+
+    // heavy copying is done in parallel, if called from several threads
+    if (!PrepareGeometry(frameIndex, info, materials, geomFlags, true, true, geom, primitiveCount, geomInfo, transformIndex))
+    {
+        std::lock_guard<std::mutex> lock(addGeometryMutex);
+        ReleaseGeometrySlot(geomFlags);
+
+        return UINT32_MAX;
+    }
+
+
+    // the order of geometries in BLAS and in geometry infos must be the same
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+    ReleaseGeometrySlot(geomFlags);
+
+    return PushPreparedGeometry(frameIndex, info, materials, geomFlags, geom, primitiveCount, geomInfo, transformIndex);
+}
+
+uint32_t VertexCollector::AddDeviceWrittenGeometry(
+    uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+    bool generateNormals, DeviceWrittenRange &outRange)
 {
     typedef VertexCollectorFilterTypeFlagBits FT;
     const VertexCollectorFilterTypeFlags geomFlags = VertexCollectorFilterTypeFlags_GetForGeometry(info);
 
+    // static data is never rewritten, so it's not needed
+    if (!(geomFlags & FT::CF_DYNAMIC))
+    {
+        assert(0);
+        return UINT32_MAX;
+    }
+
+
+    VkAccelerationStructureGeometryKHR geom;
+    uint32_t primitiveCount;
+    ShGeometryInstance geomInfo;
+    uint32_t transformIndex;
+
+    if (!ReserveGeometrySlot(geomFlags))
+    {
+        return UINT32_MAX;
+    }
+
+    if (!PrepareGeometry(frameIndex, info, materials, geomFlags, true, false, geom, primitiveCount, geomInfo, transformIndex))
+    {
+        std::lock_guard<std::mutex> lock(addGeometryMutex);
+        ReleaseGeometrySlot(geomFlags);
+
+        return UINT32_MAX;
+    }
+
+    // "info" doesn't have normal data, so rely only on the argument
+    if (generateNormals)
+    {
+        geomInfo.flags |= GEOM_INST_FLAG_GENERATE_NORMALS;
+    }
+    else
+    {
+        geomInfo.flags &= ~GEOM_INST_FLAG_GENERATE_NORMALS;
+    }
+
+    outRange = {};
+    outRange.firstVertex = geomInfo.baseVertexIndex;
+    outRange.vertexCount = info.vertexCount;
+    outRange.firstIndex = geomInfo.baseIndexIndex != UINT32_MAX ? geomInfo.baseIndexIndex : 0;
+    outRange.indexCount = geomInfo.baseIndexIndex != UINT32_MAX ? info.indexCount : 0;
+
+
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+    ReleaseGeometrySlot(geomFlags);
+
+    // even if the geometry won't be added, the range must not be copied
+    deviceWrittenRanges.push_back(outRange);
+
+    return PushPreparedGeometry(frameIndex, info, materials, geomFlags, geom, primitiveCount, geomInfo, transformIndex);
+}
+
+bool VertexCollector::ReserveGeometrySlot(VertexCollectorFilterTypeFlags geomFlags)
+{
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+
+    uint32_t &reservedCount = reservedGeometryCounts[geomFlags];
+
+    // if exceeds a limit of geometries in a group with specified geomFlags
+    if (GetGeometryCount(geomFlags) + reservedCount + 1 >= VertexCollectorFilterTypeFlags_GetAmountInGlobalArray(geomFlags))
+    {
+        assert(false && "Too many geometries in a group");
+        return false;
+    }
+
+    if ((geomInfoMgr->GetCount() + reservedGeometryTotal + 1) >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
+    {
+        assert(0);
+        return false;
+    }
+
+    reservedCount++;
+    reservedGeometryTotal++;
+
+    return true;
+}
+
+void VertexCollector::ReleaseGeometrySlot(VertexCollectorFilterTypeFlags geomFlags)
+{
+    uint32_t &reservedCount = reservedGeometryCounts[geomFlags];
+
+    assert(reservedCount > 0 && reservedGeometryTotal > 0);
+
+    reservedCount--;
+    reservedGeometryTotal--;
+}
+
+uint32_t VertexCollector::PushPreparedGeometry(
+    uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+    VertexCollectorFilterTypeFlags geomFlags,
+    const VkAccelerationStructureGeometryKHR &geom, uint32_t primitiveCount, const ShGeometryInstance &geomInfo,
+    uint32_t transformIndex)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+    const bool collectStatic = geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE);
 
     // if exceeds a limit of geometries in a group with specified geomFlags
     if (GetGeometryCount(geomFlags) + 1 >= VertexCollectorFilterTypeFlags_GetAmountInGlobalArray(geomFlags))
@@ -220,47 +406,361 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
         return UINT32_MAX;
     }
 
+    if ((geomInfoMgr->GetCount() + 1) >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
+    {
+        assert(0);
+        return UINT32_MAX;
+    }
 
-    const bool collectStatic = geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE);
 
-    const uint32_t maxVertexCount = collectStatic ? MAX_STATIC_VERTEX_COUNT : MAX_DYNAMIC_VERTEX_COUNT;
+    uint32_t localIndex = PushGeometry(geomFlags, geom);
 
 
-    const uint32_t vertIndex = AlignUpBy3(curVertexCount);
-    const uint32_t indIndex = AlignUpBy3(curIndexCount);
-    const uint32_t transformIndex = curTransformCount;
+    VkAccelerationStructureBuildRangeInfoKHR rangeInfo = {};
+    rangeInfo.primitiveCount = primitiveCount;
+    rangeInfo.primitiveOffset = 0;
+    rangeInfo.firstVertex = 0;
+    rangeInfo.transformOffset = 0;
+    PushRangeInfo(geomFlags, rangeInfo);
+
+
+    PushPrimitiveCount(geomFlags, primitiveCount);
+
+
+    // geometry with per triangle sectors doesn't belong to any specific sector
+    filters[geomFlags]->PushToChunk(localIndex, primitiveCount, 
+                                    info.pTriangleSectorIDs == nullptr ? geomInfo.sectorArrayIndex : VertexCollectorFilter::NO_SECTOR);
+
+
+    // simple index -- calculated as (global cur static count + global cur dynamic count)
+    // global geometry index -- for indexing in geom infos buffer
+    // local geometry index -- index of geometry in BLAS
+    uint32_t simpleIndex = geomInfoMgr->WriteGeomInfo(frameIndex, info.uniqueID, localIndex, geomFlags, geomInfo);
+
+
+    if (collectStatic)
+    {
+        // add material dependency but only for static geometry,
+        // dynamic is updated each frame, so their materials will be updated anyway
+        for (uint32_t layer = 0; layer < MATERIALS_MAX_LAYER_COUNT; layer++)
+        {
+            const uint32_t materialIndex = info.geomMaterial.layerMaterials[layer];
+
+            for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
+            {
+                // if at least one texture is not empty on this layer, add dependency 
+                if (materials[layer].indices[t] != EMPTY_TEXTURE_INDEX)
+                {
+                    AddMaterialDependency(simpleIndex, layer, materialIndex);
+
+                    break;
+                }               
+            }
+        }
+
+        // also, save transform index for updating static movable's transforms
+        simpleIndexToTransformIndex[simpleIndex] = transformIndex;
+    }
+
+
+    return simpleIndex;
+}
+
+// Same as in vertex preprocessing: each triangle writes its normal to its vertices
+static std::vector<uint8_t> GenerateFlatNormals(const RgGeometryUploadInfo &info, const VertexBufferProperties &properties)
+{
+    std::vector<uint8_t> normals((uint64_t)info.vertexCount * properties.normalStride, 0);
+
+    const auto *positions = static_cast<const uint8_t *>(info.pVertexData);
+    const auto *indices = static_cast<const uint32_t *>(info.pIndexData);
+
+    const uint32_t triangleCount = indices != nullptr ? info.indexCount / 3 : info.vertexCount / 3;
+    const float sign = (info.flags & RG_GEOMETRY_UPLOAD_GENERATE_INVERTED_NORMALS_BIT) ? -1.0f : 1.0f;
+
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        uint32_t v[3];
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            v[i] = indices != nullptr ? indices[t * 3 + i] : t * 3 + i;
+
+            if (v[i] >= info.vertexCount)
+            {
+                throw RgException(RG_WRONG_ARGUMENT, "Index is out of vertex count bounds");
+            }
+        }
+
+        const auto *p0 = reinterpret_cast<const float *>(positions + v[0] * (uint64_t)properties.positionStride);
+        const auto *p1 = reinterpret_cast<const float *>(positions + v[1] * (uint64_t)properties.positionStride);
+        const auto *p2 = reinterpret_cast<const float *>(positions + v[2] * (uint64_t)properties.positionStride);
+
+        const float e1[] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float e2[] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+        float n[] =
+        {
+            e1[1] * e2[2] - e1[2] * e2[1],
+            e1[2] * e2[0] - e1[0] * e2[2],
+            e1[0] * e2[1] - e1[1] * e2[0],
+        };
+
+        const float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        const float k = len > 0.0f ? sign / len : 0.0f;
+
+        n[0] *= k;
+        n[1] *= k;
+        n[2] *= k;
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            memcpy(normals.data() + v[i] * (uint64_t)properties.normalStride, n, sizeof(n));
+        }
+    }
+
+    return normals;
+}
+
+uint32_t VertexCollector::AddInstancedMesh(uint32_t frameIndex, const RgGeometryUploadInfo &_info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT])
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+    const VertexCollectorFilterTypeFlags geomFlags = VertexCollectorFilterTypeFlags_GetForGeometry(_info);
+
+    // only static vertex data can be shared between frames
+    if (!(geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE)))
+    {
+        assert(0);
+        return UINT32_MAX;
+    }
+
+
+    // mesh vertices are not preprocessed, so normals must be generated here
+    RgGeometryUploadInfo info = _info;
+    std::vector<uint8_t> generatedNormals;
+
+    if (info.pNormalData == nullptr)
+    {
+        generatedNormals = GenerateFlatNormals(info, properties);
+        info.pNormalData = generatedNormals.data();
+    }
+
+
+    VkAccelerationStructureGeometryKHR geom;
+    uint32_t primitiveCount;
+    ShGeometryInstance geomInfo;
+    uint32_t transformIndex;
+
+    // mesh has its own BLAS, and it's placed using TLAS instance transforms
+    if (!PrepareGeometry(frameIndex, info, materials, geomFlags, false, true, geom, primitiveCount, geomInfo, transformIndex))
+    {
+        return UINT32_MAX;
+    }
+
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+
+    return PushInstancedMesh(info, geomFlags, geom, primitiveCount, geomInfo);
+}
+
+uint32_t VertexCollector::AddIncrementalMesh(uint32_t frameIndex, const RgGeometryUploadInfo &_info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT])
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+    const VertexCollectorFilterTypeFlags geomFlags = VertexCollectorFilterTypeFlags_GetForGeometry(_info);
+
+    if (!(geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE)))
+    {
+        assert(0);
+        return UINT32_MAX;
+    }
+
+
+    RgGeometryUploadInfo info = _info;
+    std::vector<uint8_t> generatedNormals;
+
+    // triangle infos of static geometry are copied only when a scene is applied
+    info.pTriangleSectorIDs = nullptr;
+
+    if (info.pNormalData == nullptr)
+    {
+        generatedNormals = GenerateFlatNormals(info, properties);
+        info.pNormalData = generatedNormals.data();
+    }
 
     const bool useIndices = info.indexCount != 0 && info.pIndexData != nullptr;
+
+
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+
+    // align by 3, as in ReserveAlignedRange
+    IncrementalRange r = {};
+    r.vertexCount = AlignUpBy3(info.vertexCount);
+    r.indexCount = useIndices ? AlignUpBy3(info.indexCount) : 0;
+
+    if (!incrementalVertices.Allocate(r.vertexCount, &r.firstVertex))
+    {
+        return UINT32_MAX;
+    }
+
+    if (!incrementalIndices.Allocate(r.indexCount, &r.firstIndex))
+    {
+        incrementalVertices.Free(r.firstVertex, r.vertexCount);
+        return UINT32_MAX;
+    }
+
+    VkAccelerationStructureGeometryKHR geom;
+    ShGeometryInstance geomInfo;
+
+    PrepareGeometryInRange(frameIndex, info, materials, geomFlags, 
+                           r.firstVertex, useIndices ? r.firstIndex : UINT32_MAX, UINT32_MAX, true,
+                           geom, geomInfo);
+
     const uint32_t primitiveCount = useIndices ? info.indexCount / 3 : info.vertexCount / 3;
 
+    r.meshIndex = PushInstancedMesh(info, geomFlags, geom, primitiveCount, geomInfo);
 
-    curVertexCount = vertIndex + info.vertexCount;
-    curIndexCount = indIndex + (useIndices ? info.indexCount : 0);
-    curPrimitiveCount += primitiveCount;
-    curTransformCount += 1;
+    incrementalMeshRanges[r.meshIndex] = r;
+    incrementalToCopy.push_back(r);
 
+    return r.meshIndex;
+}
 
-    // check bounds
-    if (curVertexCount >= maxVertexCount ||
-        curIndexCount >= MAX_INDEXED_PRIMITIVE_COUNT * 3 ||
-        (geomInfoMgr->GetCount() + 1) >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
+uint32_t VertexCollector::PushInstancedMesh(
+    const RgGeometryUploadInfo &info, VertexCollectorFilterTypeFlags geomFlags,
+    const VkAccelerationStructureGeometryKHR &geom, uint32_t primitiveCount, const ShGeometryInstance &geomInfo)
+{
+    InstancedMesh mesh = {};
+    mesh.uniqueID = info.uniqueID;
+    mesh.filter = geomFlags;
+    mesh.geom = geom;
+    mesh.primitiveCount = primitiveCount;
+
+    mesh.range.primitiveCount = primitiveCount;
+    mesh.range.primitiveOffset = 0;
+    mesh.range.firstVertex = 0;
+    mesh.range.transformOffset = 0;
+
+    // materials are resolved on each placement, so no material dependency is required
+    memcpy(mesh.layerMaterials, info.geomMaterial.layerMaterials, sizeof(mesh.layerMaterials));
+
+    // reuse indices of removed meshes
+    if (!freeMeshIndices.empty())
+    {
+        uint32_t meshIndex = freeMeshIndices.back();
+        freeMeshIndices.pop_back();
+
+        instancedMeshes[meshIndex] = mesh;
+        instancedMeshGeomInfos[meshIndex] = geomInfo;
+
+        return meshIndex;
+    }
+
+    instancedMeshes.push_back(mesh);
+    instancedMeshGeomInfos.push_back(geomInfo);
+
+    return (uint32_t)instancedMeshes.size() - 1;
+}
+
+void VertexCollector::RemoveIncrementalMesh(uint32_t meshIndex)
+{
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+
+    auto f = incrementalMeshRanges.find(meshIndex);
+
+    if (f == incrementalMeshRanges.end())
     {
         assert(0);
-        return UINT32_MAX;
+        return;
     }
 
-    // copy data to buffer
-    assert(stagingVertBuffer.IsMapped());
-    CopyDataToStaging(info, vertIndex, collectStatic);
+    const IncrementalRange &r = f->second;
+
+    incrementalVertices.Free(r.firstVertex, r.vertexCount);
+    incrementalIndices.Free(r.firstIndex, r.indexCount);
+
+    instancedMeshes[meshIndex] = {};
+    freeMeshIndices.push_back(meshIndex);
+
+    incrementalMeshRanges.erase(f);
+}
+
+bool VertexCollector::PrepareGeometry(
+    uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+    VertexCollectorFilterTypeFlags geomFlags, bool useTransform, bool copyToStaging,
+    VkAccelerationStructureGeometryKHR &geom, uint32_t &primitiveCount, ShGeometryInstance &geomInfo,
+    uint32_t &transformIndex)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    const bool collectStatic = geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE);
+
+    const uint32_t maxVertexCount = collectStatic ? MAX_STATIC_VERTEX_COUNT : MAX_DYNAMIC_VERTEX_COUNT;
+
+
+    // device written geometry has only counts
+    const bool useIndices = info.indexCount != 0 && (info.pIndexData != nullptr || !copyToStaging);
+    primitiveCount = useIndices ? info.indexCount / 3 : info.vertexCount / 3;
+
+
+    // reserve ranges in staging, other threads will write after them;
+    // also, check bounds
+    uint32_t vertIndex = 0;
+    uint32_t indIndex = 0;
+
+    // data could be already written to the ranges, that were reserved by ReserveDynamicGeometry
+    if (!copyToStaging || !GetReservedRange(info, collectStatic, useIndices, vertIndex, indIndex))
+    {
+        if (!ReserveAlignedRange(curVertexCount, info.vertexCount, maxVertexCount, vertIndex))
+        {
+            assert(0);
+            return false;
+        }
+
+        if (useIndices && !ReserveAlignedRange(curIndexCount, info.indexCount, MAX_INDEXED_PRIMITIVE_COUNT * 3, indIndex))
+        {
+            assert(0);
+            return false;
+        }
+    }
+
+    curPrimitiveCount += primitiveCount;
+    transformIndex = useTransform ? curTransformCount++ : 0;
+
+    PrepareGeometryInRange(frameIndex, info, materials, geomFlags, 
+                           vertIndex, useIndices ? indIndex : UINT32_MAX, useTransform ? transformIndex : UINT32_MAX, copyToStaging,
+                           geom, geomInfo);
+    return true;
+}
+
+void VertexCollector::PrepareGeometryInRange(
+    uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+    VertexCollectorFilterTypeFlags geomFlags, uint32_t vertIndex, uint32_t indIndex, uint32_t transformIndex, bool copyToStaging,
+    VkAccelerationStructureGeometryKHR &geom, ShGeometryInstance &geomInfo)
+{
+    typedef VertexCollectorFilterTypeFlagBits FT;
+
+    const bool collectStatic = geomFlags & (FT::CF_STATIC_NON_MOVABLE | FT::CF_STATIC_MOVABLE);
+
+    const bool useIndices = indIndex != UINT32_MAX;
+    const bool useTransform = transformIndex != UINT32_MAX;
+    const uint32_t primitiveCount = useIndices ? info.indexCount / 3 : info.vertexCount / 3;
 
-    if (useIndices)
+    // copy data to buffer
+    if (copyToStaging)
     {
-        assert(stagingIndexBuffer.IsMapped());
-        memcpy(mappedIndexData + indIndex, info.pIndexData, info.indexCount * sizeof(uint32_t));
+        assert(stagingVertBuffer.IsMapped());
+        CopyDataToStaging(info, vertIndex, collectStatic);
+
+        if (useIndices && info.pIndexData != mappedIndexData + indIndex)
+        {
+            assert(stagingIndexBuffer.IsMapped());
+            memcpy(mappedIndexData + indIndex, info.pIndexData, info.indexCount * sizeof(uint32_t));
+        }
     }
 
-    static_assert(sizeof(RgTransform) == sizeof(VkTransformMatrixKHR), "RgTransform and VkTransformMatrixKHR must have the same structure to be used in AS building");
-    memcpy(mappedTransformData + transformIndex, &info.transform, sizeof(VkTransformMatrixKHR));
+    if (useTransform)
+    {
+        static_assert(sizeof(RgTransform) == sizeof(VkTransformMatrixKHR), "RgTransform and VkTransformMatrixKHR must have the same structure to be used in AS building");
+        memcpy(mappedTransformData + transformIndex, &info.transform, sizeof(VkTransformMatrixKHR));
+    }
 
     const uint32_t offsetPositions = collectStatic ?
         offsetof(ShVertexBufferStatic, positions) :
@@ -271,7 +771,7 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
         vertBuffer->GetAddress() + offsetPositions + vertIndex * static_cast<uint64_t>(properties.positionStride);
 
     // geometry info
-    VkAccelerationStructureGeometryKHR geom = {};
+    geom = {};
     geom.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
     geom.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
 
@@ -285,7 +785,11 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
     trData.maxVertex = info.vertexCount;
     trData.vertexData.deviceAddress = vertexDataDeviceAddress;
     trData.vertexStride = properties.positionStride;
-    trData.transformData.deviceAddress = transformsBuffer->GetAddress() + transformIndex * sizeof(VkTransformMatrixKHR);
+
+    // null transform is an identity
+    trData.transformData.deviceAddress = useTransform ?
+        transformsBuffer->GetAddress() + transformIndex * sizeof(VkTransformMatrixKHR) :
+        0;
 
     if (useIndices)
     {
@@ -302,21 +806,7 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
     }
 
 
-    uint32_t localIndex = PushGeometry(geomFlags, geom);
-
-
-    VkAccelerationStructureBuildRangeInfoKHR rangeInfo = {};
-    rangeInfo.primitiveCount = primitiveCount;
-    rangeInfo.primitiveOffset = 0;
-    rangeInfo.firstVertex = 0;
-    rangeInfo.transformOffset = 0;
-    PushRangeInfo(geomFlags, rangeInfo);
-
-
-    PushPrimitiveCount(geomFlags, primitiveCount);
-
-
-    ShGeometryInstance geomInfo = {};
+    geomInfo = {};
     geomInfo.baseVertexIndex = vertIndex;
     geomInfo.baseIndexIndex = useIndices ? indIndex : UINT32_MAX;
     geomInfo.vertexCount = info.vertexCount;
@@ -410,41 +900,10 @@ uint32_t VertexCollector::AddGeometry(uint32_t frameIndex, const RgGeometryUploa
     }
 
     geomInfo.triangleArrayIndex = triangleInfoMgr->UploadAndGetArrayIndex(frameIndex, info.pTriangleSectorIDs, primitiveCount, info.geomType);
-    geomInfo.sectorArrayIndex = sectorVisibility->SectorIDToArrayIndex(SectorID{ info.sectorID }).GetArrayIndex();
-
-
-    // simple index -- calculated as (global cur static count + global cur dynamic count)
-    // global geometry index -- for indexing in geom infos buffer
-    // local geometry index -- index of geometry in BLAS
-    uint32_t simpleIndex = geomInfoMgr->WriteGeomInfo(frameIndex, info.uniqueID, localIndex, geomFlags, geomInfo);
-
-
-    if (collectStatic)
-    {
-        // add material dependency but only for static geometry,
-        // dynamic is updated each frame, so their materials will be updated anyway
-        for (uint32_t layer = 0; layer < MATERIALS_MAX_LAYER_COUNT; layer++)
-        {
-            const uint32_t materialIndex = info.geomMaterial.layerMaterials[layer];
-
-            for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
-            {
-                // if at least one texture is not empty on this layer, add dependency 
-                if (materials[layer].indices[t] != EMPTY_TEXTURE_INDEX)
-                {
-                    AddMaterialDependency(simpleIndex, layer, materialIndex);
-
-                    break;
-                }               
-            }
-        }
-
-        // also, save transform index for updating static movable's transforms
-        simpleIndexToTransformIndex[simpleIndex] = transformIndex;
-    }
-
-
-    return simpleIndex;
+    // static geometry is a part of the new scene
+    geomInfo.sectorArrayIndex = info.geomType == RG_GEOMETRY_TYPE_DYNAMIC ?
+        sectorVisibility->SectorIDToArrayIndex(SectorID{ info.sectorID }).GetArrayIndex() :
+        sectorVisibility->SectorIDToArrayIndexInNewScene(SectorID{ info.sectorID }).GetArrayIndex();
 }
 
 void VertexCollector::CopyDataToStaging(const RgGeometryUploadInfo &info, uint32_t vertIndex, bool isStatic)
@@ -467,13 +926,17 @@ void VertexCollector::CopyDataToStaging(const RgGeometryUploadInfo &info, uint32
     void *positionsDst = mappedVertexData + offsetPositions + vertIndex * positionStride;
     assert(offsetPositions + (vertIndex + info.vertexCount) * positionStride < wholeBufferSize);
 
-    memcpy(positionsDst, info.pVertexData, info.vertexCount * positionStride);
+    // if the same, it was written in-place
+    if (info.pVertexData != positionsDst)
+    {
+        memcpy(positionsDst, info.pVertexData, info.vertexCount * positionStride);
+    }
 
     // normals
     void *normalsDst = mappedVertexData + offsetNormals + vertIndex * normalStride;
     assert(offsetNormals + (vertIndex + info.vertexCount) * normalStride < wholeBufferSize);
 
-    if (info.pNormalData != nullptr)
+    if (info.pNormalData != nullptr && info.pNormalData != normalsDst)
     {
         memcpy(normalsDst, info.pNormalData, info.vertexCount * normalStride);
     }
@@ -511,7 +974,10 @@ void RTGL1::VertexCollector::CopyTexCoordsToStaging(bool isStatic, uint32_t glob
             void *texCoordDst = mappedVertexData + dstOffsetBegin;
             assert(dstOffsetEnd < wholeBufferSize);
 
-            memcpy(texCoordDst, texCoordLayerData[i], texCoordDataSize);
+            if (texCoordLayerData[i] != texCoordDst)
+            {
+                memcpy(texCoordDst, texCoordLayerData[i], texCoordDataSize);
+            }
 
 
             if (addToCopy)
@@ -531,8 +997,108 @@ void RTGL1::VertexCollector::CopyTexCoordsToStaging(bool isStatic, uint32_t glob
 }
 
 
+bool VertexCollector::ReserveDynamicGeometry(uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping &outMapping)
+{
+    assert(filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC);
+    assert(mappedVertexData != nullptr && mappedIndexData != nullptr);
+
+    uint32_t vertIndex = 0;
+    uint32_t indIndex = 0;
+
+    if (!ReserveAlignedRange(curVertexCount, vertexCount, MAX_DYNAMIC_VERTEX_COUNT, vertIndex))
+    {
+        return false;
+    }
+
+    if (indexCount > 0 && !ReserveAlignedRange(curIndexCount, indexCount, MAX_INDEXED_PRIMITIVE_COUNT * 3, indIndex))
+    {
+        // vertex range is left unused
+        return false;
+    }
+
+    outMapping = {};
+    outMapping.pVertexData = mappedVertexData + offsetof(ShVertexBufferDynamic, positions) + vertIndex * static_cast<uint64_t>(properties.positionStride);
+    outMapping.pNormalData = mappedVertexData + offsetof(ShVertexBufferDynamic, normals) + vertIndex * static_cast<uint64_t>(properties.normalStride);
+
+    for (uint32_t i = 0; i < TEXCOORD_LAYER_COUNT_DYNAMIC; i++)
+    {
+        outMapping.pTexCoordLayerData[i] = mappedVertexData + OFFSET_TEX_COORDS_DYNAMIC[i] + vertIndex * static_cast<uint64_t>(properties.texCoordStride);
+    }
+
+    outMapping.pIndexData = indexCount > 0 ? mappedIndexData + indIndex : nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(reservedRangesMutex);
+        reservedRanges[vertIndex] = { vertexCount, indIndex, indexCount };
+    }
+
+    return true;
+}
+
+bool VertexCollector::GetReservedRange(const RgGeometryUploadInfo &info, bool isStatic, bool useIndices, uint32_t &outVertIndex, uint32_t &outIndIndex)
+{
+    if (isStatic)
+    {
+        return false;
+    }
+
+    const uint8_t *pPositions = mappedVertexData + offsetof(ShVertexBufferDynamic, positions);
+
+    if (!GetIndexInMappedArray(info.pVertexData, pPositions, properties.positionStride, curVertexCount, outVertIndex))
+    {
+        return false;
+    }
+
+    // vertex data is in the reserved range, so index data must be too
+    if (useIndices && !GetIndexInMappedArray(info.pIndexData, mappedIndexData, sizeof(uint32_t), curIndexCount, outIndIndex))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "pVertexData was reserved by rgReserveDynamicGeometry, but pIndexData wasn't");
+    }
+
+    std::lock_guard<std::mutex> lock(reservedRangesMutex);
+
+    auto found = reservedRanges.find(outVertIndex);
+
+    if (found == reservedRanges.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "pVertexData is not the start of a range, that was reserved by rgReserveDynamicGeometry, "
+                                             "or the range was already committed");
+    }
+
+    const ReservedRange &r = found->second;
+
+    if (info.vertexCount > r.vertexCount ||
+        (useIndices && (outIndIndex != r.firstIndex || info.indexCount > r.indexCount)))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Vertex or index data doesn't match the range, that was reserved by rgReserveDynamicGeometry");
+    }
+
+    // the same mapping must not be committed twice
+    reservedRanges.erase(found);
+
+    return true;
+}
+
 void VertexCollector::EndCollecting()
-{}
+{
+    if (filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+
+    uint32_t first;
+
+    // collected ranges are used until Reset
+    incrementalVertices.Reset();
+    incrementalVertices.Allocate(AlignUpBy3(curVertexCount), &first);
+    assert(first == 0);
+
+    incrementalIndices.Reset();
+    incrementalIndices.Allocate(AlignUpBy3(curIndexCount), &first);
+    assert(first == 0);
+}
 
 void VertexCollector::Reset()
 {
@@ -545,6 +1111,19 @@ void VertexCollector::Reset()
 
     materialDependencies.clear();
 
+    deviceWrittenRanges.clear();
+
+    reservedRanges.clear();
+
+    instancedMeshes.clear();
+    instancedMeshGeomInfos.clear();
+
+    incrementalVertices.Reset();
+    incrementalIndices.Reset();
+    incrementalMeshRanges.clear();
+    freeMeshIndices.clear();
+    incrementalToCopy.clear();
+
     for (auto &f : filters)
     {
         f.second->Reset();
@@ -575,15 +1154,31 @@ bool VertexCollector::CopyIndexDataFromStaging(VkCommandBuffer cmd)
         return false;
     }
 
-    VkBufferCopy info = {};
-    info.srcOffset = 0;
-    info.dstOffset = 0;
-    info.size = curIndexCount * sizeof(uint32_t);
+    const auto ranges = GetStagingCopyRanges(true, curIndexCount);
+
+    // all indices are written on device
+    if (ranges.empty())
+    {
+        return false;
+    }
+
+    std::vector<VkBufferCopy> infos;
+    infos.reserve(ranges.size());
+
+    for (const auto &r : ranges)
+    {
+        VkBufferCopy info = {};
+        info.srcOffset = r.first * sizeof(uint32_t);
+        info.dstOffset = r.first * sizeof(uint32_t);
+        info.size = r.second * sizeof(uint32_t);
+
+        infos.push_back(info);
+    }
 
     vkCmdCopyBuffer(
         cmd,
         stagingIndexBuffer.GetBuffer(), indexBuffer->GetBuffer(),
-        1, &info);
+        infos.size(), infos.data());
 
     return true;
 }
@@ -628,14 +1223,10 @@ bool VertexCollector::CopyTransformsFromStaging(VkCommandBuffer cmd, bool insert
     return true;
 }
 
-bool VertexCollector::RecopyTransformsFromStaging(VkCommandBuffer cmd)
-{
-    return CopyTransformsFromStaging(cmd, true);
-}
-
 bool RTGL1::VertexCollector::RecopyTexCoordsFromStaging(VkCommandBuffer cmd)
 {
-    if (curTransformCount == 0 || texCoordsToCopy.empty())
+    // instanced meshes don't have transforms, so check only the changes
+    if (texCoordsToCopy.empty())
     {
         return false;
     }
@@ -670,17 +1261,98 @@ bool RTGL1::VertexCollector::RecopyTexCoordsFromStaging(VkCommandBuffer cmd)
     return true;
 }
 
+bool VertexCollector::CopyIncrementalFromStaging(VkCommandBuffer cmd)
+{
+    std::lock_guard<std::mutex> lock(addGeometryMutex);
+
+    if (incrementalToCopy.empty())
+    {
+        return false;
+    }
+
+    std::vector<VkBufferCopy> vertCopyInfos;
+    std::vector<VkBufferCopy> indCopyInfos;
+
+    for (const auto &r : incrementalToCopy)
+    {
+        PushVertBufferCopyInfos(true, r.firstVertex, r.vertexCount, vertCopyInfos);
+
+        if (r.indexCount > 0)
+        {
+            indCopyInfos.push_back({ r.firstIndex * sizeof(uint32_t), r.firstIndex * sizeof(uint32_t), r.indexCount * sizeof(uint32_t) });
+        }
+    }
+
+    incrementalToCopy.clear();
+
+    vkCmdCopyBuffer(
+        cmd,
+        stagingVertBuffer.GetBuffer(), vertBuffer->GetBuffer(),
+        vertCopyInfos.size(), vertCopyInfos.data());
+
+    if (!indCopyInfos.empty())
+    {
+        vkCmdCopyBuffer(
+            cmd,
+            stagingIndexBuffer.GetBuffer(), indexBuffer->GetBuffer(),
+            indCopyInfos.size(), indCopyInfos.data());
+    }
+
+    // other ranges of the buffers are in use, so barriers only for the copied ones
+    std::vector<VkBufferMemoryBarrier> barriers;
+    barriers.reserve(vertCopyInfos.size() + indCopyInfos.size());
+
+    for (const auto &cp : vertCopyInfos)
+    {
+        VkBufferMemoryBarrier br = {};
+        br.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        br.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        br.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        br.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        br.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        br.buffer = vertBuffer->GetBuffer();
+        br.offset = cp.dstOffset;
+        br.size = cp.size;
+
+        barriers.push_back(br);
+    }
+
+    for (const auto &cp : indCopyInfos)
+    {
+        VkBufferMemoryBarrier br = {};
+        br.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        br.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        br.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        br.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        br.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        br.buffer = indexBuffer->GetBuffer();
+        br.offset = cp.dstOffset;
+        br.size = cp.size;
+
+        barriers.push_back(br);
+    }
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0, nullptr,
+        barriers.size(), barriers.data(),
+        0, nullptr);
+
+    return true;
+}
+
 bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexData)
 {
     const auto vrtCopied = CopyVertexDataFromStaging(cmd, isStaticVertexData);
     bool indCopied = CopyIndexDataFromStaging(cmd);
     bool trnCopied = CopyTransformsFromStaging(cmd, false);
 
-    VkBufferMemoryBarrier barriers[9];
+    std::vector<VkBufferMemoryBarrier> barriers(vrtCopied.size() + 1);
     uint32_t barrierCount = 0;
 
-    assert(vrtCopied.size() + 1 < sizeof(barriers) / sizeof(barriers[0]));
-
     // prepare for preprocessing
     for (const auto &cp : vrtCopied)
     {
@@ -721,7 +1393,7 @@ bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexDa
             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
             0,
             0, nullptr,
-            barrierCount, barriers,
+            barrierCount, barriers.data(),
             0, nullptr);
     }
 
@@ -750,13 +1422,36 @@ bool VertexCollector::CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexDa
     return !vrtCopied.empty() || indCopied || trnCopied;
 }
 
-bool VertexCollector::GetVertBufferCopyInfos(bool isStatic, std::vector<VkBufferCopy> &outInfos) const
+bool VertexCollector::GetVertBufferCopyInfos(bool isStatic, std::vector<VkBufferCopy> &outInfos, bool skipDeviceWritten) const
 {
     if (curVertexCount == 0 || curPrimitiveCount == 0)
     {
         return false;
     }
 
+    const auto ranges = skipDeviceWritten ?
+        GetStagingCopyRanges(false, curVertexCount) :
+        std::vector<std::pair<uint32_t, uint32_t>>{ { 0, curVertexCount.load() } };
+
+    if (ranges.empty())
+    {
+        return false;
+    }
+
+    // positions, normals + texCoords
+    uint32_t count = 2 + (isStatic ? TEXCOORD_LAYER_COUNT_STATIC : TEXCOORD_LAYER_COUNT_DYNAMIC);
+    outInfos.reserve(count * ranges.size());
+
+    for (const auto &r : ranges)
+    {
+        PushVertBufferCopyInfos(isStatic, r.first, r.second, outInfos);
+    }
+
+    return true;
+}
+
+void VertexCollector::PushVertBufferCopyInfos(bool isStatic, uint64_t first, uint64_t vertCount, std::vector<VkBufferCopy> &outInfos) const
+{
     const uint32_t offsetPositions = isStatic ?
         offsetof(ShVertexBufferStatic, positions) :
         offsetof(ShVertexBufferDynamic, positions);
@@ -767,45 +1462,84 @@ bool VertexCollector::GetVertBufferCopyInfos(bool isStatic, std::vector<VkBuffer
 
     const uint64_t *offsetTexCoords = isStatic ? OFFSET_TEX_COORDS_STATIC : OFFSET_TEX_COORDS_DYNAMIC;
     uint32_t        offsetCount     = isStatic ? TEXCOORD_LAYER_COUNT_STATIC : TEXCOORD_LAYER_COUNT_DYNAMIC;
-    
-    // positions, normals + texCoords
-    uint32_t count = 2 + offsetCount;
-    outInfos.reserve(count);
 
-    outInfos.push_back({ offsetPositions,    offsetPositions,    (uint64_t)curVertexCount * properties.positionStride });
-    outInfos.push_back({ offsetNormals,      offsetNormals,      (uint64_t)curVertexCount * properties.normalStride   });
+    outInfos.push_back({ offsetPositions + first * properties.positionStride, offsetPositions + first * properties.positionStride, vertCount * properties.positionStride });
+    outInfos.push_back({ offsetNormals   + first * properties.normalStride,   offsetNormals   + first * properties.normalStride,   vertCount * properties.normalStride   });
 
     for (uint32_t i = 0; i < offsetCount; i++)
     {
-        outInfos.push_back({ offsetTexCoords[i], offsetTexCoords[i], (uint64_t)curVertexCount * properties.texCoordStride });
+        const uint64_t offset = offsetTexCoords[i] + first * properties.texCoordStride;
+        outInfos.push_back({ offset, offset, vertCount * properties.texCoordStride });
     }
-
-    return true;
 }
 
-void VertexCollector::UpdateTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo)
+std::vector<std::pair<uint32_t, uint32_t>> VertexCollector::GetStagingCopyRanges(bool forIndices, uint32_t totalCount) const
 {
-    if (simpleIndex >= MAX_BOTTOM_LEVEL_GEOMETRIES_COUNT)
+    std::vector<std::pair<uint32_t, uint32_t>> written;
+    written.reserve(deviceWrittenRanges.size());
+
+    for (const auto &d : deviceWrittenRanges)
     {
-        assert(0);
-        return;
+        if (forIndices)
+        {
+            written.emplace_back(d.firstIndex, d.indexCount);
+        }
+        else
+        {
+            written.emplace_back(d.firstVertex, d.vertexCount);
+        }
     }
 
-    assert(mappedTransformData != nullptr);
+    std::sort(written.begin(), written.end());
+
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    uint32_t cur = 0;
+
+    for (const auto &w : written)
+    {
+        if (w.first > cur)
+        {
+            result.emplace_back(cur, std::min(w.first, totalCount) - cur);
+        }
+
+        cur = std::max(cur, w.first + w.second);
+
+        if (cur >= totalCount)
+        {
+            break;
+        }
+    }
 
-    static_assert(sizeof(RgTransform) == sizeof(VkTransformMatrixKHR), "RgTransform and VkTransformMatrixKHR must have the same structure to be used in AS building");
-    memcpy(mappedTransformData + simpleIndexToTransformIndex[simpleIndex], &updateInfo.transform, sizeof(VkTransformMatrixKHR));
+    if (cur < totalCount)
+    {
+        result.emplace_back(cur, totalCount - cur);
+    }
 
-    geomInfoMgr->WriteStaticGeomInfoTransform(simpleIndex, updateInfo.movableStaticUniqueID, updateInfo.transform);
+    return result;
 }
 
 void RTGL1::VertexCollector::UpdateTexCoords(uint32_t simpleIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
+{
+    // base vertex index is saved in geometry instance info
+    UpdateTexCoordsAt(geomInfoMgr->GetStaticGeomBaseVertexIndex(simpleIndex), texCoordsInfo);
+}
+
+void VertexCollector::UpdateInstancedMeshTexCoords(uint32_t meshIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
+{
+    if (meshIndex >= instancedMeshGeomInfos.size())
+    {
+        assert(0);
+        return;
+    }
+
+    UpdateTexCoordsAt(instancedMeshGeomInfos[meshIndex].baseVertexIndex, texCoordsInfo);
+}
+
+void VertexCollector::UpdateTexCoordsAt(uint32_t globalVertIndex, const RgUpdateTexCoordsInfo &texCoordsInfo)
 {
     const bool isStatic = true;
     const uint32_t maxVertexCount = isStatic ? MAX_STATIC_VERTEX_COUNT : MAX_DYNAMIC_VERTEX_COUNT;
 
-    // base vertex index is saved in geometry instance info
-    uint32_t globalVertIndex = geomInfoMgr->GetStaticGeomBaseVertexIndex(simpleIndex);
     uint32_t dstVertIndex = globalVertIndex + texCoordsInfo.vertexOffset;
 
     if (dstVertIndex + texCoordsInfo.vertexCount >= maxVertexCount)
@@ -843,6 +1577,17 @@ void VertexCollector::OnMaterialChange(uint32_t materialIndex, const MaterialTex
 }
 
 
+const std::vector<VertexCollector::InstancedMesh> &VertexCollector::GetInstancedMeshes() const
+{
+    return instancedMeshes;
+}
+
+const ShGeometryInstance &VertexCollector::GetInstancedMeshGeomInfo(uint32_t meshIndex) const
+{
+    assert(meshIndex < instancedMeshGeomInfos.size());
+    return instancedMeshGeomInfos[meshIndex];
+}
+
 VkBuffer VertexCollector::GetVertexBuffer() const
 {
     return vertBuffer->GetBuffer();
@@ -880,6 +1625,23 @@ const std::vector<VkAccelerationStructureBuildRangeInfoKHR> &VertexCollector::Ge
     return f->second->GetASBuildRangeInfos();
 }
 
+const std::vector<VertexCollectorFilter::Chunk> &VertexCollector::GetChunks(
+    VertexCollectorFilterTypeFlags filter) const
+{
+    auto f = filters.find(filter);
+    assert(f != filters.end());
+
+    return f->second->GetChunks();
+}
+
+bool VertexCollector::IsChunked(VertexCollectorFilterTypeFlags filter) const
+{
+    auto f = filters.find(filter);
+    assert(f != filters.end());
+
+    return f->second->IsChunked();
+}
+
 bool VertexCollector::AreGeometriesEmpty(VertexCollectorFilterTypeFlags flags) const
 {
     for (const auto &p : filters)
@@ -911,7 +1673,8 @@ void VertexCollector::InsertVertexPreprocessFinishBarrier(VkCommandBuffer cmd)
 {
     std::vector<VkBufferCopy> vertCopyInfos;
     bool isDynamic = filtersFlags & VertexCollectorFilterTypeFlagBits::CF_DYNAMIC;
-    GetVertBufferCopyInfos(!isDynamic, vertCopyInfos);
+    // device written ranges could be preprocessed too, so include them
+    GetVertBufferCopyInfos(!isDynamic, vertCopyInfos, false);
 
 
     VkBufferMemoryBarrier barriers[10];
@@ -1025,7 +1788,15 @@ void VertexCollector::AddFilter(VertexCollectorFilterTypeFlags filterGroup)
 
     assert(filters.find(filterGroup) == filters.end());
 
-    filters[filterGroup] = std::make_shared<VertexCollectorFilter>(filterGroup);
+    // only static non-movable geometry can be chunked, others are changed as a whole
+    if (filterGroup & VertexCollectorFilterTypeFlagBits::CF_STATIC_NON_MOVABLE)
+    {
+        filters[filterGroup] = std::make_shared<VertexCollectorFilter>(filterGroup, staticChunking, staticChunkPrimitiveCount);
+    }
+    else
+    {
+        filters[filterGroup] = std::make_shared<VertexCollectorFilter>(filterGroup);
+    }
 }
 
 // try create filters for each group (mask)
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 #include "Buffer.h"
@@ -27,6 +29,7 @@
 #include "GeomInfoManager.h"
 #include "IMaterialDependency.h"
 #include "Material.h"
+#include "RangeAllocator.h"
 #include "TriangleInfoManager.h"
 #include "VertexBufferProperties.h"
 #include "VertexCollectorFilter.h"
@@ -42,6 +45,28 @@ struct ShGeometryInstance;
 // is a vertex buffer with ready data and infos for acceleration structure creation/building.
 class VertexCollector : public IMaterialDependency
 {
+public:
+    // Geometry that has its own BLAS and that is placed by TLAS instances
+    struct InstancedMesh
+    {
+        uint64_t                                    uniqueID;
+        VertexCollectorFilterTypeFlags              filter;
+        VkAccelerationStructureGeometryKHR          geom;
+        VkAccelerationStructureBuildRangeInfoKHR    range;
+        uint32_t                                    primitiveCount;
+        uint32_t                                    layerMaterials[MATERIALS_MAX_LAYER_COUNT];
+    };
+
+    // Vertex and index ranges that are written on device, e.g. by skinning,
+    // rather than copied from staging
+    struct DeviceWrittenRange
+    {
+        uint32_t    firstVertex;
+        uint32_t    vertexCount;
+        uint32_t    firstIndex;
+        uint32_t    indexCount;
+    };
+
 public:
     explicit VertexCollector(
         VkDevice device, 
@@ -51,7 +76,9 @@ public:
         std::shared_ptr<SectorVisibility> sectorVisibility,
         VkDeviceSize bufferSize, 
         const VertexBufferProperties &properties,
-        VertexCollectorFilterTypeFlags filters);
+        VertexCollectorFilterTypeFlags filters,
+        RgStaticGeometryChunking staticChunking,
+        uint32_t staticChunkPrimitiveCount);
 
     // Create new vertex collector, but with shared device local buffers
     explicit VertexCollector(
@@ -68,9 +95,36 @@ public:
 
     void BeginCollecting(bool isStatic);
     uint32_t AddGeometry(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT]);
+    // Add static geometry that won't be included into filters' BLAS-es,
+    // its vertices are in local space. If there are no normals, flat ones
+    // are generated, as meshes are not preprocessed. Returns mesh index.
+    uint32_t AddInstancedMesh(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT]);
+    // Add dynamic geometry, but only reserve its vertex and index ranges:
+    // data pointers of "info" are ignored, and the ranges are not copied from staging,
+    // they must be written on device after CopyFromStaging. Returns simple index.
+    uint32_t AddDeviceWrittenGeometry(
+        uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+        bool generateNormals, DeviceWrittenRange &outRange);
+    // Reserve vertex and index ranges in staging and return pointers to them.
+    // If AddGeometry receives these pointers, the data is not copied.
+    // Only for dynamic geometry. Returns false, if there's not enough space.
+    bool ReserveDynamicGeometry(uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping &outMapping);
+    // After the end of collecting static geometry, the rest of the buffers
+    // can be used by incremental meshes.
     void EndCollecting();
 
 
+    // Add instanced mesh to the already collected static geometry, its vertex and index
+    // ranges are allocated in the free space of the buffers, so other geometry is not affected.
+    // Per-triangle sector IDs are ignored. Returns mesh index, or UINT32_MAX if there's no space.
+    uint32_t AddIncrementalMesh(uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT]);
+    // Free ranges of the incremental mesh, its mesh index can be reused after that.
+    // Frames in flight must not use the mesh anymore.
+    void RemoveIncrementalMesh(uint32_t meshIndex);
+    // Copy the added incremental meshes from staging. Returns false, if there was nothing to copy
+    bool CopyIncrementalFromStaging(VkCommandBuffer cmd);
+
+
     // Clear data that was generated while collecting.
     // Should be called when blasGeometries is not needed anymore
     virtual void Reset();
@@ -78,15 +132,12 @@ public:
     // "isStaticVertexData" is required to determine what GLSL struct to use for copying
     bool CopyFromStaging(VkCommandBuffer cmd, bool isStaticVertexData);
     // Returns false, if wasn't copied
-    bool RecopyTransformsFromStaging(VkCommandBuffer cmd);
     bool RecopyTexCoordsFromStaging(VkCommandBuffer cmd);
 
 
-    // Update transform, only for movable static geometry as dynamic geometry
-    // will be updated every frame and thus their transforms.
-    void UpdateTransform(uint32_t simpleIndex, const RgUpdateTransformInfo &updateInfo);
     // Update texture coordinates 
     void UpdateTexCoords(uint32_t simpleIndex, const RgUpdateTexCoordsInfo &texCoordsInfo);
+    void UpdateInstancedMeshTexCoords(uint32_t meshIndex, const RgUpdateTexCoordsInfo &texCoordsInfo);
 
 
     // When material data is changed, this function is called
@@ -108,6 +159,15 @@ public:
     // Get AS build range infos from filters. Null if corresponding filter wasn't found.
     const std::vector<VkAccelerationStructureBuildRangeInfoKHR> &GetASBuildRangeInfos(VertexCollectorFilterTypeFlags filter) const;
 
+    // Get chunks of static non-movable geometry. Empty, if the filter is not chunked.
+    const std::vector<VertexCollectorFilter::Chunk> &GetChunks(VertexCollectorFilterTypeFlags filter) const;
+    bool IsChunked(VertexCollectorFilterTypeFlags filter) const;
+
+
+    const std::vector<InstancedMesh> &GetInstancedMeshes() const;
+    // Geometry info that is copied for each placement of the mesh
+    const ShGeometryInstance &GetInstancedMeshGeomInfo(uint32_t meshIndex) const;
+
 
     // Are all geometries for each filter type in "flags" empty?
     bool AreGeometriesEmpty(VertexCollectorFilterTypeFlags flags) const;
@@ -123,12 +183,55 @@ public:
 private:
     void InitStagingBuffers(const std::shared_ptr<MemoryAllocator> &allocator);
 
+    // Copy vertex data to staging, fill AS geometry and geometry info.
+    // If "useTransform" is false, AS geometry won't have a transform.
+    // If "copyToStaging" is false, staging ranges are only reserved.
+    // Staging ranges are reserved atomically, so it can be called from several threads.
+    bool PrepareGeometry(
+        uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+        VertexCollectorFilterTypeFlags geomFlags, bool useTransform, bool copyToStaging,
+        VkAccelerationStructureGeometryKHR &outGeom, uint32_t &outPrimitiveCount, ShGeometryInstance &outGeomInfo,
+        uint32_t &outTransformIndex);
+    // Same as PrepareGeometry, but the ranges are already reserved.
+    // If "indIndex" is UINT32_MAX, geometry is not indexed.
+    // If "transformIndex" is UINT32_MAX, AS geometry won't have a transform.
+    void PrepareGeometryInRange(
+        uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+        VertexCollectorFilterTypeFlags geomFlags, uint32_t vertIndex, uint32_t indIndex, uint32_t transformIndex, bool copyToStaging,
+        VkAccelerationStructureGeometryKHR &outGeom, ShGeometryInstance &outGeomInfo);
+    // "addGeometryMutex" must be locked. Returns mesh index.
+    uint32_t PushInstancedMesh(
+        const RgGeometryUploadInfo &info, VertexCollectorFilterTypeFlags geomFlags,
+        const VkAccelerationStructureGeometryKHR &geom, uint32_t primitiveCount, const ShGeometryInstance &geomInfo);
+    // Check the limits of geometries and take a slot for one in a group with "geomFlags",
+    // so the staging ranges are not reserved for geometry that won't be added.
+    bool ReserveGeometrySlot(VertexCollectorFilterTypeFlags geomFlags);
+    // "addGeometryMutex" must be locked.
+    void ReleaseGeometrySlot(VertexCollectorFilterTypeFlags geomFlags);
+    // Add prepared geometry to its filter and write geometry info.
+    // "addGeometryMutex" must be locked.
+    uint32_t PushPreparedGeometry(
+        uint32_t frameIndex, const RgGeometryUploadInfo &info, const MaterialTextures materials[MATERIALS_MAX_LAYER_COUNT],
+        VertexCollectorFilterTypeFlags geomFlags,
+        const VkAccelerationStructureGeometryKHR &geom, uint32_t primitiveCount, const ShGeometryInstance &geomInfo,
+        uint32_t transformIndex);
+
     void CopyDataToStaging(const RgGeometryUploadInfo &info, uint32_t vertIndex, bool isStatic);
+    // If the data pointers of "info" were returned by ReserveDynamicGeometry, get the reserved indices.
+    // A reservation can be committed only once.
+    bool GetReservedRange(const RgGeometryUploadInfo &info, bool isStatic, bool useIndices, uint32_t &outVertIndex, uint32_t &outIndIndex);
     void CopyTexCoordsToStaging(
         bool isStatic, uint32_t globalVertIndex, uint32_t vertexCount, 
         const void *const texCoordLayerData[3], bool addToCopy = false);
-
-    bool GetVertBufferCopyInfos(bool isStatic, std::vector<VkBufferCopy> &outInfos) const;
+    void UpdateTexCoordsAt(uint32_t globalVertIndex, const RgUpdateTexCoordsInfo &texCoordsInfo);
+
+    // If "skipDeviceWritten" is false, device written ranges are included
+    bool GetVertBufferCopyInfos(bool isStatic, std::vector<VkBufferCopy> &outInfos, bool skipDeviceWritten = true) const;
+    // Add copy infos of positions, normals and tex coords of the given vertex range
+    void PushVertBufferCopyInfos(bool isStatic, uint64_t firstVertex, uint64_t vertexCount, std::vector<VkBufferCopy> &outInfos) const;
+    // Get (first, count) ranges of [0, totalCount) vertices or indices, that must be copied
+    // from staging, i.e. which don't intersect device written ranges
+    std::vector<std::pair<uint32_t, uint32_t>> GetStagingCopyRanges(bool forIndices, uint32_t totalCount) const;
     
     std::vector<VkBufferCopy> CopyVertexDataFromStaging(VkCommandBuffer cmd, bool isStatic);
     bool CopyIndexDataFromStaging(VkCommandBuffer cmd);
@@ -156,10 +259,30 @@ private:
         uint32_t layer;
     };
 
+    // Ranges returned by ReserveDynamicGeometry, that weren't committed yet
+    struct ReservedRange
+    {
+        uint32_t    vertexCount;
+        uint32_t    firstIndex;
+        uint32_t    indexCount;
+    };
+
+    // Allocated ranges of an incremental mesh, counts are aligned by 3
+    struct IncrementalRange
+    {
+        uint32_t    meshIndex;
+        uint32_t    firstVertex;
+        uint32_t    vertexCount;
+        uint32_t    firstIndex;
+        uint32_t    indexCount;
+    };
+
 private:
     VkDevice device;
     VertexBufferProperties properties;
     VertexCollectorFilterTypeFlags filtersFlags;
+    RgStaticGeometryChunking staticChunking;
+    uint32_t staticChunkPrimitiveCount;
 
     Buffer stagingVertBuffer;
     std::shared_ptr<Buffer> vertBuffer;
@@ -174,10 +297,18 @@ private:
     std::shared_ptr<TriangleInfoManager> triangleInfoMgr;
     std::shared_ptr<SectorVisibility> sectorVisibility;
 
-    uint32_t curVertexCount;
-    uint32_t curIndexCount;
-    uint32_t curPrimitiveCount;
-    uint32_t curTransformCount;
+    std::atomic<uint32_t> curVertexCount;
+    std::atomic<uint32_t> curIndexCount;
+    std::atomic<uint32_t> curPrimitiveCount;
+    std::atomic<uint32_t> curTransformCount;
+
+    // guards filters, geometry infos and material dependencies,
+    // vertex data is copied to staging without it
+    std::mutex addGeometryMutex;
+
+    // geometries that are being prepared, but not pushed yet, guarded by "addGeometryMutex"
+    rgl::unordered_map<VertexCollectorFilterTypeFlags, uint32_t> reservedGeometryCounts;
+    uint32_t reservedGeometryTotal;
 
     uint8_t *mappedVertexData;
     uint32_t *mappedIndexData;
@@ -194,6 +325,26 @@ private:
     VkDeviceSize texCoordsToCopyUpperBound;
 
     rgl::unordered_map<uint32_t, uint32_t> simpleIndexToTransformIndex;
+
+    // not copied from staging, guarded by "addGeometryMutex"
+    std::vector<DeviceWrittenRange> deviceWrittenRanges;
+
+    // first vertex index to a reservation
+    rgl::unordered_map<uint32_t, ReservedRange> reservedRanges;
+    std::mutex reservedRangesMutex;
+
+    std::vector<InstancedMesh> instancedMeshes;
+    // same indices as in instancedMeshes
+    std::vector<ShGeometryInstance> instancedMeshGeomInfos;
+
+    // free space of static buffers after EndCollecting, guarded by "addGeometryMutex"
+    RangeAllocator incrementalVertices;
+    RangeAllocator incrementalIndices;
+    rgl::unordered_map<uint32_t, IncrementalRange> incrementalMeshRanges;
+    // indices of removed incremental meshes, that can be reused
+    std::vector<uint32_t> freeMeshIndices;
+    // ranges of the added meshes to copy from staging
+    std::vector<IncrementalRange> incrementalToCopy;
 };
 
 }
\ No newline at end of file
@@ -24,7 +24,11 @@
 
 using namespace RTGL1;
 
-VertexCollectorFilter::VertexCollectorFilter(VertexCollectorFilterTypeFlags _filter) : filter(_filter)
+VertexCollectorFilter::VertexCollectorFilter(VertexCollectorFilterTypeFlags _filter, RgStaticGeometryChunking _chunking, uint32_t _chunkPrimitiveCount)
+:
+    filter(_filter),
+    chunking(_chunking),
+    chunkPrimitiveCount(_chunkPrimitiveCount)
 {}
 
 VertexCollectorFilter::~VertexCollectorFilter()
@@ -45,11 +49,22 @@ const std::vector<VkAccelerationStructureBuildRangeInfoKHR> &VertexCollectorFilt
     return asBuildRangeInfos;
 }
 
+const std::vector<VertexCollectorFilter::Chunk> &VertexCollectorFilter::GetChunks() const
+{
+    return chunks;
+}
+
+bool VertexCollectorFilter::IsChunked() const
+{
+    return chunking != RG_STATIC_GEOMETRY_CHUNKING_NONE;
+}
+
 void VertexCollectorFilter::Reset()
 {
     asGeometries.clear();
     primitiveCounts.clear();
     asBuildRangeInfos.clear();
+    chunks.clear();
 }
 
 uint32_t VertexCollectorFilter::PushGeometry(VertexCollectorFilterTypeFlags type, const VkAccelerationStructureGeometryKHR &geom)
@@ -76,6 +91,52 @@ void VertexCollectorFilter::PushRangeInfo(VertexCollectorFilterTypeFlags type, c
     asBuildRangeInfos.push_back(rangeInfo);
 }
 
+void VertexCollectorFilter::PushToChunk(uint32_t localIndex, uint32_t primCount, uint32_t sectorArrayIndex)
+{
+    if (!IsChunked())
+    {
+        return;
+    }
+
+    bool startNew = chunks.empty();
+
+    if (!startNew)
+    {
+        const Chunk &last = chunks.back();
+
+        switch (chunking)
+        {
+            case RG_STATIC_GEOMETRY_CHUNKING_BY_TRIANGLE_COUNT:
+                startNew = last.primitiveCount >= chunkPrimitiveCount;
+                break;
+            case RG_STATIC_GEOMETRY_CHUNKING_BY_SECTOR:
+                startNew = last.sectorArrayIndex != sectorArrayIndex;
+                break;
+            default:
+                assert(0);
+                break;
+        }
+    }
+
+    if (startNew)
+    {
+        chunks.push_back({ localIndex, 0, 0, sectorArrayIndex });
+    }
+
+    Chunk &c = chunks.back();
+
+    // chunk's geometries must be consecutive, so they could be referenced by the first one
+    assert(c.firstGeometry + c.geometryCount == localIndex);
+
+    c.geometryCount++;
+    c.primitiveCount += primCount;
+
+    if (c.sectorArrayIndex != sectorArrayIndex)
+    {
+        c.sectorArrayIndex = NO_SECTOR;
+    }
+}
+
 VertexCollectorFilterTypeFlags VertexCollectorFilter::GetFilter() const
 {
     return filter;
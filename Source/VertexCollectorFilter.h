@@ -24,6 +24,7 @@
 
 #include "Common.h"
 #include "VertexCollectorFilterType.h"
+#include "RTGL1/RTGL1.h"
 
 namespace RTGL1
 {
@@ -33,7 +34,23 @@ namespace RTGL1
 class VertexCollectorFilter
 {
 public:
-    explicit VertexCollectorFilter(VertexCollectorFilterTypeFlags filter);
+    // Consecutive geometries of the filter that have their own BLAS
+    struct Chunk
+    {
+        uint32_t    firstGeometry;
+        uint32_t    geometryCount;
+        uint32_t    primitiveCount;
+        // NO_SECTOR, if geometries of the chunk are in different sectors
+        uint32_t    sectorArrayIndex;
+    };
+
+    static constexpr uint32_t NO_SECTOR = UINT32_MAX;
+
+public:
+    // If "chunking" is not RG_STATIC_GEOMETRY_CHUNKING_NONE, the geometries are grouped into chunks
+    explicit VertexCollectorFilter(VertexCollectorFilterTypeFlags filter,
+                                   RgStaticGeometryChunking chunking = RG_STATIC_GEOMETRY_CHUNKING_NONE,
+                                   uint32_t chunkPrimitiveCount = 0);
     ~VertexCollectorFilter();
 
     VertexCollectorFilter(const VertexCollectorFilter& other) = delete;
@@ -47,22 +64,31 @@ public:
         &GetASGeometries() const;
     const std::vector<VkAccelerationStructureBuildRangeInfoKHR>
         &GetASBuildRangeInfos() const;
+    const std::vector<Chunk>
+        &GetChunks() const;
+    bool IsChunked() const;
 
     void Reset();
 
     uint32_t PushGeometry(VertexCollectorFilterTypeFlags type, const VkAccelerationStructureGeometryKHR& geom);
     void PushPrimitiveCount(VertexCollectorFilterTypeFlags type, uint32_t primCount);
     void PushRangeInfo(VertexCollectorFilterTypeFlags type, const VkAccelerationStructureBuildRangeInfoKHR &rangeInfo);
+    // Add the pushed geometry to the last chunk, or start a new one.
+    // "sectorArrayIndex" is NO_SECTOR, if the geometry has per triangle sectors.
+    void PushToChunk(uint32_t localIndex, uint32_t primCount, uint32_t sectorArrayIndex);
 
     VertexCollectorFilterTypeFlags GetFilter() const;
     uint32_t GetGeometryCount() const;
 
 private:
     VertexCollectorFilterTypeFlags filter;
+    RgStaticGeometryChunking chunking;
+    uint32_t chunkPrimitiveCount;
 
     std::vector<uint32_t> primitiveCounts;
     std::vector<VkAccelerationStructureGeometryKHR> asGeometries;
     std::vector<VkAccelerationStructureBuildRangeInfoKHR> asBuildRangeInfos;
+    std::vector<Chunk> chunks;
 };
 
 }
\ No newline at end of file
@@ -143,7 +143,7 @@ void RTGL1::VertexPreprocessing::CreatePipelines(const ShaderManager *shaderMana
     {
         specInfoDataOnlyDynamic = VERT_PREPROC_MODE_ONLY_DYNAMIC;
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineOnlyDynamic);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipelineOnlyDynamic);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, pipelineOnlyDynamic, VK_OBJECT_TYPE_PIPELINE, "Vertex only dynamic preprocessing pipeline");
@@ -152,7 +152,7 @@ void RTGL1::VertexPreprocessing::CreatePipelines(const ShaderManager *shaderMana
     {
         specInfoDataOnlyDynamic = VERT_PREPROC_MODE_DYNAMIC_AND_MOVABLE;
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineDynamicAndMovable);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipelineDynamicAndMovable);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, pipelineDynamicAndMovable, VK_OBJECT_TYPE_PIPELINE, "Vertex movable/dynamic preprocessing pipeline");
@@ -161,7 +161,7 @@ void RTGL1::VertexPreprocessing::CreatePipelines(const ShaderManager *shaderMana
     {
         specInfoDataOnlyDynamic = VERT_PREPROC_MODE_ALL;
 
-        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipelineAll);
+        r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipelineAll);
         VK_CHECKERROR(r);
 
         SET_DEBUG_NAME(device, pipelineAll, VK_OBJECT_TYPE_PIPELINE, "Vertex static/movable/dynamic preprocessing pipeline");
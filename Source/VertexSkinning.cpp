@@ -0,0 +1,570 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "VertexSkinning.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "Generated/ShaderCommonC.h"
+#include "CmdLabel.h"
+#include "RgException.h"
+#include "Utils.h"
+
+
+static_assert(sizeof(RgTransform) == 3 * 4 * sizeof(float), "Bone matrices are read in shader as 3 rows of vec4");
+
+
+RTGL1::VertexSkinning::VertexSkinning(
+    VkDevice _device,
+    const std::shared_ptr<MemoryAllocator> &_allocator,
+    std::shared_ptr<CommandBufferManager> _cmdManager,
+    const std::shared_ptr<const ASManager> &_asManager,
+    const std::shared_ptr<const ShaderManager> &_shaderManager,
+    const VertexBufferProperties &_properties)
+:
+    device(_device),
+    allocator(_allocator),
+    cmdManager(std::move(_cmdManager)),
+    properties(_properties),
+    dynamicIndexBuffer(_asManager->GetDynamicIndexBuffer()),
+    vertexAllocator(MAX_SKINNED_VERTEX_COUNT),
+    indexAllocator(MAX_SKINNED_INDEX_COUNT),
+    meshCounter(0),
+    curBoneCount(0),
+    descPool(VK_NULL_HANDLE),
+    descSetLayout(VK_NULL_HANDLE),
+    descSet(VK_NULL_HANDLE),
+    pipelineLayout(VK_NULL_HANDLE),
+    pipeline(VK_NULL_HANDLE)
+{
+    meshVertices.Init(
+        allocator, MAX_SKINNED_VERTEX_COUNT * sizeof(ShSkinnedVertex),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Skinned meshes vertex buffer");
+
+    meshIndices.Init(
+        allocator, MAX_SKINNED_INDEX_COUNT * sizeof(uint32_t),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        "Skinned meshes index buffer");
+
+    bones = std::make_unique<AutoBuffer>(device, allocator);
+    bones->Create(MAX_SKINNING_BONE_COUNT * sizeof(RgTransform), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Skinning bones buffer");
+
+    CreateDescriptors(_asManager->GetDynamicVertexBuffer());
+    CreatePipelineLayout();
+    CreatePipelines(_shaderManager.get());
+}
+
+RTGL1::VertexSkinning::~VertexSkinning()
+{
+    vkDestroyDescriptorPool(device, descPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, descSetLayout, nullptr);
+
+    DestroyPipelines();
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+}
+
+void RTGL1::VertexSkinning::PrepareForFrame(uint32_t frameIndex)
+{
+    {
+        std::lock_guard<std::mutex> lock(meshesMutex);
+
+        for (const Mesh &m : meshesToFree[frameIndex])
+        {
+            vertexAllocator.Free(m.vertices.first, m.vertices.count);
+            indexAllocator.Free(m.indices.first, m.indices.count);
+        }
+        meshesToFree[frameIndex].clear();
+    }
+
+    instances.clear();
+    curBoneCount = 0;
+}
+
+RgSkinnedMesh RTGL1::VertexSkinning::CreateMesh(const RgSkinnedMeshCreateInfo &info)
+{
+    if (info.vertexCount == 0 || info.pVertexData == nullptr || info.pBoneIndices == nullptr || info.pBoneWeights == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Skinned mesh must have vertices, bone indices and bone weights");
+    }
+
+    if ((info.pIndexData == nullptr && info.indexCount != 0) ||
+        (info.pIndexData != nullptr && info.indexCount == 0))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Incorrect index data");
+    }
+
+    Mesh mesh = {};
+    mesh.hasNormals = info.pNormalData != nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(meshesMutex);
+
+        if (!vertexAllocator.Allocate(info.vertexCount, &mesh.vertices.first))
+        {
+            throw RgException(RG_CANT_CREATE_SKINNED_MESH, "Not enough space for skinned mesh vertices, MAX_SKINNED_VERTEX_COUNT is " + std::to_string(MAX_SKINNED_VERTEX_COUNT));
+        }
+        mesh.vertices.count = info.vertexCount;
+
+        if (info.indexCount > 0)
+        {
+            if (!indexAllocator.Allocate(info.indexCount, &mesh.indices.first))
+            {
+                vertexAllocator.Free(mesh.vertices.first, mesh.vertices.count);
+                throw RgException(RG_CANT_CREATE_SKINNED_MESH, "Not enough space for skinned mesh indices, MAX_SKINNED_INDEX_COUNT is " + std::to_string(MAX_SKINNED_INDEX_COUNT));
+            }
+            mesh.indices.count = info.indexCount;
+        }
+    }
+
+
+    // convert to the shader struct in staging
+    const VkDeviceSize vertDataSize = info.vertexCount * sizeof(ShSkinnedVertex);
+    const VkDeviceSize indexDataSize = info.indexCount * sizeof(uint32_t);
+
+    Buffer staging;
+    staging.Init(
+        allocator, vertDataSize + indexDataSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        "Skinned mesh staging buffer");
+
+    auto *mapped = static_cast<uint8_t *>(staging.Map());
+    auto *dstVerts = reinterpret_cast<ShSkinnedVertex *>(mapped);
+
+    const auto *srcPositions = static_cast<const uint8_t *>(info.pVertexData);
+    const auto *srcNormals = static_cast<const uint8_t *>(info.pNormalData);
+    const auto *srcTexCoords = static_cast<const uint8_t *>(info.pTexCoordData);
+
+    for (uint32_t i = 0; i < info.vertexCount; i++)
+    {
+        ShSkinnedVertex &v = dstVerts[i];
+        v = {};
+
+        memcpy(v.position, srcPositions + i * static_cast<uint64_t>(properties.positionStride), 3 * sizeof(float));
+        v.position[3] = 1.0f;
+
+        if (srcNormals != nullptr)
+        {
+            memcpy(v.normal, srcNormals + i * static_cast<uint64_t>(properties.normalStride), 3 * sizeof(float));
+        }
+
+        if (srcTexCoords != nullptr)
+        {
+            memcpy(v.texCoord, srcTexCoords + i * static_cast<uint64_t>(properties.texCoordStride), 2 * sizeof(float));
+        }
+
+        const uint32_t *b = &info.pBoneIndices[i * 4];
+
+        if (b[0] > UINT16_MAX || b[1] > UINT16_MAX || b[2] > UINT16_MAX || b[3] > UINT16_MAX)
+        {
+            staging.TryUnmap();
+
+            std::lock_guard<std::mutex> lock(meshesMutex);
+            vertexAllocator.Free(mesh.vertices.first, mesh.vertices.count);
+            indexAllocator.Free(mesh.indices.first, mesh.indices.count);
+
+            throw RgException(RG_WRONG_ARGUMENT, "Skinned mesh bone index must be less than 65536");
+        }
+
+        v.boneIndices01 = b[0] | (b[1] << 16);
+        v.boneIndices23 = b[2] | (b[3] << 16);
+
+        memcpy(v.boneWeights, &info.pBoneWeights[i * 4], 4 * sizeof(float));
+    }
+
+    if (info.indexCount > 0)
+    {
+        memcpy(mapped + vertDataSize, info.pIndexData, indexDataSize);
+    }
+
+    staging.Unmap();
+
+
+    // copy to device local and wait, similar to other load-time uploads
+    VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
+
+    VkBufferCopy vertCopy = {};
+    vertCopy.srcOffset = 0;
+    vertCopy.dstOffset = mesh.vertices.first * sizeof(ShSkinnedVertex);
+    vertCopy.size = vertDataSize;
+
+    vkCmdCopyBuffer(cmd, staging.GetBuffer(), meshVertices.GetBuffer(), 1, &vertCopy);
+
+    if (info.indexCount > 0)
+    {
+        VkBufferCopy indexCopy = {};
+        indexCopy.srcOffset = vertDataSize;
+        indexCopy.dstOffset = mesh.indices.first * sizeof(uint32_t);
+        indexCopy.size = indexDataSize;
+
+        vkCmdCopyBuffer(cmd, staging.GetBuffer(), meshIndices.GetBuffer(), 1, &indexCopy);
+    }
+
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+
+    cmdManager->Submit(cmd);
+    cmdManager->WaitGraphicsIdle();
+
+    staging.Destroy();
+
+
+    std::lock_guard<std::mutex> lock(meshesMutex);
+
+    // 0 is RG_NO_SKINNED_MESH
+    const RgSkinnedMesh handle = ++meshCounter;
+    meshes[handle] = mesh;
+
+    return handle;
+}
+
+void RTGL1::VertexSkinning::DestroyMesh(uint32_t frameIndex, RgSkinnedMesh handle)
+{
+    if (handle == RG_NO_SKINNED_MESH)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(meshesMutex);
+
+    auto found = meshes.find(handle);
+
+    if (found == meshes.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Skinned mesh with ID=" + std::to_string(handle) + " doesn't exist");
+    }
+
+    // the mesh could be skinned in the current frame
+    meshesToFree[frameIndex].push_back(found->second);
+    meshes.erase(found);
+}
+
+bool RTGL1::VertexSkinning::GetMeshInfo(RgSkinnedMesh handle, uint32_t *pOutVertexCount, uint32_t *pOutIndexCount, bool *pOutHasNormals) const
+{
+    std::lock_guard<std::mutex> lock(meshesMutex);
+
+    auto found = meshes.find(handle);
+
+    if (found == meshes.end())
+    {
+        return false;
+    }
+
+    *pOutVertexCount = found->second.vertices.count;
+    *pOutIndexCount = found->second.indices.count;
+    *pOutHasNormals = found->second.hasNormals;
+
+    return true;
+}
+
+RTGL1::VertexSkinning::Instance RTGL1::VertexSkinning::PrepareInstance(
+    uint32_t frameIndex, RgSkinnedMesh handle,
+    const RgTransform *pBoneTransforms, uint32_t boneCount)
+{
+    Instance inst = {};
+    inst.boneCount = boneCount;
+
+    {
+        std::lock_guard<std::mutex> lock(meshesMutex);
+
+        auto found = meshes.find(handle);
+
+        if (found == meshes.end())
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Skinned mesh with ID=" + std::to_string(handle) + " doesn't exist");
+        }
+
+        inst.mesh = found->second;
+    }
+
+    // reserve bones range, other threads will write after it;
+    // if it doesn't fit, the counter is left untouched
+    uint32_t baseBone = curBoneCount.load();
+
+    do
+    {
+        if ((uint64_t)baseBone + boneCount > MAX_SKINNING_BONE_COUNT)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Too many bones in the current frame, MAX_SKINNING_BONE_COUNT is " + std::to_string(MAX_SKINNING_BONE_COUNT));
+        }
+    }
+    while (!curBoneCount.compare_exchange_weak(baseBone, baseBone + boneCount));
+
+    inst.baseBone = baseBone;
+
+    auto *dstBones = static_cast<RgTransform *>(bones->GetMapped(frameIndex));
+    memcpy(dstBones + inst.baseBone, pBoneTransforms, boneCount * sizeof(RgTransform));
+
+    return inst;
+}
+
+void RTGL1::VertexSkinning::AddInstance(Instance inst, const VertexCollector::DeviceWrittenRange &dstRange)
+{
+    inst.dst = dstRange;
+
+    assert(inst.dst.vertexCount == inst.mesh.vertices.count);
+    assert(inst.dst.indexCount == inst.mesh.indices.count);
+
+    std::lock_guard<std::mutex> lock(instancesMutex);
+    instances.push_back(inst);
+}
+
+void RTGL1::VertexSkinning::Skin(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (instances.empty())
+    {
+        return;
+    }
+
+    CmdLabel label(cmd, "Vertex skinning");
+
+
+    // bones and indices
+
+    const uint32_t boneCount = std::min<uint32_t>(curBoneCount, MAX_SKINNING_BONE_COUNT);
+
+    if (boneCount > 0)
+    {
+        bones->CopyFromStaging(cmd, frameIndex, boneCount * sizeof(RgTransform));
+    }
+
+    std::vector<VkBufferCopy> indexCopies;
+
+    for (const Instance &inst : instances)
+    {
+        if (inst.dst.indexCount > 0)
+        {
+            VkBufferCopy cp = {};
+            cp.srcOffset = inst.mesh.indices.first * sizeof(uint32_t);
+            cp.dstOffset = inst.dst.firstIndex * sizeof(uint32_t);
+            cp.size = inst.dst.indexCount * sizeof(uint32_t);
+
+            indexCopies.push_back(cp);
+        }
+    }
+
+    if (!indexCopies.empty())
+    {
+        vkCmdCopyBuffer(cmd, meshIndices.GetBuffer(), dynamicIndexBuffer, indexCopies.size(), indexCopies.data());
+    }
+
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+    }
+
+
+    // skin each instance
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout,
+                            0, 1, &descSet,
+                            0, nullptr);
+
+    for (const Instance &inst : instances)
+    {
+        ShVertSkinning push = {};
+        push.srcBaseVertex = inst.mesh.vertices.first;
+        push.dstBaseVertex = inst.dst.firstVertex;
+        push.vertexCount = inst.dst.vertexCount;
+        push.baseBone = inst.baseBone;
+        push.boneCount = inst.boneCount;
+        // otherwise, they'll be generated in vertex preprocessing
+        push.writeNormals = inst.mesh.hasNormals ? 1 : 0;
+        push.positionsStride = properties.positionStride / 4;
+        push.normalsStride = properties.normalStride / 4;
+        push.texCoordsStride = properties.texCoordStride / 4;
+
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+
+        vkCmdDispatch(cmd, Utils::GetWorkGroupCount(push.vertexCount, COMPUTE_VERT_SKINNING_GROUP_SIZE_X), 1, 1);
+    }
+
+
+    // skinned vertices and copied indices are used in BLAS building and vertex preprocessing
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+}
+
+void RTGL1::VertexSkinning::OnShaderReload(const ShaderManager *shaderManager)
+{
+    DestroyPipelines();
+    CreatePipelines(shaderManager);
+}
+
+void RTGL1::VertexSkinning::CreateDescriptors(VkBuffer dynamicVertexBuffer)
+{
+    VkResult r;
+
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+
+    bindings[0].binding = BINDING_SKINNED_VERTICES;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = BINDING_SKINNING_BONES;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[2].binding = BINDING_SKINNING_OUTPUT;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    r = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descSetLayout);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, descSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Vertex skinning Desc set layout");
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = bindings.size();
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    r = vkCreateDescriptorPool(device, &poolInfo, nullptr, &descPool);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, descPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL, "Vertex skinning Desc pool");
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descSetLayout;
+
+    r = vkAllocateDescriptorSets(device, &allocInfo, &descSet);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, descSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Vertex skinning Desc set");
+
+
+    // all buffers are device local and don't change
+    std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+    bufferInfos[0].buffer = meshVertices.GetBuffer();
+    bufferInfos[1].buffer = bones->GetDeviceLocal();
+    bufferInfos[2].buffer = dynamicVertexBuffer;
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+
+    for (uint32_t i = 0; i < writes.size(); i++)
+    {
+        bufferInfos[i].offset = 0;
+        bufferInfos[i].range = VK_WHOLE_SIZE;
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descSet;
+        writes[i].dstBinding = bindings[i].binding;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].descriptorCount = 1;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+}
+
+void RTGL1::VertexSkinning::CreatePipelineLayout()
+{
+    VkPushConstantRange pc = {};
+    pc.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pc.offset = 0;
+    pc.size = sizeof(ShVertSkinning);
+
+    VkPipelineLayoutCreateInfo plLayoutInfo = {};
+    plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plLayoutInfo.setLayoutCount = 1;
+    plLayoutInfo.pSetLayouts = &descSetLayout;
+    plLayoutInfo.pushConstantRangeCount = 1;
+    plLayoutInfo.pPushConstantRanges = &pc;
+
+    VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &pipelineLayout);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Vertex skinning pipeline layout");
+}
+
+void RTGL1::VertexSkinning::CreatePipelines(const ShaderManager *shaderManager)
+{
+    VkComputePipelineCreateInfo plInfo = {};
+    plInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    plInfo.layout = pipelineLayout;
+    plInfo.stage = shaderManager->GetStageInfo("CVertexSkinning");
+
+    VkResult r = vkCreateComputePipelines(device, shaderManager->GetPipelineCache(), 1, &plInfo, nullptr, &pipeline);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipeline, VK_OBJECT_TYPE_PIPELINE, "Vertex skinning pipeline");
+}
+
+void RTGL1::VertexSkinning::DestroyPipelines()
+{
+    vkDestroyPipeline(device, pipeline, nullptr);
+    pipeline = VK_NULL_HANDLE;
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "ASManager.h"
+#include "AutoBuffer.h"
+#include "Buffer.h"
+#include "CommandBufferManager.h"
+#include "Containers.h"
+#include "RangeAllocator.h"
+#include "ShaderManager.h"
+#include "VertexBufferProperties.h"
+#include "VertexCollector.h"
+
+namespace RTGL1
+{
+
+// Skinned meshes keep their bind pose, bone indices and weights in device memory.
+// Each frame only bone matrices are uploaded, and a compute shader writes
+// skinned vertices to the dynamic vertex buffer before dynamic BLAS building.
+class VertexSkinning : public IShaderDependency
+{
+public:
+    struct Range
+    {
+        uint32_t    first;
+        uint32_t    count;
+    };
+
+    struct Mesh
+    {
+        Range       vertices;
+        Range       indices;
+        bool        hasNormals;
+    };
+
+    struct Instance
+    {
+        Mesh        mesh;
+        uint32_t    baseBone;
+        uint32_t    boneCount;
+        VertexCollector::DeviceWrittenRange dst;
+    };
+
+public:
+    explicit VertexSkinning(
+        VkDevice device,
+        const std::shared_ptr<MemoryAllocator> &allocator,
+        std::shared_ptr<CommandBufferManager> cmdManager,
+        const std::shared_ptr<const ASManager> &asManager,
+        const std::shared_ptr<const ShaderManager> &shaderManager,
+        const VertexBufferProperties &properties);
+    ~VertexSkinning() override;
+
+    VertexSkinning(const VertexSkinning &other) = delete;
+    VertexSkinning(VertexSkinning &&other) noexcept = delete;
+    VertexSkinning &operator=(const VertexSkinning &other) = delete;
+    VertexSkinning &operator=(VertexSkinning &&other) noexcept = delete;
+
+    // Free the ranges of meshes that were destroyed MAX_FRAMES_IN_FLIGHT ago,
+    // and forget the instances of the previous frame.
+    void PrepareForFrame(uint32_t frameIndex);
+
+    // Data is uploaded synchronously.
+    RgSkinnedMesh CreateMesh(const RgSkinnedMeshCreateInfo &info);
+    void DestroyMesh(uint32_t frameIndex, RgSkinnedMesh mesh);
+
+    // Returns false, if the mesh doesn't exist.
+    bool GetMeshInfo(RgSkinnedMesh mesh, uint32_t *pOutVertexCount, uint32_t *pOutIndexCount, bool *pOutHasNormals) const;
+
+    // Check that the mesh exists and reserve a range for bone matrices,
+    // then copy them to staging. Throws, if the mesh doesn't exist
+    // or there are too many bones in the current frame.
+    // Can be called from several threads.
+    Instance PrepareInstance(uint32_t frameIndex, RgSkinnedMesh mesh,
+                             const RgTransform *pBoneTransforms, uint32_t boneCount);
+    // Skin the mesh of the prepared instance into "dstRange" of the dynamic buffers.
+    // Can be called from several threads.
+    void AddInstance(Instance instance, const VertexCollector::DeviceWrittenRange &dstRange);
+
+    // Must be called after dynamic geometry is copied from staging,
+    // but before dynamic BLAS are built.
+    void Skin(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    void OnShaderReload(const ShaderManager *shaderManager) override;
+
+private:
+    void CreateDescriptors(VkBuffer dynamicVertexBuffer);
+    void CreatePipelineLayout();
+    void CreatePipelines(const ShaderManager *shaderManager);
+    void DestroyPipelines();
+
+private:
+    VkDevice device;
+    std::shared_ptr<MemoryAllocator> allocator;
+    std::shared_ptr<CommandBufferManager> cmdManager;
+    VertexBufferProperties properties;
+
+    // dynamic index buffer is the destination for copying mesh indices
+    VkBuffer dynamicIndexBuffer;
+
+    Buffer meshVertices;
+    Buffer meshIndices;
+    RangeAllocator vertexAllocator;
+    RangeAllocator indexAllocator;
+
+    rgl::unordered_map<RgSkinnedMesh, Mesh> meshes;
+    uint32_t meshCounter;
+    mutable std::mutex meshesMutex;
+
+    // ranges can be reused only when the frame's command buffer is not in use
+    std::vector<Mesh> meshesToFree[MAX_FRAMES_IN_FLIGHT];
+
+    std::unique_ptr<AutoBuffer> bones;
+    std::atomic<uint32_t> curBoneCount;
+
+    std::vector<Instance> instances;
+    std::mutex instancesMutex;
+
+    VkDescriptorPool descPool;
+    VkDescriptorSetLayout descSetLayout;
+    VkDescriptorSet descSet;
+
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+};
+
+}
@@ -91,7 +91,15 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
 
     uniform             = std::make_shared<GlobalUniform>(device, memAllocator);
 
-    swapchain           = std::make_shared<Swapchain>(device, surface, physDevice, cmdManager);
+    gpuTimestamps       = std::make_shared<GpuTimestamps>(device, physDevice, queues);
+
+    swapchain           = std::make_shared<Swapchain>(
+        device,
+        surface,
+        physDevice,
+        cmdManager,
+        memAllocator,
+        info->pHeadlessSurfaceCreateInfo != nullptr ? info->pHeadlessSurfaceCreateInfo->imageCount : 0);
 
     // for world samplers with modifyable lod biad
     worldSamplerManager     = std::make_shared<SamplerManager>(device, 8, info->textureSamplerForceMinificationFilterLinear);
@@ -109,28 +117,56 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         cmdManager, 
         userFileLoad);
 
+    pipelineCache       = std::make_shared<PipelineCache>(
+        device,
+        physDevice,
+        info->pPipelineCacheFilePath,
+        userFileLoad);
+
+    // shaders are needed for texture uploading
+    shaderManager       = std::make_shared<ShaderManager>(
+        device,
+        info->pShaderFolderPath,
+        userFileLoad,
+        pipelineCache);
+
+    mipmapGenerator     = std::make_shared<MipmapGenerator>(
+        device,
+        shaderManager);
+
+    textureStagingRing  = std::make_shared<TextureStagingRing>(
+        device,
+        memAllocator,
+        info->textureStagingRingSizeInMegabytes);
+
+    if (info->indexOverridenTexturesFolder)
+    {
+        overrideFileIndex = std::make_shared<OverrideFileIndex>(
+            info->pOverridenTexturesFolderPath != nullptr ? info->pOverridenTexturesFolderPath : DEFAULT_TEXTURES_PATH);
+    }
+
     textureManager      = std::make_shared<TextureManager>(
         device, 
         memAllocator,
         worldSamplerManager,
+        textureStagingRing,
+        mipmapGenerator,
         cmdManager,
         userFileLoad,
+        overrideFileIndex,
         *info);
 
     cubemapManager      = std::make_shared<CubemapManager>(
         device,
         memAllocator,
         genericSamplerManager,
+        textureStagingRing,
         cmdManager,
         userFileLoad,
+        overrideFileIndex,
         info->pOverridenTexturesFolderPath,
         info->pOverridenAlbedoAlphaTexturePostfix);
 
-    shaderManager       = std::make_shared<ShaderManager>(
-        device,
-        info->pShaderFolderPath,
-        userFileLoad);
-
     scene               = std::make_shared<Scene>(
         device,
         physDevice,
@@ -139,7 +175,10 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         textureManager,
         uniform,
         shaderManager,
-        vbProperties);
+        vbProperties,
+        info->compactStaticAccelerationStructures,
+        info->staticGeometryChunking,
+        info->staticGeometryChunkTriangleCount);
    
     rasterizer          = std::make_shared<Rasterizer>(
         device,
@@ -242,6 +281,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
 #undef SIMPLE_EFFECT_CONSTRUCTOR_PARAMS
 
 
+    shaderManager->Subscribe(mipmapGenerator);
     shaderManager->Subscribe(denoiser);
     shaderManager->Subscribe(imageComposition);
     shaderManager->Subscribe(rasterizer);
@@ -249,6 +289,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     shaderManager->Subscribe(rtPipeline);
     shaderManager->Subscribe(tonemapping);
     shaderManager->Subscribe(scene->GetVertexPreprocessing());
+    shaderManager->Subscribe(scene->GetVertexSkinning());
     shaderManager->Subscribe(bloom);
     shaderManager->Subscribe(amdFsr);
     shaderManager->Subscribe(sharpening);
@@ -296,18 +337,25 @@ VulkanDevice::~VulkanDevice()
     uniform.reset();
     scene.reset();
     shaderManager.reset();
+    pipelineCache.reset();
     rtPipeline.reset();
     pathTracer.reset();
     rasterizer.reset();
     decalManager.reset();
+    gpuTimestamps.reset();
     worldSamplerManager.reset();
     genericSamplerManager.reset();
     blueNoise.reset();
     textureManager.reset();
     cubemapManager.reset();
+    textureStagingRing.reset();
+    mipmapGenerator.reset();
     memAllocator.reset();
 
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (surface != VK_NULL_HANDLE)
+    {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
     DestroySyncPrimitives();
 
     DestroyDevice();
@@ -332,7 +380,8 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
     swapchain->RequestVsync(startInfo.requestVSync);
     swapchain->AcquireImage(imageAvailableSemaphores[frameIndex]);
 
-    VkSemaphore semaphoreToWaitOnSubmit = imageAvailableSemaphores[frameIndex];
+    // headless swapchain doesn't signal the semaphore
+    VkSemaphore semaphoreToWaitOnSubmit = swapchain->IsHeadless() ? VK_NULL_HANDLE : imageAvailableSemaphores[frameIndex];
 
 
     // if out-of-frame cmd exist, submit it
@@ -374,6 +423,8 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
     // clear the data that were created MAX_FRAMES_IN_FLIGHT ago
     worldSamplerManager->PrepareForFrame(frameIndex);
     genericSamplerManager->PrepareForFrame(frameIndex);
+    textureStagingRing->PrepareForFrame(frameIndex);
+    mipmapGenerator->PrepareForFrame(frameIndex);
     textureManager->PrepareForFrame(frameIndex);
     cubemapManager->PrepareForFrame(frameIndex);
     rasterizer->PrepareForFrame(frameIndex, startInfo.requestRasterizedSkyGeometryReuse);
@@ -381,7 +432,14 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
 
     VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
 
+    // frame fence was waited, so the previous timestamps can be read
+    gpuTimestamps->PrepareForFrame(cmd, frameIndex);
+
     BeginCmdLabel(cmd, "Prepare for frame");
+    gpuTimestamps->BeginScope(cmd, frameIndex, "Prepare for frame");
+
+    // replace placeholders of the textures that were loaded in background
+    textureManager->UploadLoadedTextures(cmd, frameIndex);
 
     // start dynamic geometry recording to current frame
     scene->PrepareForFrame(cmd, frameIndex);
@@ -771,12 +829,13 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
 
 void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 {
+    const uint32_t frameIndex = currentFrameState.GetFrameIndex();
+
     // end of "Prepare for frame" label
+    gpuTimestamps->EndScope(cmd, frameIndex);
     EndCmdLabel(cmd);
 
 
-    const uint32_t frameIndex = currentFrameState.GetFrameIndex();
-
     
     bool mipLodBiasUpdated = worldSamplerManager->TryChangeMipLodBias(frameIndex, renderResolution.GetMipLodBias());
     const RgFloat2D jitter = renderResolution.IsNvDlssEnabled() ? HaltonSequence::GetJitter_Halton23(frameId) : RgFloat2D{ 0, 0 };
@@ -786,11 +845,17 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
 
     // submit geometry and upload uniform after getting data from a scene
-    const bool raysCanBeTraced = scene->SubmitForFrame(cmd, frameIndex, uniform, 
-                                                       uniform->GetData()->rayCullMaskWorld, 
-                                                       allowGeometryWithSkyFlag, 
-                                                       drawInfo.pReflectRefractParams ? drawInfo.pReflectRefractParams->isReflRefrAlphaTested : false,
-                                                       drawInfo.disableRayTracing);
+    bool raysCanBeTraced;
+    {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Scene and acceleration structures");
+
+        raysCanBeTraced = scene->SubmitForFrame(cmd, frameIndex, uniform, 
+                                                uniform->GetData()->rayCullMaskWorld, 
+                                                allowGeometryWithSkyFlag, 
+                                                drawInfo.pReflectRefractParams ? drawInfo.pReflectRefractParams->isReflRefrAlphaTested : false,
+                                                drawInfo.disableRayTracing,
+                                                drawInfo.cullStaticChunksBySector ? &drawInfo.cameraSectorID : nullptr);
+    }
 
 
     framebuffers->PrepareForSize(renderResolution.GetResolutionState());
@@ -798,6 +863,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     if (!drawInfo.disableRasterization)
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Rasterized sky");
+
         rasterizer->SubmitForFrame(cmd, frameIndex);
 
         // draw rasterized sky to albedo before tracing primary rays
@@ -814,34 +881,60 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     if (raysCanBeTraced)
     {
-        decalManager->SubmitForFrame(cmd, frameIndex);
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Primary rays");
 
-        pathTracer->Bind(
-            cmd, frameIndex, 
-            scene, uniform, textureManager, 
-            framebuffers, blueNoise, cubemapManager, rasterizer->GetRenderCubemap());
+            decalManager->SubmitForFrame(cmd, frameIndex);
 
-        pathTracer->TracePrimaryRays(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
+            pathTracer->Bind(
+                cmd, frameIndex, 
+                scene, uniform, textureManager, 
+                framebuffers, blueNoise, cubemapManager, rasterizer->GetRenderCubemap());
 
-        // draw decals on top of primary surface
-        decalManager->Draw(cmd, frameIndex, uniform, framebuffers, textureManager);
+            pathTracer->TracePrimaryRays(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
+        }
+
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Decals");
+
+            // draw decals on top of primary surface
+            decalManager->Draw(cmd, frameIndex, uniform, framebuffers, textureManager);
+        }
 
         if (uniform->GetData()->reflectRefractMaxDepth > 0)
         {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Reflection and refraction rays");
+
             pathTracer->TraceReflectionRefractionRays(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
         }
 
-        // save and merge samples from previous illumination results
-        denoiser->MergeSamples(cmd, frameIndex, uniform, scene->GetASManager());
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Merge samples");
+
+            // save and merge samples from previous illumination results
+            denoiser->MergeSamples(cmd, frameIndex, uniform, scene->GetASManager());
+        }
 
         // update the illumination
-        pathTracer->TraceDirectllumination(  cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
-        pathTracer->TraceIndirectllumination(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Direct illumination");
+            pathTracer->TraceDirectllumination(  cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
+        }
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Indirect illumination");
+            pathTracer->TraceIndirectllumination(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
+        }
 
-        denoiser->Denoise(cmd, frameIndex, uniform);
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Denoising");
+            denoiser->Denoise(cmd, frameIndex, uniform);
+        }
 
         // tonemapping
-        tonemapping->Tonemap(cmd, frameIndex, uniform);
+        {
+            GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Tonemapping");
+            tonemapping->Tonemap(cmd, frameIndex, uniform);
+        }
     }
 
 
@@ -849,15 +942,21 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     if (enableBloom)
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Bloom");
         bloom->Prepare(cmd, frameIndex, uniform, tonemapping);
     }
 
 
     // final image composition
-    imageComposition->Compose(cmd, frameIndex, uniform, tonemapping);
+    {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Image composition");
+        imageComposition->Compose(cmd, frameIndex, uniform, tonemapping);
+    }
 
     if (!drawInfo.disableRasterization)
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Rasterized geometry");
+
         // draw rasterized geometry into the final image
         rasterizer->DrawToFinalImage(cmd, frameIndex, textureManager,
                                      uniform->GetData()->view, uniform->GetData()->projection,
@@ -867,6 +966,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     FramebufferImageIndex currentResultImage = FramebufferImageIndex::FB_IMAGE_INDEX_FINAL;
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Upscaling");
+
         VkExtent2D extent = { renderResolution.Width(), renderResolution.Height() };
 
 
@@ -895,6 +996,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     const CommonnlyUsedEffectArguments args = { cmd, frameIndex, framebuffers, uniform, renderResolution.UpscaledWidth(), renderResolution.UpscaledHeight(), (float)currentFrameTime };
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Post-effects");
+
         if (renderResolution.IsSharpeningEnabled())
         {
             currentResultImage = sharpening->Apply(
@@ -941,12 +1044,16 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     // draw geometry such as HUD directly into the swapchain image
     if (!drawInfo.disableRasterization)
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Rasterized swapchain geometry");
+
         rasterizer->DrawToSwapchain(cmd, frameIndex, currentResultImage, textureManager,
                                     uniform->GetData()->view, uniform->GetData()->projection);
     }
 
     // post-effect that work on swapchain geometry too
     {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Swapchain post-effects");
+
         if (effectWipe->Setup(args, drawInfo.postEffectParams.pWipe, swapchain, frameId))
         {
             currentResultImage = effectWipe->Apply(args, blueNoise, currentResultImage);
@@ -962,9 +1069,13 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     }
 
     // blit result image to present on a surface
-    framebuffers->PresentToSwapchain(
-        cmd, frameIndex, swapchain,
-        currentResultImage, VK_FILTER_NEAREST);
+    {
+        GpuTimestampScope ts(*gpuTimestamps, cmd, frameIndex, "Present");
+
+        framebuffers->PresentToSwapchain(
+            cmd, frameIndex, swapchain,
+            currentResultImage, VK_FILTER_NEAREST);
+    }
 }
 
 void VulkanDevice::EndFrame(VkCommandBuffer cmd)
@@ -972,12 +1083,15 @@ void VulkanDevice::EndFrame(VkCommandBuffer cmd)
     uint32_t frameIndex = currentFrameState.GetFrameIndex();
     VkSemaphore semaphoreToWait = currentFrameState.GetSemaphoreForWaitAndRemove();
 
-    // submit command buffer, but wait until presentation engine has completed using image
+    gpuTimestamps->FinishFrame(cmd, frameIndex);
+
+    // submit command buffer, but wait until presentation engine has completed using image;
+    // if headless, nothing will wait for the render finish
     cmdManager->Submit(
         cmd, 
         semaphoreToWait,
         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-        renderFinishedSemaphores[frameIndex],
+        swapchain->IsHeadless() ? VK_NULL_HANDLE : renderFinishedSemaphores[frameIndex],
         frameFences[frameIndex]);
 
     // present on a surface when rendering will be finished
@@ -1056,75 +1170,115 @@ bool RTGL1::VulkanDevice::IsRenderUpscaleTechniqueAvailable(RgRenderUpscaleTechn
     }
 }
 
-void VulkanDevice::Print(const char *pMessage) const
+void VulkanDevice::GetStatistics(RgStatistics *pResult) const
 {
-    userPrint->Print(pMessage);
-}
+    if (pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
 
+    *pResult = {};
 
-void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
-{
-    using namespace std::string_literals;
+    scene->GetASManager()->GetStatistics(*pResult);
+}
 
-    if (uploadInfo == nullptr)
+void VulkanDevice::GetFrameTimings(RgFrameTimings *pResult) const
+{
+    if (pResult == nullptr)
     {
         throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
     }
 
-    if (uploadInfo->pVertexData == nullptr || uploadInfo->vertexCount == 0)
+    gpuTimestamps->GetFrameTimings(*pResult);
+}
+
+void VulkanDevice::Print(const char *pMessage) const
+{
+    userPrint->Print(pMessage);
+}
+
+
+void VulkanDevice::ValidateGeometryUploadInfo(const RgGeometryUploadInfo &info) const
+{
+    if (info.pVertexData == nullptr || info.vertexCount == 0)
     {
         throw RgException(RG_WRONG_ARGUMENT, "Incorrect vertex data");
     }
 
-    if ((uploadInfo->pIndexData == nullptr && uploadInfo->indexCount != 0) ||
-        (uploadInfo->pIndexData != nullptr && uploadInfo->indexCount == 0))
+    if ((info.pIndexData == nullptr && info.indexCount != 0) ||
+        (info.pIndexData != nullptr && info.indexCount == 0))
     {
         throw RgException(RG_WRONG_ARGUMENT, "Incorrect index data");
     }
 
-    if (uploadInfo->geomType != RG_GEOMETRY_TYPE_STATIC &&
-        uploadInfo->geomType != RG_GEOMETRY_TYPE_STATIC_MOVABLE &&
-        uploadInfo->geomType != RG_GEOMETRY_TYPE_DYNAMIC &&
+    if (info.geomType != RG_GEOMETRY_TYPE_STATIC &&
+        info.geomType != RG_GEOMETRY_TYPE_STATIC_MOVABLE &&
+        info.geomType != RG_GEOMETRY_TYPE_DYNAMIC &&
 
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_OPAQUE &&
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_ALPHA_TESTED &&
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_MIRROR &&
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_PORTAL &&
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_WATER_ONLY_REFLECT &&
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_WATER_REFLECT_REFRACT &&
-        uploadInfo->passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_GLASS_REFLECT_REFRACT &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_OPAQUE &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_ALPHA_TESTED &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_MIRROR &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_PORTAL &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_WATER_ONLY_REFLECT &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_WATER_REFLECT_REFRACT &&
+        info.passThroughType != RG_GEOMETRY_PASS_THROUGH_TYPE_GLASS_REFLECT_REFRACT &&
 
-        uploadInfo->visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_WORLD_0 &&
-        uploadInfo->visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_WORLD_1 &&
-        uploadInfo->visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_WORLD_2 &&
-        uploadInfo->visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_FIRST_PERSON &&
-        uploadInfo->visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_FIRST_PERSON_VIEWER && 
-        uploadInfo->visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_SKY)
+        info.visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_WORLD_0 &&
+        info.visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_WORLD_1 &&
+        info.visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_WORLD_2 &&
+        info.visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_FIRST_PERSON &&
+        info.visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_FIRST_PERSON_VIEWER && 
+        info.visibilityType != RG_GEOMETRY_VISIBILITY_TYPE_SKY)
     {
         throw RgException(RG_WRONG_ARGUMENT, "Incorrect type of ray traced geometry");
     }
 
     if (allowGeometryWithSkyFlag)
     {
-        if (uploadInfo->visibilityType == RG_GEOMETRY_VISIBILITY_TYPE_WORLD_2)
+        if (info.visibilityType == RG_GEOMETRY_VISIBILITY_TYPE_WORLD_2)
         {
             throw RgException(RG_WRONG_ARGUMENT, "Geometry with RG_GEOMETRY_VISIBILITY_TYPE_WORLD_2 cannot be used, as RgInstanceCreateInfo::allowGeometryWithSkyFlag was true");
         }
     }
     else
     {
-        if (uploadInfo->visibilityType == RG_GEOMETRY_VISIBILITY_TYPE_SKY)
+        if (info.visibilityType == RG_GEOMETRY_VISIBILITY_TYPE_SKY)
         {
             throw RgException(RG_WRONG_ARGUMENT, "Geometry with RG_GEOMETRY_VISIBILITY_TYPE_SKY cannot be used, as RgInstanceCreateInfo::allowGeometryWithSkyFlag was false");
         }
     }
 
-    if ((uploadInfo->flags & RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_MULTIPLY_BIT) != 0 &&
-        (uploadInfo->flags & RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_ADD_BIT) != 0)
+    if ((info.flags & RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_MULTIPLY_BIT) != 0 &&
+        (info.flags & RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_ADD_BIT) != 0)
     {
         throw RgException(RG_WRONG_ARGUMENT, "RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_MULTIPLY_BIT and RG_GEOMETRY_UPLOAD_REFL_REFR_ALBEDO_ADD_BIT must be set separately");
     }
 
+    if (info.flags & RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT)
+    {
+        if (info.geomType == RG_GEOMETRY_TYPE_DYNAMIC)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT can be set only for static geometry");
+        }
+
+        if (info.pNormalData == nullptr)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Geometry with RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT must have normals");
+        }
+    }
+}
+
+void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
+{
+    using namespace std::string_literals;
+
+    if (uploadInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    ValidateGeometryUploadInfo(*uploadInfo);
+
     if (scene->DoesUniqueIDExist(uploadInfo->uniqueID))
     {
         throw RgException(RG_WRONG_ARGUMENT, "Geometry with ID="s + std::to_string(uploadInfo->uniqueID) + " already exists");
@@ -1133,6 +1287,31 @@ void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
     scene->Upload(currentFrameState.GetFrameIndex(), *uploadInfo);
 }
 
+void VulkanDevice::ReserveDynamicGeometry(uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping *pResult)
+{
+    if (pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (!currentFrameState.WasFrameStarted())
+    {
+        throw RgException(RG_FRAME_WASNT_STARTED);
+    }
+
+    if (vertexCount == 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Incorrect vertex count");
+    }
+
+    if (indexCount % 3 != 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Index count must be a multiple of 3");
+    }
+
+    scene->ReserveDynamicGeometry(currentFrameState.GetFrameIndex(), vertexCount, indexCount, *pResult);
+}
+
 void VulkanDevice::UpdateGeometryTransform(const RgUpdateTransformInfo *updateInfo)
 {
     if (updateInfo == nullptr)
@@ -1153,6 +1332,135 @@ void RTGL1::VulkanDevice::UpdateGeometryTexCoords(const RgUpdateTexCoordsInfo *u
     scene->UpdateTexCoords(*updateInfo);
 }
 
+void VulkanDevice::UploadMeshInstance(const RgMeshInstanceUploadInfo *uploadInfo)
+{
+    using namespace std::string_literals;
+
+    if (uploadInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (!currentFrameState.WasFrameStarted())
+    {
+        throw RgException(RG_FRAME_WASNT_STARTED);
+    }
+
+    if (!scene->DoesMeshExist(uploadInfo->meshUniqueID))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Mesh with ID="s + std::to_string(uploadInfo->meshUniqueID) + " doesn't exist or wasn't uploaded with RG_GEOMETRY_UPLOAD_INSTANCED_MESH_BIT");
+    }
+
+    if (!scene->UploadMeshInstance(currentFrameState.GetFrameIndex(), *uploadInfo))
+    {
+        throw RgException(RG_CANT_UPLOAD_MESH_INSTANCE, "Can't place mesh with ID="s + std::to_string(uploadInfo->meshUniqueID) +
+                          ", the limit of " + std::to_string(MAX_MESH_INSTANCE_COUNT) + " mesh instances per frame is reached");
+    }
+}
+
+void VulkanDevice::CreateSkinnedMesh(const RgSkinnedMeshCreateInfo *pCreateInfo, RgSkinnedMesh *pResult)
+{
+    if (pCreateInfo == nullptr || pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    *pResult = scene->GetVertexSkinning()->CreateMesh(*pCreateInfo);
+}
+
+void VulkanDevice::DestroySkinnedMesh(RgSkinnedMesh skinnedMesh)
+{
+    scene->GetVertexSkinning()->DestroyMesh(currentFrameState.GetFrameIndex(), skinnedMesh);
+}
+
+void VulkanDevice::UploadSkinnedGeometry(const RgSkinnedGeometryUploadInfo *pUploadInfo)
+{
+    using namespace std::string_literals;
+
+    if (pUploadInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (!currentFrameState.WasFrameStarted())
+    {
+        throw RgException(RG_FRAME_WASNT_STARTED);
+    }
+
+    if (pUploadInfo->geometry.geomType != RG_GEOMETRY_TYPE_DYNAMIC)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Skinned geometry must be RG_GEOMETRY_TYPE_DYNAMIC");
+    }
+
+    if (pUploadInfo->pBoneTransforms == nullptr || pUploadInfo->boneCount == 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Incorrect bone transforms");
+    }
+
+    if (scene->DoesUniqueIDExist(pUploadInfo->geometry.uniqueID))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Geometry with ID="s + std::to_string(pUploadInfo->geometry.uniqueID) + " already exists");
+    }
+
+    scene->UploadSkinned(currentFrameState.GetFrameIndex(), *pUploadInfo);
+}
+
+void VulkanDevice::CreateRetainedGeometry(const RgGeometryUploadInfo *pCreateInfo, RgRetainedGeometry *pResult)
+{
+    using namespace std::string_literals;
+
+    if (pCreateInfo == nullptr || pResult == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    ValidateGeometryUploadInfo(*pCreateInfo);
+
+    if (pCreateInfo->geomType != RG_GEOMETRY_TYPE_DYNAMIC)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Retained geometry must be RG_GEOMETRY_TYPE_DYNAMIC");
+    }
+
+    // like for dynamic geometry, only the first layer is kept
+    if (pCreateInfo->pTexCoordLayerData[1] != nullptr || pCreateInfo->pTexCoordLayerData[2] != nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Retained geometry can have only one texture coordinates layer, "
+                                             "pTexCoordLayerData[1] and pTexCoordLayerData[2] must be null");
+    }
+
+    if (scene->DoesUniqueIDExist(pCreateInfo->uniqueID))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Geometry with ID="s + std::to_string(pCreateInfo->uniqueID) + " already exists");
+    }
+
+    *pResult = scene->GetRetainedGeometryManager()->Create(*pCreateInfo);
+}
+
+void VulkanDevice::DestroyRetainedGeometry(RgRetainedGeometry retainedGeometry)
+{
+    scene->GetRetainedGeometryManager()->Destroy(currentFrameState.GetFrameIndex(), retainedGeometry);
+}
+
+void VulkanDevice::UpdateRetainedGeometryTransform(RgRetainedGeometry retainedGeometry, const RgTransform *pTransform)
+{
+    if (pTransform == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    scene->GetRetainedGeometryManager()->UpdateTransform(retainedGeometry, *pTransform);
+}
+
+void VulkanDevice::UpdateRetainedGeometryVertices(const RgUpdateRetainedVerticesInfo *pUpdateInfo)
+{
+    if (pUpdateInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    scene->GetRetainedGeometryManager()->UpdateVertices(*pUpdateInfo);
+}
+
 void VulkanDevice::UploadRasterizedGeometry(const RgRasterizedGeometryUploadInfo *pUploadInfo,
                                                 const float *pViewProjection, const RgViewport *pViewport)
 {
@@ -1223,6 +1531,30 @@ void VulkanDevice::StartNewStaticScene()
     scene->StartNewStatic();
 }
 
+void VulkanDevice::AddStaticGeometry(const RgGeometryUploadInfo *pUploadInfo)
+{
+    using namespace std::string_literals;
+
+    if (pUploadInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    ValidateGeometryUploadInfo(*pUploadInfo);
+
+    if (scene->DoesUniqueIDExist(pUploadInfo->uniqueID))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Geometry with ID="s + std::to_string(pUploadInfo->uniqueID) + " already exists");
+    }
+
+    scene->AddIncrementalStatic(currentFrameState.GetFrameIndex(), *pUploadInfo);
+}
+
+void VulkanDevice::RemoveStaticGeometry(uint64_t staticUniqueID)
+{
+    scene->RemoveIncrementalStatic(currentFrameState.GetFrameIndex(), staticUniqueID);
+}
+
 void VulkanDevice::UploadLight(const RgDirectionalLightUploadInfo *pLightInfo)
 {
     if (pLightInfo == nullptr)
@@ -1268,6 +1600,19 @@ void RTGL1::VulkanDevice::SetPotentialVisibility(SectorID sectorID_A, SectorID s
     scene->SetPotentialVisibility(sectorID_A, sectorID_B);
 }
 
+void RTGL1::VulkanDevice::SetPotentialVisibility(const RgPotentialVisibilityMatrixInfo *pInfo)
+{
+    if (pInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    static_assert(sizeof(SectorID) == sizeof(uint32_t), "");
+    static_assert(std::is_trivial_v<SectorID>, "");
+
+    scene->SetPotentialVisibility(reinterpret_cast<const SectorID *>(pInfo->pSectorIDs), pInfo->sectorCount, pInfo->pVisibilityBits);
+}
+
 void VulkanDevice::CreateStaticMaterial(const RgStaticMaterialCreateInfo *createInfo, RgMaterial *result)
 {
     if (createInfo == nullptr)
@@ -1344,6 +1689,13 @@ void VulkanDevice::DestroyMaterial(RgMaterial material)
 {
     textureManager->DestroyMaterial(currentFrameState.GetFrameIndex(), material);
 }
+void VulkanDevice::RescanOverridenTexturesFolder()
+{
+    if (overrideFileIndex)
+    {
+        overrideFileIndex->Rescan();
+    }
+}
 void VulkanDevice::CreateSkyboxCubemap(const RgCubemapCreateInfo *createInfo, RgCubemap *result)
 {
     *result = cubemapManager->CreateCubemap(currentFrameState.GetCmdBufferForMaterials(cmdManager), currentFrameState.GetFrameIndex(), *createInfo);
@@ -1431,28 +1783,38 @@ void VulkanDevice::CreateInstance(const RgInstanceCreateInfo &info)
     std::vector<const char *> extensions =
     {
         VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
-        VK_KHR_SURFACE_EXTENSION_NAME,
+    };
+
+    // headless instance doesn't need any surface extensions
+    if (info.pHeadlessSurfaceCreateInfo == nullptr)
+    {
+        const char *surfaceExtensions[] =
+        {
+            VK_KHR_SURFACE_EXTENSION_NAME,
 
-    #ifdef RG_USE_SURFACE_WIN32
-        VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
-    #endif // RG_USE_SURFACE_WIN32
+        #ifdef RG_USE_SURFACE_WIN32
+            VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
+        #endif // RG_USE_SURFACE_WIN32
 
-    #ifdef RG_USE_SURFACE_METAL
-        VK_EXT_METAL_SURFACE_EXTENSION_NAME,
-    #endif // RG_USE_SURFACE_METAL
+        #ifdef RG_USE_SURFACE_METAL
+            VK_EXT_METAL_SURFACE_EXTENSION_NAME,
+        #endif // RG_USE_SURFACE_METAL
 
-    #ifdef RG_USE_SURFACE_WAYLAND
-        VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME,
-    #endif // RG_USE_SURFACE_WAYLAND
+        #ifdef RG_USE_SURFACE_WAYLAND
+            VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME,
+        #endif // RG_USE_SURFACE_WAYLAND
 
-    #ifdef RG_USE_SURFACE_XCB
-        VK_KHR_XCB_SURFACE_EXTENSION_NAME,
-    #endif // RG_USE_SURFACE_XCB
+        #ifdef RG_USE_SURFACE_XCB
+            VK_KHR_XCB_SURFACE_EXTENSION_NAME,
+        #endif // RG_USE_SURFACE_XCB
 
-    #ifdef RG_USE_SURFACE_XLIB
-        VK_KHR_XLIB_SURFACE_EXTENSION_NAME,
-    #endif // RG_USE_SURFACE_XLIB
-    };
+        #ifdef RG_USE_SURFACE_XLIB
+            VK_KHR_XLIB_SURFACE_EXTENSION_NAME,
+        #endif // RG_USE_SURFACE_XLIB
+        };
+
+        extensions.insert(extensions.end(), std::begin(surfaceExtensions), std::end(surfaceExtensions));
+    }
 
     if (enableValidationLayer)
     {
@@ -1623,7 +1985,6 @@ void VulkanDevice::CreateDevice()
     }
 
     std::vector<const char *> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
         VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
         VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
         VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
@@ -1632,6 +1993,12 @@ void VulkanDevice::CreateDevice()
         VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME,
     };
 
+    // headless instance doesn't have a surface to present to
+    if (surface != VK_NULL_HANDLE)
+    {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
     for (const char *n : DLSS::GetDlssVulkanDeviceExtensions())
     {
         const bool isSupported = std::any_of(supportedDeviceExtensions.cbegin(), supportedDeviceExtensions.cend(),
@@ -1715,6 +2082,12 @@ VkSurfaceKHR VulkanDevice::GetSurfaceFromUser(VkInstance instance, const RgInsta
     VkResult r;
 
 
+    if (info.pHeadlessSurfaceCreateInfo != nullptr)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+
 #ifdef RG_USE_SURFACE_WIN32
     if (info.pWin32SurfaceInfo != nullptr)
     {
@@ -1865,7 +2238,8 @@ void RTGL1::VulkanDevice::ValidateCreateInfo(const RgInstanceCreateInfo *pInfo)
             !!pInfo->pMetalSurfaceCreateInfo +
             !!pInfo->pWaylandSurfaceCreateInfo +
             !!pInfo->pXcbSurfaceCreateInfo +
-            !!pInfo->pXlibSurfaceCreateInfo;
+            !!pInfo->pXlibSurfaceCreateInfo +
+            !!pInfo->pHeadlessSurfaceCreateInfo;
 
         if (count != 1)
         {
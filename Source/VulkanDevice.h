@@ -49,6 +49,7 @@
 #include "DLSS.h"
 #include "RenderResolutionHelper.h"
 #include "DecalManager.h"
+#include "GpuTimestamps.h"
 #include "EffectWipe.h"
 #include "EffectSimple_Instances.h"
 
@@ -67,8 +68,17 @@ public:
     VulkanDevice& operator=(VulkanDevice&& other) noexcept = delete;
 
     void UploadGeometry(const RgGeometryUploadInfo *pUploadInfo);
+    void ReserveDynamicGeometry(uint32_t vertexCount, uint32_t indexCount, RgDynamicGeometryMapping *pResult);
     void UpdateGeometryTransform(const RgUpdateTransformInfo *pUpdateInfo);
     void UpdateGeometryTexCoords(const RgUpdateTexCoordsInfo *pUpdateInfo);
+    void UploadMeshInstance(const RgMeshInstanceUploadInfo *pUploadInfo);
+    void CreateSkinnedMesh(const RgSkinnedMeshCreateInfo *pCreateInfo, RgSkinnedMesh *pResult);
+    void DestroySkinnedMesh(RgSkinnedMesh skinnedMesh);
+    void UploadSkinnedGeometry(const RgSkinnedGeometryUploadInfo *pUploadInfo);
+    void CreateRetainedGeometry(const RgGeometryUploadInfo *pCreateInfo, RgRetainedGeometry *pResult);
+    void DestroyRetainedGeometry(RgRetainedGeometry retainedGeometry);
+    void UpdateRetainedGeometryTransform(RgRetainedGeometry retainedGeometry, const RgTransform *pTransform);
+    void UpdateRetainedGeometryVertices(const RgUpdateRetainedVerticesInfo *pUpdateInfo);
 
     void UploadRasterizedGeometry(const RgRasterizedGeometryUploadInfo *pUploadInfo,
                                   const float *pViewProjection, const RgViewport *pViewport);
@@ -77,6 +87,8 @@ public:
 
     void SubmitStaticGeometries();
     void StartNewStaticScene();
+    void AddStaticGeometry(const RgGeometryUploadInfo *pUploadInfo);
+    void RemoveStaticGeometry(uint64_t staticUniqueID);
 
     void UploadLight(const RgDirectionalLightUploadInfo *pLightInfo);
     void UploadLight(const RgSphericalLightUploadInfo *pLightInfo);
@@ -84,6 +96,7 @@ public:
     void UploadLight(const RgPolygonalLightUploadInfo *pLightInfo);
 
     void SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B);
+    void SetPotentialVisibility(const RgPotentialVisibilityMatrixInfo *pInfo);
 
     void CreateStaticMaterial(const RgStaticMaterialCreateInfo *pCreateInfo, RgMaterial *pResult);
     void CreateAnimatedMaterial(const RgAnimatedMaterialCreateInfo *pCreateInfo, RgMaterial *pResult);
@@ -91,6 +104,7 @@ public:
     void CreateDynamicMaterial(const RgDynamicMaterialCreateInfo *pCreateInfo, RgMaterial *pResult);
     void UpdateDynamicMaterial(const RgDynamicMaterialUpdateInfo *pUpdateInfo);
     void DestroyMaterial(RgMaterial material);
+    void RescanOverridenTexturesFolder();
 
     void CreateSkyboxCubemap(const RgCubemapCreateInfo *pCreateInfo, RgCubemap *pResult);
     void DestroyCubemap(RgCubemap cubemap);
@@ -101,6 +115,8 @@ public:
 
 
     bool IsRenderUpscaleTechniqueAvailable(RgRenderUpscaleTechnique technique) const;
+    void GetStatistics(RgStatistics *pResult) const;
+    void GetFrameTimings(RgFrameTimings *pResult) const;
 
 
     void Print(const char *pMessage) const;
@@ -111,6 +127,7 @@ private:
     void CreateSyncPrimitives();
     static VkSurfaceKHR GetSurfaceFromUser(VkInstance instance, const RgInstanceCreateInfo &info);
     void ValidateCreateInfo(const RgInstanceCreateInfo *pInfo);
+    void ValidateGeometryUploadInfo(const RgGeometryUploadInfo &info) const;
 
     void DestroyInstance();
     void DestroyDevice();
@@ -263,11 +280,13 @@ private:
     std::shared_ptr<GlobalUniform>          uniform;
     std::shared_ptr<Scene>                  scene;
 
+    std::shared_ptr<PipelineCache>          pipelineCache;
     std::shared_ptr<ShaderManager>          shaderManager;
     std::shared_ptr<RayTracingPipeline>     rtPipeline;
     std::shared_ptr<PathTracer>             pathTracer;
     std::shared_ptr<Rasterizer>             rasterizer;
     std::shared_ptr<DecalManager>           decalManager;
+    std::shared_ptr<GpuTimestamps>          gpuTimestamps;
     std::shared_ptr<Denoiser>               denoiser;
     std::shared_ptr<Tonemapping>            tonemapping;
     std::shared_ptr<ImageComposition>       imageComposition;
@@ -289,6 +308,9 @@ private:
     std::shared_ptr<SamplerManager>         worldSamplerManager;
     std::shared_ptr<SamplerManager>         genericSamplerManager;
     std::shared_ptr<BlueNoise>              blueNoise;
+    std::shared_ptr<TextureStagingRing>     textureStagingRing;
+    std::shared_ptr<OverrideFileIndex>      overrideFileIndex;
+    std::shared_ptr<MipmapGenerator>        mipmapGenerator;
     std::shared_ptr<TextureManager>         textureManager;
     std::shared_ptr<CubemapManager>         cubemapManager;
 